@@ -0,0 +1,500 @@
+// Benchmarks des noyaux de la simulation (Google Benchmark)
+//
+// Chaque benchmark prend en arguments le nombre de particules et la densité
+// en centièmes de particules par unité de surface (2D) ou de volume (3D).
+// Exemple : ./UniversBench --benchmark_filter=CalculForces3D
+
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <random>
+#include <string>
+
+#include "NoyauLJ.hxx"
+#include "OrdreCellules.hxx"
+#include "PotentielTabule.hxx"
+#include "Trajectoire.hxx"
+#include "Univers.hxx"
+#include "Vector3D.hxx"
+
+// Number of heap allocations of the whole program, counted by the replaced operator new
+std::atomic<long> nbAllocations(0);
+
+// Not inlined, so that the compiler does not pair the calls to malloc and free with those to new and delete
+#if defined(__GNUC__)
+#define NON_INLINE __attribute__((noinline))
+#else
+#define NON_INLINE
+#endif
+
+NON_INLINE void *operator new(std::size_t taille) {
+    nbAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(taille ? taille : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+NON_INLINE void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+NON_INLINE void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+const std::vector<int64_t> NB_PARTICULES = {1000, 10000, 100000, 1000000};
+const std::vector<int64_t> DENSITES = {30, 60, 90};
+
+// Builds a periodic universe of the given size and density, without any output
+Univers creerUnivers(int dimension, int64_t nbParticules, int64_t densite) {
+    const double rho = densite / 100.0;
+    const int L = static_cast<int>(std::ceil(std::pow(nbParticules / rho, 1.0 / dimension)));
+    srand(0);
+    Univers univers(dimension, L, L, (dimension == 3) ? L : 0, 1, 1, 2.5, 0.0005, 1, 1, 0, 0);
+    univers.setFrequenceSortie(0);
+    univers.initialiserUniforme(static_cast<int>(nbParticules), 1);
+    return univers;
+}
+
+// Reports the number of particles processed per second
+void compterParticules(benchmark::State &state, const Univers &univers) {
+    state.counters["particules"] = univers.getNbParticules();
+    state.counters["particules/s"] = benchmark::Counter(univers.getNbParticules(), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// Reports the number of heap allocations per iteration since a count taken before the loop
+void compterAllocations(benchmark::State &state, long avant) {
+    state.counters["allocations"] = benchmark::Counter(static_cast<double>(nbAllocations.load() - avant), benchmark::Counter::kAvgIterations);
+}
+
+void BM_CalculForces(benchmark::State &state) {
+    Univers univers = creerUnivers(2, state.range(0), state.range(1));
+    for (auto _ : state) {
+        univers.calculForces();
+    }
+    compterParticules(state, univers);
+}
+
+void BM_CalculForces3D(benchmark::State &state) {
+    Univers univers = creerUnivers(3, state.range(0), state.range(1));
+    for (auto _ : state) {
+        univers.calculForces3D();
+    }
+    compterParticules(state, univers);
+}
+
+// The particles are moved back and forth by a small step so that some of them change cell
+void BM_ReassignCells(benchmark::State &state) {
+    Univers univers = creerUnivers(2, state.range(0), state.range(1));
+    ParticuleStore &store = univers.getStore();
+    double deplacement = 0.05;
+    for (auto _ : state) {
+        for (auto &x : store.x) {
+            x += deplacement;
+        }
+        deplacement = -deplacement;
+        univers.reassignCells();
+    }
+    compterParticules(state, univers);
+}
+
+void BM_ReassignCells3D(benchmark::State &state) {
+    Univers univers = creerUnivers(3, state.range(0), state.range(1));
+    ParticuleStore &store = univers.getStore();
+    double deplacement = 0.05;
+    for (auto _ : state) {
+        for (auto &x : store.x) {
+            x += deplacement;
+        }
+        deplacement = -deplacement;
+        univers.reassignCells3D();
+    }
+    compterParticules(state, univers);
+}
+
+// Second argument: VTK format (0 = ASCII, 1 = binary, 2 = compressed)
+void BM_WriteVTKFile(benchmark::State &state) {
+    Univers univers = creerUnivers(3, state.range(0), 60);
+    if (state.range(1) == 2 && !EcritureVTK::zlibDisponible()) {
+        state.SkipWithError("Built without zlib");
+        return;
+    }
+    univers.setFormatVTK(static_cast<int>(state.range(1)));
+    const std::string filename = "bench_univers.vtu";
+    for (auto _ : state) {
+        univers.writeVTKFile(filename);
+    }
+    std::remove(filename.c_str());
+    compterParticules(state, univers);
+}
+
+void BM_EnergieCinetique(benchmark::State &state) {
+    Univers univers = creerUnivers(3, state.range(0), state.range(1));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(univers.energieCinetique());
+    }
+    compterParticules(state, univers);
+}
+
+// One complete time step (positions, boundary conditions, cells, forces, velocities)
+void BM_Pas2D(benchmark::State &state) {
+    Univers univers = creerUnivers(2, state.range(0), state.range(1));
+    univers.avancer(1);
+    const long allocations = nbAllocations.load();
+    for (auto _ : state) {
+        univers.avancer(1);
+    }
+    compterParticules(state, univers);
+    compterAllocations(state, allocations);
+}
+
+void BM_Pas3D(benchmark::State &state) {
+    Univers univers = creerUnivers(3, state.range(0), state.range(1));
+    univers.avancer(1);
+    const long allocations = nbAllocations.load();
+    for (auto _ : state) {
+        univers.avancer(1);
+    }
+    compterParticules(state, univers);
+    compterAllocations(state, allocations);
+}
+
+// Arguments: instruction set (see NoyauLJ) and number of neighbors of the batch.
+// Every particle of a random box is evaluated against the batch that follows it
+void BM_NoyauLJ(benchmark::State &state) {
+    const int jeu = static_cast<int>(state.range(0));
+    const int longueur = static_cast<int>(state.range(1));
+    if (!NoyauLJ::estDisponible(jeu)) {
+        state.SkipWithError("Instruction set not supported");
+        return;
+    }
+    const int n = 4096;
+    std::vector<ReelPosition> x(n + longueur), y(n + longueur), z(n + longueur);
+    std::vector<ReelForce> fx(n + longueur), fy(n + longueur), fz(n + longueur);
+    std::vector<float> masse(n + longueur, 1.0f);
+    std::mt19937 generateur(0);
+    std::uniform_real_distribution<double> position(0.0, 4.0);
+    for (size_t k = 0; k < x.size(); k++) {
+        x[k] = position(generateur);
+        y[k] = position(generateur);
+        z[k] = position(generateur);
+    }
+    const NoyauLJ noyau({2.5 * 2.5, 1.0, 24.0, true, true}, jeu);
+    for (auto _ : state) {
+        for (int i = 0; i < n; i++) {
+            double fxi = 0, fyi = 0, fzi = 0;
+            noyau.demiCoquille(x.data(), y.data(), z.data(), masse.data(), fx.data(), fy.data(), fz.data(), i, i + 1,
+                               i + 1 + longueur, fxi, fyi, fzi);
+            fx[i] += fxi;
+            fy[i] += fyi;
+            fz[i] += fzi;
+        }
+    }
+    benchmark::DoNotOptimize(fx.data());
+    state.SetLabel(NoyauLJ::getNom(jeu));
+    state.counters["paires/s"] = benchmark::Counter(static_cast<double>(n) * longueur, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// Arguments: instruction set and engine (0 = full shell, 1 = half shell), 100000 particles in 3D
+void BM_CalculForces3DJeu(benchmark::State &state) {
+    const int jeu = static_cast<int>(state.range(0));
+    if (!NoyauLJ::estDisponible(jeu)) {
+        state.SkipWithError("Instruction set not supported");
+        return;
+    }
+    Univers univers = creerUnivers(3, 100000, 60);
+    univers.setJeuInstructions(jeu);
+    univers.setForceEngine(static_cast<int>(state.range(1)));
+    univers.setProfilage(true);
+    for (auto _ : state) {
+        univers.calculForces3D();
+    }
+    state.SetLabel(NoyauLJ::getNom(jeu));
+    state.counters["paires/s"] = benchmark::Counter(static_cast<double>(univers.getProfil().getNbPairesTestees()), benchmark::Counter::kIsRate);
+}
+
+
+// Arguments: order of the cells (see OrdreCellules) and number of particles, 3D at density 0.6
+void BM_CalculForces3DOrdre(benchmark::State &state) {
+    Univers univers = creerUnivers(3, state.range(1), 60);
+    univers.setOrdreCellules(static_cast<int>(state.range(0)));
+    univers.calculForces3D();
+    for (auto _ : state) {
+        univers.calculForces3D();
+    }
+    state.SetLabel(OrdreCellules::getNom(static_cast<int>(state.range(0))));
+    compterParticules(state, univers);
+}
+
+// Same arguments, whole steps: the migrants are moved in the store in the order of the cells
+void BM_Pas3DOrdre(benchmark::State &state) {
+    Univers univers = creerUnivers(3, state.range(1), 60);
+    univers.setOrdreCellules(static_cast<int>(state.range(0)));
+    univers.avancer(1);
+    const long allocations = nbAllocations.load();
+    for (auto _ : state) {
+        univers.avancer(1);
+    }
+    state.SetLabel(OrdreCellules::getNom(static_cast<int>(state.range(0))));
+    compterParticules(state, univers);
+    compterAllocations(state, allocations);
+}
+
+
+// Arguments: number of threads and force engine (0 = full shell, 1 = half shell, 2 = Verlet
+// lists). The particles of the collision scenario fill about 3% of the cells of the box: the
+// blocks of cells are weighted by their occupancy and the idle threads steal the remaining ones
+void BM_PasConcentre(benchmark::State &state) {
+    srand(0);
+    Univers univers(2, 600, 600, 0, 1, 1, 2.5, 0.0005, 1, 1, 0, 0);
+    univers.setFrequenceSortie(0);
+    univers.initialiserDemoCercle(70, 20, 10, Vector3D(0, -10, 0), Vector3D(0, 5, 0));
+    univers.setNbThreads(static_cast<int>(state.range(0)));
+    univers.setForceEngine(state.range(1) == 0 ? 0 : 1);
+    if (state.range(1) == 2) {
+        univers.setVerletSkin(0.3f);
+    }
+    univers.avancer(1);
+    const long allocations = nbAllocations.load();
+    for (auto _ : state) {
+        univers.avancer(1);
+    }
+    compterParticules(state, univers);
+    compterAllocations(state, allocations);
+}
+
+// Arguments: potential (0 = analytic kernel, 1 = table read linearly, 2 = cubic table,
+// 3 = cubic table of a costly user term) and force engine
+void BM_CalculForces3DPotentiel(benchmark::State &state) {
+    typedef PotentielTabule::Terme Terme;
+    Univers univers = creerUnivers(3, 100000, 60);
+    univers.setForceEngine(static_cast<int>(state.range(1)));
+    univers.setProfilage(true);
+    std::vector<Terme> termes = {Terme::lennardJones(1, 1), Terme::gravitation()};
+    if (state.range(0) == 3) {
+        // Buckingham-like term with an exponential and a tenth root, evaluated only when sampling
+        Terme terme;
+        terme.coefficient = [](double r2) { return -std::exp(-std::sqrt(r2)) / std::sqrt(r2) + 6 * std::pow(r2, -4.05); };
+        terme.energie = [](double r2) { return std::exp(-std::sqrt(r2)) - std::pow(r2, -3.05); };
+        termes.push_back(terme);
+    }
+    if (state.range(0) > 0) {
+        const int interpolation = (state.range(0) == 1) ? PotentielTabule::LINEAIRE : PotentielTabule::CUBIQUE;
+        univers.setPotentielTabule(std::make_shared<PotentielTabule>(termes, 0.5, 2.5, 4096, interpolation));
+    }
+    for (auto _ : state) {
+        univers.calculForces3D();
+    }
+    state.counters["paires/s"] = benchmark::Counter(static_cast<double>(univers.getProfil().getNbPairesTestees()), benchmark::Counter::kIsRate);
+}
+
+// Arguments: law of the force field (ChampForces::LENNARD_JONES to COULOMB, -1 = analytic kernel)
+// and number of species, the particles alternating between them
+void BM_CalculForces3DChamp(benchmark::State &state) {
+    Univers univers = creerUnivers(3, 100000, 60);
+    univers.setForceEngine(1);
+    univers.setProfilage(true);
+    const int loi = static_cast<int>(state.range(0));
+    const int nbEspeces = static_cast<int>(state.range(1));
+    if (loi >= 0) {
+        auto champ = std::make_shared<ChampForces>(loi, nbEspeces, 1, 1, 1);
+        if (nbEspeces > 1) {
+            champ->setCategorie(1, (loi == ChampForces::COULOMB) ? -1 : 2, 1.2, 1.1);
+        }
+        univers.setChampForces(champ);
+    }
+    std::vector<int> &categorie = univers.getStore().categorie;
+    for (size_t i = 0; i < categorie.size(); i++) {
+        categorie[i] = static_cast<int>(i % nbEspeces);
+    }
+    for (auto _ : state) {
+        univers.calculForces3D();
+    }
+    state.counters["paires/s"] = benchmark::Counter(static_cast<double>(univers.getProfil().getNbPairesTestees()), benchmark::Counter::kIsRate);
+}
+
+// Arguments: steps between two measures of the statistics (0 = none) and force engine
+void BM_Pas3DStatistiques(benchmark::State &state) {
+    Univers univers = creerUnivers(3, 100000, 60);
+    univers.setForceEngine(static_cast<int>(state.range(1)));
+    univers.setStatistiques(static_cast<int>(state.range(0)));
+    univers.avancer(1);
+    const long allocations = nbAllocations.load();
+    for (auto _ : state) {
+        univers.avancer(1);
+    }
+    compterParticules(state, univers);
+    compterAllocations(state, allocations);
+}
+
+// Argument: thermostat (Thermostat::AUCUN, BERENDSEN, LANGEVIN or NOSE_HOOVER); ten steps per iteration
+void BM_Pas3DThermostat(benchmark::State &state) {
+    Univers univers = creerUnivers(3, 100000, 60);
+    if (state.range(0) != Thermostat::AUCUN) {
+        univers.setThermostat(static_cast<int>(state.range(0)), 0.5, 0.1, 1);
+    }
+    univers.avancer(1);
+    const long allocations = nbAllocations.load();
+    for (auto _ : state) {
+        univers.avancer(10);
+    }
+    compterParticules(state, univers);
+    compterAllocations(state, allocations);
+}
+
+// Argument: 0 = fixed step 0.002, 1 = adaptive step (displacement 0.01, up to 0.02); one iteration runs
+// a soft-sphere gas until t = 0.2 and reports its number of steps and its relative energy drift
+void BM_PasAdaptatif(benchmark::State &state) {
+    int nbPas = 0;
+    double derive = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        srand(1);
+        Univers univers(3, 25, 25, 25, 1, 1, 2.5, (state.range(0) == 1) ? 0.02 : 0.002, 0.2, 2, 0, 0);
+        univers.setFrequenceSortie(0);
+        univers.initialiserUniforme(10000, 2);
+        auto champ = std::make_shared<ChampForces>(ChampForces::SPHERE_MOLLE, 1, 1, 1);
+        champ->setGravitation(false);
+        univers.setChampForces(champ);
+        if (state.range(0) == 1) {
+            univers.setPasAdaptatif(0.01);
+        }
+        const double initiale = univers.mesurerStatistiques().getEnergieTotale();
+        state.ResumeTiming();
+        for (nbPas = 0; univers.getTemps() < 0.2f; nbPas++) {
+            univers.avancer(1);
+        }
+        state.PauseTiming();
+        derive = std::abs(univers.mesurerStatistiques().getEnergieTotale() - initiale) / std::abs(initiale);
+        state.ResumeTiming();
+    }
+    state.counters["pas"] = nbPas;
+    state.counters["derive"] = derive;
+}
+
+// Arguments: huge pages (0 = no, 1 = advised) and number of particles
+void BM_Pas3DPages(benchmark::State &state) {
+    const double rho = 0.6;
+    const int L = static_cast<int>(std::ceil(std::pow(state.range(1) / rho, 1.0 / 3)));
+    srand(0);
+    Univers univers(3, L, L, L, 1, 1, 2.5, 0.0005, 1, 1, 0, 0);
+    univers.setFrequenceSortie(0);
+    univers.setPagesEnormes(state.range(0) == 1);
+    univers.initialiserUniforme(static_cast<int>(state.range(1)), 1);
+    univers.avancer(1);
+    const long allocations = nbAllocations.load();
+    for (auto _ : state) {
+        univers.avancer(1);
+    }
+    compterParticules(state, univers);
+    compterAllocations(state, allocations);
+}
+
+// Arguments: side of the box and grid (0 = dense, 1 = sparse). The collision stays in a
+// corner of the box: the sparse grid only creates the occupied cells and their neighbors
+void BM_GrilleCreuse(benchmark::State &state) {
+    const double cote = static_cast<double>(state.range(0));
+    if (state.range(1) == 0 && cote > 5000) {
+        state.SkipWithError("dense grid too large");
+        return;
+    }
+    srand(0);
+    Univers univers(2, cote, cote, 0, 1, 1, 2.5, 0.0005, 1, 1, 0, 0);
+    univers.setFrequenceSortie(0);
+    univers.setGrilleCreuse(state.range(1) == 1);
+    univers.initialiserDemoCercle(70, 20, 10, Vector3D(0, -10, 0), Vector3D(0, 5, 0));
+    univers.avancer(1);
+    const long allocations = nbAllocations.load();
+    for (auto _ : state) {
+        univers.avancer(1);
+    }
+    compterParticules(state, univers);
+    compterAllocations(state, allocations);
+    state.counters["cellules"] = univers.getNbCellules();
+}
+
+// Arguments: number of particles and output (0 = one .vtu file per snapshot, 1 = trajectory file)
+void BM_Sortie(benchmark::State &state) {
+    Univers univers = creerUnivers(3, state.range(0), 60);
+    int nbSnapshots = 0;
+    if (state.range(1) == 0) {
+        for (auto _ : state) {
+            univers.writeVTKFile("bench_sortie_t" + std::to_string(nbSnapshots++) + ".vtu");
+        }
+        for (int k = 0; k < nbSnapshots; k++) {
+            std::remove(("bench_sortie_t" + std::to_string(k) + ".vtu").c_str());
+        }
+    } else {
+        {
+            EcritureTrajectoire trajectoire("bench_sortie.traj", 3);
+            for (auto _ : state) {
+                trajectoire.ecrire(univers.getStore(), nbSnapshots, nbSnapshots);
+                nbSnapshots++;
+            }
+            trajectoire.vider();
+        }
+        std::remove("bench_sortie.traj");
+    }
+    state.SetLabel(state.range(1) == 0 ? "vtu" : "trajectoire");
+    compterParticules(state, univers);
+}
+
+// Argument: number of particles, 3D. Writes then reads back a restart file
+void BM_SaveCheckpoint(benchmark::State &state) {
+    Univers univers = creerUnivers(3, state.range(0), 60);
+    univers.avancer(1);
+    for (auto _ : state) {
+        univers.saveCheckpoint("bench_reprise.bin");
+    }
+    std::ifstream fichier("bench_reprise.bin", std::ios::binary | std::ios::ate);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * fichier.tellg());
+    compterParticules(state, univers);
+}
+
+void BM_LoadCheckpoint(benchmark::State &state) {
+    Univers univers = creerUnivers(3, state.range(0), 60);
+    univers.avancer(1);
+    univers.saveCheckpoint("bench_reprise.bin");
+    for (auto _ : state) {
+        univers.loadCheckpoint("bench_reprise.bin");
+    }
+    std::ifstream fichier("bench_reprise.bin", std::ios::binary | std::ios::ate);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * fichier.tellg());
+    compterParticules(state, univers);
+    std::remove("bench_reprise.bin");
+}
+
+}
+
+BENCHMARK(BM_CalculForces)->ArgsProduct({NB_PARTICULES, DENSITES})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CalculForces3D)->ArgsProduct({NB_PARTICULES, DENSITES})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_NoyauLJ)->ArgsProduct({{0, 1, 2, 3}, {8, 32, 256}});
+BENCHMARK(BM_CalculForces3DJeu)->ArgsProduct({{0, 1, 2, 3}, {0, 1}})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ReassignCells)->ArgsProduct({NB_PARTICULES, DENSITES})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ReassignCells3D)->ArgsProduct({NB_PARTICULES, DENSITES})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_WriteVTKFile)->ArgsProduct({NB_PARTICULES, {0, 1, 2}})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_EnergieCinetique)->ArgsProduct({NB_PARTICULES, {60}})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Pas2D)->ArgsProduct({NB_PARTICULES, DENSITES})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Pas3D)->ArgsProduct({NB_PARTICULES, DENSITES})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CalculForces3DOrdre)->ArgsProduct({{0, 1, 2}, {100000, 1000000, 10000000}})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Pas3DOrdre)->ArgsProduct({{0, 1, 2}, {100000, 1000000, 10000000}})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PasConcentre)->ArgsProduct({{1, 2, 4, 8}, {0, 1, 2}})->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CalculForces3DPotentiel)->ArgsProduct({{0, 1, 2, 3}, {0, 1}})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CalculForces3DChamp)->ArgsProduct({{-1, 0, 1, 2, 3}, {1, 2}})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Pas3DStatistiques)->ArgsProduct({{0, 1, 100}, {0, 1}})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Pas3DThermostat)->DenseRange(0, 3)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PasAdaptatif)->DenseRange(0, 1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Pas3DPages)->ArgsProduct({{0, 1}, {100000, 1000000}})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GrilleCreuse)->ArgsProduct({{600, 5000, 25000}, {0, 1}})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Sortie)->ArgsProduct({{1000, 10000, 100000}, {0, 1}})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SaveCheckpoint)->ArgsProduct({{100000, 1000000, 10000000}})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadCheckpoint)->ArgsProduct({{100000, 1000000, 10000000}})->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,39 @@
+// Scénario de collision réparti sur plusieurs processus (décomposition de domaine)
+// Usage : mpirun -np 4 collisionMPI
+// Chaque processus construit le même univers puis ne garde que sa tranche ;
+// les fichiers de sortie portent le rang : data_t<N>_r<rang>.vtu
+
+#include <exception>
+#include <iostream>
+
+#include "DecompositionDomaine.hxx"
+#include "Univers.hxx"
+#include "Vector3D.hxx"
+
+
+int main(int argc, char **argv) {
+
+    DecompositionDomaine::initialiserMPI(&argc, &argv);
+    int code = 0;
+
+    try {
+        Univers univers = Univers(3, 300, 200, 0, 1, 1,2.5,0.005, 1.95);
+
+        univers.initialiserDemoCercle(70,20,10, Vector3D(0,-10,0),Vector3D(0,5,0));
+        univers.setDecomposition(true);
+
+        univers.evolution();
+
+        const long total = univers.getNbParticulesTotal();
+        if (univers.getDecomposition()->getRang() == 0) {
+            std::cout << total << " particules sur " << univers.getDecomposition()->getNbRangs() << " processus" << std::endl;
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        code = 1;
+    }
+
+    DecompositionDomaine::finaliserMPI();
+    return code;
+
+}
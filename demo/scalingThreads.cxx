@@ -0,0 +1,44 @@
+
+// Mesure de l'accélération du calcul des forces en fonction du nombre de threads,
+// sur la configuration de la démo collision
+
+#include <iostream>
+
+#include "Univers.hxx"
+#include "Vector3D.hxx"
+#include <chrono> // Pour mesurer le temps
+#include <cstdlib>
+#include <thread>
+
+
+int main(int argc, char **argv) {
+
+    int nbPas = (argc > 1) ? std::atoi(argv[1]) : 200;
+    int maxThreads = (argc > 2) ? std::atoi(argv[2]) : static_cast<int>(std::thread::hardware_concurrency());
+    if (maxThreads < 1) {
+        maxThreads = 1;
+    }
+
+    double tempsSequentiel = 0;
+    std::cout << "threads ; temps (s) ; acceleration" << std::endl;
+    for (int nbThreads = 1; nbThreads <= maxThreads; nbThreads *= 2) {
+        srand(0);
+        Univers univers = Univers(3, 300, 200, 0, 1, 1, 2.5, 0.005, 1.95);
+        univers.initialiserDemoCercle(70, 20, 10, Vector3D(0, -10, 0), Vector3D(0, 5, 0));
+        univers.setNbThreads(nbThreads);
+
+        auto debut = std::chrono::steady_clock::now();
+        for (int pas = 0; pas < nbPas; pas++) {
+            univers.calculForces();
+        }
+        double temps = std::chrono::duration<double>(std::chrono::steady_clock::now() - debut).count();
+
+        if (nbThreads == 1) {
+            tempsSequentiel = temps;
+        }
+        std::cout << nbThreads << " ; " << temps << " ; " << tempsSequentiel / temps << std::endl;
+    }
+
+    return 0;
+
+}
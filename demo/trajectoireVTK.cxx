@@ -0,0 +1,33 @@
+// Conversion d'un fichier de trajectoire (Univers::setTrajectoire) en fichiers .vtu
+// et en une collection .pvd pour ParaView
+// Usage : trajectoireVTK <fichier de trajectoire> [préfixe] [format : 0 = ASCII, 1 = binaire, 2 = compressé]
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include "Trajectoire.hxx"
+
+
+int main(int argc, char **argv) {
+
+    if (argc < 2) {
+        std::cerr << "Usage : " << argv[0] << " <fichier de trajectoire> [préfixe] [format]" << std::endl;
+        return 1;
+    }
+    const std::string prefixe = (argc > 2) ? argv[2] : "data";
+    const int format = (argc > 3) ? std::atoi(argv[3]) : 1;
+
+    try {
+        LectureTrajectoire lecture(argv[1]);
+        lecture.exporterVTK(prefixe, format);
+        std::cout << lecture.getNbFrames() << " frames écrites dans " << prefixe << ".pvd" << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+
+}
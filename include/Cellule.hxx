@@ -13,8 +13,9 @@
 
 class Cellule {
 private:
-    int id[2];  ///< Identifier of the cell (coordinates)
+    int id[3];  ///< Identifier of the cell (coordinates)
     int nbParticules;  ///< Number of particles in the cell
+    int debut;  ///< Index of the first particle of the cell in the universe particle store
     std::vector<Particule3D> particules;  ///< List of particles in the cell
     Vector3D centre;  ///< Center of the cell
 
@@ -38,6 +39,16 @@ public:
      */
     Cellule(int id_1, int id_2, Vector3D centre);
 
+    /**
+     * @brief Constructor of the Cellule class for a 3D grid.
+     *
+     * @param id_1 The first coordinate of the cell identifier.
+     * @param id_2 The second coordinate of the cell identifier.
+     * @param id_3 The third coordinate of the cell identifier.
+     * @param centre The center of the cell.
+     */
+    Cellule(int id_1, int id_2, int id_3, Vector3D centre);
+
     /**
      * @brief Default constructor of the Cellule class.
      */
@@ -73,10 +84,17 @@ public:
     /**
      * @brief Gets the identifier of the cell.
      *
-     * @return A pointer to the identifier (array of two integers).
+     * @return A pointer to the identifier (array of three integers).
      */
     int* getId();
 
+    /**
+     * @brief Gets the identifier of the cell (read-only).
+     *
+     * @return A pointer to the identifier (array of three integers).
+     */
+    const int* getId() const;
+
     /**
      * @brief Gets the list of particles in the cell.
      *
@@ -123,6 +141,21 @@ public:
      * @brief Removes all particles from the cell.
      */
     void clearParticules();
+
+    /**
+     * @brief Gets the index of the first particle of the cell in the particle store.
+     *
+     * @return The start of the cell range.
+     */
+    int getDebut() const;
+
+    /**
+     * @brief Makes the cell refer to a range of the universe particle store.
+     *
+     * @param debut The index of the first particle of the cell.
+     * @param nb The number of particles in the range.
+     */
+    void setPlage(int debut, int nb);
 };
 
 #endif // CELLULE_HXX
@@ -0,0 +1,228 @@
+/**
+ * @class ChampForces
+ * @brief Pair potential of the force passes, with its parameters for each pair of particle categories.
+ *
+ * The potential is one of the laws below (Lennard-Jones, Morse, soft sphere,
+ * Coulomb with cutoff). Each category of particles (Particule3D::getCategorie) gets
+ * its own parameters; the parameters of a pair of different categories come from
+ * the mixing rule of the law, unless they are set explicitly with setPaire. The
+ * force engines are instantiated for each law, so the pair loop calls no virtual
+ * function and reads the parameters of the pair in a flat table.
+ *
+ * Each law is a struct with two static inline functions of a row of the table and
+ * of r²: coefficient, such that the force on i is coefficient (r_j - r_i), and energie.
+ */
+
+#ifndef CHAMPFORCES_HXX
+#define CHAMPFORCES_HXX
+
+#include <cmath>
+#include <vector>
+#include "Reprise.hxx"
+
+/**
+ * @brief Lennard-Jones law 4 eps ((sigma/r)^12 - (sigma/r)^6); row {sigma², 24 eps, 4 eps}.
+ */
+struct LoiLennardJones {
+    static double coefficient(const double *p, double r2) {
+        const double s2 = p[0] / r2;
+        const double s6 = s2 * s2 * s2;
+        return p[1] / r2 * s6 * (1 - 2 * s6);
+    }
+    static double energie(const double *p, double r2) {
+        const double s2 = p[0] / r2;
+        const double s6 = s2 * s2 * s2;
+        return p[2] * s6 * (s6 - 1);
+    }
+};
+
+/**
+ * @brief Morse law D (1 - exp(-a (r - r0)))² - D; row {D, a, r0}.
+ */
+struct LoiMorse {
+    static double coefficient(const double *p, double r2) {
+        const double r = std::sqrt(r2);
+        const double e = std::exp(-p[1] * (r - p[2]));
+        return 2 * p[0] * p[1] * e * (1 - e) / r;
+    }
+    static double energie(const double *p, double r2) {
+        const double e = std::exp(-p[1] * (std::sqrt(r2) - p[2]));
+        return p[0] * (1 - e) * (1 - e) - p[0];
+    }
+};
+
+/**
+ * @brief Soft sphere law eps (sigma/r)^12, purely repulsive; row {sigma², 12 eps, eps}.
+ */
+struct LoiSphereMolle {
+    static double coefficient(const double *p, double r2) {
+        const double s2 = p[0] / r2;
+        const double s6 = s2 * s2 * s2;
+        return -p[1] / r2 * s6 * s6;
+    }
+    static double energie(const double *p, double r2) {
+        const double s2 = p[0] / r2;
+        const double s6 = s2 * s2 * s2;
+        return p[2] * s6 * s6;
+    }
+};
+
+/**
+ * @brief Coulomb law q_i q_j / r, truncated at the cutoff radius; row {q_i q_j}.
+ */
+struct LoiCoulomb {
+    static double coefficient(const double *p, double r2) {
+        return -p[0] / (r2 * std::sqrt(r2));
+    }
+    static double energie(const double *p, double r2) {
+        return p[0] / std::sqrt(r2);
+    }
+};
+
+class ChampForces {
+public:
+    static const int LENNARD_JONES = 0;  ///< Parameters (eps, sigma), Lorentz-Berthelot mixing
+    static const int MORSE = 1;  ///< Parameters (D, a, r0), geometric mean of D, arithmetic means of a and r0
+    static const int SPHERE_MOLLE = 2;  ///< Parameters (eps, sigma), Lorentz-Berthelot mixing
+    static const int COULOMB = 3;  ///< Parameter (q), product of the charges
+    static const int TAILLE_LIGNE = 4;  ///< Number of doubles of a row of the table
+
+private:
+    int type = LENNARD_JONES;  ///< Law of the potential
+    int nbCategories = 0;  ///< Number of categories, the categories of the particles must lie in [0, nbCategories)
+    bool gravitation = true;  ///< true to add the m_i / r² term of the analytic kernel
+    std::vector<double> parametresCategories;  ///< Parameters of each category (3 per category)
+    std::vector<double> parametresPaires;  ///< Parameters of each pair of categories (3 per pair)
+    std::vector<char> explicites;  ///< 1 for the pairs set with setPaire, which the mixing rule leaves alone
+    std::vector<double> table;  ///< Row of each pair of categories, in the form read by the law
+
+public:
+    /**
+     * @brief Default constructor, creates a field without categories.
+     */
+    ChampForces();
+
+    /**
+     * @brief Creates a force field whose categories all share the same parameters.
+     *
+     * @param type LENNARD_JONES, MORSE, SPHERE_MOLLE or COULOMB
+     * @param nbCategories The number of categories (at least 1)
+     * @param p1, p2, p3 The parameters of every category, in the order of the type
+     */
+    ChampForces(int type, int nbCategories, double p1, double p2 = 0, double p3 = 0);
+
+    /**
+     * @brief Sets the parameters of a category, and of its pairs by the mixing rule.
+     *
+     * @param categorie The category
+     * @param p1, p2, p3 The parameters, in the order of the type
+     */
+    void setCategorie(int categorie, double p1, double p2 = 0, double p3 = 0);
+
+    /**
+     * @brief Sets the parameters of a pair of categories, in place of the mixing rule.
+     *
+     * @param categorie1, categorie2 The categories, in any order
+     * @param p1, p2, p3 The parameters, in the order of the type (for COULOMB, the product of the charges)
+     */
+    void setPaire(int categorie1, int categorie2, double p1, double p2 = 0, double p3 = 0);
+
+    /**
+     * @brief Adds or removes the m_i / r² term of the analytic kernel (added by default).
+     *
+     * @param gravitation true to add the term
+     */
+    void setGravitation(bool gravitation);
+
+    /**
+     * @brief Tells whether the m_i / r² term is added.
+     *
+     * @return bool true if added
+     */
+    bool getGravitation() const {
+        return gravitation;
+    }
+
+    /**
+     * @brief Gets the law of the potential.
+     *
+     * @return int LENNARD_JONES, MORSE, SPHERE_MOLLE or COULOMB
+     */
+    int getType() const {
+        return type;
+    }
+
+    /**
+     * @brief Gets the number of categories.
+     *
+     * @return int The number of categories
+     */
+    int getNbCategories() const {
+        return nbCategories;
+    }
+
+    /**
+     * @brief Gets the rows of the table, TAILLE_LIGNE doubles for each pair (categorie_i, categorie_j).
+     *
+     * @return const double* The row of the pair (0, 0); the row of (a, b) is at TAILLE_LIGNE (a nbCategories + b)
+     */
+    const double *getTable() const {
+        return table.data();
+    }
+
+    /**
+     * @brief Gets the force coefficient of a pair, without the m_i / r² term.
+     *
+     * @param categorie1, categorie2 The categories of the particles
+     * @param r2 The squared distance
+     * @return double The coefficient c such that the force on the first particle is c (r_2 - r_1)
+     */
+    double getCoefficient(int categorie1, int categorie2, double r2) const;
+
+    /**
+     * @brief Gets the energy of a pair, without the m_i / r² term.
+     *
+     * @param categorie1, categorie2 The categories of the particles
+     * @param r2 The squared distance
+     * @return double The energy
+     */
+    double getEnergie(int categorie1, int categorie2, double r2) const;
+
+    /**
+     * @brief Writes the force field to a restart file.
+     *
+     * @param reprise The restart file
+     */
+    void ecrire(EcritureReprise &reprise) const;
+
+    /**
+     * @brief Reads a force field written by ecrire.
+     *
+     * @param reprise The restart file
+     */
+    void lire(LectureReprise &reprise);
+
+private:
+    /**
+     * @brief Checks a category.
+     *
+     * @param categorie The category
+     */
+    void verifierCategorie(int categorie) const;
+
+    /**
+     * @brief Computes the parameters of the pairs of a category that were not set explicitly.
+     *
+     * @param categorie The category
+     */
+    void melanger(int categorie);
+
+    /**
+     * @brief Fills the rows of a pair of categories from its parameters.
+     *
+     * @param a, b The categories
+     */
+    void remplirLigne(int a, int b);
+};
+
+#endif // CHAMPFORCES_HXX
@@ -0,0 +1,185 @@
+/**
+ * @class DecompositionDomaine
+ * @brief Spatial decomposition of the cell grid over the MPI ranks.
+ *
+ * The layers of cells along the slowest axis of the grid (y in 2D, z in 3D) are
+ * split into contiguous slabs, one per rank. Each rank owns the particles of its
+ * slab; before each force pass it receives copies (ghosts) of the particles of the
+ * layer just below and just above its slab from the neighboring ranks, and after
+ * each step the particles that left the slab move to the rank that owns them.
+ *
+ * Without MPI (UNIVERS_AVEC_MPI undefined) there is a single rank owning the whole
+ * grid, and every exchange is a copy.
+ */
+
+#ifndef DECOMPOSITIONDOMAINE_HXX
+#define DECOMPOSITIONDOMAINE_HXX
+
+#include <cstdint>
+#include <vector>
+#include "ParticuleStore.hxx"
+
+class DecompositionDomaine {
+public:
+    /**
+     * @brief The whole state of a particle, as sent to another rank.
+     */
+    struct ParticuleEchangee {
+        double x, y, z;  ///< Position
+        double vx, vy, vz;  ///< Velocity
+        double fx, fy, fz;  ///< Force
+        double fxOld, fyOld, fzOld;  ///< Force of the previous step
+        float masse;  ///< Mass
+        int32_t categorie;  ///< Category
+        int32_t id;  ///< Identifier
+    };
+
+private:
+    int rang = 0;  ///< Index of this rank
+    int nbRangs = 1;  ///< Number of ranks
+    int nbCouches = 0;  ///< Number of layers of the grid
+    int debut = 0;  ///< First layer of the slab of this rank
+    int fin = 0;  ///< End of the slab of this rank (excluded)
+
+public:
+    /**
+     * @brief Gets the rank and the number of ranks of MPI_COMM_WORLD.
+     *
+     * MPI must be initialized (see initialiserMPI).
+     */
+    DecompositionDomaine();
+
+    /**
+     * @brief Tells whether the library was built with MPI.
+     *
+     * @return true if built with MPI
+     */
+    static bool mpiDisponible();
+
+    /**
+     * @brief Initializes MPI if the library was built with it and MPI is not yet initialized.
+     *
+     * @param argc, argv The arguments of main
+     */
+    static void initialiserMPI(int *argc, char ***argv);
+
+    /**
+     * @brief Finalizes MPI if it was initialized.
+     */
+    static void finaliserMPI();
+
+    /**
+     * @brief Splits the layers of the grid into one slab per rank.
+     *
+     * @param nbCouches The number of layers, at least the number of ranks
+     */
+    void decouper(int nbCouches);
+
+    /**
+     * @brief Gets the index of this rank.
+     *
+     * @return int The rank
+     */
+    int getRang() const {
+        return rang;
+    }
+
+    /**
+     * @brief Gets the number of ranks.
+     *
+     * @return int The number of ranks
+     */
+    int getNbRangs() const {
+        return nbRangs;
+    }
+
+    /**
+     * @brief Gets the first layer of the slab of this rank.
+     *
+     * @return int The layer
+     */
+    int getDebut() const {
+        return debut;
+    }
+
+    /**
+     * @brief Gets the end of the slab of this rank (excluded).
+     *
+     * @return int The layer after the last one
+     */
+    int getFin() const {
+        return fin;
+    }
+
+    /**
+     * @brief Gets the rank owning a layer.
+     *
+     * @param couche The layer
+     * @return int The rank
+     */
+    int getProprietaire(int couche) const;
+
+    /**
+     * @brief Packs a particle of the store.
+     *
+     * @param store The particle store
+     * @param i The index of the particle
+     * @return ParticuleEchangee The state of the particle
+     */
+    static ParticuleEchangee extraire(const ParticuleStore &store, int i);
+
+    /**
+     * @brief Appends a received particle to the store.
+     *
+     * @param store The particle store
+     * @param particule The state of the particle
+     * @param cellule The index of its cell
+     */
+    static void ajouter(ParticuleStore &store, const ParticuleEchangee &particule, int cellule);
+
+    /**
+     * @brief Sends particles to any rank and receives the particles sent to this one.
+     *
+     * @param envois The particles to send to each rank (nbRangs lists)
+     * @param recus The particles received, from every rank
+     */
+    void echanger(const std::vector<std::vector<ParticuleEchangee>> &envois, std::vector<ParticuleEchangee> &recus) const;
+
+    /**
+     * @brief Sends particles to the ranks of the previous and next slabs and receives theirs.
+     *
+     * The first and last slabs have no neighbor on the outer side: their lists are ignored.
+     *
+     * @param versPrecedent The particles for the previous slab
+     * @param versSuivant The particles for the next slab
+     * @param recus The particles received from both neighbors
+     */
+    void echangerVoisins(const std::vector<ParticuleEchangee> &versPrecedent, const std::vector<ParticuleEchangee> &versSuivant,
+                         std::vector<ParticuleEchangee> &recus) const;
+
+    /**
+     * @brief Sums a value over every rank.
+     *
+     * @param valeur The value of this rank
+     * @return double The sum
+     */
+    double sommer(double valeur) const;
+
+    /**
+     * @brief Sums a count over every rank.
+     *
+     * @param valeur The count of this rank
+     * @return long The sum
+     */
+    long sommer(long valeur) const;
+
+    /**
+     * @brief Gets the largest value over every rank.
+     *
+     * @param valeur The value of this rank
+     * @return double The maximum
+     */
+    double maximum(double valeur) const;
+};
+
+#endif // DECOMPOSITIONDOMAINE_HXX
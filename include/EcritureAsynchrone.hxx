@@ -0,0 +1,78 @@
+/**
+ * @class EcritureAsynchrone
+ * @brief Writes VTK snapshots on a background thread.
+ *
+ * The particle data is copied into one of two buffers by the calling thread,
+ * then written by a dedicated thread while the simulation goes on. The caller
+ * only waits when both buffers are busy, i.e. when a snapshot is requested
+ * while the previous one is still queued behind the one being written.
+ */
+
+#ifndef ECRITUREASYNCHRONE_HXX
+#define ECRITUREASYNCHRONE_HXX
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "EcritureVTK.hxx"
+#include "ParticuleStore.hxx"
+
+class EcritureAsynchrone {
+private:
+    EcritureVTK tampons[2];  ///< Double buffer of snapshots
+    std::string noms[2];  ///< File name of each buffer
+    int enAttente = -1;  ///< Buffer queued for writing, -1 if none
+    int enCours = -1;  ///< Buffer being written, -1 if none
+    bool arret = false;  ///< Asks the writer thread to stop
+    std::exception_ptr erreur;  ///< First error raised by the writer thread
+    std::mutex mutex;  ///< Protects the state above
+    std::condition_variable changement;  ///< Signals any change of the state
+    std::thread ecrivain;  ///< Writer thread
+
+    /**
+     * @brief Main loop of the writer thread.
+     */
+    void boucle();
+
+    /**
+     * @brief Rethrows the error of the writer thread, if any. The mutex must be held.
+     */
+    void verifierErreur();
+
+public:
+    /**
+     * @brief Starts the writer thread.
+     *
+     * @param format The VTK format (see EcritureVTK).
+     */
+    explicit EcritureAsynchrone(int format = 1);
+
+    /**
+     * @brief Writes the pending snapshots and stops the writer thread.
+     */
+    ~EcritureAsynchrone();
+
+    EcritureAsynchrone(const EcritureAsynchrone&) = delete;
+    EcritureAsynchrone& operator=(const EcritureAsynchrone&) = delete;
+
+    /**
+     * @brief Copies the particle data and queues it for writing.
+     *
+     * Throws the error of a previous write, if any.
+     *
+     * @param store The particle store.
+     * @param filename The name of the file to write.
+     */
+    void soumettre(const ParticuleStore &store, const std::string &filename);
+
+    /**
+     * @brief Waits until every queued snapshot is written.
+     *
+     * Throws the error of a previous write, if any.
+     */
+    void attendre();
+};
+
+#endif // ECRITUREASYNCHRONE_HXX
@@ -0,0 +1,100 @@
+/**
+ * @class EcritureVTK
+ * @brief Writer of the particles as VTK unstructured grid (.vtu) files.
+ *
+ * The particle data is first converted to contiguous Float32 buffers with
+ * preparer(), then written by ecrire(). In the binary formats the arrays are
+ * stored as appended data after the XML header and written in one block
+ * each, straight from the buffers.
+ */
+
+#ifndef ECRITUREVTK_HXX
+#define ECRITUREVTK_HXX
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ParticuleStore.hxx"
+
+class EcritureVTK {
+private:
+    int format;  ///< Output format: 0 = ASCII, 1 = raw binary appended data, 2 = zlib-compressed appended data
+    int nbPoints = 0;  ///< Number of particles in the buffers
+    std::vector<float> positions;  ///< Positions, 3 components per particle
+    std::vector<float> vitesses;  ///< Velocities, 3 components per particle
+    std::vector<float> categories;  ///< Categories, one value per particle
+    std::vector<unsigned char> compresse;  ///< Scratch: encoded arrays in the zlib format
+    std::vector<uint64_t> decalages;  ///< Scratch: offset of each array in the appended data
+
+    /**
+     * @brief Writes the XML part of the file up to the appended data.
+     *
+     * @param file The output stream.
+     */
+    void ecrireEntete(std::ostream &file) const;
+
+    /**
+     * @brief Compresses an array into the zlib block format of VTK and appends it to compresse.
+     *
+     * @param data The array.
+     * @param n The number of values.
+     */
+    void compresser(const float *data, size_t n);
+
+public:
+    /**
+     * @brief Creates a writer.
+     *
+     * @param format 0 = ASCII, 1 = raw binary (default), 2 = zlib-compressed binary
+     */
+    explicit EcritureVTK(int format = 1);
+
+    /**
+     * @brief Selects the output format.
+     *
+     * @param format 0 = ASCII, 1 = raw binary, 2 = zlib-compressed binary (only when built with zlib)
+     */
+    void setFormat(int format);
+
+    /**
+     * @brief Gets the output format.
+     *
+     * @return int 0 = ASCII, 1 = raw binary, 2 = zlib-compressed binary
+     */
+    int getFormat() const;
+
+    /**
+     * @brief Tells whether the zlib-compressed format is available.
+     *
+     * @return true if the library was built with zlib.
+     */
+    static bool zlibDisponible();
+
+    /**
+     * @brief Copies the particle data to the Float32 buffers.
+     *
+     * The positions and velocities always have 3 components; unused components are 0.
+     *
+     * @param store The particle store.
+     */
+    void preparer(const ParticuleStore &store);
+
+    /**
+     * @brief Copies Float32 particle data to the buffers.
+     *
+     * @param positions The positions, 3 components per particle.
+     * @param vitesses The velocities, 3 components per particle.
+     * @param categories The categories, one value per particle.
+     * @param n The number of particles.
+     */
+    void preparer(const float *positions, const float *vitesses, const float *categories, int n);
+
+    /**
+     * @brief Writes the buffers to a .vtu file.
+     *
+     * @param filename The name of the file.
+     */
+    void ecrire(const std::string &filename);
+};
+
+#endif // ECRITUREVTK_HXX
@@ -0,0 +1,127 @@
+/**
+ * @class ListeVoisins
+ * @brief Verlet neighbor lists built over the particle store.
+ *
+ * For every particle i the list holds the particles j > i closer than
+ * rCut + skin at build time (half lists, to be used with Newton's third law).
+ * The lists stay valid as long as no particle moved more than skin / 2 since
+ * the last build and the store has not been reordered.
+ */
+
+#ifndef LISTEVOISINS_HXX
+#define LISTEVOISINS_HXX
+
+#include <vector>
+#include "ParticuleStore.hxx"
+#include "Reprise.hxx"
+
+class ListeVoisins {
+private:
+    std::vector<int> debut;  ///< Start of the list of each particle in voisins (size n + 1)
+    std::vector<int> voisins;  ///< Concatenated neighbor lists
+    std::vector<int> portee;  ///< Index past the largest neighbor of the particles 0 .. i, at least i + 1
+    std::vector<ReelPosition> xRef;  ///< Positions along x at the last build
+    std::vector<ReelPosition> yRef;  ///< Positions along y at the last build
+    std::vector<ReelPosition> zRef;  ///< Positions along z at the last build
+    std::vector<int> teteBin;  ///< Scratch: first particle of each bin
+    std::vector<int> suivant;  ///< Scratch: next particle in the same bin
+    int nbReconstructions = 0;  ///< Number of builds since construction
+
+    /**
+     * @brief Computes portee from the lists.
+     */
+    void calculerPortee();
+
+public:
+    /**
+     * @brief Default constructor, creates empty lists.
+     */
+    ListeVoisins();
+
+    /**
+     * @brief Builds the half neighbor lists of every particle of the store.
+     *
+     * The particles are binned in cells of size at least rayon covering the box
+     * [0, L1] x [0, L2] x [0, L3]; particles outside the box are put in the border bins.
+     *
+     * @param store The particle store.
+     * @param rayon The list radius (rCut + skin).
+     * @param L1 The size of the box in x direction.
+     * @param L2 The size of the box in y direction.
+     * @param L3 The size of the box in z direction (0 in 2D).
+     */
+    void construire(const ParticuleStore& store, double rayon, double L1, double L2, double L3);
+
+    /**
+     * @brief Tells whether a particle moved more than skin / 2 since the last build.
+     *
+     * @param store The particle store, in the same order as at the last build.
+     * @param skin The skin distance.
+     * @return True if the lists must be rebuilt.
+     */
+    bool deplacementExcessif(const ParticuleStore& store, double skin) const;
+
+    /**
+     * @brief Gets the start of the list of a particle.
+     *
+     * @param i The index of the particle.
+     * @return The index of its first neighbor in getVoisins().
+     */
+    int debutListe(int i) const { return debut[i]; }
+
+    /**
+     * @brief Gets the end of the list of a particle.
+     *
+     * @param i The index of the particle.
+     * @return The index past its last neighbor in getVoisins().
+     */
+    int finListe(int i) const { return debut[i + 1]; }
+
+    /**
+     * @brief Gets the end of the particles reached by the lists of the particles 0 .. i.
+     *
+     * A pass over the lists of a range of particles [debut, i] writes the forces of
+     * the particles [debut, getPortee(i)) only.
+     *
+     * @param i The index of the particle.
+     * @return The index past the largest neighbor of the particles 0 .. i, at least i + 1.
+     */
+    int getPortee(int i) const { return portee[i]; }
+
+    /**
+     * @brief Gets the concatenated neighbor lists.
+     *
+     * @return A reference to the neighbor indices.
+     */
+    const std::vector<int>& getVoisins() const;
+
+    /**
+     * @brief Gets the number of pairs stored in the lists.
+     *
+     * @return The number of pairs.
+     */
+    int getNbPaires() const;
+
+    /**
+     * @brief Gets the number of builds since construction.
+     *
+     * @return The number of builds.
+     */
+    int getNbReconstructions() const;
+
+    /**
+     * @brief Writes the lists and the reference positions to a restart file.
+     *
+     * @param reprise The restart file
+     */
+    void ecrire(EcritureReprise &reprise) const;
+
+    /**
+     * @brief Reads the lists and the reference positions from a restart file.
+     *
+     * @param reprise The restart file
+     */
+    void lire(LectureReprise &reprise);
+};
+
+#endif // LISTEVOISINS_HXX
@@ -0,0 +1,139 @@
+/**
+ * @class NoyauLJ
+ * @brief Vectorized Lennard-Jones and gravitational kernel: one particle against a batch of neighbors.
+ *
+ * The neighbors are a contiguous index range of the particle store, so that their
+ * coordinates are loaded as packed vectors (and widened to double when the store
+ * holds floats, see Precision.hxx). Each pair is evaluated with squared
+ * distances and an r^-2 power chain; the pairs at zero distance or beyond the cutoff
+ * radius are masked out. Every lane rounds like the scalar loop (no FMA contraction),
+ * so only the order of the sums differs between the instruction sets (AVX-512, AVX2,
+ * SSE2 or plain scalar code), which is chosen at run time from the processor features.
+ */
+
+#ifndef NOYAULJ_HXX
+#define NOYAULJ_HXX
+
+#include "Precision.hxx"
+
+class NoyauLJ {
+public:
+    static const int AUTOMATIQUE = -1;  ///< Best instruction set of the processor
+    static const int SCALAIRE = 0;  ///< Portable scalar loop
+    static const int SSE2 = 1;  ///< 2 pairs per instruction
+    static const int AVX2 = 2;  ///< 4 pairs per instruction
+    static const int AVX512 = 3;  ///< 8 pairs per instruction
+
+    /**
+     * @brief Parameters of the interaction, shared by every variant.
+     */
+    struct Parametres {
+        double rCut2;  ///< Squared cutoff radius
+        double sigma2;  ///< Squared Lennard-Jones sigma
+        double eps24;  ///< 24 times the Lennard-Jones epsilon
+        bool borner;  ///< true to cap each force component to [-1e5, 1e5]
+        bool troisD;  ///< false to ignore the z components
+    };
+
+    /**
+     * @brief Full-shell variant: adds the forces of the neighbors on a particle.
+     *
+     * @return The number of pairs within the cutoff radius
+     */
+    typedef int (*FonctionCoquille)(const Parametres &p, const ReelPosition *x, const ReelPosition *y, const ReelPosition *z,
+                                    int i, double masse_i, int debut, int fin, double &fxi, double &fyi, double &fzi);
+
+    /**
+     * @brief Half-shell variant: also subtracts the reaction from the forces of the neighbors.
+     *
+     * @return The number of pairs within the cutoff radius
+     */
+    typedef int (*FonctionDemi)(const Parametres &p, const ReelPosition *x, const ReelPosition *y, const ReelPosition *z,
+                                const float *masse, ReelForce *fx, ReelForce *fy, ReelForce *fz, int i, int debut, int fin,
+                                double &fxi, double &fyi, double &fzi);
+
+private:
+    Parametres parametres;  ///< Parameters of the interaction
+    int jeu;  ///< Instruction set in use
+    FonctionCoquille coquille;  ///< Full-shell variant of the instruction set
+    FonctionDemi demi;  ///< Half-shell variant of the instruction set
+
+public:
+    /**
+     * @brief Selects the variant of an instruction set.
+     *
+     * @param parametres The parameters of the interaction
+     * @param jeu The instruction set, AUTOMATIQUE for the best one available
+     */
+    explicit NoyauLJ(const Parametres &parametres, int jeu = AUTOMATIQUE);
+
+    /**
+     * @brief Tells whether the processor and the build support an instruction set.
+     *
+     * @param jeu The instruction set
+     * @return true if supported
+     */
+    static bool estDisponible(int jeu);
+
+    /**
+     * @brief Gets the best instruction set supported by the processor.
+     *
+     * @return int The instruction set
+     */
+    static int detecter();
+
+    /**
+     * @brief Gets the name of an instruction set.
+     *
+     * @param jeu The instruction set
+     * @return The name ("scalaire", "sse2", "avx2" or "avx512")
+     */
+    static const char *getNom(int jeu);
+
+    /**
+     * @brief Gets the instruction set in use.
+     *
+     * @return int The instruction set
+     */
+    int getJeu() const {
+        return jeu;
+    }
+
+    /**
+     * @brief Adds to (fxi, fyi, fzi) the forces of the particles [debut, fin) on particle i.
+     *
+     * Particle i itself may lie in the batch: its zero distance masks it out.
+     *
+     * @param x, y, z The coordinates of the store
+     * @param i The index of the particle
+     * @param masse_i The mass of the particle, used by the gravitational term
+     * @param debut, fin The index range of the neighbors
+     * @param fxi, fyi, fzi The force accumulated on particle i
+     * @return int The number of pairs within the cutoff radius
+     */
+    int coquillePleine(const ReelPosition *x, const ReelPosition *y, const ReelPosition *z, int i, double masse_i, int debut,
+                       int fin, double &fxi, double &fyi, double &fzi) const {
+        return coquille(parametres, x, y, z, i, masse_i, debut, fin, fxi, fyi, fzi);
+    }
+
+    /**
+     * @brief Evaluates each pair (i, j) of the batch once, for the half-shell engine.
+     *
+     * The force on i is added to (fxi, fyi, fzi) and the force on j, computed with the
+     * mass of j, is subtracted from its store entry. The batch must not contain i.
+     *
+     * @param x, y, z The coordinates of the store
+     * @param masse The masses of the store
+     * @param fx, fy, fz The forces of the store
+     * @param i The index of the particle
+     * @param debut, fin The index range of the neighbors
+     * @param fxi, fyi, fzi The force accumulated on particle i
+     * @return int The number of pairs within the cutoff radius
+     */
+    int demiCoquille(const ReelPosition *x, const ReelPosition *y, const ReelPosition *z, const float *masse, ReelForce *fx,
+                     ReelForce *fy, ReelForce *fz, int i, int debut, int fin, double &fxi, double &fyi, double &fzi) const {
+        return demi(parametres, x, y, z, masse, fx, fy, fz, i, debut, fin, fxi, fyi, fzi);
+    }
+};
+
+#endif // NOYAULJ_HXX
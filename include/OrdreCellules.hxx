@@ -0,0 +1,64 @@
+/**
+ * @class OrdreCellules
+ * @brief Orders of the cells of the grid along a space-filling curve.
+ *
+ * In row-major order the neighbors of a cell along y and z are far apart in
+ * the cell array, hence in the particle store which is sorted by cell. Along a
+ * Morton (Z-order) or Hilbert curve, cells close in space mostly get close
+ * indices, so the neighbor stencil of the force kernels touches nearby memory.
+ */
+
+#ifndef ORDRECELLULES_HXX
+#define ORDRECELLULES_HXX
+
+#include <cstdint>
+#include <vector>
+
+class OrdreCellules {
+public:
+    static const int LIGNES = 0;  ///< Row-major order (x first, then y, then z)
+    static const int MORTON = 1;  ///< Morton (Z-order) curve
+    static const int HILBERT = 2;  ///< Hilbert curve
+
+    /**
+     * @brief Computes the Morton key of a point by interleaving the bits of its coordinates.
+     *
+     * @param coords The coordinates
+     * @param nbDims The number of coordinates (2 or 3)
+     * @param nbBits The number of bits of each coordinate (at most 21)
+     * @return uint64_t The key
+     */
+    static uint64_t cleMorton(const unsigned *coords, int nbDims, int nbBits);
+
+    /**
+     * @brief Computes the index of a point along the Hilbert curve (Skilling's algorithm).
+     *
+     * @param coords The coordinates
+     * @param nbDims The number of coordinates (2 or 3)
+     * @param nbBits The number of bits of each coordinate (at most 21)
+     * @return uint64_t The index along the curve
+     */
+    static uint64_t cleHilbert(const unsigned *coords, int nbDims, int nbBits);
+
+    /**
+     * @brief Computes the index of every cell of a grid in a given order.
+     *
+     * The grids that are not a power of two wide are embedded in the smallest
+     * enclosing power-of-two grid, whose curve is then followed.
+     *
+     * @param ordre LIGNES, MORTON or HILBERT
+     * @param largeur, hauteur, profondeur The number of cells along x, y and z
+     * @return The index of each cell, by row-major position
+     */
+    static std::vector<int> calculerRangs(int ordre, int largeur, int hauteur, int profondeur);
+
+    /**
+     * @brief Gets the name of an order.
+     *
+     * @param ordre LIGNES, MORTON or HILBERT
+     * @return The name ("lignes", "morton" or "hilbert")
+     */
+    static const char *getNom(int ordre);
+};
+
+#endif // ORDRECELLULES_HXX
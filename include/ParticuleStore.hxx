@@ -0,0 +1,198 @@
+/**
+ * @class ParticuleStore
+ * @brief Structure-of-arrays container holding every particle of a universe.
+ *
+ * Each physical quantity lives in its own contiguous array so that the force
+ * and integration kernels only stream the fields they actually touch. The
+ * floating-point types of the arrays follow the precision policy (Precision.hxx). After a
+ * call to sortByCell() the particles are grouped by cell: the particles of
+ * cell c occupy the index range [cellStart(c), cellEnd(c)).
+ */
+
+#ifndef PARTICULESTORE_HXX
+#define PARTICULESTORE_HXX
+
+#include <vector>
+#include "Particule3D.hxx"
+#include "Precision.hxx"
+
+class ParticuleStore {
+public:
+    std::vector<ReelPosition> x;  ///< Positions along x
+    std::vector<ReelPosition> y;  ///< Positions along y
+    std::vector<ReelPosition> z;  ///< Positions along z
+    std::vector<ReelPosition> vx;  ///< Velocities along x
+    std::vector<ReelPosition> vy;  ///< Velocities along y
+    std::vector<ReelPosition> vz;  ///< Velocities along z
+    std::vector<ReelForce> fx;  ///< Forces along x
+    std::vector<ReelForce> fy;  ///< Forces along y
+    std::vector<ReelForce> fz;  ///< Forces along z
+    std::vector<ReelForce> fxOld;  ///< Forces of the previous step along x
+    std::vector<ReelForce> fyOld;  ///< Forces of the previous step along y
+    std::vector<ReelForce> fzOld;  ///< Forces of the previous step along z
+    std::vector<float> masse;  ///< Masses
+    std::vector<int> categorie;  ///< Categories
+    std::vector<int> id;  ///< Identifiers
+    std::vector<int> cellule;  ///< Index of the cell owning each particle
+
+    /**
+     * @brief Default constructor, creates an empty store.
+     */
+    ParticuleStore();
+
+    /**
+     * @brief Gets the number of particles in the store.
+     *
+     * @return The number of particles.
+     */
+    int getNbParticules() const;
+
+    /**
+     * @brief Reserves memory for a given number of particles.
+     *
+     * @param n The number of particles to reserve room for.
+     */
+    void reserve(int n);
+
+    /**
+     * @brief Removes every particle from the store.
+     */
+    void clear();
+
+    /**
+     * @brief Appends a particle at the end of the store.
+     *
+     * The store is no longer sorted by cell after this call.
+     *
+     * @param particule The particle to add.
+     * @param indexCellule The index of the cell owning the particle.
+     */
+    void addParticule(const Particule3D& particule, int indexCellule);
+
+    /**
+     * @brief Builds a Particule3D from the data stored at a given index.
+     *
+     * @param i The index of the particle in the store.
+     * @return A copy of the particle.
+     */
+    Particule3D getParticule(int i) const;
+
+    /**
+     * @brief Sorts the particles by cell index (stable counting sort).
+     *
+     * Every particle must have a valid cell index in [0, nbCellules).
+     * Scratch buffers are kept between calls so that a steady-state sort does
+     * not allocate.
+     *
+     * @param nbCellules The number of cells.
+     */
+    void sortByCell(int nbCellules);
+
+    /**
+     * @brief Moves the particles whose cell changed to their new cell.
+     *
+     * The store must be grouped by cell with up-to-date ranges, and cellule must
+     * hold the new cell of every particle. When few particles migrate, each migrant
+     * is moved in place by swapping it across the boundaries of the cells between
+     * its old and new cell; when the moves would cost more than a counting sort,
+     * the store is rebinned with sortByCell.
+     *
+     * @param nbCellules The number of cells.
+     * @return The number of particles that changed cell.
+     */
+    int rebinCells(int nbCellules);
+
+    /**
+     * @brief Moves the particles appended at the end of a store grouped by cell into their cells.
+     *
+     * The particles [0, debutQueue) must be grouped by cell with up-to-date ranges;
+     * the particles appended after them take place at the end of their cell, in
+     * their order of arrival, and the ranges are updated. The other particles keep
+     * their order: the arrays are shifted in blocks, without the scatter of a sort.
+     * When the ranges are not up to date, the store is sorted with sortByCell.
+     *
+     * @param debutQueue The index of the first appended particle.
+     * @param nbCellules The number of cells.
+     * @return The number of particles inserted.
+     */
+    int insererQueue(int debutQueue, int nbCellules);
+
+    /**
+     * @brief Recomputes the cell ranges of a store already sorted by cell.
+     *
+     * @param nbCellules The number of cells.
+     */
+    void recountCells(int nbCellules);
+
+    /**
+     * @brief Removes the particles flagged in a mask, preserving the order of the others.
+     *
+     * @param aSupprimer One flag per particle, non zero to remove the particle.
+     * @return The number of removed particles.
+     */
+    int removeFlagged(const std::vector<char>& aSupprimer);
+
+    /**
+     * @brief Gets the index of the first particle of a cell.
+     *
+     * @param c The cell index.
+     * @return The first index of the cell range.
+     */
+    int cellStart(int c) const { return debutCellules[c]; }
+
+    /**
+     * @brief Gets the index past the last particle of a cell.
+     *
+     * @param c The cell index.
+     * @return The end index of the cell range.
+     */
+    int cellEnd(int c) const { return debutCellules[c + 1]; }
+
+    /**
+     * @brief Asks the system to back the arrays of the store with huge pages.
+     *
+     * On Linux the arrays and the sort buffers are advised with MADV_HUGEPAGE
+     * (transparent huge pages) now and after each reallocation, which cuts the
+     * TLB misses of the passes over millions of particles. Elsewhere, or when the
+     * kernel has transparent huge pages disabled, the call has no effect.
+     *
+     * @param pagesEnormes True to advise huge pages.
+     */
+    void setPagesEnormes(bool pagesEnormes);
+
+    /**
+     * @brief Tells whether the arrays are advised to use huge pages.
+     *
+     * @return True if huge pages are requested.
+     */
+    bool getPagesEnormes() const { return pagesEnormes; }
+
+private:
+    std::vector<int> debutCellules;  ///< Start index of each cell range (size nbCellules + 1)
+    std::vector<int> permutation;  ///< Scratch: destination index of each particle during a sort
+    std::vector<ReelPosition> tamponPosition;  ///< Scratch buffer for position and velocity arrays
+    std::vector<ReelForce> tamponForce;  ///< Scratch buffer for force arrays
+    std::vector<float> tamponFloat;  ///< Scratch buffer for float arrays
+    std::vector<int> tamponInt;  ///< Scratch buffer for int arrays
+    bool pagesEnormes = false;  ///< True to advise huge pages for the arrays (see setPagesEnormes)
+
+    /**
+     * @brief Advises huge pages for every array and scratch buffer, if requested.
+     */
+    void conseillerPages();
+
+    /**
+     * @brief Applies the current permutation to every array of the store.
+     */
+    void permute();
+
+    /**
+     * @brief Swaps two particles in every array of the store.
+     *
+     * @param i The index of the first particle.
+     * @param j The index of the second particle.
+     */
+    void echanger(int i, int j);
+};
+
+#endif // PARTICULESTORE_HXX
@@ -0,0 +1,180 @@
+/**
+ * @class PoolThreads
+ * @brief Fixed set of worker threads executing parallel loops.
+ *
+ * The workers are created once and wait for work between two loops. The
+ * calling thread takes part in every loop as worker 0. Launching a loop does
+ * not allocate.
+ *
+ * The tasks of a loop are split into one contiguous range per thread, balanced
+ * by their weights. A thread runs its range from the front; once it is empty,
+ * it steals the back half of the range of another thread, so that a thread
+ * slowed by heavy tasks (or by the system) is helped by the others.
+ */
+
+#ifndef POOLTHREADS_HXX
+#define POOLTHREADS_HXX
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+class PoolThreads {
+public:
+    static const int BLOCS_PAR_THREAD = 8;  ///< Blocks per thread of pourIntervalles, the granularity of the stealing
+
+private:
+    /**
+     * @brief Range of tasks left to a thread, [debut, fin) packed in one word so that
+     * the owner and the thieves update it with a single compare-and-swap.
+     */
+    struct alignas(64) Plage {
+        std::atomic<uint64_t> bornes{0};  ///< debut in the high 32 bits, fin in the low ones
+    };
+
+    int nbThreads;  ///< Number of threads, the calling thread included
+    std::vector<std::thread> workers;  ///< Worker threads 1 .. nbThreads - 1
+    std::mutex mutex;  ///< Protects the job description and the counters
+    std::condition_variable debutTravail;  ///< Signals a new job to the workers
+    std::condition_variable finTravail;  ///< Signals the end of the job to the caller
+    void (*fonction)(void*, int) = nullptr;  ///< Task function of the current job
+    void *contexte = nullptr;  ///< Context of the task function
+    int nbTaches = 0;  ///< Number of tasks of the current job
+    std::unique_ptr<Plage[]> plages;  ///< Range of tasks left to each thread
+    long generation = 0;  ///< Incremented at each new job
+    int nbActifs = 0;  ///< Workers still running the current job
+    bool arret = false;  ///< Asks the workers to stop
+
+    /**
+     * @brief Main loop of a worker thread.
+     *
+     * @param rang The rank of the worker (1 .. nbThreads - 1).
+     */
+    void boucleWorker(int rang);
+
+    /**
+     * @brief Runs the range of tasks of a rank, then steals from the other ranks until every range is empty.
+     *
+     * @param rang The rank of the thread.
+     */
+    void executerTaches(int rang);
+
+    /**
+     * @brief Runs the tasks left in the range of a rank, from the front.
+     *
+     * @param rang The rank of the thread.
+     */
+    void executerPlage(int rang);
+
+    /**
+     * @brief Moves the back half of the range of another thread to the (empty) range of a rank.
+     *
+     * @param victime The rank of the thread robbed.
+     * @param rang The rank of the thief.
+     * @return true if at least one task was stolen.
+     */
+    bool voler(int victime, int rang);
+
+    /**
+     * @brief Runs a job on every thread and waits for its completion.
+     *
+     * @param nbTaches The number of tasks.
+     * @param poidsCumules The nbTaches + 1 cumulated weights of the tasks (0 first), null for equal weights.
+     * @param fonction The task function, called with the context and the task index.
+     * @param contexte The context passed to the task function.
+     */
+    void lancer(int nbTaches, const long *poidsCumules, void (*fonction)(void*, int), void *contexte);
+
+public:
+    /**
+     * @brief Creates the worker threads.
+     *
+     * @param nbThreads The number of threads, the calling thread included (at least 1).
+     */
+    explicit PoolThreads(int nbThreads);
+
+    /**
+     * @brief Stops and joins the worker threads.
+     */
+    ~PoolThreads();
+
+    PoolThreads(const PoolThreads&) = delete;
+    PoolThreads& operator=(const PoolThreads&) = delete;
+
+    /**
+     * @brief Gets the number of threads.
+     *
+     * @return The number of threads, the calling thread included.
+     */
+    int getNbThreads() const;
+
+    /**
+     * @brief Runs f(tache) for every task in [0, nbTaches).
+     *
+     * The tasks are split into one contiguous range per thread, the idle threads steal the others.
+     *
+     * @param nbTaches The number of tasks.
+     * @param f The task, a callable taking the task index.
+     */
+    template <typename F>
+    void paralleliser(int nbTaches, F &&f) {
+        paralleliserPondere(nbTaches, nullptr, f);
+    }
+
+    /**
+     * @brief Runs f(tache) for every task in [0, nbTaches), the initial ranges of the threads having equal weights.
+     *
+     * @param nbTaches The number of tasks.
+     * @param poidsCumules The nbTaches + 1 cumulated weights of the tasks, starting at 0
+     * (poidsCumules[t + 1] - poidsCumules[t] is the weight of task t); null for equal weights.
+     * @param f The task, a callable taking the task index.
+     */
+    template <typename F>
+    void paralleliserPondere(int nbTaches, const long *poidsCumules, F &&f) {
+        using Tache = typename std::remove_reference<F>::type;
+        lancer(nbTaches, poidsCumules, [](void *ctx, int tache) { (*static_cast<Tache*>(ctx))(tache); }, &f);
+    }
+
+    /**
+     * @brief Splits [0, n) into BLOCS_PAR_THREAD contiguous intervals per thread and runs f(debut, fin) on each.
+     *
+     * @param n The size of the range.
+     * @param f A callable taking (int debut, int fin).
+     */
+    template <typename F>
+    void pourIntervalles(int n, F &&f) {
+        pourIntervallesNumerotes(n, [&](int, int debut, int fin) { f(debut, fin); });
+    }
+
+    /**
+     * @brief Gets the number of intervals made of [0, n) by pourIntervalles.
+     *
+     * @param n The size of the range.
+     * @return The number of intervals.
+     */
+    int getNbIntervalles(int n) const {
+        return std::max(1, std::min(n, BLOCS_PAR_THREAD * nbThreads));
+    }
+
+    /**
+     * @brief Same as pourIntervalles, and passes the index of the interval, for reductions in a fixed order.
+     *
+     * @param n The size of the range.
+     * @param f A callable taking (int intervalle, int debut, int fin), intervalle in [0, getNbIntervalles(n)).
+     */
+    template <typename F>
+    void pourIntervallesNumerotes(int n, F &&f) {
+        const int nb = getNbIntervalles(n);
+        paralleliser(nb, [&](int t) {
+            f(t, static_cast<int>(static_cast<long>(n) * t / nb), static_cast<int>(static_cast<long>(n) * (t + 1) / nb));
+        });
+    }
+};
+
+#endif // POOLTHREADS_HXX
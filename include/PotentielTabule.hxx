@@ -0,0 +1,180 @@
+/**
+ * @class PotentielTabule
+ * @brief Pair potential tabulated over the squared distance, read with linear or cubic interpolation.
+ *
+ * A potential is a sum of terms (Lennard-Jones, shifted Lennard-Jones, the
+ * gravity-like term of the analytic kernel, or any user function). Each term gives,
+ * as functions of r², the coefficient c such that the force on particle i is
+ * c (r_j - r_i), and the energy of the pair. A term may be multiplied by the mass of
+ * the particle it acts on, as the gravity-like term. The tables are sampled once on a
+ * uniform grid of r² in [rMin², rCut²]: a pair then costs one lookup, whatever the
+ * cost of the functions. Below rMin the values at rMin are used.
+ *
+ * The cubic interpolation is a Hermite spline through the samples and the derivatives
+ * of the functions (by central differences), so the curve and its slope are continuous.
+ */
+
+#ifndef POTENTIELTABULE_HXX
+#define POTENTIELTABULE_HXX
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include "Reprise.hxx"
+
+class PotentielTabule {
+public:
+    static const int LINEAIRE = 0;  ///< Linear interpolation between the samples
+    static const int CUBIQUE = 1;  ///< Cubic Hermite interpolation
+
+    /**
+     * @brief One term of a potential, as functions of the squared distance.
+     */
+    struct Terme {
+        std::function<double(double)> coefficient;  ///< (1/r) dU/dr: the force on i is coefficient(r²) (r_j - r_i)
+        std::function<double(double)> energie;  ///< Energy U of the pair
+        bool parMasse = false;  ///< true when the term is multiplied by the mass of the particle it acts on
+
+        /**
+         * @brief Lennard-Jones term 4 eps ((sigma/r)^12 - (sigma/r)^6).
+         *
+         * @param eps, sigma The parameters of the potential
+         * @return Terme The term
+         */
+        static Terme lennardJones(double eps, double sigma);
+
+        /**
+         * @brief Lennard-Jones term whose energy is shifted to be zero at the cutoff radius.
+         *
+         * The forces are those of lennardJones.
+         *
+         * @param eps, sigma The parameters of the potential
+         * @param rCut The cutoff radius
+         * @return Terme The term
+         */
+        static Terme lennardJonesDecale(double eps, double sigma, double rCut);
+
+        /**
+         * @brief Gravity-like term of the analytic kernel: force m_i (r_j - r_i) / r³ on particle i.
+         *
+         * @return Terme The term, with its energy -m_i / r
+         */
+        static Terme gravitation();
+    };
+
+private:
+    double r2Min = 0;  ///< First sample
+    double r2Max = 0;  ///< Last sample, the squared cutoff radius
+    double invPas = 0;  ///< Inverse of the spacing of the samples
+    int nbIntervalles = 0;  ///< Number of intervals between the samples
+    int interpolation = LINEAIRE;  ///< LINEAIRE or CUBIQUE
+    std::vector<double> force;  ///< Polynomials of each interval: the pair coefficient, then the mass one (2 or 4 terms each)
+    std::vector<double> energie;  ///< Polynomials of each interval for the energies, same layout
+
+public:
+    /**
+     * @brief Default constructor, creates an empty table.
+     */
+    PotentielTabule();
+
+    /**
+     * @brief Samples a potential.
+     *
+     * @param termes The terms of the potential
+     * @param rMin The smallest tabulated distance (> 0)
+     * @param rCut The cutoff radius (> rMin)
+     * @param nbPoints The number of samples (at least 2)
+     * @param interpolation LINEAIRE or CUBIQUE
+     */
+    PotentielTabule(const std::vector<Terme> &termes, double rMin, double rCut, int nbPoints = 4096, int interpolation = CUBIQUE);
+
+    /**
+     * @brief Gets the squared cutoff radius of the table.
+     *
+     * @return double The last tabulated r²
+     */
+    double getR2Max() const {
+        return r2Max;
+    }
+
+    /**
+     * @brief Gets the interpolation of the table.
+     *
+     * @return int LINEAIRE or CUBIQUE
+     */
+    int getInterpolation() const {
+        return interpolation;
+    }
+
+    /**
+     * @brief Gets the number of samples.
+     *
+     * @return int The number of samples
+     */
+    int getNbPoints() const {
+        return nbIntervalles + 1;
+    }
+
+    /**
+     * @brief Reads the force coefficients at a squared distance.
+     *
+     * The force on particle i is (coefficient + m_i coefficientMasse) (r_j - r_i).
+     *
+     * @param r2 The squared distance, below the squared cutoff radius
+     * @param coefficient The coefficient of the terms independent of the mass
+     * @param coefficientMasse The coefficient of the terms multiplied by the mass
+     */
+    void coefficients(double r2, double &coefficient, double &coefficientMasse) const {
+        double t;
+        const int k = intervalle(r2, t);
+        if (interpolation == CUBIQUE) {
+            const double *a = &force[8 * k];
+            coefficient = a[0] + t * (a[1] + t * (a[2] + t * a[3]));
+            coefficientMasse = a[4] + t * (a[5] + t * (a[6] + t * a[7]));
+        } else {
+            const double *a = &force[4 * k];
+            coefficient = a[0] + t * a[1];
+            coefficientMasse = a[2] + t * a[3];
+        }
+    }
+
+    /**
+     * @brief Reads the energy of a pair, seen from particle i.
+     *
+     * @param r2 The squared distance, below the squared cutoff radius
+     * @param masse The mass of particle i, for the terms multiplied by the mass
+     * @return double The energy
+     */
+    double getEnergie(double r2, double masse) const;
+
+    /**
+     * @brief Writes the table to a restart file.
+     *
+     * @param reprise The restart file
+     */
+    void ecrire(EcritureReprise &reprise) const;
+
+    /**
+     * @brief Reads a table written by ecrire.
+     *
+     * @param reprise The restart file
+     */
+    void lire(LectureReprise &reprise);
+
+private:
+    /**
+     * @brief Finds the interval of a squared distance.
+     *
+     * @param r2 The squared distance, clamped to the table
+     * @param t The position in the interval, in [0, 1]
+     * @return int The index of the interval
+     */
+    int intervalle(double r2, double &t) const {
+        const double u = (std::min(std::max(r2, r2Min), r2Max) - r2Min) * invPas;
+        const int k = std::min(static_cast<int>(u), nbIntervalles - 1);
+        t = u - k;
+        return k;
+    }
+};
+
+#endif // POTENTIELTABULE_HXX
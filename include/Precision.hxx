@@ -0,0 +1,44 @@
+/**
+ * @file Precision.hxx
+ * @brief Floating-point types of the particle store, chosen at build time.
+ *
+ * The CMake option UNIVERS_PRECISION selects one of three policies:
+ * - double (default): every array of the store holds doubles;
+ * - mixte: positions and velocities are stored as floats, the forces as doubles;
+ * - simple: positions, velocities and forces are stored as floats.
+ *
+ * In every mode the pair interactions are computed in double precision, and the
+ * force, energy and statistics sums are accumulated in doubles; only the storage,
+ * hence the memory traffic of the kernels, shrinks.
+ */
+
+#ifndef PRECISION_HXX
+#define PRECISION_HXX
+
+#if defined(UNIVERS_PRECISION_SIMPLE)
+typedef float ReelPosition;  ///< Type of the stored positions and velocities
+typedef float ReelForce;  ///< Type of the stored forces
+#elif defined(UNIVERS_PRECISION_MIXTE)
+typedef float ReelPosition;  ///< Type of the stored positions and velocities
+typedef double ReelForce;  ///< Type of the stored forces
+#else
+typedef double ReelPosition;  ///< Type of the stored positions and velocities
+typedef double ReelForce;  ///< Type of the stored forces
+#endif
+
+/**
+ * @brief Gets the name of the precision policy of the build.
+ *
+ * @return "double", "mixte" or "simple"
+ */
+inline const char *nomPrecision() {
+#if defined(UNIVERS_PRECISION_SIMPLE)
+    return "simple";
+#elif defined(UNIVERS_PRECISION_MIXTE)
+    return "mixte";
+#else
+    return "double";
+#endif
+}
+
+#endif // PRECISION_HXX
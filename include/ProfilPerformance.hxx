@@ -0,0 +1,193 @@
+/**
+ * @class ProfilPerformance
+ * @brief Per-phase timers, pair counters and cell occupancy statistics of a run.
+ *
+ * The phases of a time step are timed with the scoped Chrono class. The report
+ * is written as a JSON document or appended as a CSV line, so that the time
+ * spent in each phase can be followed without a profiler.
+ */
+
+#ifndef PROFILPERFORMANCE_HXX
+#define PROFILPERFORMANCE_HXX
+
+#include <chrono>
+#include <string>
+#include "ParticuleStore.hxx"
+
+class ProfilPerformance {
+public:
+    static const int POSITIONS = 0;  ///< Position update
+    static const int CONDITIONS_LIMITES = 1;  ///< Boundary conditions
+    static const int CELLULES = 2;  ///< Cell reassignment and Verlet list updates
+    static const int FORCES = 3;  ///< Force computation
+    static const int VITESSES = 4;  ///< Velocity update
+    static const int SORTIE = 5;  ///< VTK output
+    static const int NB_PHASES = 6;  ///< Number of phases
+
+    /**
+     * @class Chrono
+     * @brief Adds the time spent in its scope to a phase of a profile.
+     *
+     * Nothing is measured when the profile is inactive.
+     */
+    class Chrono {
+    private:
+        ProfilPerformance *profil;  ///< The profile, null when inactive
+        int phase;  ///< The timed phase
+        std::chrono::steady_clock::time_point debut;  ///< Start of the measure
+
+    public:
+        /**
+         * @brief Starts timing a phase.
+         *
+         * @param profil The profile receiving the time.
+         * @param phase The phase index.
+         */
+        Chrono(ProfilPerformance &profil, int phase);
+
+        /**
+         * @brief Stops timing and adds the elapsed time to the phase.
+         */
+        ~Chrono();
+
+        Chrono(const Chrono&) = delete;
+        Chrono& operator=(const Chrono&) = delete;
+    };
+
+private:
+    bool actif = false;  ///< True when the timers and counters are recorded
+    double temps[NB_PHASES] = {};  ///< Time spent in each phase (s)
+    long nbAppels[NB_PHASES] = {};  ///< Number of measures of each phase
+    long nbPairesTestees = 0;  ///< Pair distances evaluated by the force passes
+    long nbPairesActives = 0;  ///< Pairs found within the cutoff radius
+    int nbCellules = 0;  ///< Number of cells at the last occupancy measure
+    int nbCellulesVides = 0;  ///< Number of empty cells
+    int occupationMin = 0;  ///< Smallest number of particles in a cell
+    int occupationMax = 0;  ///< Largest number of particles in a cell
+    double occupationMoyenne = 0;  ///< Mean number of particles per cell
+    double occupationEcartType = 0;  ///< Standard deviation of the number of particles per cell
+
+public:
+    /**
+     * @brief Enables or disables the recording.
+     *
+     * @param actif true to record the timers and counters
+     */
+    void setActif(bool actif);
+
+    /**
+     * @brief Tells whether the recording is enabled.
+     *
+     * @return true if enabled
+     */
+    bool estActif() const;
+
+    /**
+     * @brief Resets every timer, counter and statistic.
+     */
+    void reinitialiser();
+
+    /**
+     * @brief Adds a measure to a phase.
+     *
+     * @param phase The phase index
+     * @param secondes The measured time (s)
+     */
+    void ajouterTemps(int phase, double secondes);
+
+    /**
+     * @brief Adds the pair counts of a force pass.
+     *
+     * @param testees Pair distances evaluated
+     * @param actives Pairs within the cutoff radius
+     */
+    void ajouterPaires(long testees, long actives);
+
+    /**
+     * @brief Computes the occupancy statistics of the cells of a store sorted by cell.
+     *
+     * @param store The particle store, with up-to-date cell ranges
+     * @param nbCellules The number of cells
+     */
+    void mesurerOccupation(const ParticuleStore &store, int nbCellules);
+
+    /**
+     * @brief Gets the name of a phase.
+     *
+     * @param phase The phase index
+     * @return The name used in the reports
+     */
+    static const char *getNomPhase(int phase);
+
+    /**
+     * @brief Gets the time spent in a phase.
+     *
+     * @param phase The phase index
+     * @return double The time (s)
+     */
+    double getTemps(int phase) const;
+
+    /**
+     * @brief Gets the number of measures of a phase.
+     *
+     * @param phase The phase index
+     * @return long The number of measures
+     */
+    long getNbAppels(int phase) const;
+
+    /**
+     * @brief Gets the number of pair distances evaluated.
+     *
+     * @return long The number of pairs
+     */
+    long getNbPairesTestees() const;
+
+    /**
+     * @brief Gets the number of pairs found within the cutoff radius.
+     *
+     * @return long The number of pairs
+     */
+    long getNbPairesActives() const;
+
+    /**
+     * @brief Gets the number of empty cells at the last occupancy measure.
+     *
+     * @return int The number of empty cells
+     */
+    int getNbCellulesVides() const;
+
+    /**
+     * @brief Gets the largest number of particles in a cell at the last occupancy measure.
+     *
+     * @return int The largest occupancy
+     */
+    int getOccupationMax() const;
+
+    /**
+     * @brief Gets the mean number of particles per cell at the last occupancy measure.
+     *
+     * @return double The mean occupancy
+     */
+    double getOccupationMoyenne() const;
+
+    /**
+     * @brief Writes the report as a JSON document, replacing the file.
+     *
+     * @param fichier The name of the file
+     * @param iteration The step index
+     * @param t The simulated time
+     */
+    void ecrireJSON(const std::string &fichier, int iteration, double t) const;
+
+    /**
+     * @brief Appends the report as a CSV line.
+     *
+     * @param fichier The name of the file
+     * @param iteration The step index
+     * @param t The simulated time
+     * @param entete true to replace the file and write the header line first
+     */
+    void ecrireCSV(const std::string &fichier, int iteration, double t, bool entete) const;
+};
+
+#endif // PROFILPERFORMANCE_HXX
@@ -0,0 +1,167 @@
+/**
+ * @file Reprise.hxx
+ * @brief Binary restart files: EcritureReprise writes them, LectureReprise reads them.
+ *
+ * A file starts with a magic string, the format version and an endianness marker,
+ * followed by the values in the order they were written, and ends with the magic
+ * string again to detect truncated files. Each array is stored with its length and
+ * element size, then written or read in one block straight from its memory. Arrays
+ * of floating-point values saved with another precision (see Precision.hxx) are
+ * converted on reading.
+ */
+
+#ifndef REPRISE_HXX
+#define REPRISE_HXX
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @class EcritureReprise
+ * @brief Writer of a restart file.
+ *
+ * The data goes to a temporary file that replaces the target only once complete,
+ * so a crash while writing keeps the previous restart file intact.
+ */
+class EcritureReprise {
+private:
+    std::string fichier;  ///< Name of the restart file
+    std::string temporaire;  ///< Name of the file being written
+    std::ofstream flux;  ///< Output stream of the temporary file
+
+    /**
+     * @brief Writes raw bytes.
+     */
+    void ecrireOctets(const void *data, size_t taille);
+
+public:
+    /**
+     * @brief Opens the temporary file and writes the header.
+     *
+     * @param fichier The name of the restart file
+     */
+    explicit EcritureReprise(const std::string &fichier);
+
+    /**
+     * @brief Writes a value.
+     *
+     * @tparam T A trivially copyable type
+     * @param valeur The value
+     */
+    template <typename T>
+    void ecrire(const T &valeur) {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be written.");
+        ecrireOctets(&valeur, sizeof(T));
+    }
+
+    /**
+     * @brief Writes an array with its length and element size.
+     *
+     * @tparam T A trivially copyable type
+     * @param tableau The array
+     */
+    template <typename T>
+    void ecrireTableau(const std::vector<T> &tableau) {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be written.");
+        ecrire<uint64_t>(tableau.size());
+        ecrire<uint32_t>(sizeof(T));
+        ecrireOctets(tableau.data(), tableau.size() * sizeof(T));
+    }
+
+    /**
+     * @brief Writes the end marker, closes the file and moves it to its final name.
+     */
+    void terminer();
+};
+
+/**
+ * @class LectureReprise
+ * @brief Reader of a restart file.
+ */
+class LectureReprise {
+private:
+    std::string fichier;  ///< Name of the restart file
+    std::ifstream flux;  ///< Input stream
+    uint32_t version = 0;  ///< Format version of the file
+
+    /**
+     * @brief Reads raw bytes, throws if the file is too short.
+     */
+    void lireOctets(void *data, size_t taille);
+
+    /**
+     * @brief Reads n values of type S and converts them to T.
+     */
+    template <typename S, typename T>
+    void convertir(std::vector<T> &tableau, uint64_t n) {
+        std::vector<S> lus(n);
+        lireOctets(lus.data(), n * sizeof(S));
+        for (uint64_t k = 0; k < n; k++) {
+            tableau[k] = static_cast<T>(lus[k]);
+        }
+    }
+
+public:
+    /**
+     * @brief Opens the file and checks its header.
+     *
+     * @param fichier The name of the restart file
+     */
+    explicit LectureReprise(const std::string &fichier);
+
+    /**
+     * @brief Gets the format version of the file.
+     *
+     * @return uint32_t The version
+     */
+    uint32_t getVersion() const {
+        return version;
+    }
+
+    /**
+     * @brief Reads a value.
+     *
+     * @tparam T The type it was written with
+     * @return T The value
+     */
+    template <typename T>
+    T lire() {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be read.");
+        T valeur;
+        lireOctets(&valeur, sizeof(T));
+        return valeur;
+    }
+
+    /**
+     * @brief Reads an array written by ecrireTableau, converting the floating-point precision if needed.
+     *
+     * @tparam T The element type of the array
+     * @param tableau The array, resized to the stored length
+     */
+    template <typename T>
+    void lireTableau(std::vector<T> &tableau) {
+        const uint64_t n = lire<uint64_t>();
+        const uint32_t tailleElement = lire<uint32_t>();
+        tableau.resize(n);
+        if (tailleElement == sizeof(T)) {
+            lireOctets(tableau.data(), n * sizeof(T));
+        } else if (std::is_floating_point<T>::value && tailleElement == sizeof(float)) {
+            convertir<float>(tableau, n);
+        } else if (std::is_floating_point<T>::value && tailleElement == sizeof(double)) {
+            convertir<double>(tableau, n);
+        } else {
+            throw std::runtime_error("Unexpected element size in restart file " + fichier + ".");
+        }
+    }
+
+    /**
+     * @brief Checks the end marker.
+     */
+    void terminer();
+};
+
+#endif // REPRISE_HXX
@@ -0,0 +1,115 @@
+/**
+ * @file Statistiques.hxx
+ * @brief Global observables of a run (energies, momentum, temperature, virial pressure)
+ * and their time series, written as CSV or binary by SerieStatistiques.
+ *
+ * The observables are by-products of a step: the potential energy and the virial
+ * are summed by the force pass, the kinetic energy and the momentum by the velocity
+ * update. The units are those of the simulation, with the Boltzmann constant set to 1.
+ *
+ * The binary series starts with a magic string, the format version and an
+ * endianness marker; each record then holds the step index (int32), the number of
+ * particles (int64) and the NB_REELS doubles of the record, in the order of the
+ * CSV columns.
+ */
+
+#ifndef STATISTIQUES_HXX
+#define STATISTIQUES_HXX
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The observables of one step.
+ */
+struct Statistiques {
+    static const int NB_REELS = 9;  ///< Number of floating-point fields, from temps to viriel
+
+    int iteration = 0;  ///< Step index of the measure
+    long nbParticules = 0;  ///< Number of particles, over every MPI rank
+    double temps = 0;  ///< Simulated time
+    double energieCinetique = 0;  ///< Sum of m v² / 2
+    double energiePotentielle = 0;  ///< Pair energies within the cutoff radius, plus -m G y for the uniform field
+    double quantiteMouvement[3] = {};  ///< Total momentum
+    double temperature = 0;  ///< 2 Ec / (d N), d being the dimension
+    double pression = 0;  ///< Virial pressure (2 Ec + viriel) / (d V), V being the volume of the box
+    double viriel = 0;  ///< Sum over the pairs of r_ij . f_ij, with the uncapped pair forces
+
+    /**
+     * @brief Gets the total energy.
+     *
+     * @return double Ec + Ep
+     */
+    double getEnergieTotale() const {
+        return energieCinetique + energiePotentielle;
+    }
+};
+
+/**
+ * @class SerieStatistiques
+ * @brief Appends measures to a time series file.
+ *
+ * The series is written as CSV (';' separated, with a header line) when the name of
+ * the file ends with .csv, and in binary otherwise.
+ */
+class SerieStatistiques {
+private:
+    std::string fichier;  ///< Name of the file
+    bool csv;  ///< true for a CSV file, false for a binary one
+    std::ofstream flux;  ///< Output stream
+    int nbMesures = 0;  ///< Number of measures written
+
+public:
+    /**
+     * @brief Creates the file, replacing an existing one, and writes its header.
+     *
+     * @param fichier The name of the file
+     */
+    explicit SerieStatistiques(const std::string &fichier);
+
+    SerieStatistiques(const SerieStatistiques&) = delete;
+    SerieStatistiques& operator=(const SerieStatistiques&) = delete;
+
+    /**
+     * @brief Appends a measure.
+     *
+     * @param statistiques The measure
+     */
+    void ajouter(const Statistiques &statistiques);
+
+    /**
+     * @brief Writes the buffered measures to the file.
+     */
+    void vider();
+
+    /**
+     * @brief Gets the number of measures written.
+     *
+     * @return int The number of measures
+     */
+    int getNbMesures() const {
+        return nbMesures;
+    }
+
+    /**
+     * @brief Tells whether the file is written as CSV.
+     *
+     * @return bool true for CSV, false for binary
+     */
+    bool estCSV() const {
+        return csv;
+    }
+
+    /**
+     * @brief Reads every measure of a binary series.
+     *
+     * @param fichier The name of the file
+     * @return std::vector<Statistiques> The measures, in the order they were written
+     */
+    static std::vector<Statistiques> lire(const std::string &fichier);
+};
+
+#endif // STATISTIQUES_HXX
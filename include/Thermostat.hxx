@@ -0,0 +1,197 @@
+/**
+ * @class Thermostat
+ * @brief Temperature control of the runs: Berendsen, Langevin or Nosé–Hoover.
+ *
+ * The thermostat acts in the velocity update of each step, in the same loop: the
+ * updated velocities are multiplied by getEchelle() and, for Langevin, receive a
+ * Gaussian kick of standard deviation getBruit() / sqrt(m) per component. Berendsen
+ * and Nosé–Hoover read the temperature summed by the velocity update of the previous
+ * step, so a thermostatted step makes no extra pass over the particles.
+ *
+ * The units are those of the simulation, with the Boltzmann constant set to 1: the
+ * temperature is 2 Ec / (d N), d being the dimension.
+ *
+ * The random numbers of Langevin come from a counter-based generator keyed on the
+ * seed, the step and the particle identifier, so the kicks do not depend on the
+ * number of threads nor on the order of the particles, and a run resumed from a
+ * restart file draws the same numbers.
+ */
+
+#ifndef THERMOSTAT_HXX
+#define THERMOSTAT_HXX
+
+#include <cmath>
+#include <cstdint>
+#include "Reprise.hxx"
+
+class Thermostat {
+public:
+    static const int AUCUN = 0;  ///< No thermostat: constant energy
+    static const int BERENDSEN = 1;  ///< Rescaling by sqrt(1 + dt / tau (T0 / T - 1)), first-order relaxation of T
+    static const int LANGEVIN = 2;  ///< Friction 1 / tau and matching random kicks, canonical sampling
+    static const int NOSE_HOOVER = 3;  ///< Friction xi with d xi / dt = (T / T0 - 1) / tau², canonical sampling
+
+private:
+    int type = AUCUN;  ///< Kind of thermostat
+    double temperatureCible = 0;  ///< Target temperature T0
+    double tempsCouplage = 1;  ///< Coupling time tau
+    uint64_t graine = 0;  ///< Seed of the random kicks of Langevin
+    double friction = 0;  ///< Friction xi of Nosé–Hoover, 0 for the other kinds
+    double echelle = 1;  ///< Factor of the velocities in the current step
+    double bruit = 0;  ///< Standard deviation of the kicks of the current step, times sqrt(m)
+
+public:
+    /**
+     * @brief Default constructor, creates an inactive thermostat (AUCUN).
+     */
+    Thermostat();
+
+    /**
+     * @brief Creates a thermostat.
+     *
+     * @param type AUCUN, BERENDSEN, LANGEVIN or NOSE_HOOVER
+     * @param temperature The target temperature (>= 0, > 0 for NOSE_HOOVER)
+     * @param tempsCouplage The coupling time (> 0): relaxation time of Berendsen, inverse friction
+     * of Langevin, period of the friction of Nosé–Hoover
+     * @param graine The seed of the random kicks of Langevin
+     */
+    Thermostat(int type, double temperature, double tempsCouplage, uint64_t graine = 0);
+
+    /**
+     * @brief Gets the kind of thermostat.
+     *
+     * @return int AUCUN, BERENDSEN, LANGEVIN or NOSE_HOOVER
+     */
+    int getType() const {
+        return type;
+    }
+
+    /**
+     * @brief Tells whether the thermostat acts on the velocities.
+     *
+     * @return bool false for AUCUN
+     */
+    bool estActif() const {
+        return type != AUCUN;
+    }
+
+    /**
+     * @brief Tells whether the thermostat needs the temperature of the previous step.
+     *
+     * @return bool true for BERENDSEN and NOSE_HOOVER
+     */
+    bool litTemperature() const {
+        return type == BERENDSEN || type == NOSE_HOOVER;
+    }
+
+    /**
+     * @brief Gets the target temperature.
+     *
+     * @return double T0
+     */
+    double getTemperatureCible() const {
+        return temperatureCible;
+    }
+
+    /**
+     * @brief Gets the coupling time.
+     *
+     * @return double tau
+     */
+    double getTempsCouplage() const {
+        return tempsCouplage;
+    }
+
+    /**
+     * @brief Gets the seed of the random kicks.
+     *
+     * @return uint64_t The seed
+     */
+    uint64_t getGraine() const {
+        return graine;
+    }
+
+    /**
+     * @brief Gets the friction of Nosé–Hoover.
+     *
+     * @return double xi, 0 for the other kinds
+     */
+    double getFriction() const {
+        return friction;
+    }
+
+    /**
+     * @brief Computes the factors of a step; for Nosé–Hoover, advances the friction by dt.
+     *
+     * @param temperature The temperature at the end of the previous step (ignored by Langevin)
+     * @param dt The time step
+     */
+    void preparer(double temperature, double dt);
+
+    /**
+     * @brief Gets the factor of the velocities in the current step.
+     *
+     * @return double The factor, 1 for AUCUN
+     */
+    double getEchelle() const {
+        return echelle;
+    }
+
+    /**
+     * @brief Gets the standard deviation of the kicks of the current step, for a unit mass.
+     *
+     * @return double sqrt((1 - exp(-2 dt / tau)) T0) for Langevin, 0 otherwise
+     */
+    double getBruit() const {
+        return bruit;
+    }
+
+    /**
+     * @brief Draws two independent standard normal numbers from the seed, the step, the particle and the pair index.
+     *
+     * @param graine The seed
+     * @param pas The step index
+     * @param id The identifier of the particle
+     * @param paire 0 for the x and y components, 1 for z
+     * @param g1, g2 Receive the numbers, always the same for the same arguments
+     */
+    static void gaussiennes(uint64_t graine, uint64_t pas, uint64_t id, int paire, double &g1, double &g2) {
+        const uint64_t h = melanger(melanger(melanger(graine + pas) + id) + static_cast<uint64_t>(paire));
+        const double u1 = (static_cast<double>(h >> 32) + 0.5) * (1.0 / 4294967296.0);
+        const double u2 = (static_cast<double>(h & 0xffffffffu) + 0.5) * (1.0 / 4294967296.0);
+        // Box-Muller: the cosine and the sine of the same angle give two independent numbers
+        const double rayon = std::sqrt(-2 * std::log(u1));
+        g1 = rayon * std::cos(6.283185307179586 * u2);
+        g2 = rayon * std::sin(6.283185307179586 * u2);
+    }
+
+    /**
+     * @brief Writes the thermostat, with the friction of Nosé–Hoover, to a restart file.
+     *
+     * @param reprise The restart file
+     */
+    void ecrire(EcritureReprise &reprise) const;
+
+    /**
+     * @brief Reads a thermostat written by ecrire.
+     *
+     * @param reprise The restart file
+     */
+    void lire(LectureReprise &reprise);
+
+private:
+    /**
+     * @brief Mixes the bits of a 64-bit word (splitmix64 finalizer).
+     *
+     * @param x The word
+     * @return uint64_t The mixed word
+     */
+    static uint64_t melanger(uint64_t x) {
+        x += 0x9e3779b97f4a7c15ull;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+};
+
+#endif // THERMOSTAT_HXX
@@ -0,0 +1,187 @@
+/**
+ * @file Trajectoire.hxx
+ * @brief Append-only trajectory files: EcritureTrajectoire writes the snapshots of a run
+ * into a single file, LectureTrajectoire reads any of them back or converts them for ParaView.
+ *
+ * The file starts with a magic string, the format version, an endianness marker and
+ * the dimension of the universe. Each frame then holds a header (marker, size of the
+ * frame in bytes, frame index, step index, simulated time, number of particles)
+ * followed by the Float32 positions and velocities (3 components per particle),
+ * the categories and the identifiers. A frame cut short by a crash is ignored on
+ * reading and dropped when the file is resumed.
+ */
+
+#ifndef TRAJECTOIRE_HXX
+#define TRAJECTOIRE_HXX
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ParticuleStore.hxx"
+
+/**
+ * @brief A snapshot read from a trajectory file.
+ */
+struct FrameTrajectoire {
+    int iteration = 0;  ///< Step index of the snapshot
+    double temps = 0;  ///< Simulated time of the snapshot
+    std::vector<float> positions;  ///< Positions, 3 components per particle
+    std::vector<float> vitesses;  ///< Velocities, 3 components per particle
+    std::vector<int32_t> categories;  ///< Category of each particle
+    std::vector<int32_t> ids;  ///< Identifier of each particle
+
+    /**
+     * @brief Gets the number of particles of the snapshot.
+     *
+     * @return int The number of particles
+     */
+    int getNbParticules() const {
+        return static_cast<int>(ids.size());
+    }
+};
+
+/**
+ * @class EcritureTrajectoire
+ * @brief Appends snapshots to a trajectory file through a large output buffer.
+ *
+ * Small frames accumulate in the buffer, so a run writes a few large blocks
+ * instead of one file per snapshot.
+ */
+class EcritureTrajectoire {
+private:
+    std::string fichier;  ///< Name of the trajectory file
+    std::unique_ptr<char[]> tampon;  ///< Buffer of the output stream
+    std::ofstream flux;  ///< Output stream
+    uint32_t nbFrames = 0;  ///< Number of frames in the file
+    std::vector<float> scratch;  ///< Scratch: one array converted to Float32
+    std::vector<int32_t> scratchEntiers;  ///< Scratch: one array of integers
+
+public:
+    static const size_t TAILLE_TAMPON = 8 << 20;  ///< Size of the output buffer in bytes
+
+    /**
+     * @brief Creates a trajectory file, or resumes an existing one.
+     *
+     * @param fichier The name of the file
+     * @param dimension The dimension of the universe, stored in the header
+     * @param derniereIteration -1 to start a new file; otherwise the frames of the
+     * existing file up to this step index are kept and the next ones are dropped
+     */
+    EcritureTrajectoire(const std::string &fichier, int dimension, int derniereIteration = -1);
+
+    EcritureTrajectoire(const EcritureTrajectoire&) = delete;
+    EcritureTrajectoire& operator=(const EcritureTrajectoire&) = delete;
+
+    /**
+     * @brief Appends a snapshot of the particle store.
+     *
+     * @param store The particle store
+     * @param iteration The step index
+     * @param temps The simulated time
+     */
+    void ecrire(const ParticuleStore &store, int iteration, double temps);
+
+    /**
+     * @brief Writes the buffered frames to the file.
+     */
+    void vider();
+
+    /**
+     * @brief Gets the number of frames in the file, buffered ones included.
+     *
+     * @return int The number of frames
+     */
+    int getNbFrames() const {
+        return static_cast<int>(nbFrames);
+    }
+};
+
+/**
+ * @class LectureTrajectoire
+ * @brief Random access to the frames of a trajectory file.
+ *
+ * Opening the file only reads the frame headers, hopping from one frame to the
+ * next, to build the index of the frames.
+ */
+class LectureTrajectoire {
+public:
+    /**
+     * @brief Position and header of a frame.
+     */
+    struct Entree {
+        uint64_t decalage;  ///< Offset of the frame in the file
+        int iteration;  ///< Step index
+        double temps;  ///< Simulated time
+        uint64_t nbParticules;  ///< Number of particles
+    };
+
+private:
+    std::string fichier;  ///< Name of the trajectory file
+    std::ifstream flux;  ///< Input stream
+    int dimension = 0;  ///< Dimension of the universe
+    std::vector<Entree> index;  ///< Index of the complete frames
+    uint64_t finDonnees = 0;  ///< End of the last complete frame
+
+public:
+    /**
+     * @brief Opens a trajectory file and indexes its frames.
+     *
+     * @param fichier The name of the file
+     */
+    explicit LectureTrajectoire(const std::string &fichier);
+
+    /**
+     * @brief Gets the number of complete frames.
+     *
+     * @return int The number of frames
+     */
+    int getNbFrames() const {
+        return static_cast<int>(index.size());
+    }
+
+    /**
+     * @brief Gets the dimension of the universe stored in the header.
+     *
+     * @return int The dimension
+     */
+    int getDimension() const {
+        return dimension;
+    }
+
+    /**
+     * @brief Gets the header of a frame.
+     *
+     * @param k The index of the frame
+     * @return const Entree& The position and header of the frame
+     */
+    const Entree &getEntree(int k) const;
+
+    /**
+     * @brief Gets the end of the last complete frame, where the next frame is appended.
+     *
+     * @return uint64_t The offset in bytes
+     */
+    uint64_t getFinDonnees() const {
+        return finDonnees;
+    }
+
+    /**
+     * @brief Reads a frame.
+     *
+     * @param k The index of the frame
+     * @param frame The snapshot, its arrays are resized
+     */
+    void lireFrame(int k, FrameTrajectoire &frame);
+
+    /**
+     * @brief Converts every frame to a .vtu file and writes a .pvd collection for ParaView.
+     *
+     * @param prefixe The prefix of the files: prefixe_t<step>.vtu and prefixe.pvd
+     * @param format The VTK format (see EcritureVTK)
+     */
+    void exporterVTK(const std::string &prefixe, int format = 1);
+};
+
+#endif // TRAJECTOIRE_HXX
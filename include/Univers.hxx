@@ -2,7 +2,23 @@
 #include "Cellule.hxx"
 #include "Particule3D.hxx"
 #include "Vector3D.hxx"
+#include "ParticuleStore.hxx"
+#include "ListeVoisins.hxx"
+#include "PoolThreads.hxx"
+#include "EcritureVTK.hxx"
+#include "EcritureAsynchrone.hxx"
+#include "Trajectoire.hxx"
+#include "DecompositionDomaine.hxx"
+#include "ProfilPerformance.hxx"
+#include "NoyauLJ.hxx"
+#include "PotentielTabule.hxx"
+#include "ChampForces.hxx"
+#include "Statistiques.hxx"
+#include "Thermostat.hxx"
+#include "OrdreCellules.hxx"
+#include <memory>
 #include <string>
+#include <algorithm>
 
 #ifndef UNIVERS_HXX
 #define UNIVERS_HXX
@@ -26,7 +42,498 @@ private:
     float tmax; ///< Maximum time
     int boundaryCond = 0; ///< Boundary condition: 0 = absorption, 1 = periodic, 2 = reflection
     float G = 0; ///< Gravitational constant
-    int scaleType = 0; ///< Scale type: 0 = scale by max force, 1 = using kinetic energy
+    int scaleType = 0; ///< Scale type: 0 = cap the forces in 2D too, 1 = cap them only in 3D (temperature control is the thermostat)
+    int forceEngine = 1; ///< Force engine: 0 = full shell (every pair seen twice), 1 = half shell (Newton's third law)
+    int jeuInstructions = NoyauLJ::AUTOMATIQUE; ///< Instruction set of the cell force kernels (see NoyauLJ)
+    std::shared_ptr<const PotentielTabule> potentiel; ///< Tabulated potential of the force passes, null for the analytic kernel NoyauLJ
+    std::shared_ptr<const ChampForces> champ; ///< Force field of the force passes, in place of the table and of NoyauLJ when set
+    int ordreCellules = OrdreCellules::LIGNES; ///< Order of the cells in the cell array (see OrdreCellules)
+    std::vector<int> rangCellules; ///< Index in cellules of each cell, by row-major position (empty in row-major order)
+    bool grilleCreuse = false; ///< True when only the occupied cells and their neighbors are created (see setGrilleCreuse)
+    std::vector<long> clesCreuses; ///< Open-addressing hash table of the created cells: row-major position, -1 if the slot is free (sparse grid only)
+    std::vector<int> indexCreux; ///< Index in cellules of the cell of each slot of clesCreuses (sparse grid only)
+    int decalageCreux = 64; ///< Shift of the hash of a position, 64 minus the log2 of the table size
+    std::vector<long> rangsParticules; ///< Scratch: row-major position of the cell of each particle, while the sparse grid is built
+    std::vector<long> rangsCrees; ///< Scratch: row-major positions of the cells to create, while the sparse grid is built
+    std::vector<int> voisinesCreuses; ///< Index in cellules of the 27 neighbors of each cell, -1 if not created (sparse grid only)
+    bool celluleManquante = false; ///< True when a particle of the sparse grid lies in a cell not created yet
+    float verletSkin = 0; ///< Skin distance of the Verlet neighbor lists, 0 = lists disabled
+    ListeVoisins listes; ///< Verlet neighbor lists (half lists built with rCut + verletSkin)
+    bool listesValides = false; ///< True while the lists refer to the current order of the store
+    int nbPasVerlet = 0; ///< Number of neighborhood updates done in Verlet mode
+    int nbThreads = 1; ///< Number of threads used by the force and integration passes
+    std::shared_ptr<PoolThreads> pool; ///< Worker threads, null when nbThreads is 1
+    std::vector<int> bornesBlocs; ///< Scratch: first cell (or layer) of each block of the weighted loops, then the end
+    std::vector<long> poidsBlocs; ///< Scratch: cumulated weights of the blocks of the weighted loops
+    std::vector<long> poidsCouches; ///< Scratch: cumulated weights of the layers of cells, for the half-shell slabs
+    std::vector<ReelForce> forcesTaches; ///< Scratch: forces (x, y, z) of the ranges 1 .. nbThreads - 1 of the threaded Verlet pass
+    std::vector<size_t> basesTaches; ///< Scratch: offset of the force of particle i in forcesTaches, minus i, per range and component
+    std::vector<int> finsTaches; ///< Scratch: end of the particles reached by each range of the threaded Verlet pass
+    EcritureVTK ecritureVTK; ///< Writer of the VTK files (raw binary by default)
+    std::shared_ptr<EcritureAsynchrone> ecritureAsynchrone; ///< Background writer, null when the files are written synchronously
+    std::shared_ptr<EcritureTrajectoire> trajectoire; ///< Trajectory file receiving the snapshots instead of the VTK files, null if none
+    std::shared_ptr<DecompositionDomaine> decomposition; ///< Slab of the grid owned by this MPI rank, null for a single process
+    std::vector<std::vector<DecompositionDomaine::ParticuleEchangee>> envois; ///< Scratch: particles sent to each rank
+    std::vector<DecompositionDomaine::ParticuleEchangee> versPrecedent; ///< Scratch: ghosts sent to the previous slab
+    std::vector<DecompositionDomaine::ParticuleEchangee> versSuivant; ///< Scratch: ghosts sent to the next slab
+    std::vector<DecompositionDomaine::ParticuleEchangee> recus; ///< Scratch: particles received from the other ranks
+    int frequenceSortie = 1; ///< Number of steps between two VTK files, 0 = no output
+    float intervalleSortie = 0; ///< Simulated time between two VTK files, 0 = use frequenceSortie
+    double prochaineSortie = 0; ///< Simulated time of the next VTK file when intervalleSortie is set
+    std::string prefixeSortie = "data"; ///< Start of the VTK file names, <prefixe>_t<N>.vtu
+    ParticuleStore store; ///< Structure-of-arrays storage of all the particles, grouped by cell
+    bool plagesValides = true; ///< True when the store is sorted by cell and the cell ranges are up to date
+    int nbMigrants = 0; ///< Number of particles that changed cell at the last reassignment
+    ProfilPerformance profil; ///< Per-phase timers, pair counters and cell occupancy
+    std::string fichierRapport; ///< Performance report file, empty if none
+    int frequenceRapport = 0; ///< Number of steps between two intermediate reports, 0 = final report only
+    bool rapportCommence = false; ///< True once the report of the current run has been written
+    std::string fichierReprise; ///< Restart file written during the runs, empty if none
+    int frequenceReprise = 0; ///< Number of steps between two restart files, 0 = none
+    long nbPairesTestees = 0; ///< Pair distances evaluated by the last force pass
+    long nbPairesActives = 0; ///< Pairs within rCut found by the last force pass
+    int frequenceStatistiques = 0; ///< Number of steps between two measures of the statistics, 0 = none
+    std::shared_ptr<SerieStatistiques> serieStatistiques; ///< Time series receiving the measures, null to keep only the last one
+    Statistiques statistiques; ///< Last measure of the statistics
+    bool mesurerForces = false; ///< True when the next force pass also sums the potential energy and the virial
+    std::vector<double> mesuresCellules; ///< Scratch: potential energy and virial of the pairs of each cell, during a measured force pass
+    std::vector<double> partielsVitesses; ///< Scratch: kinetic energy, momentum and field energy of each interval, during a measured velocity update
+    Thermostat thermostat; ///< Temperature control applied in the velocity update, AUCUN by default
+    double temperatureThermostat = 0; ///< Temperature summed by the last velocity update, read by the thermostat in the next one
+    float deplacementMaxPas = 0; ///< Largest displacement of a particle in an adaptive step, 0 for the fixed step dt
+    float dtMin = 0; ///< Smallest adaptive step
+    float dtMax = 0; ///< Largest adaptive step, the fixed step given before the adaptive step was set
+    float temps = 0; ///< Simulated time since the start of the evolution
+    int iteration = 0; ///< Number of steps since the start of the evolution
+    bool forcesAJour = false; ///< True when the forces match the current positions
+    bool categoriesVerifiees = false; ///< True when the categories of the particles were checked against the force field
+    int gridWidth = 0; ///< Number of cells in x direction
+    int gridHeight = 0; ///< Number of cells in y direction
+    int gridDepth = 0; ///< Number of cells in z direction (1 in 2D)
+
+    /**
+     * @brief Computes the number of cells in each direction from the box size and the cutoff radius.
+     */
+    void initGrille();
+
+    /**
+     * @brief Creates the cells of the grid (none for a sparse grid) and empties the store.
+     */
+    void creerCellules();
+
+    /**
+     * @brief Creates every cell of the dense grid, without touching the store.
+     */
+    void construireCellules();
+
+    /**
+     * @brief Creates the cells of the sparse grid holding a particle, and their neighbors,
+     * then moves every particle to its cell.
+     */
+    void construireGrilleCreuse();
+
+    /**
+     * @brief Replaces the cells with those of the sparse grid at given positions.
+     *
+     * @param cles The row-major positions of the cells, in increasing order
+     */
+    void materialiserCellules(const std::vector<long> &cles);
+
+    /**
+     * @brief Gets the coordinates of the cell containing a position, clamped to the grid.
+     *
+     * @param x, y, z The position
+     * @param cellX, cellY, cellZ The coordinates of the cell
+     */
+    void coordonneesCellule(double x, double y, double z, int &cellX, int &cellY, int &cellZ) const;
+
+    /**
+     * @brief Gets the index in cellules of the first cell of a layer (y in 2D, z in 3D), or of the row-major
+     * position of that cell when the cells follow a space-filling curve.
+     *
+     * @param couche The layer
+     * @param tailleCouche The number of cells of a layer in the dense grid
+     * @return int The index, the number of cells after the last layer
+     */
+    int debutCouche(int couche, int tailleCouche) const;
+
+    /**
+     * @brief Moves the cells, created in row-major order, to the positions of ordreCellules.
+     */
+    void ordonnerCellules();
+
+    /**
+     * @brief Gets the index in cellules of the cell at given grid coordinates.
+     *
+     * @param cellX, cellY, cellZ The coordinates of the cell in the grid
+     * @return int The index of the cell, -1 if the sparse grid has not created it
+     */
+    int indexCellule(int cellX, int cellY, int cellZ) const {
+        const long rang = cellX + static_cast<long>(cellY) * gridWidth + static_cast<long>(cellZ) * gridWidth * gridHeight;
+        if (grilleCreuse) {
+            return chercherCreuse(rang);
+        }
+        return rangCellules.empty() ? static_cast<int>(rang) : rangCellules[rang];
+    }
+
+    /**
+     * @brief Looks up a cell of the sparse grid in its hash table (linear probing).
+     *
+     * @param rang The row-major position of the cell
+     * @return int The index of the cell, -1 if not created
+     */
+    int chercherCreuse(long rang) const {
+        if (clesCreuses.empty()) {
+            return -1;
+        }
+        const size_t masque = clesCreuses.size() - 1;
+        for (size_t h = (static_cast<unsigned long long>(rang) * 0x9E3779B97F4A7C15ull) >> decalageCreux;; h = (h + 1) & masque) {
+            if (clesCreuses[h] == rang) {
+                return indexCreux[h];
+            }
+            if (clesCreuses[h] < 0) {
+                return -1;
+            }
+        }
+    }
+
+    /**
+     * @brief Gets the index in cellules of a neighbor of a cell of the sparse grid.
+     *
+     * @param c Index of the cell
+     * @param dx, dy, dz The offset of the neighbor, each in [-1, 1]
+     * @return int The index of the neighbor, -1 if not created or outside the grid
+     */
+    int voisineCreuse(int c, int dx, int dy, int dz) const {
+        return voisinesCreuses[27 * c + (dz + 1) * 9 + (dy + 1) * 3 + dx + 1];
+    }
+
+    /**
+     * @brief Gets the index in cellules of the cell of a particle that moved, from its previous cell.
+     *
+     * A move to a neighboring cell is read in the neighbor table of the sparse grid,
+     * a longer one is looked up in the hash table.
+     *
+     * @param c Index of the previous cell, -1 if none
+     * @param cellX, cellY, cellZ The coordinates of the new cell
+     * @return int The index of the cell, -1 if the sparse grid has not created it
+     */
+    int celluleApresDeplacement(int c, int cellX, int cellY, int cellZ) const {
+        if (!grilleCreuse) {
+            return indexCellule(cellX, cellY, cellZ);
+        }
+        if (c >= 0) {
+            const int *id = cellules[c].getId();
+            const int dx = cellX - id[0], dy = cellY - id[1], dz = cellZ - id[2];
+            if (dx >= -1 && dx <= 1 && dy >= -1 && dy <= 1 && dz >= -1 && dz <= 1) {
+                return voisineCreuse(c, dx, dy, dz);
+            }
+        }
+        return indexCellule(cellX, cellY, cellZ);
+    }
+
+    /**
+     * @brief Sorts the store by cell if particles were added since the last sort.
+     */
+    void assurerTri();
+
+    /**
+     * @brief Copies the cell ranges of the store into the cells.
+     */
+    void synchroniserPlages();
+
+    /**
+     * @brief Checks once that the categories of the particles lie in those of the force field.
+     *
+     * The check is cached until the particles, the field or the store change.
+     */
+    void verifierCategories();
+
+    /**
+     * @brief Moves the particles whose cell index changed to their new cell.
+     */
+    void migrerParticules();
+
+    /**
+     * @brief Writes the performance report with the current cell occupancy.
+     */
+    void ecrireRapport();
+
+    /**
+     * @brief Writes the VTK file of a step if the output cadence asks for it.
+     *
+     * @param iter The step index (0 for the initial state).
+     * @param t The simulated time.
+     */
+    void ecrireSortie(int iter, double t);
+
+    /**
+     * @brief Waits for the snapshots written in the background and flushes the trajectory and statistics files.
+     */
+    void terminerSorties();
+
+    std::vector<char> aSupprimer; ///< Scratch flags reused by absorptionBC and the domain decomposition
+
+    /**
+     * @brief Tells whether the grid is split over several MPI ranks.
+     *
+     * @return true if this rank owns only a slab of the grid
+     */
+    bool estDecompose() const {
+        return decomposition && decomposition->getNbRangs() > 1;
+    }
+
+    /**
+     * @brief Gets the name of a file of this rank: the name with the suffix _r<rank> before its extension.
+     *
+     * @param fichier The name of the file
+     * @return std::string The name unchanged for a single process, data_r2.bin for data.bin on rank 2
+     */
+    std::string nomDuRang(const std::string &fichier) const;
+
+    /**
+     * @brief Gets the layer of a cell along the axis split by the domain decomposition (y in 2D, z in 3D).
+     *
+     * @param c Index of the cell
+     * @return int The layer
+     */
+    int coucheCellule(int c) const {
+        return cellules[c].getId()[(gridDepth > 1) ? 2 : 1];
+    }
+
+    /**
+     * @brief Computes the index of the cell containing a position of the box.
+     *
+     * @param x, y, z The position
+     * @return int The index of the cell
+     */
+    int celluleDePosition(double x, double y, double z) const;
+
+    /**
+     * @brief Sends the particles that left the slab of this rank to their new owner and receives the others.
+     */
+    void migrerEntreDomaines();
+
+    /**
+     * @brief Adds copies of the particles of the layers bordering the slab, received from the neighboring ranks.
+     */
+    void ajouterFantomes();
+
+    /**
+     * @brief Appends the received particles to the store and merges them into their cells.
+     *
+     * The cell ranges stay valid when they were, so that no step re-sorts the
+     * store; a particle outside the cells of a sparse grid invalidates them.
+     */
+    void insererRecus();
+
+    /**
+     * @brief Removes the particles outside the slab of this rank.
+     *
+     * @return int The number of particles removed
+     */
+    int retirerHorsDomaine();
+
+    /**
+     * @brief Computes the forces of a step: with the ghost particles when the grid is decomposed.
+     *
+     * @tparam DIM 2 or 3
+     */
+    template <int DIM>
+    void calculForcesPas();
+
+    /**
+     * @brief Lennard-Jones and gravitational force kernel shared by calculForces and calculForces3D.
+     *
+     * @tparam DIM 2 to visit the 9 neighboring cells in the xy plane, 3 to visit the 27 neighbors
+     */
+    template <int DIM>
+    void calculForcesCellules();
+
+    /**
+     * @brief Half-shell force kernel: each pair is evaluated once and the opposite force is applied to both particles.
+     *
+     * @tparam DIM 2 to visit 4 forward neighbors in the xy plane, 3 to visit 13 forward neighbors
+     * @tparam BORNER true to cap the pair forces
+     */
+    template <int DIM, bool BORNER>
+    void calculForcesDemiCoquille();
+
+    /**
+     * @brief Runs the selected force engine (Verlet lists, half shell or full shell).
+     *
+     * @tparam DIM 2 or 3
+     */
+    template <int DIM>
+    void calculForcesDim();
+
+    /**
+     * @brief Splits [0, n) among the threads and runs f(debut, fin) on each part.
+     *
+     * @param n The size of the range.
+     * @param f A callable taking (int debut, int fin).
+     */
+    template <typename F>
+    void pourIntervalles(int n, F &&f) {
+        if (pool) {
+            pool->pourIntervalles(n, f);
+        } else {
+            f(0, n);
+        }
+    }
+
+    /**
+     * @brief Splits [0, n) among the threads and runs f(intervalle, debut, fin) on each part.
+     *
+     * @param n The size of the range.
+     * @param f A callable taking (int intervalle, int debut, int fin).
+     * @return The number of intervals, the values taken by intervalle.
+     */
+    template <typename F>
+    int pourIntervallesNumerotes(int n, F &&f) {
+        if (pool) {
+            pool->pourIntervallesNumerotes(n, f);
+            return pool->getNbIntervalles(n);
+        }
+        f(0, 0, n);
+        return 1;
+    }
+
+    /**
+     * @brief Prepares mesuresCellules for a measured force pass.
+     *
+     * @param nbSommes The minimum number of pairs of sums (default 1)
+     * @return double* Two zeroed sums (energy, virial) per cell, at least nbSommes.
+     */
+    double *preparerMesures(int nbSommes = 1);
+
+    /**
+     * @brief Sums the kinetic energy, the momentum and the energy in the uniform field G over the particles.
+     *
+     * With MISE_A_JOUR, the sums are taken in the velocity update itself, after each
+     * particle is updated and multiplied by the factor of the thermostat; otherwise the
+     * velocities are only read. The partial sums of the intervals are added in a fixed order.
+     *
+     * @tparam DIM 2 or 3, the number of components updated
+     * @tparam MISE_A_JOUR true to update the velocities in the same loop
+     * @tparam LANGEVIN true to add the random kicks of the Langevin thermostat
+     * @param sommes Receives Ec, px, py, pz, the field energy and the largest v² and (F / m)² of this rank
+     */
+    template <int DIM, bool MISE_A_JOUR, bool LANGEVIN = false>
+    void sommerVitesses(double sommes[7]);
+
+    /**
+     * @brief Computes the temperature 2 Ec / (d N) over every MPI rank.
+     *
+     * @param energie The kinetic energy of this rank
+     * @return double The temperature, 0 without particles
+     */
+    double calculerTemperature(double energie);
+
+    /**
+     * @brief Updates the velocities with the sums of the thermostat, of the statistics and of the adaptive step.
+     *
+     * @tparam DIM 2 or 3
+     */
+    template <int DIM>
+    void miseAJourVitessesSommees();
+
+    /**
+     * @brief Chooses the time step of the next step from the largest velocity and acceleration, over every MPI rank.
+     *
+     * @param sommes The sums of sommerVitesses on this rank
+     */
+    void choisirPas(const double sommes[7]);
+
+    /**
+     * @brief Completes statistiques from the sums of the force pass and of the velocities, over every MPI rank.
+     *
+     * @param sommes Ec, px, py, pz and the field energy of this rank
+     */
+    void terminerStatistiques(const double sommes[7]);
+
+    /**
+     * @brief Splits the cell array into blocks of equal weight and fills bornesBlocs and poidsBlocs.
+     *
+     * The weight of a cell is its number of particles plus one, so that the empty
+     * cells still count. The store must be sorted by cell.
+     *
+     * @param nbBlocs The number of blocks wanted; fewer are made when the cells are too heavy.
+     * @return The number of blocks made.
+     */
+    int decouperCellules(int nbBlocs);
+
+    /**
+     * @brief Runs f(cDebut, cFin) on blocks of cells weighted by their occupancy; the idle threads steal blocks.
+     *
+     * @param f A callable taking (int cDebut, int cFin).
+     */
+    template <typename F>
+    void pourCellulesPonderees(F &&f) {
+        if (pool) {
+            const int nbBlocs = decouperCellules(PoolThreads::BLOCS_PAR_THREAD * nbThreads);
+            pool->paralleliserPondere(nbBlocs, poidsBlocs.data(), [&](int b) { f(bornesBlocs[b], bornesBlocs[b + 1]); });
+        } else {
+            f(0, static_cast<int>(cellules.size()));
+        }
+    }
+
+    /**
+     * @brief First half of the Verlet step: updates the positions and saves the forces.
+     *
+     * With reflecting boundaries the velocity components that would leave the box are reversed first.
+     *
+     * @tparam DIM 2 or 3, the number of components updated
+     * @tparam BC The boundary condition (see boundaryCond)
+     */
+    template <int DIM, int BC>
+    void miseAJourPositions();
+
+    /**
+     * @brief Second half of the Verlet step: updates the velocities from the old and new forces.
+     *
+     * @tparam DIM 2 or 3, the number of components updated
+     */
+    template <int DIM>
+    void miseAJourVitesses();
+
+    /**
+     * @brief Force kernel on the Verlet neighbor lists (each pair evaluated once).
+     *
+     * @tparam DIM 2 or 3
+     * @tparam BORNER true to cap the pair forces
+     */
+    template <int DIM, bool BORNER>
+    void calculForcesListes();
+
+    /**
+     * @brief Runs steps of the Verlet integration with the dimension and boundary condition fixed at compile time.
+     *
+     * @tparam DIM 2 or 3
+     * @tparam BC The boundary condition (see boundaryCond)
+     * @param nbPas The number of steps, ignored when jusquaTmax is true
+     * @param jusquaTmax true to run until the simulated time reaches tmax
+     */
+    template <int DIM, int BC>
+    void integrer(int nbPas, bool jusquaTmax);
+
+    /**
+     * @brief Calls the instantiation of integrer matching boundaryCond.
+     *
+     * @tparam DIM 2 or 3
+     * @param nbPas The number of steps, ignored when jusquaTmax is true
+     * @param jusquaTmax true to run until the simulated time reaches tmax
+     */
+    template <int DIM>
+    void lancerIntegration(int nbPas, bool jusquaTmax);
+
+    /**
+     * @brief Runs a whole evolution from t = 0 to tmax.
+     *
+     * @tparam DIM 2 or 3
+     */
+    template <int DIM>
+    void evolutionDim();
 
 public:
     /**
@@ -94,13 +601,57 @@ public:
      */
     int getNbParticules() const;
 
+    /**
+     * @brief Gets the number of particles over every MPI rank.
+     *
+     * @return long The number of particles of the whole universe
+     */
+    long getNbParticulesTotal() const;
+
+    /**
+     * @brief Splits the grid over the MPI ranks (see DecompositionDomaine).
+     *
+     * Every rank must have built the same universe; each one then keeps only the
+     * particles of its slab. The runs exchange the ghost particles and the migrants
+     * at each step, so they follow the single-process runs up to the rounding of
+     * the force sums. The particle accessors cover the particles of this rank only.
+     * The VTK files, the trajectory, the performance reports and the checkpoints of
+     * each rank get a suffix _r<rank> before their extension; the checkpoints record
+     * the slab and can only be loaded by the same rank of the same decomposition. The
+     * statistics series, made of global sums, is written by rank 0 only. The trajectory
+     * and the statistics series must be set after the decomposition. The Verlet lists
+     * are not supported.
+     *
+     * @param active true to split the grid, false to keep the whole universe in this process
+     */
+    void setDecomposition(bool active);
+
+    /**
+     * @brief Gets the domain decomposition.
+     *
+     * @return const DecompositionDomaine* The decomposition, null for a single process
+     */
+    const DecompositionDomaine *getDecomposition() const;
+
     /**
      * @brief Gets the list of cells in the universe.
      *
+     * The returned cells are copies holding their own particles.
+     *
      * @return std::vector<Cellule> List of cells
      */
     std::vector<Cellule> getCellules();
 
+    /**
+     * @brief Gets the particle store of the universe.
+     *
+     * The categories are checked again at the next force pass, since they may be changed
+     * through the returned reference.
+     *
+     * @return ParticuleStore& The structure-of-arrays particle storage
+     */
+    ParticuleStore& getStore();
+
     /**
      * @brief Gets the length of the universe in the x direction.
      *
@@ -138,7 +689,7 @@ public:
 
 
     /**
-     * @brief Writes a VTK file.
+     * @brief Writes a VTK file in the format selected with setFormatVTK.
      *
      * @param filename Name of the file
      */
@@ -149,6 +700,436 @@ public:
      */
     void calculForces3D();
 
+    /**
+     * @brief Visits in place the particles of the cells neighboring a cell, the cell itself included.
+     *
+     * In row-major order the neighboring cells of a row along x are consecutive in
+     * the store, so the visitor is called once per row (3 in 2D, 9 in 3D) with the
+     * index range [debut, fin) of their particles; along a space-filling curve, or in a
+     * sparse grid where the missing cells are skipped, it is called once per run of
+     * consecutive cells. Nothing is copied or allocated.
+     *
+     * @tparam DIM 2 to visit the 9 neighbors in the xy plane, 3 to visit the 27 neighbors
+     * @param c Index of the cell
+     * @param visiteur Callable taking (int debut, int fin)
+     */
+    template <int DIM, typename Visiteur>
+    void forEachCelluleVoisine(int c, Visiteur &&visiteur) const {
+        const int *id = cellules[c].getId();
+        const int nbCellules = static_cast<int>(cellules.size());
+        const int zMin = (DIM == 3) ? std::max(id[2] - 1, 0) : id[2];
+        const int zMax = (DIM == 3) ? std::min(id[2] + 1, gridDepth - 1) : id[2];
+        const int xMin = std::max(id[0] - 1, 0);
+        const int xMax = std::min(id[0] + 1, gridWidth - 1);
+        int voisines[27];
+        int nbVoisines = 0;
+        for (int nz = zMin; nz <= zMax; nz++) {
+            for (int ny = std::max(id[1] - 1, 0); ny <= std::min(id[1] + 1, gridHeight - 1); ny++) {
+                if (!rangCellules.empty() || grilleCreuse) {
+                    for (int nx = xMin; nx <= xMax; nx++) {
+                        const int v = grilleCreuse ? voisineCreuse(c, nx - id[0], ny - id[1], nz - id[2]) : indexCellule(nx, ny, nz);
+                        if (v >= 0) {
+                            voisines[nbVoisines++] = v;
+                        }
+                    }
+                    continue;
+                }
+                const int rangee = ny * gridWidth + ((DIM == 3) ? nz * gridWidth * gridHeight : 0);
+                const int derniere = std::min(rangee + xMax, nbCellules - 1);
+                if (rangee + xMin <= derniere) {
+                    visiteur(store.cellStart(rangee + xMin), store.cellEnd(derniere));
+                }
+            }
+        }
+        visiterFusionnees(voisines, nbVoisines, visiteur);
+    }
+
+    /**
+     * @brief Visits in place the forward half of the neighboring cells of a cell.
+     *
+     * Only the neighbors whose offset (dz, dy, dx) is lexicographically positive are
+     * visited (4 in 2D, 13 in 3D), so that every pair of cells is seen exactly once.
+     * The cell itself is not visited. As in forEachCelluleVoisine, the visitor is
+     * called once per row of consecutive cells (2 in 2D, 5 in 3D) in row-major order,
+     * once per run of consecutive cells otherwise.
+     *
+     * @tparam DIM 2 for the xy plane, 3 for the full 3D stencil
+     * @param c Index of the cell
+     * @param visiteur Callable taking (int debut, int fin)
+     */
+    template <int DIM, typename Visiteur>
+    void forEachCelluleVoisineDemi(int c, Visiteur &&visiteur) const {
+        const int *id = cellules[c].getId();
+        const int nbCellules = static_cast<int>(cellules.size());
+        int voisines[13];
+        int nbVoisines = 0;
+        for (int dz = 0; dz <= ((DIM == 3) ? 1 : 0); dz++) {
+            for (int dy = (dz == 0) ? 0 : -1; dy <= 1; dy++) {
+                const int ny = id[1] + dy;
+                const int nz = id[2] + dz;
+                if (ny < 0 || ny >= gridHeight || nz >= gridDepth) {
+                    continue;
+                }
+                const int xMin = std::max(id[0] + ((dz == 0 && dy == 0) ? 1 : -1), 0);
+                const int xMax = std::min(id[0] + 1, gridWidth - 1);
+                if (!rangCellules.empty() || grilleCreuse) {
+                    for (int nx = xMin; nx <= xMax; nx++) {
+                        const int v = grilleCreuse ? voisineCreuse(c, nx - id[0], ny - id[1], nz - id[2]) : indexCellule(nx, ny, nz);
+                        if (v >= 0) {
+                            voisines[nbVoisines++] = v;
+                        }
+                    }
+                    continue;
+                }
+                const int rangee = ny * gridWidth + ((DIM == 3) ? nz * gridWidth * gridHeight : 0);
+                const int derniere = std::min(rangee + xMax, nbCellules - 1);
+                if (rangee + xMin <= derniere) {
+                    visiteur(store.cellStart(rangee + xMin), store.cellEnd(derniere));
+                }
+            }
+        }
+        visiterFusionnees(voisines, nbVoisines, visiteur);
+    }
+
+    /**
+     * @brief Visits a list of cells once per run of consecutive indices, after sorting it.
+     *
+     * Along a space-filling curve the cells of a row are not consecutive, but most
+     * neighbors still come in short runs whose particles form a single index range.
+     *
+     * @param voisines The indices of the cells, sorted in place
+     * @param nbVoisines The number of cells (0 in row-major order)
+     * @param visiteur Callable taking (int debut, int fin)
+     */
+    template <typename Visiteur>
+    void visiterFusionnees(int *voisines, int nbVoisines, Visiteur &visiteur) const {
+        // Insertion sort: at most 27 cells
+        for (int k = 1; k < nbVoisines; k++) {
+            const int voisine = voisines[k];
+            int j = k;
+            for (; j > 0 && voisines[j - 1] > voisine; j--) {
+                voisines[j] = voisines[j - 1];
+            }
+            voisines[j] = voisine;
+        }
+        for (int k = 0; k < nbVoisines;) {
+            int suivante = k + 1;
+            while (suivante < nbVoisines && voisines[suivante] == voisines[suivante - 1] + 1) {
+                suivante++;
+            }
+            visiteur(store.cellStart(voisines[k]), store.cellEnd(voisines[suivante - 1]));
+            k = suivante;
+        }
+    }
+
+    /**
+     * @brief Selects the force engine used by calculForces and calculForces3D.
+     *
+     * @param forceEngine 0 = full shell, 1 = half shell (default)
+     */
+    void setForceEngine(int forceEngine);
+
+    /**
+     * @brief Selects the instruction set of the cell force kernels.
+     *
+     * @param jeu NoyauLJ::AUTOMATIQUE (default), SCALAIRE, SSE2, AVX2 or AVX512
+     */
+    void setJeuInstructions(int jeu);
+
+    /**
+     * @brief Gets the instruction set of the cell force kernels.
+     *
+     * @return int The instruction set in use, never AUTOMATIQUE
+     */
+    int getJeuInstructions() const;
+
+    /**
+     * @brief Replaces the analytic Lennard-Jones kernel with a tabulated potential.
+     *
+     * Every force pass then reads the pair forces in the table (see PotentielTabule),
+     * for instance PotentielTabule({Terme::lennardJones(eps, sigma), Terme::gravitation()},
+     * 0.5, rCut) for the interaction of the analytic kernel. The table is shared by the
+     * copies of the universe and saved in the checkpoints.
+     *
+     * @param potentiel The table, sampled up to at least rCut; null to go back to the analytic kernel
+     */
+    void setPotentielTabule(std::shared_ptr<const PotentielTabule> potentiel);
+
+    /**
+     * @brief Gets the tabulated potential.
+     *
+     * @return const PotentielTabule* The table, null for the analytic kernel
+     */
+    const PotentielTabule *getPotentielTabule() const;
+
+    /**
+     * @brief Replaces the analytic Lennard-Jones kernel with a force field.
+     *
+     * Every force pass then evaluates the law of the field (Lennard-Jones, Morse, soft
+     * sphere or Coulomb) with the parameters of the categories of each pair. The force
+     * engines are instantiated for each law. The categories of the particles must lie in
+     * [0, champ->getNbCategories()). Setting a field removes the tabulated potential and
+     * the other way round. The field is shared by the copies of the universe and saved in
+     * the checkpoints.
+     *
+     * @param champ The force field; null to go back to the analytic kernel
+     */
+    void setChampForces(std::shared_ptr<const ChampForces> champ);
+
+    /**
+     * @brief Gets the force field.
+     *
+     * @return const ChampForces* The force field, null when not set
+     */
+    const ChampForces *getChampForces() const;
+
+    /**
+     * @brief Selects the order of the cells in the cell array, hence of the particles in the store.
+     *
+     * The particles already added are moved to the same cells in the new order; the
+     * store is sorted again before the next force pass.
+     *
+     * @param ordre OrdreCellules::LIGNES (default), MORTON or HILBERT
+     */
+    void setOrdreCellules(int ordre);
+
+    /**
+     * @brief Gets the order of the cells in the cell array.
+     *
+     * @return int OrdreCellules::LIGNES, MORTON or HILBERT
+     */
+    int getOrdreCellules() const;
+
+    /**
+     * @brief Creates only the cells holding a particle and their neighbors, instead of the whole grid.
+     *
+     * The created cells are kept in row-major order and found through a hash map on
+     * their position. A particle entering a cell not created yet makes the grid be
+     * built again from the positions. Requires the row-major order of the cells.
+     *
+     * @param creuse true for the sparse grid, false for the dense one (default)
+     */
+    void setGrilleCreuse(bool creuse);
+
+    /**
+     * @brief Tells whether only the occupied cells and their neighbors are created.
+     *
+     * @return true for the sparse grid
+     */
+    bool getGrilleCreuse() const;
+
+    /**
+     * @brief Gets the number of cells created.
+     *
+     * @return int The number of cells, the whole grid unless the grid is sparse
+     */
+    int getNbCellules() const;
+
+    /**
+     * @brief Selects the format of the VTK files written by writeVTKFile.
+     *
+     * @param format 0 = ASCII, 1 = raw binary appended data (default), 2 = zlib-compressed appended data
+     */
+    void setFormatVTK(int format);
+
+    /**
+     * @brief Gets the format of the VTK files.
+     *
+     * @return int 0 = ASCII, 1 = raw binary, 2 = zlib-compressed binary
+     */
+    int getFormatVTK() const;
+
+    /**
+     * @brief Writes a VTK file every given number of steps during the evolution.
+     *
+     * @param frequence Number of steps between two files, 0 to disable the output (default 1)
+     */
+    void setFrequenceSortie(int frequence);
+
+    /**
+     * @brief Gets the number of steps between two VTK files.
+     *
+     * @return int Number of steps, 0 if the output is disabled
+     */
+    int getFrequenceSortie() const;
+
+    /**
+     * @brief Writes a VTK file every given interval of simulated time during the evolution.
+     *
+     * When set, the interval takes precedence over the step frequency.
+     *
+     * @param intervalle Simulated time between two files, 0 to use the step frequency (default)
+     */
+    void setIntervalleSortie(float intervalle);
+
+    /**
+     * @brief Gets the simulated time between two VTK files.
+     *
+     * @return float The interval, 0 if the step frequency is used
+     */
+    float getIntervalleSortie() const;
+
+    /**
+     * @brief Writes the VTK files on a background thread.
+     *
+     * The particle data is copied into a double buffer at each output step and
+     * written while the next steps are computed.
+     *
+     * @param asynchrone true to write on a background thread, false to write synchronously (default)
+     */
+    void setEcritureAsynchrone(bool asynchrone);
+
+    /**
+     * @brief Tells whether the VTK files are written on a background thread.
+     *
+     * @return true if the output is asynchronous
+     */
+    bool getEcritureAsynchrone() const;
+
+    /**
+     * @brief Sets the start of the VTK file names.
+     *
+     * The files are named <prefixe>_t<N>.vtu, or <prefixe>_t<N>_r<rang>.vtu under MPI.
+     * The prefix may contain a directory, which must exist.
+     *
+     * @param prefixe The prefix, "data" by default
+     */
+    void setPrefixeSortie(const std::string &prefixe);
+
+    /**
+     * @brief Gets the start of the VTK file names.
+     *
+     * @return const std::string& The prefix
+     */
+    const std::string& getPrefixeSortie() const;
+
+    /**
+     * @brief Writes the snapshots to a single append-only trajectory file instead of one VTK file each.
+     *
+     * The output cadence is unchanged. The frames are written through a large
+     * buffer, flushed at the end of each run and before each checkpoint; see
+     * LectureTrajectoire to read them back or convert them to .vtu/.pvd files.
+     * With a domain decomposition each rank writes its particles to fichier with
+     * the suffix _r<rank>.
+     *
+     * @param fichier The trajectory file, empty to go back to the VTK files
+     * @param reprendre false to start a new file; true to keep the frames of the
+     * existing file up to the current step, e.g. after loadCheckpoint
+     */
+    void setTrajectoire(const std::string &fichier, bool reprendre = false);
+
+    /**
+     * @brief Enables or disables the per-phase timers and pair counters of the evolution.
+     *
+     * @param actif true to record the profile
+     */
+    void setProfilage(bool actif);
+
+    /**
+     * @brief Gets the performance profile of the current run.
+     *
+     * @return const ProfilPerformance& The profile
+     */
+    const ProfilPerformance& getProfil() const;
+
+    /**
+     * @brief Writes a performance report at the end of each run and optionally every N steps.
+     *
+     * Enables the profile. A file ending with .json receives a JSON document
+     * (replaced at each report); any other name receives one CSV line per report.
+     * With a domain decomposition each rank reports to fichier with the suffix _r<rank>.
+     *
+     * @param fichier The report file, empty to disable the report
+     * @param frequence Number of steps between two intermediate reports, 0 for the final report only
+     */
+    void setRapportPerformance(const std::string &fichier, int frequence = 0);
+
+    /**
+     * @brief Gets the force engine.
+     *
+     * @return int 0 = full shell, 1 = half shell
+     */
+    int getForceEngine() const;
+
+    /**
+     * @brief Sets the number of threads of the force and integration passes.
+     *
+     * The cell grid is split into slabs along its slowest axis; with the half-shell
+     * engine the slabs are processed in two colors so that no two threads write the
+     * force of the same particle. On the Verlet lists each thread takes a range of
+     * particles of equal numbers of pairs and writes into its own force buffer,
+     * which spans only the particles the lists of its range reach.
+     *
+     * @param nbThreads Number of threads (1 = sequential)
+     */
+    void setNbThreads(int nbThreads);
+
+    /**
+     * @brief Gets the number of threads.
+     *
+     * @return int Number of threads
+     */
+    int getNbThreads() const;
+
+    /**
+     * @brief Asks the system to back the particle arrays with huge pages (Linux only).
+     *
+     * @param pagesEnormes True to advise transparent huge pages (see ParticuleStore::setPagesEnormes)
+     */
+    void setPagesEnormes(bool pagesEnormes);
+
+    /**
+     * @brief Tells whether the particle arrays are advised to use huge pages.
+     *
+     * @return bool True if huge pages are requested
+     */
+    bool getPagesEnormes() const;
+
+    /**
+     * @brief Enables the Verlet neighbor lists.
+     *
+     * @param skin Skin distance added to rCut when building the lists, 0 to disable the lists
+     */
+    void setVerletSkin(float skin);
+
+    /**
+     * @brief Updates the neighborhood in Verlet mode.
+     *
+     * The cells and the lists are rebuilt only when the lists are invalid or when a
+     * particle moved more than verletSkin / 2 since the last build.
+     *
+     * @param is3D True to rebin with reassignCells3D and build 3D lists
+     */
+    void mettreAJourVoisinage(bool is3D);
+
+    /**
+     * @brief Gets the skin distance of the Verlet neighbor lists.
+     *
+     * @return float Skin distance, 0 when the lists are disabled
+     */
+    float getVerletSkin() const;
+
+    /**
+     * @brief Gets the number of Verlet list builds.
+     *
+     * @return int Number of builds
+     */
+    int getNbReconstructionsVerlet() const;
+
+    /**
+     * @brief Gets the number of neighborhood updates done in Verlet mode (one per step).
+     *
+     * @return int Number of updates
+     */
+    int getNbPasVerlet() const;
+
+    /**
+     * @brief Gets the number of particles that changed cell at the last reassignment.
+     *
+     * @return int Number of migrants
+     */
+    int getNbMigrants() const;
+
     /**
      * @brief Initializes a demo in a circle.
      *
@@ -160,6 +1141,19 @@ public:
      */
     void initialiserDemoCercle(int dim1_bleue, int dim2_bleue, float rayon_rouge, const Vector3D& vitesse_bleue, const Vector3D& vitesse_rouge);
 
+    /**
+     * @brief Fills the whole box with particles on a jittered regular lattice.
+     *
+     * The lattice spacing is chosen so that the requested number of particles fits
+     * in the box (in 3D when L3 > 0, in the xy plane otherwise); each position is
+     * shifted by a random amount up to 10% of the spacing. The velocity components
+     * are drawn uniformly in [-vitesseMax, vitesseMax].
+     *
+     * @param nbParticules Number of particles
+     * @param vitesseMax Maximum of each velocity component
+     */
+    void initialiserUniforme(int nbParticules, float vitesseMax);
+
     /**
      * @brief Calculates forces.
      *
@@ -233,6 +1227,70 @@ public:
      */
     void evolution3D();
 
+    /**
+     * @brief Advances the simulation by a number of steps from its current state.
+     *
+     * The VTK files follow the output cadence; the step index and the simulated
+     * time continue from the previous call.
+     *
+     * @param nbPas Number of steps
+     */
+    void avancer(int nbPas);
+
+    /**
+     * @brief Gets the simulated time.
+     *
+     * @return float The simulated time since the start of the last evolution
+     */
+    float getTemps() const;
+
+    /**
+     * @brief Gets the index of the current step.
+     *
+     * @return int The number of steps since the start of the last evolution
+     */
+    int getIteration() const;
+
+    /**
+     * @brief Saves the whole state of the simulation to a binary restart file.
+     *
+     * The file holds the parameters of the universe, the particle store in its
+     * current order (forces and previous forces included), the time and step
+     * counters and the Verlet lists, so that a run resumed with loadCheckpoint
+     * and the same number of threads follows the uninterrupted trajectory bit
+     * for bit. Each array is written in one block; the file is replaced only once
+     * complete. With a domain decomposition each rank writes its particles and
+     * its slab to its own file, fichier with the suffix _r<rank>.
+     *
+     * @param fichier The name of the file
+     */
+    void saveCheckpoint(const std::string &fichier);
+
+    /**
+     * @brief Replaces the state of the simulation with the content of a restart file.
+     *
+     * The output, profiling and threading settings are kept. Arrays saved with
+     * another precision (see UNIVERS_PRECISION) are converted. With a domain
+     * decomposition, set it first: each rank reads its own file, which must have
+     * been saved by the same rank of the same decomposition.
+     *
+     * @param fichier The name of a file written by saveCheckpoint
+     */
+    void loadCheckpoint(const std::string &fichier);
+
+    /**
+     * @brief Saves a restart file every N steps of the runs.
+     *
+     * @param fichier The restart file, replaced at each save; empty to disable the saves
+     * @param frequence Number of steps between two saves
+     */
+    void setCheckpoint(const std::string &fichier, int frequence);
+
+    /**
+     * @brief Continues the evolution from the current state until tmax, typically after loadCheckpoint.
+     */
+    void poursuivreEvolution();
+
     /**
      * @brief Calculates kinetic energy.
      *
@@ -240,6 +1298,97 @@ public:
      */
     double energieCinetique();
 
+    /**
+     * @brief Measures the statistics (see Statistiques) every few steps of the runs.
+     *
+     * A measured step sums the potential energy and the virial in its force pass and
+     * the kinetic energy and the momentum in its velocity update, with parallel
+     * reductions in a fixed order: no extra pass over the particles. The other steps
+     * run unchanged.
+     *
+     * @param frequence The number of steps between two measures, 0 to stop measuring
+     * @param fichier The time series receiving the measures (CSV if the name ends with .csv,
+     * binary otherwise, see SerieStatistiques), written by rank 0 only with a domain
+     * decomposition; empty to keep only the last measure
+     */
+    void setStatistiques(int frequence, const std::string &fichier = "");
+
+    /**
+     * @brief Gets the number of steps between two measures of the statistics.
+     *
+     * @return int The number of steps, 0 when not measured
+     */
+    int getFrequenceStatistiques() const;
+
+    /**
+     * @brief Gets the last measure of the statistics.
+     *
+     * @return const Statistiques& The measure of the last measured step, or of mesurerStatistiques
+     */
+    const Statistiques &getStatistiques() const;
+
+    /**
+     * @brief Measures the statistics of the current state, outside of the runs.
+     *
+     * The forces are computed again with the measure; they are the same as before.
+     * The measure is not added to the time series.
+     *
+     * @return const Statistiques& The measure
+     */
+    const Statistiques &mesurerStatistiques();
+
+    /**
+     * @brief Controls the temperature of the runs with a thermostat.
+     *
+     * The thermostat acts in the velocity update of every step (see Thermostat):
+     * Berendsen and Nosé–Hoover rescale the velocities from the temperature summed by
+     * the previous update, Langevin adds friction and random kicks. The temperature is
+     * 2 Ec / (d N) with k_B = 1. The friction of Nosé–Hoover is saved in the restart files.
+     *
+     * @param type Thermostat::AUCUN (constant energy), BERENDSEN, LANGEVIN or NOSE_HOOVER
+     * @param temperature The target temperature
+     * @param tempsCouplage The coupling time, in simulated time
+     * @param graine The seed of the random kicks of Langevin
+     */
+    void setThermostat(int type, double temperature, double tempsCouplage, uint64_t graine = 0);
+
+    /**
+     * @brief Gets the thermostat.
+     *
+     * @return const Thermostat& The thermostat, of type AUCUN when not set
+     */
+    const Thermostat &getThermostat() const;
+
+    /**
+     * @brief Adapts the time step of each step to the fastest particle.
+     *
+     * Before each step, dt becomes the largest step within [dtMin, dtMax] such that no
+     * particle moves by more than deplacementMax at its velocity (v dt) nor under its
+     * acceleration (a dt² / 2). The largest v² and (F / m)² are found in the velocity
+     * update of the previous step, in the same loop: no extra pass over the particles.
+     * The rare close approaches thus get small steps while the rest of the run keeps
+     * large ones. A run until tmax ends exactly at tmax.
+     *
+     * @param deplacementMax The largest displacement in a step, in units of length; 0 to go back to the fixed step dtMax
+     * @param dtMin The smallest step
+     * @param dtMax The largest step, 0 for the current fixed step
+     */
+    void setPasAdaptatif(float deplacementMax, float dtMin = 0, float dtMax = 0);
+
+    /**
+     * @brief Gets the largest displacement of a particle in an adaptive step.
+     *
+     * @return float The displacement, 0 for the fixed step
+     */
+    float getPasAdaptatif() const;
+
+    /**
+     * @brief Gets the time step of the next step.
+     *
+     * @return float dt, chosen before each step when the step is adaptive
+     */
+    float getDt() const;
+
     /**
      * @brief Reassigns particles to cells in 3D.
      */
@@ -10,22 +10,37 @@
 Cellule::Cellule(int id_1, int id_2, Vector3D centre, std::vector<Particule3D> particules) {
     this->id[0] = id_1;
     this->id[1] = id_2;
+    this->id[2] = 0;
     this->centre = centre;
     this->particules = particules;
     this->nbParticules = static_cast<int>(particules.size());
+    this->debut = 0;
 }
 
 // Constructor
 Cellule::Cellule(int id_1, int id_2, Vector3D centre) {
     this->id[0] = id_1;
     this->id[1] = id_2;
+    this->id[2] = 0;
     this->centre = centre;
     this->particules = std::vector<Particule3D>();
     this->nbParticules = 0;
+    this->debut = 0;
+}
+
+// Constructor for a 3D grid
+Cellule::Cellule(int id_1, int id_2, int id_3, Vector3D centre) {
+    this->id[0] = id_1;
+    this->id[1] = id_2;
+    this->id[2] = id_3;
+    this->centre = centre;
+    this->particules = std::vector<Particule3D>();
+    this->nbParticules = 0;
+    this->debut = 0;
 }
 
 // Default constructor
-Cellule::Cellule() : nbParticules(0), particules(std::vector<Particule3D>()) {}
+Cellule::Cellule() : id{0, 0, 0}, nbParticules(0), debut(0), particules(std::vector<Particule3D>()) {}
 
 // Destructor
 Cellule::~Cellule() {
@@ -36,9 +51,11 @@ Cellule::~Cellule() {
 Cellule::Cellule(const Cellule &other) {
     id[0] = other.id[0];
     id[1] = other.id[1];
+    id[2] = other.id[2];
     centre = other.centre;
     particules = other.particules;
     nbParticules = other.nbParticules;
+    debut = other.debut;
 }
 
 // Copy assignment operator
@@ -48,9 +65,11 @@ Cellule& Cellule::operator=(const Cellule &other) {
     }
     id[0] = other.id[0];
     id[1] = other.id[1];
+    id[2] = other.id[2];
     centre = other.centre;
     particules = other.particules;
     nbParticules = other.nbParticules;
+    debut = other.debut;
     return *this;
 }
 
@@ -59,6 +78,11 @@ int* Cellule::getId() {
     return id;
 }
 
+// Get the cell ID (read-only)
+const int* Cellule::getId() const {
+    return id;
+}
+
 // Get the number of particles
 int Cellule::getNbParticules() const {
     return nbParticules;
@@ -127,6 +151,15 @@ void Cellule::clearParticules() {
         std::cerr << "Error in clearParticules: " << e.what() << std::endl;
         throw; // Re-throw the exception after logging it
     }
+}
+
+// Get the start of the cell range in the particle store
+int Cellule::getDebut() const {
+    return debut;
+}
 
-    std::cout << "All particles cleared.\n";
+// Refer to a range of the particle store
+void Cellule::setPlage(int debut, int nb) {
+    this->debut = debut;
+    this->nbParticules = nb;
 }
@@ -0,0 +1,219 @@
+#include "ChampForces.hxx"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+const int ChampForces::LENNARD_JONES;
+const int ChampForces::MORSE;
+const int ChampForces::SPHERE_MOLLE;
+const int ChampForces::COULOMB;
+const int ChampForces::TAILLE_LIGNE;
+
+namespace {
+
+// Check the parameters of a category or of a pair
+void verifierParametres(int type, double p1, double p2) {
+    if ((type == ChampForces::LENNARD_JONES || type == ChampForces::SPHERE_MOLLE) && (p1 < 0 || p2 <= 0)) {
+        throw std::invalid_argument("Invalid parameters: eps >= 0 and sigma > 0 are required.");
+    }
+    if (type == ChampForces::MORSE && (p1 < 0 || p2 <= 0)) {
+        throw std::invalid_argument("Invalid parameters: D >= 0 and a > 0 are required.");
+    }
+}
+
+} // namespace
+
+// Default constructor
+ChampForces::ChampForces() {}
+
+// Give every category the same parameters
+ChampForces::ChampForces(int type, int nbCategories, double p1, double p2, double p3)
+    : type(type), nbCategories(nbCategories) {
+    if (type < LENNARD_JONES || type > COULOMB) {
+        throw std::invalid_argument("Invalid force field: unknown potential.");
+    }
+    if (nbCategories < 1) {
+        throw std::invalid_argument("Invalid force field: at least 1 category is required.");
+    }
+    verifierParametres(type, p1, p2);
+    parametresCategories.resize(3 * nbCategories);
+    parametresPaires.resize(3 * nbCategories * nbCategories);
+    explicites.assign(nbCategories * nbCategories, 0);
+    table.assign(TAILLE_LIGNE * nbCategories * nbCategories, 0);
+    for (int c = 0; c < nbCategories; c++) {
+        double *p = &parametresCategories[3 * c];
+        p[0] = p1;
+        p[1] = p2;
+        p[2] = p3;
+    }
+    for (int c = 0; c < nbCategories; c++) {
+        melanger(c);
+    }
+}
+
+// Set a category and mix it with the others
+void ChampForces::setCategorie(int categorie, double p1, double p2, double p3) {
+    verifierCategorie(categorie);
+    verifierParametres(type, p1, p2);
+    double *p = &parametresCategories[3 * categorie];
+    p[0] = p1;
+    p[1] = p2;
+    p[2] = p3;
+    melanger(categorie);
+}
+
+// Set a pair, which the mixing rule then leaves alone
+void ChampForces::setPaire(int categorie1, int categorie2, double p1, double p2, double p3) {
+    verifierCategorie(categorie1);
+    verifierCategorie(categorie2);
+    verifierParametres(type, p1, p2);
+    for (int sens = 0; sens < 2; sens++) {
+        const int a = sens ? categorie2 : categorie1;
+        const int b = sens ? categorie1 : categorie2;
+        double *p = &parametresPaires[3 * (a * nbCategories + b)];
+        p[0] = p1;
+        p[1] = p2;
+        p[2] = p3;
+        explicites[a * nbCategories + b] = 1;
+        remplirLigne(a, b);
+    }
+}
+
+// Switch the gravity-like term
+void ChampForces::setGravitation(bool gravitation) {
+    this->gravitation = gravitation;
+}
+
+// Force coefficient of a pair, one instantiation per law
+double ChampForces::getCoefficient(int categorie1, int categorie2, double r2) const {
+    verifierCategorie(categorie1);
+    verifierCategorie(categorie2);
+    const double *p = &table[TAILLE_LIGNE * (categorie1 * nbCategories + categorie2)];
+    switch (type) {
+        case MORSE:
+            return LoiMorse::coefficient(p, r2);
+        case SPHERE_MOLLE:
+            return LoiSphereMolle::coefficient(p, r2);
+        case COULOMB:
+            return LoiCoulomb::coefficient(p, r2);
+        default:
+            return LoiLennardJones::coefficient(p, r2);
+    }
+}
+
+// Energy of a pair
+double ChampForces::getEnergie(int categorie1, int categorie2, double r2) const {
+    verifierCategorie(categorie1);
+    verifierCategorie(categorie2);
+    const double *p = &table[TAILLE_LIGNE * (categorie1 * nbCategories + categorie2)];
+    switch (type) {
+        case MORSE:
+            return LoiMorse::energie(p, r2);
+        case SPHERE_MOLLE:
+            return LoiSphereMolle::energie(p, r2);
+        case COULOMB:
+            return LoiCoulomb::energie(p, r2);
+        default:
+            return LoiLennardJones::energie(p, r2);
+    }
+}
+
+// Write the force field
+void ChampForces::ecrire(EcritureReprise &reprise) const {
+    reprise.ecrire<int32_t>(type);
+    reprise.ecrire<int32_t>(nbCategories);
+    reprise.ecrire<uint8_t>(gravitation ? 1 : 0);
+    reprise.ecrireTableau(parametresCategories);
+    reprise.ecrireTableau(parametresPaires);
+    reprise.ecrireTableau(explicites);
+}
+
+// Read the force field and rebuild its table
+void ChampForces::lire(LectureReprise &reprise) {
+    type = reprise.lire<int32_t>();
+    nbCategories = reprise.lire<int32_t>();
+    gravitation = reprise.lire<uint8_t>() != 0;
+    reprise.lireTableau(parametresCategories);
+    reprise.lireTableau(parametresPaires);
+    reprise.lireTableau(explicites);
+    const size_t n = static_cast<size_t>(std::max(nbCategories, 0));
+    if (type < LENNARD_JONES || type > COULOMB || nbCategories < 1 || parametresCategories.size() != 3 * n ||
+        parametresPaires.size() != 3 * n * n || explicites.size() != n * n) {
+        throw std::runtime_error("Invalid force field in restart file.");
+    }
+    table.assign(TAILLE_LIGNE * n * n, 0);
+    for (int a = 0; a < nbCategories; a++) {
+        for (int b = 0; b < nbCategories; b++) {
+            remplirLigne(a, b);
+        }
+    }
+}
+
+// Check a category
+void ChampForces::verifierCategorie(int categorie) const {
+    if (categorie < 0 || categorie >= nbCategories) {
+        throw std::invalid_argument("Invalid category: must lie in [0, nbCategories).");
+    }
+}
+
+// Mixing rule of the law for the pairs of one category
+void ChampForces::melanger(int categorie) {
+    const double *pc = &parametresCategories[3 * categorie];
+    for (int autre = 0; autre < nbCategories; autre++) {
+        const double *po = &parametresCategories[3 * autre];
+        double melange[3];
+        switch (type) {
+            case MORSE:
+                melange[0] = std::sqrt(pc[0] * po[0]);
+                melange[1] = (pc[1] + po[1]) / 2;
+                melange[2] = (pc[2] + po[2]) / 2;
+                break;
+            case COULOMB:
+                melange[0] = pc[0] * po[0];
+                melange[1] = 0;
+                melange[2] = 0;
+                break;
+            default:
+                // Lorentz-Berthelot
+                melange[0] = std::sqrt(pc[0] * po[0]);
+                melange[1] = (pc[1] + po[1]) / 2;
+                melange[2] = 0;
+                break;
+        }
+        for (int sens = 0; sens < 2; sens++) {
+            const int a = sens ? autre : categorie;
+            const int b = sens ? categorie : autre;
+            if (explicites[a * nbCategories + b]) {
+                continue;
+            }
+            double *p = &parametresPaires[3 * (a * nbCategories + b)];
+            p[0] = melange[0];
+            p[1] = melange[1];
+            p[2] = melange[2];
+            remplirLigne(a, b);
+        }
+    }
+}
+
+// Row of the table read by the law
+void ChampForces::remplirLigne(int a, int b) {
+    const double *p = &parametresPaires[3 * (a * nbCategories + b)];
+    double *ligne = &table[TAILLE_LIGNE * (a * nbCategories + b)];
+    switch (type) {
+        case LENNARD_JONES:
+            ligne[0] = p[1] * p[1];
+            ligne[1] = 24 * p[0];
+            ligne[2] = 4 * p[0];
+            break;
+        case SPHERE_MOLLE:
+            ligne[0] = p[1] * p[1];
+            ligne[1] = 12 * p[0];
+            ligne[2] = p[0];
+            break;
+        default:
+            ligne[0] = p[0];
+            ligne[1] = p[1];
+            ligne[2] = p[2];
+            break;
+    }
+}
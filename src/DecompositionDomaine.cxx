@@ -0,0 +1,199 @@
+#include "DecompositionDomaine.hxx"
+#include <stdexcept>
+#include <string>
+
+#ifdef UNIVERS_AVEC_MPI
+#include <mpi.h>
+
+namespace {
+
+// MPI type of one exchanged particle, so that the counts are numbers of particles
+MPI_Datatype typeParticule() {
+    static MPI_Datatype type = [] {
+        MPI_Datatype t;
+        MPI_Type_contiguous(sizeof(DecompositionDomaine::ParticuleEchangee), MPI_BYTE, &t);
+        MPI_Type_commit(&t);
+        return t;
+    }();
+    return type;
+}
+
+}
+#endif
+
+// Get the rank and the number of ranks
+DecompositionDomaine::DecompositionDomaine() {
+#ifdef UNIVERS_AVEC_MPI
+    int initialise = 0;
+    MPI_Initialized(&initialise);
+    if (!initialise) {
+        throw std::runtime_error("MPI must be initialized before the domain decomposition.");
+    }
+    MPI_Comm_rank(MPI_COMM_WORLD, &rang);
+    MPI_Comm_size(MPI_COMM_WORLD, &nbRangs);
+#endif
+}
+
+// Tell whether the library was built with MPI
+bool DecompositionDomaine::mpiDisponible() {
+#ifdef UNIVERS_AVEC_MPI
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Initialize MPI once
+void DecompositionDomaine::initialiserMPI(int *argc, char ***argv) {
+#ifdef UNIVERS_AVEC_MPI
+    int initialise = 0;
+    MPI_Initialized(&initialise);
+    if (!initialise) {
+        MPI_Init(argc, argv);
+    }
+#else
+    (void)argc;
+    (void)argv;
+#endif
+}
+
+// Finalize MPI once
+void DecompositionDomaine::finaliserMPI() {
+#ifdef UNIVERS_AVEC_MPI
+    int initialise = 0, finalise = 0;
+    MPI_Initialized(&initialise);
+    MPI_Finalized(&finalise);
+    if (initialise && !finalise) {
+        MPI_Finalize();
+    }
+#endif
+}
+
+// Give each rank the same number of layers, up to one
+void DecompositionDomaine::decouper(int nbCouches) {
+    if (nbCouches < nbRangs) {
+        throw std::invalid_argument("Invalid decomposition: " + std::to_string(nbCouches) + " layers of cells for " +
+                                    std::to_string(nbRangs) + " ranks.");
+    }
+    this->nbCouches = nbCouches;
+    debut = static_cast<int>(static_cast<long>(nbCouches) * rang / nbRangs);
+    fin = static_cast<int>(static_cast<long>(nbCouches) * (rang + 1) / nbRangs);
+}
+
+// Invert the split of decouper: the last slab whose first layer is not past the layer
+int DecompositionDomaine::getProprietaire(int couche) const {
+    int proprietaire = static_cast<int>(static_cast<long>(couche) * nbRangs / nbCouches);
+    while (proprietaire < nbRangs - 1 && static_cast<long>(nbCouches) * (proprietaire + 1) / nbRangs <= couche) {
+        proprietaire++;
+    }
+    return proprietaire;
+}
+
+// Pack a particle of the store
+DecompositionDomaine::ParticuleEchangee DecompositionDomaine::extraire(const ParticuleStore &store, int i) {
+    return {store.x[i],     store.y[i],     store.z[i],     store.vx[i],    store.vy[i],    store.vz[i],       store.fx[i],
+            store.fy[i],    store.fz[i],    store.fxOld[i], store.fyOld[i], store.fzOld[i], store.masse[i], store.categorie[i],
+            store.id[i]};
+}
+
+// Append a received particle to every array of the store
+void DecompositionDomaine::ajouter(ParticuleStore &store, const ParticuleEchangee &p, int cellule) {
+    store.x.push_back(p.x);
+    store.y.push_back(p.y);
+    store.z.push_back(p.z);
+    store.vx.push_back(p.vx);
+    store.vy.push_back(p.vy);
+    store.vz.push_back(p.vz);
+    store.fx.push_back(p.fx);
+    store.fy.push_back(p.fy);
+    store.fz.push_back(p.fz);
+    store.fxOld.push_back(p.fxOld);
+    store.fyOld.push_back(p.fyOld);
+    store.fzOld.push_back(p.fzOld);
+    store.masse.push_back(p.masse);
+    store.categorie.push_back(p.categorie);
+    store.id.push_back(p.id);
+    store.cellule.push_back(cellule);
+}
+
+// Exchange the counts, then the particles in one collective
+void DecompositionDomaine::echanger(const std::vector<std::vector<ParticuleEchangee>> &envois, std::vector<ParticuleEchangee> &recus) const {
+#ifdef UNIVERS_AVEC_MPI
+    std::vector<int> nbEnvois(nbRangs), nbRecus(nbRangs), decalagesEnvois(nbRangs + 1, 0), decalagesRecus(nbRangs + 1, 0);
+    for (int r = 0; r < nbRangs; r++) {
+        nbEnvois[r] = static_cast<int>(envois[r].size());
+    }
+    MPI_Alltoall(nbEnvois.data(), 1, MPI_INT, nbRecus.data(), 1, MPI_INT, MPI_COMM_WORLD);
+    for (int r = 0; r < nbRangs; r++) {
+        decalagesEnvois[r + 1] = decalagesEnvois[r] + nbEnvois[r];
+        decalagesRecus[r + 1] = decalagesRecus[r] + nbRecus[r];
+    }
+    std::vector<ParticuleEchangee> tampon;
+    tampon.reserve(decalagesEnvois[nbRangs]);
+    for (const auto &liste : envois) {
+        tampon.insert(tampon.end(), liste.begin(), liste.end());
+    }
+    recus.resize(decalagesRecus[nbRangs]);
+    MPI_Alltoallv(tampon.data(), nbEnvois.data(), decalagesEnvois.data(), typeParticule(), recus.data(), nbRecus.data(),
+                  decalagesRecus.data(), typeParticule(), MPI_COMM_WORLD);
+#else
+    recus = envois[0];
+#endif
+}
+
+// Exchange with the previous slab, then with the next one
+void DecompositionDomaine::echangerVoisins(const std::vector<ParticuleEchangee> &versPrecedent,
+                                           const std::vector<ParticuleEchangee> &versSuivant, std::vector<ParticuleEchangee> &recus) const {
+    recus.clear();
+#ifdef UNIVERS_AVEC_MPI
+    const int precedent = (rang > 0) ? rang - 1 : MPI_PROC_NULL;
+    const int suivant = (rang < nbRangs - 1) ? rang + 1 : MPI_PROC_NULL;
+    const int voisins[2][2] = {{suivant, precedent}, {precedent, suivant}};  // {destination, source} of each direction
+    const std::vector<ParticuleEchangee> *listes[2] = {&versSuivant, &versPrecedent};
+    for (int sens = 0; sens < 2; sens++) {
+        int nbEnvoi = static_cast<int>(listes[sens]->size()), nbRecu = 0;
+        MPI_Sendrecv(&nbEnvoi, 1, MPI_INT, voisins[sens][0], 0, &nbRecu, 1, MPI_INT, voisins[sens][1], 0, MPI_COMM_WORLD,
+                     MPI_STATUS_IGNORE);
+        const size_t decalage = recus.size();
+        recus.resize(decalage + nbRecu);
+        MPI_Sendrecv(listes[sens]->data(), nbEnvoi, typeParticule(), voisins[sens][0], 1, recus.data() + decalage, nbRecu,
+                     typeParticule(), voisins[sens][1], 1, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    }
+#else
+    (void)versPrecedent;
+    (void)versSuivant;
+#endif
+}
+
+// Sum over every rank
+double DecompositionDomaine::sommer(double valeur) const {
+#ifdef UNIVERS_AVEC_MPI
+    double somme = 0;
+    MPI_Allreduce(&valeur, &somme, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    return somme;
+#else
+    return valeur;
+#endif
+}
+
+// Sum over every rank
+long DecompositionDomaine::sommer(long valeur) const {
+#ifdef UNIVERS_AVEC_MPI
+    long somme = 0;
+    MPI_Allreduce(&valeur, &somme, 1, MPI_LONG, MPI_SUM, MPI_COMM_WORLD);
+    return somme;
+#else
+    return valeur;
+#endif
+}
+
+// Maximum over every rank
+double DecompositionDomaine::maximum(double valeur) const {
+#ifdef UNIVERS_AVEC_MPI
+    double maximum = 0;
+    MPI_Allreduce(&valeur, &maximum, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    return maximum;
+#else
+    return valeur;
+#endif
+}
@@ -0,0 +1,84 @@
+#include "EcritureAsynchrone.hxx"
+
+// Start the writer thread
+EcritureAsynchrone::EcritureAsynchrone(int format) {
+    tampons[0].setFormat(format);
+    tampons[1].setFormat(format);
+    ecrivain = std::thread(&EcritureAsynchrone::boucle, this);
+}
+
+// Write the pending snapshots and stop the writer thread
+EcritureAsynchrone::~EcritureAsynchrone() {
+    {
+        std::lock_guard<std::mutex> verrou(mutex);
+        arret = true;
+    }
+    changement.notify_all();
+    ecrivain.join();
+}
+
+// Write the queued buffers until asked to stop
+void EcritureAsynchrone::boucle() {
+    std::unique_lock<std::mutex> verrou(mutex);
+    while (true) {
+        changement.wait(verrou, [&] { return arret || enAttente != -1; });
+        if (enAttente == -1) {
+            return;
+        }
+        enCours = enAttente;
+        enAttente = -1;
+        verrou.unlock();
+        changement.notify_all();
+
+        std::exception_ptr e;
+        try {
+            tampons[enCours].ecrire(noms[enCours]);
+        } catch (...) {
+            e = std::current_exception();
+        }
+
+        verrou.lock();
+        if (e && !erreur) {
+            erreur = e;
+        }
+        enCours = -1;
+        changement.notify_all();
+    }
+}
+
+// Rethrow the error of the writer thread
+void EcritureAsynchrone::verifierErreur() {
+    if (erreur) {
+        std::exception_ptr e = erreur;
+        erreur = nullptr;
+        std::rethrow_exception(e);
+    }
+}
+
+// Copy the particle data into a free buffer and queue it
+void EcritureAsynchrone::soumettre(const ParticuleStore &store, const std::string &filename) {
+    int libre;
+    {
+        std::unique_lock<std::mutex> verrou(mutex);
+        changement.wait(verrou, [&] { return enAttente == -1; });
+        verifierErreur();
+        libre = (enCours == 0) ? 1 : 0;
+    }
+
+    // The writer thread never touches a buffer that is neither queued nor being written
+    tampons[libre].preparer(store);
+    noms[libre] = filename;
+
+    {
+        std::lock_guard<std::mutex> verrou(mutex);
+        enAttente = libre;
+    }
+    changement.notify_all();
+}
+
+// Wait until every snapshot is written
+void EcritureAsynchrone::attendre() {
+    std::unique_lock<std::mutex> verrou(mutex);
+    changement.wait(verrou, [&] { return enAttente == -1 && enCours == -1; });
+    verifierErreur();
+}
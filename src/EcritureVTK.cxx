@@ -0,0 +1,216 @@
+#include "EcritureVTK.hxx"
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef UNIVERS_AVEC_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+
+// Size of the uncompressed blocks of the zlib format
+const uint64_t TAILLE_BLOC = 1 << 16;
+
+// Byte order of the machine, used for the binary formats
+const char *ordreOctets() {
+    const uint16_t test = 1;
+    return (*reinterpret_cast<const unsigned char*>(&test) == 1) ? "LittleEndian" : "BigEndian";
+}
+
+// Writes an array as ASCII values
+void ecrireAscii(std::ostream &file, const std::vector<float> &data) {
+    for (float v : data) {
+        file << v << ' ';
+    }
+    file << '\n';
+}
+
+}
+
+// Create a writer
+EcritureVTK::EcritureVTK(int format) {
+    setFormat(format);
+}
+
+// Select the output format
+void EcritureVTK::setFormat(int format) {
+    if (format < 0 || format > 2) {
+        throw std::invalid_argument("Invalid VTK format: must be 0 (ASCII), 1 (binary) or 2 (compressed).");
+    }
+    if (format == 2 && !zlibDisponible()) {
+        throw std::invalid_argument("Invalid VTK format: compressed output needs zlib.");
+    }
+    this->format = format;
+}
+
+// Get the output format
+int EcritureVTK::getFormat() const {
+    return format;
+}
+
+// Tell whether zlib is available
+bool EcritureVTK::zlibDisponible() {
+#ifdef UNIVERS_AVEC_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Copy the particle data to the Float32 buffers
+void EcritureVTK::preparer(const ParticuleStore &store) {
+    nbPoints = store.getNbParticules();
+    positions.resize(3 * nbPoints);
+    vitesses.resize(3 * nbPoints);
+    categories.resize(nbPoints);
+    for (int i = 0; i < nbPoints; i++) {
+        positions[3 * i] = static_cast<float>(store.x[i]);
+        positions[3 * i + 1] = static_cast<float>(store.y[i]);
+        positions[3 * i + 2] = static_cast<float>(store.z[i]);
+        vitesses[3 * i] = static_cast<float>(store.vx[i]);
+        vitesses[3 * i + 1] = static_cast<float>(store.vy[i]);
+        vitesses[3 * i + 2] = static_cast<float>(store.vz[i]);
+        categories[i] = static_cast<float>(store.categorie[i]);
+    }
+}
+
+// Copy Float32 particle data to the buffers
+void EcritureVTK::preparer(const float *positions, const float *vitesses, const float *categories, int n) {
+    nbPoints = n;
+    this->positions.assign(positions, positions + 3 * n);
+    this->vitesses.assign(vitesses, vitesses + 3 * n);
+    this->categories.assign(categories, categories + n);
+}
+
+// Write the XML header and the data arrays, inline in ASCII or as references to the appended data
+void EcritureVTK::ecrireEntete(std::ostream &file) const {
+    file << "<?xml version=\"1.0\"?>\n";
+    file << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"" << ordreOctets() << "\" header_type=\"UInt64\"";
+    if (format == 2) {
+        file << " compressor=\"vtkZLibDataCompressor\"";
+    }
+    file << ">\n";
+    file << "  <UnstructuredGrid>\n";
+    file << "    <Piece NumberOfPoints=\"" << nbPoints << "\" NumberOfCells=\"0\">\n";
+
+    // Opening tag of a data array, with its offset in the appended data for the binary formats
+    auto ouvrir = [&](const char *attributs, int k) {
+        file << "        <DataArray " << attributs;
+        if (format == 0) {
+            file << " format=\"ascii\">\n";
+        } else {
+            file << " format=\"appended\" offset=\"" << decalages[k] << "\"/>\n";
+        }
+    };
+
+    file << "      <Points>\n";
+    ouvrir("type=\"Float32\" Name=\"Position\" NumberOfComponents=\"3\"", 0);
+    if (format == 0) {
+        ecrireAscii(file, positions);
+        file << "        </DataArray>\n";
+    }
+    file << "      </Points>\n";
+    file << "      <PointData Vectors=\"vector\">\n";
+    ouvrir("type=\"Float32\" Name=\"Velocity\" NumberOfComponents=\"3\"", 1);
+    if (format == 0) {
+        ecrireAscii(file, vitesses);
+        file << "        </DataArray>\n";
+    }
+    ouvrir("type=\"Float32\" Name=\"Category\"", 2);
+    if (format == 0) {
+        ecrireAscii(file, categories);
+        file << "        </DataArray>\n";
+    }
+    file << "      </PointData>\n";
+    file << "      <Cells>\n";
+    file << "        <DataArray type=\"Int32\" Name=\"connectivity\" format=\"ascii\">\n";
+    file << "        </DataArray>\n";
+    file << "        <DataArray type=\"Int32\" Name=\"offsets\" format=\"ascii\">\n";
+    file << "        </DataArray>\n";
+    file << "        <DataArray type=\"UInt8\" Name=\"types\" format=\"ascii\">\n";
+    file << "        </DataArray>\n";
+    file << "      </Cells>\n";
+    file << "    </Piece>\n";
+    file << "  </UnstructuredGrid>\n";
+}
+
+// Compress an array into the zlib block format of VTK
+void EcritureVTK::compresser(const float *data, size_t n) {
+#ifdef UNIVERS_AVEC_ZLIB
+    const uint64_t taille = n * sizeof(float);
+    const uint64_t nbBlocs = (taille + TAILLE_BLOC - 1) / TAILLE_BLOC;
+    const uint64_t dernierBloc = (nbBlocs == 0) ? 0 : taille - (nbBlocs - 1) * TAILLE_BLOC;
+
+    // Header: number of blocks, block size, size of the last block, compressed size of each block
+    const size_t debutEntete = compresse.size();
+    const size_t tailleEntete = (3 + nbBlocs) * sizeof(uint64_t);
+    compresse.resize(debutEntete + tailleEntete);
+    uint64_t entete[3] = {nbBlocs, TAILLE_BLOC, dernierBloc};
+    std::copy(reinterpret_cast<unsigned char*>(entete), reinterpret_cast<unsigned char*>(entete) + sizeof(entete), compresse.begin() + debutEntete);
+
+    const auto *octets = reinterpret_cast<const Bytef*>(data);
+    for (uint64_t b = 0; b < nbBlocs; b++) {
+        const uLong tailleBloc = (b + 1 == nbBlocs) ? dernierBloc : TAILLE_BLOC;
+        uLongf tailleCompresse = compressBound(tailleBloc);
+        const size_t debutBloc = compresse.size();
+        compresse.resize(debutBloc + tailleCompresse);
+        if (compress2(compresse.data() + debutBloc, &tailleCompresse, octets + b * TAILLE_BLOC, tailleBloc, Z_BEST_SPEED) != Z_OK) {
+            throw std::runtime_error("Compression of the VTK data failed.");
+        }
+        compresse.resize(debutBloc + tailleCompresse);
+        const uint64_t t = tailleCompresse;
+        std::copy(reinterpret_cast<const unsigned char*>(&t), reinterpret_cast<const unsigned char*>(&t) + sizeof(t),
+                  compresse.begin() + debutEntete + (3 + b) * sizeof(uint64_t));
+    }
+#else
+    (void)data;
+    (void)n;
+    throw std::runtime_error("Compressed VTK output needs zlib.");
+#endif
+}
+
+// Write the buffers to a .vtu file
+void EcritureVTK::ecrire(const std::string &filename) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open file " + filename + " for writing.");
+    }
+
+    const std::vector<float> *tableaux[3] = {&positions, &vitesses, &categories};
+    decalages.assign(3, 0);
+    if (format == 1) {
+        // Each array is preceded by its size in bytes
+        uint64_t decalage = 0;
+        for (int k = 0; k < 3; k++) {
+            decalages[k] = decalage;
+            decalage += sizeof(uint64_t) + tableaux[k]->size() * sizeof(float);
+        }
+    } else if (format == 2) {
+        compresse.clear();
+        for (int k = 0; k < 3; k++) {
+            decalages[k] = compresse.size();
+            compresser(tableaux[k]->data(), tableaux[k]->size());
+        }
+    }
+
+    ecrireEntete(file);
+    if (format != 0) {
+        file << "  <AppendedData encoding=\"raw\">\n   _";
+        if (format == 1) {
+            for (const auto *tableau : tableaux) {
+                const uint64_t taille = tableau->size() * sizeof(float);
+                file.write(reinterpret_cast<const char*>(&taille), sizeof(taille));
+                file.write(reinterpret_cast<const char*>(tableau->data()), static_cast<std::streamsize>(taille));
+            }
+        } else {
+            file.write(reinterpret_cast<const char*>(compresse.data()), static_cast<std::streamsize>(compresse.size()));
+        }
+        file << "\n  </AppendedData>\n";
+    }
+    file << "</VTKFile>\n";
+
+    if (!file) {
+        throw std::runtime_error("Error while writing file " + filename + ".");
+    }
+}
@@ -0,0 +1,131 @@
+#include "ListeVoisins.hxx"
+#include <algorithm>
+#include <cmath>
+
+// Default constructor
+ListeVoisins::ListeVoisins() : debut(1, 0) {}
+
+// Build the half neighbor lists with a linked-cell binning of size rayon
+void ListeVoisins::construire(const ParticuleStore& store, double rayon, double L1, double L2, double L3) {
+    const int n = store.getNbParticules();
+    const int nx = std::max(1, static_cast<int>(L1 / rayon));
+    const int ny = std::max(1, static_cast<int>(L2 / rayon));
+    const int nz = (L3 > 0) ? std::max(1, static_cast<int>(L3 / rayon)) : 1;
+    const double taille_x = (L1 > 0) ? L1 / nx : 1.0;
+    const double taille_y = (L2 > 0) ? L2 / ny : 1.0;
+    const double taille_z = (L3 > 0) ? L3 / nz : 1.0;
+
+    auto binX = [&](double v) { return std::min(std::max(static_cast<int>(v / taille_x), 0), nx - 1); };
+    auto binY = [&](double v) { return std::min(std::max(static_cast<int>(v / taille_y), 0), ny - 1); };
+    auto binZ = [&](double v) { return std::min(std::max(static_cast<int>(v / taille_z), 0), nz - 1); };
+
+    // Bin the particles (head / next linked lists)
+    teteBin.assign(nx * ny * nz, -1);
+    suivant.resize(n);
+    for (int i = n - 1; i >= 0; i--) {
+        int b = binX(store.x[i]) + binY(store.y[i]) * nx + binZ(store.z[i]) * nx * ny;
+        suivant[i] = teteBin[b];
+        teteBin[b] = i;
+    }
+
+    // Collect the pairs (i, j > i) closer than rayon
+    const double rayon2 = rayon * rayon;
+    debut.resize(n + 1);
+    voisins.clear();
+    for (int i = 0; i < n; i++) {
+        debut[i] = static_cast<int>(voisins.size());
+        const int bx = binX(store.x[i]);
+        const int by = binY(store.y[i]);
+        const int bz = binZ(store.z[i]);
+        for (int cz = std::max(bz - 1, 0); cz <= std::min(bz + 1, nz - 1); cz++) {
+            for (int cy = std::max(by - 1, 0); cy <= std::min(by + 1, ny - 1); cy++) {
+                for (int cx = std::max(bx - 1, 0); cx <= std::min(bx + 1, nx - 1); cx++) {
+                    for (int j = teteBin[cx + cy * nx + cz * nx * ny]; j != -1; j = suivant[j]) {
+                        if (j <= i) continue;
+                        double rx = store.x[j] - store.x[i];
+                        double ry = store.y[j] - store.y[i];
+                        double rz = store.z[j] - store.z[i];
+                        if (rx * rx + ry * ry + rz * rz < rayon2) {
+                            voisins.push_back(j);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    debut[n] = static_cast<int>(voisins.size());
+    calculerPortee();
+
+    // Keep the reference positions for the displacement check
+    xRef.assign(store.x.begin(), store.x.end());
+    yRef.assign(store.y.begin(), store.y.end());
+    zRef.assign(store.z.begin(), store.z.end());
+    nbReconstructions++;
+}
+
+// Running maximum of the neighbors, the particle itself included
+void ListeVoisins::calculerPortee() {
+    const int n = std::max(static_cast<int>(debut.size()) - 1, 0);
+    portee.resize(n);
+    int maximum = 0;
+    for (int i = 0; i < n; i++) {
+        maximum = std::max(maximum, i + 1);
+        for (int k = debut[i]; k < debut[i + 1]; k++) {
+            maximum = std::max(maximum, voisins[k] + 1);
+        }
+        portee[i] = maximum;
+    }
+}
+
+// Check whether a particle moved more than skin / 2
+bool ListeVoisins::deplacementExcessif(const ParticuleStore& store, double skin) const {
+    const int n = store.getNbParticules();
+    if (n != static_cast<int>(xRef.size())) {
+        return true;
+    }
+    const double limite2 = 0.25 * skin * skin;
+    double max2 = 0;
+    for (int i = 0; i < n; i++) {
+        double dx = store.x[i] - xRef[i];
+        double dy = store.y[i] - yRef[i];
+        double dz = store.z[i] - zRef[i];
+        max2 = std::max(max2, dx * dx + dy * dy + dz * dz);
+    }
+    return max2 > limite2;
+}
+
+// Get the neighbor lists
+const std::vector<int>& ListeVoisins::getVoisins() const {
+    return voisins;
+}
+
+// Get the number of pairs
+int ListeVoisins::getNbPaires() const {
+    return static_cast<int>(voisins.size());
+}
+
+// Get the number of builds
+int ListeVoisins::getNbReconstructions() const {
+    return nbReconstructions;
+}
+
+// Write the state of the lists
+void ListeVoisins::ecrire(EcritureReprise &reprise) const {
+    reprise.ecrireTableau(debut);
+    reprise.ecrireTableau(voisins);
+    reprise.ecrireTableau(xRef);
+    reprise.ecrireTableau(yRef);
+    reprise.ecrireTableau(zRef);
+    reprise.ecrire<int32_t>(nbReconstructions);
+}
+
+// Read the state of the lists
+void ListeVoisins::lire(LectureReprise &reprise) {
+    reprise.lireTableau(debut);
+    reprise.lireTableau(voisins);
+    reprise.lireTableau(xRef);
+    reprise.lireTableau(yRef);
+    reprise.lireTableau(zRef);
+    nbReconstructions = reprise.lire<int32_t>();
+    calculerPortee();
+}
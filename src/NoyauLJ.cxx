@@ -0,0 +1,636 @@
+#include "NoyauLJ.hxx"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define NOYAULJ_X86
+// GCC 12 warns about the undefined vectors used internally by its AVX-512 intrinsics
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const double BORNE = 1e5;
+
+/**
+ * @brief Scalar evaluation of one pair, with the same operations as the vector lanes.
+ *
+ * @return true if the pair is within the cutoff radius
+ */
+template <bool TROIS_D, bool BORNER>
+inline bool evaluerPaire(const NoyauLJ::Parametres &p, double rx, double ry, double rz, double masse_i, double masse_j,
+                         double &fix, double &fiy, double &fiz, double &fjx, double &fjy, double &fjz) {
+    if (!TROIS_D) {
+        rz = 0.0;
+    }
+    double r2 = rx * rx + ry * ry + rz * rz;
+    if (r2 == 0.0 || r2 >= p.rCut2) {
+        return false;
+    }
+    double inv_r2 = 1.0 / r2;
+    double s2 = p.sigma2 * inv_r2;
+    double powTo6 = s2 * s2 * s2;
+    double inv_r3 = inv_r2 * std::sqrt(inv_r2);
+    double lj = p.eps24 * inv_r2 * powTo6 * (1 - 2 * powTo6);
+    double coef_i = lj + masse_i * inv_r3;
+    double coef_j = lj + masse_j * inv_r3;
+    fix = rx * coef_i;
+    fiy = ry * coef_i;
+    fiz = rz * coef_i;
+    fjx = rx * coef_j;
+    fjy = ry * coef_j;
+    fjz = rz * coef_j;
+    if (BORNER) {
+        fix = std::min(std::max(fix, -BORNE), BORNE);
+        fiy = std::min(std::max(fiy, -BORNE), BORNE);
+        fiz = std::min(std::max(fiz, -BORNE), BORNE);
+        fjx = std::min(std::max(fjx, -BORNE), BORNE);
+        fjy = std::min(std::max(fjy, -BORNE), BORNE);
+        fjz = std::min(std::max(fjz, -BORNE), BORNE);
+    }
+    return true;
+}
+
+// Full-shell pairs of [debut, fin) with the scalar loop
+template <bool TROIS_D, bool BORNER>
+int coquilleScalaire(const NoyauLJ::Parametres &p, const ReelPosition *x, const ReelPosition *y, const ReelPosition *z, int i,
+                     double masse_i, int debut, int fin, double &fxi, double &fyi, double &fzi) {
+    int actives = 0;
+    double fix, fiy, fiz, fjx, fjy, fjz;
+    for (int j = debut; j < fin; j++) {
+        const double rz = TROIS_D ? double(z[j]) - z[i] : 0.0;
+        if (evaluerPaire<TROIS_D, BORNER>(p, double(x[j]) - x[i], double(y[j]) - y[i], rz, masse_i, 0.0, fix, fiy, fiz, fjx, fjy, fjz)) {
+            actives++;
+            fxi += fix;
+            fyi += fiy;
+            fzi += fiz;
+        }
+    }
+    return actives;
+}
+
+// Half-shell pairs of [debut, fin) with the scalar loop
+template <bool TROIS_D, bool BORNER>
+int demiScalaire(const NoyauLJ::Parametres &p, const ReelPosition *x, const ReelPosition *y, const ReelPosition *z,
+                 const float *masse, ReelForce *fx, ReelForce *fy, ReelForce *fz, int i, int debut, int fin, double &fxi,
+                 double &fyi, double &fzi) {
+    int actives = 0;
+    double fix, fiy, fiz, fjx, fjy, fjz;
+    for (int j = debut; j < fin; j++) {
+        const double rz = TROIS_D ? double(z[j]) - z[i] : 0.0;
+        if (evaluerPaire<TROIS_D, BORNER>(p, double(x[j]) - x[i], double(y[j]) - y[i], rz, masse[i], masse[j],
+                                          fix, fiy, fiz, fjx, fjy, fjz)) {
+            actives++;
+            fxi += fix;
+            fyi += fiy;
+            fx[j] -= fjx;
+            fy[j] -= fjy;
+            if (TROIS_D) {
+                fzi += fiz;
+                fz[j] -= fjz;
+            }
+        }
+    }
+    return actives;
+}
+
+#ifdef NOYAULJ_X86
+
+/*
+ * SSE2: 2 pairs per instruction, the odd last neighbor goes through the scalar loop.
+ */
+
+// Keeps the lanes of a where the mask is set, b elsewhere
+__attribute__((target("sse2"))) inline __m128d choisirSSE2(__m128d masque, __m128d a, __m128d b) {
+    return _mm_or_pd(_mm_and_pd(masque, a), _mm_andnot_pd(masque, b));
+}
+
+// Lennard-Jones and gravitational coefficients of 2 pairs, zero outside the mask
+template <bool TROIS_D>
+__attribute__((target("sse2"))) inline int coefficientsSSE2(const NoyauLJ::Parametres &p, __m128d rx, __m128d ry, __m128d rz,
+                                                            __m128d masse_i, __m128d masse_j, __m128d &coef_i, __m128d &coef_j) {
+    const __m128d un = _mm_set1_pd(1.0);
+    __m128d r2 = _mm_add_pd(_mm_mul_pd(rx, rx), _mm_mul_pd(ry, ry));
+    if (TROIS_D) {
+        r2 = _mm_add_pd(r2, _mm_mul_pd(rz, rz));
+    }
+    const __m128d masque = _mm_and_pd(_mm_cmpneq_pd(r2, _mm_setzero_pd()), _mm_cmplt_pd(r2, _mm_set1_pd(p.rCut2)));
+    const int bits = _mm_movemask_pd(masque);
+    if (bits == 0) {
+        return 0;
+    }
+    const __m128d inv_r2 = _mm_div_pd(un, choisirSSE2(masque, r2, un));
+    const __m128d s2 = _mm_mul_pd(_mm_set1_pd(p.sigma2), inv_r2);
+    const __m128d powTo6 = _mm_mul_pd(_mm_mul_pd(s2, s2), s2);
+    const __m128d inv_r3 = _mm_mul_pd(inv_r2, _mm_sqrt_pd(inv_r2));
+    const __m128d lj = _mm_mul_pd(_mm_mul_pd(_mm_mul_pd(_mm_set1_pd(p.eps24), inv_r2), powTo6),
+                                  _mm_sub_pd(un, _mm_mul_pd(_mm_set1_pd(2.0), powTo6)));
+    coef_i = _mm_and_pd(masque, _mm_add_pd(lj, _mm_mul_pd(masse_i, inv_r3)));
+    coef_j = _mm_and_pd(masque, _mm_add_pd(lj, _mm_mul_pd(masse_j, inv_r3)));
+    return __builtin_popcount(bits);
+}
+
+// Caps the components of a force
+template <bool BORNER>
+__attribute__((target("sse2"))) inline __m128d bornerSSE2(__m128d f) {
+    return BORNER ? _mm_min_pd(_mm_max_pd(f, _mm_set1_pd(-BORNE)), _mm_set1_pd(BORNE)) : f;
+}
+
+// Loads 2 consecutive values as doubles
+__attribute__((target("sse2"))) inline __m128d chargerSSE2(const double *p) {
+    return _mm_loadu_pd(p);
+}
+
+__attribute__((target("sse2"))) inline __m128d chargerSSE2(const float *p) {
+    return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p))));
+}
+
+// Stores 2 doubles into consecutive values
+__attribute__((target("sse2"))) inline void stockerSSE2(double *p, __m128d v) {
+    _mm_storeu_pd(p, v);
+}
+
+__attribute__((target("sse2"))) inline void stockerSSE2(float *p, __m128d v) {
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_castps_si128(_mm_cvtpd_ps(v)));
+}
+
+// Sum of the 2 lanes
+__attribute__((target("sse2"))) inline double sommeSSE2(__m128d v) {
+    return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+// Full-shell pairs of [debut, fin) with SSE2
+template <bool TROIS_D, bool BORNER>
+__attribute__((target("sse2"))) int coquilleSSE2(const NoyauLJ::Parametres &p, const ReelPosition *x, const ReelPosition *y,
+                                                 const ReelPosition *z, int i, double masse_i, int debut, int fin, double &fxi,
+                                                 double &fyi, double &fzi) {
+    const __m128d xi = _mm_set1_pd(x[i]), yi = _mm_set1_pd(y[i]), zi = _mm_set1_pd(TROIS_D ? double(z[i]) : 0.0);
+    const __m128d mi = _mm_set1_pd(masse_i);
+    __m128d ax = _mm_setzero_pd(), ay = _mm_setzero_pd(), az = _mm_setzero_pd();
+    int actives = 0;
+    int j = debut;
+    for (; j + 2 <= fin; j += 2) {
+        const __m128d rx = _mm_sub_pd(chargerSSE2(x + j), xi);
+        const __m128d ry = _mm_sub_pd(chargerSSE2(y + j), yi);
+        const __m128d rz = TROIS_D ? _mm_sub_pd(chargerSSE2(z + j), zi) : _mm_setzero_pd();
+        __m128d coef_i, coef_j;
+        const int n = coefficientsSSE2<TROIS_D>(p, rx, ry, rz, mi, mi, coef_i, coef_j);
+        if (n == 0) {
+            continue;
+        }
+        actives += n;
+        ax = _mm_add_pd(ax, bornerSSE2<BORNER>(_mm_mul_pd(rx, coef_i)));
+        ay = _mm_add_pd(ay, bornerSSE2<BORNER>(_mm_mul_pd(ry, coef_i)));
+        if (TROIS_D) {
+            az = _mm_add_pd(az, bornerSSE2<BORNER>(_mm_mul_pd(rz, coef_i)));
+        }
+    }
+    fxi += sommeSSE2(ax);
+    fyi += sommeSSE2(ay);
+    fzi += sommeSSE2(az);
+    return actives + coquilleScalaire<TROIS_D, BORNER>(p, x, y, z, i, masse_i, j, fin, fxi, fyi, fzi);
+}
+
+// Half-shell pairs of [debut, fin) with SSE2
+template <bool TROIS_D, bool BORNER>
+__attribute__((target("sse2"))) int demiSSE2(const NoyauLJ::Parametres &p, const ReelPosition *x, const ReelPosition *y,
+                                             const ReelPosition *z, const float *masse, ReelForce *fx, ReelForce *fy,
+                                             ReelForce *fz, int i, int debut, int fin, double &fxi, double &fyi, double &fzi) {
+    const __m128d xi = _mm_set1_pd(x[i]), yi = _mm_set1_pd(y[i]), zi = _mm_set1_pd(TROIS_D ? double(z[i]) : 0.0);
+    const __m128d mi = _mm_set1_pd(masse[i]);
+    __m128d ax = _mm_setzero_pd(), ay = _mm_setzero_pd(), az = _mm_setzero_pd();
+    int actives = 0;
+    int j = debut;
+    for (; j + 2 <= fin; j += 2) {
+        const __m128d rx = _mm_sub_pd(chargerSSE2(x + j), xi);
+        const __m128d ry = _mm_sub_pd(chargerSSE2(y + j), yi);
+        const __m128d rz = TROIS_D ? _mm_sub_pd(chargerSSE2(z + j), zi) : _mm_setzero_pd();
+        const __m128d mj = chargerSSE2(masse + j);
+        __m128d coef_i, coef_j;
+        const int n = coefficientsSSE2<TROIS_D>(p, rx, ry, rz, mi, mj, coef_i, coef_j);
+        if (n == 0) {
+            continue;
+        }
+        actives += n;
+        ax = _mm_add_pd(ax, bornerSSE2<BORNER>(_mm_mul_pd(rx, coef_i)));
+        ay = _mm_add_pd(ay, bornerSSE2<BORNER>(_mm_mul_pd(ry, coef_i)));
+        stockerSSE2(fx + j, _mm_sub_pd(chargerSSE2(fx + j), bornerSSE2<BORNER>(_mm_mul_pd(rx, coef_j))));
+        stockerSSE2(fy + j, _mm_sub_pd(chargerSSE2(fy + j), bornerSSE2<BORNER>(_mm_mul_pd(ry, coef_j))));
+        if (TROIS_D) {
+            az = _mm_add_pd(az, bornerSSE2<BORNER>(_mm_mul_pd(rz, coef_i)));
+            stockerSSE2(fz + j, _mm_sub_pd(chargerSSE2(fz + j), bornerSSE2<BORNER>(_mm_mul_pd(rz, coef_j))));
+        }
+    }
+    fxi += sommeSSE2(ax);
+    fyi += sommeSSE2(ay);
+    fzi += sommeSSE2(az);
+    return actives + demiScalaire<TROIS_D, BORNER>(p, x, y, z, masse, fx, fy, fz, i, j, fin, fxi, fyi, fzi);
+}
+
+/*
+ * AVX2: 4 pairs per instruction, the last partial batch uses masked loads and stores.
+ */
+
+// Lennard-Jones and gravitational coefficients of 4 pairs, zero outside the mask
+template <bool TROIS_D>
+__attribute__((target("avx2"))) inline int coefficientsAVX2(const NoyauLJ::Parametres &p, __m256d valides, __m256d rx, __m256d ry,
+                                                            __m256d rz, __m256d masse_i, __m256d masse_j, __m256d &coef_i,
+                                                            __m256d &coef_j) {
+    const __m256d un = _mm256_set1_pd(1.0);
+    __m256d r2 = _mm256_add_pd(_mm256_mul_pd(rx, rx), _mm256_mul_pd(ry, ry));
+    if (TROIS_D) {
+        r2 = _mm256_add_pd(r2, _mm256_mul_pd(rz, rz));
+    }
+    const __m256d masque = _mm256_and_pd(valides, _mm256_and_pd(_mm256_cmp_pd(r2, _mm256_setzero_pd(), _CMP_NEQ_OQ),
+                                                                _mm256_cmp_pd(r2, _mm256_set1_pd(p.rCut2), _CMP_LT_OQ)));
+    const int bits = _mm256_movemask_pd(masque);
+    if (bits == 0) {
+        return 0;
+    }
+    const __m256d inv_r2 = _mm256_div_pd(un, _mm256_blendv_pd(un, r2, masque));
+    const __m256d s2 = _mm256_mul_pd(_mm256_set1_pd(p.sigma2), inv_r2);
+    const __m256d powTo6 = _mm256_mul_pd(_mm256_mul_pd(s2, s2), s2);
+    const __m256d inv_r3 = _mm256_mul_pd(inv_r2, _mm256_sqrt_pd(inv_r2));
+    const __m256d lj = _mm256_mul_pd(_mm256_mul_pd(_mm256_mul_pd(_mm256_set1_pd(p.eps24), inv_r2), powTo6),
+                                     _mm256_sub_pd(un, _mm256_mul_pd(_mm256_set1_pd(2.0), powTo6)));
+    coef_i = _mm256_and_pd(masque, _mm256_add_pd(lj, _mm256_mul_pd(masse_i, inv_r3)));
+    coef_j = _mm256_and_pd(masque, _mm256_add_pd(lj, _mm256_mul_pd(masse_j, inv_r3)));
+    return __builtin_popcount(bits);
+}
+
+// Caps the components of a force
+template <bool BORNER>
+__attribute__((target("avx2"))) inline __m256d bornerAVX2(__m256d f) {
+    return BORNER ? _mm256_min_pd(_mm256_max_pd(f, _mm256_set1_pd(-BORNE)), _mm256_set1_pd(BORNE)) : f;
+}
+
+// Sum of the 4 lanes
+__attribute__((target("avx2"))) inline double sommeAVX2(__m256d v) {
+    const __m128d s = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+}
+
+// Mask of the first reste lanes of 4
+__attribute__((target("avx2"))) inline __m256i masqueAVX2(int reste) {
+    return _mm256_cmpgt_epi64(_mm256_set1_epi64x(reste), _mm256_set_epi64x(3, 2, 1, 0));
+}
+
+// Mask of the first reste lanes of 4, for 32-bit values
+__attribute__((target("avx2"))) inline __m128i masque32AVX2(int reste) {
+    return _mm_cmpgt_epi32(_mm_set1_epi32(reste), _mm_set_epi32(3, 2, 1, 0));
+}
+
+// Loads 4 consecutive values as doubles
+__attribute__((target("avx2"))) inline __m256d chargerAVX2(const double *p) {
+    return _mm256_loadu_pd(p);
+}
+
+__attribute__((target("avx2"))) inline __m256d chargerAVX2(const float *p) {
+    return _mm256_cvtps_pd(_mm_loadu_ps(p));
+}
+
+// Loads the first reste of 4 consecutive values as doubles, zero elsewhere
+__attribute__((target("avx2"))) inline __m256d chargerAVX2(const double *p, int reste) {
+    return _mm256_maskload_pd(p, masqueAVX2(reste));
+}
+
+__attribute__((target("avx2"))) inline __m256d chargerAVX2(const float *p, int reste) {
+    return _mm256_cvtps_pd(_mm_maskload_ps(p, masque32AVX2(reste)));
+}
+
+// Stores 4 doubles into consecutive values
+__attribute__((target("avx2"))) inline void stockerAVX2(double *p, __m256d v) {
+    _mm256_storeu_pd(p, v);
+}
+
+__attribute__((target("avx2"))) inline void stockerAVX2(float *p, __m256d v) {
+    _mm_storeu_ps(p, _mm256_cvtpd_ps(v));
+}
+
+// Stores the first reste of 4 doubles into consecutive values
+__attribute__((target("avx2"))) inline void stockerAVX2(double *p, int reste, __m256d v) {
+    _mm256_maskstore_pd(p, masqueAVX2(reste), v);
+}
+
+__attribute__((target("avx2"))) inline void stockerAVX2(float *p, int reste, __m256d v) {
+    _mm_maskstore_ps(p, masque32AVX2(reste), _mm256_cvtpd_ps(v));
+}
+
+// Full-shell pairs of [debut, fin) with AVX2
+template <bool TROIS_D, bool BORNER>
+__attribute__((target("avx2"))) int coquilleAVX2(const NoyauLJ::Parametres &p, const ReelPosition *x, const ReelPosition *y,
+                                                 const ReelPosition *z, int i, double masse_i, int debut, int fin, double &fxi,
+                                                 double &fyi, double &fzi) {
+    const __m256d xi = _mm256_set1_pd(x[i]), yi = _mm256_set1_pd(y[i]), zi = _mm256_set1_pd(TROIS_D ? double(z[i]) : 0.0);
+    const __m256d mi = _mm256_set1_pd(masse_i);
+    const __m256d tous = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    __m256d ax = _mm256_setzero_pd(), ay = _mm256_setzero_pd(), az = _mm256_setzero_pd();
+    int actives = 0;
+    for (int j = debut; j < fin; j += 4) {
+        __m256d rx, ry, rz = _mm256_setzero_pd(), valides;
+        if (fin - j >= 4) {
+            rx = _mm256_sub_pd(chargerAVX2(x + j), xi);
+            ry = _mm256_sub_pd(chargerAVX2(y + j), yi);
+            if (TROIS_D) {
+                rz = _mm256_sub_pd(chargerAVX2(z + j), zi);
+            }
+            valides = tous;
+        } else {
+            rx = _mm256_sub_pd(chargerAVX2(x + j, fin - j), xi);
+            ry = _mm256_sub_pd(chargerAVX2(y + j, fin - j), yi);
+            if (TROIS_D) {
+                rz = _mm256_sub_pd(chargerAVX2(z + j, fin - j), zi);
+            }
+            valides = _mm256_castsi256_pd(masqueAVX2(fin - j));
+        }
+        __m256d coef_i, coef_j;
+        const int n = coefficientsAVX2<TROIS_D>(p, valides, rx, ry, rz, mi, mi, coef_i, coef_j);
+        if (n == 0) {
+            continue;
+        }
+        actives += n;
+        ax = _mm256_add_pd(ax, bornerAVX2<BORNER>(_mm256_mul_pd(rx, coef_i)));
+        ay = _mm256_add_pd(ay, bornerAVX2<BORNER>(_mm256_mul_pd(ry, coef_i)));
+        if (TROIS_D) {
+            az = _mm256_add_pd(az, bornerAVX2<BORNER>(_mm256_mul_pd(rz, coef_i)));
+        }
+    }
+    fxi += sommeAVX2(ax);
+    fyi += sommeAVX2(ay);
+    fzi += sommeAVX2(az);
+    return actives;
+}
+
+// Half-shell pairs of [debut, fin) with AVX2
+template <bool TROIS_D, bool BORNER>
+__attribute__((target("avx2"))) int demiAVX2(const NoyauLJ::Parametres &p, const ReelPosition *x, const ReelPosition *y,
+                                             const ReelPosition *z, const float *masse, ReelForce *fx, ReelForce *fy,
+                                             ReelForce *fz, int i, int debut, int fin, double &fxi, double &fyi, double &fzi) {
+    const __m256d xi = _mm256_set1_pd(x[i]), yi = _mm256_set1_pd(y[i]), zi = _mm256_set1_pd(TROIS_D ? double(z[i]) : 0.0);
+    const __m256d mi = _mm256_set1_pd(masse[i]);
+    const __m256d tous = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    __m256d ax = _mm256_setzero_pd(), ay = _mm256_setzero_pd(), az = _mm256_setzero_pd();
+    int actives = 0;
+    for (int j = debut; j < fin; j += 4) {
+        const int reste = fin - j;
+        __m256d rx, ry, rz = _mm256_setzero_pd(), mj, valides;
+        if (reste >= 4) {
+            rx = _mm256_sub_pd(chargerAVX2(x + j), xi);
+            ry = _mm256_sub_pd(chargerAVX2(y + j), yi);
+            if (TROIS_D) {
+                rz = _mm256_sub_pd(chargerAVX2(z + j), zi);
+            }
+            mj = chargerAVX2(masse + j);
+            valides = tous;
+        } else {
+            rx = _mm256_sub_pd(chargerAVX2(x + j, reste), xi);
+            ry = _mm256_sub_pd(chargerAVX2(y + j, reste), yi);
+            if (TROIS_D) {
+                rz = _mm256_sub_pd(chargerAVX2(z + j, reste), zi);
+            }
+            mj = chargerAVX2(masse + j, reste);
+            valides = _mm256_castsi256_pd(masqueAVX2(reste));
+        }
+        __m256d coef_i, coef_j;
+        const int n = coefficientsAVX2<TROIS_D>(p, valides, rx, ry, rz, mi, mj, coef_i, coef_j);
+        if (n == 0) {
+            continue;
+        }
+        actives += n;
+        ax = _mm256_add_pd(ax, bornerAVX2<BORNER>(_mm256_mul_pd(rx, coef_i)));
+        ay = _mm256_add_pd(ay, bornerAVX2<BORNER>(_mm256_mul_pd(ry, coef_i)));
+        const __m256d fjx = bornerAVX2<BORNER>(_mm256_mul_pd(rx, coef_j));
+        const __m256d fjy = bornerAVX2<BORNER>(_mm256_mul_pd(ry, coef_j));
+        if (reste >= 4) {
+            stockerAVX2(fx + j, _mm256_sub_pd(chargerAVX2(fx + j), fjx));
+            stockerAVX2(fy + j, _mm256_sub_pd(chargerAVX2(fy + j), fjy));
+        } else {
+            stockerAVX2(fx + j, reste, _mm256_sub_pd(chargerAVX2(fx + j, reste), fjx));
+            stockerAVX2(fy + j, reste, _mm256_sub_pd(chargerAVX2(fy + j, reste), fjy));
+        }
+        if (TROIS_D) {
+            az = _mm256_add_pd(az, bornerAVX2<BORNER>(_mm256_mul_pd(rz, coef_i)));
+            const __m256d fjz = bornerAVX2<BORNER>(_mm256_mul_pd(rz, coef_j));
+            if (reste >= 4) {
+                stockerAVX2(fz + j, _mm256_sub_pd(chargerAVX2(fz + j), fjz));
+            } else {
+                stockerAVX2(fz + j, reste, _mm256_sub_pd(chargerAVX2(fz + j, reste), fjz));
+            }
+        }
+    }
+    fxi += sommeAVX2(ax);
+    fyi += sommeAVX2(ay);
+    fzi += sommeAVX2(az);
+    return actives;
+}
+
+/*
+ * AVX-512: 8 pairs per instruction, the last partial batch uses mask registers.
+ */
+
+// Lennard-Jones and gravitational coefficients of 8 pairs, zero outside the mask
+template <bool TROIS_D>
+__attribute__((target("avx512f"))) inline int coefficientsAVX512(const NoyauLJ::Parametres &p, __mmask8 valides, __m512d rx,
+                                                                 __m512d ry, __m512d rz, __m512d masse_i, __m512d masse_j,
+                                                                 __m512d &coef_i, __m512d &coef_j) {
+    const __m512d un = _mm512_set1_pd(1.0);
+    __m512d r2 = _mm512_add_pd(_mm512_mul_pd(rx, rx), _mm512_mul_pd(ry, ry));
+    if (TROIS_D) {
+        r2 = _mm512_add_pd(r2, _mm512_mul_pd(rz, rz));
+    }
+    const __mmask8 masque = _mm512_mask_cmp_pd_mask(_mm512_mask_cmp_pd_mask(valides, r2, _mm512_setzero_pd(), _CMP_NEQ_OQ), r2,
+                                                    _mm512_set1_pd(p.rCut2), _CMP_LT_OQ);
+    if (masque == 0) {
+        return 0;
+    }
+    const __m512d inv_r2 = _mm512_div_pd(un, _mm512_mask_blend_pd(masque, un, r2));
+    const __m512d s2 = _mm512_mul_pd(_mm512_set1_pd(p.sigma2), inv_r2);
+    const __m512d powTo6 = _mm512_mul_pd(_mm512_mul_pd(s2, s2), s2);
+    const __m512d inv_r3 = _mm512_mul_pd(inv_r2, _mm512_sqrt_pd(inv_r2));
+    const __m512d lj = _mm512_mul_pd(_mm512_mul_pd(_mm512_mul_pd(_mm512_set1_pd(p.eps24), inv_r2), powTo6),
+                                     _mm512_sub_pd(un, _mm512_mul_pd(_mm512_set1_pd(2.0), powTo6)));
+    coef_i = _mm512_maskz_mov_pd(masque, _mm512_add_pd(lj, _mm512_mul_pd(masse_i, inv_r3)));
+    coef_j = _mm512_maskz_mov_pd(masque, _mm512_add_pd(lj, _mm512_mul_pd(masse_j, inv_r3)));
+    return __builtin_popcount(masque);
+}
+
+// Caps the components of a force
+template <bool BORNER>
+__attribute__((target("avx512f"))) inline __m512d bornerAVX512(__m512d f) {
+    return BORNER ? _mm512_min_pd(_mm512_max_pd(f, _mm512_set1_pd(-BORNE)), _mm512_set1_pd(BORNE)) : f;
+}
+
+// Loads the consecutive values of the mask as doubles, zero elsewhere
+__attribute__((target("avx512f"))) inline __m512d chargerAVX512(const double *p, __mmask8 m) {
+    return _mm512_maskz_loadu_pd(m, p);
+}
+
+__attribute__((target("avx512f"))) inline __m512d chargerAVX512(const float *p, __mmask8 m) {
+    return _mm512_cvtps_pd(_mm512_castps512_ps256(_mm512_maskz_loadu_ps(m, p)));
+}
+
+// Stores the doubles of the mask into consecutive values
+__attribute__((target("avx512f"))) inline void stockerAVX512(double *p, __mmask8 m, __m512d v) {
+    _mm512_mask_storeu_pd(p, m, v);
+}
+
+__attribute__((target("avx512f"))) inline void stockerAVX512(float *p, __mmask8 m, __m512d v) {
+    _mm512_mask_storeu_ps(p, m, _mm512_castps256_ps512(_mm512_cvtpd_ps(v)));
+}
+
+// Full-shell pairs of [debut, fin) with AVX-512
+template <bool TROIS_D, bool BORNER>
+__attribute__((target("avx512f"))) int coquilleAVX512(const NoyauLJ::Parametres &p, const ReelPosition *x,
+                                                      const ReelPosition *y, const ReelPosition *z, int i, double masse_i,
+                                                      int debut, int fin, double &fxi, double &fyi, double &fzi) {
+    const __m512d xi = _mm512_set1_pd(x[i]), yi = _mm512_set1_pd(y[i]), zi = _mm512_set1_pd(TROIS_D ? double(z[i]) : 0.0);
+    const __m512d mi = _mm512_set1_pd(masse_i);
+    __m512d ax = _mm512_setzero_pd(), ay = _mm512_setzero_pd(), az = _mm512_setzero_pd();
+    int actives = 0;
+    for (int j = debut; j < fin; j += 8) {
+        const __mmask8 m = (fin - j >= 8) ? 0xFF : static_cast<__mmask8>((1u << (fin - j)) - 1);
+        const __m512d rx = _mm512_sub_pd(chargerAVX512(x + j, m), xi);
+        const __m512d ry = _mm512_sub_pd(chargerAVX512(y + j, m), yi);
+        const __m512d rz = TROIS_D ? _mm512_sub_pd(chargerAVX512(z + j, m), zi) : _mm512_setzero_pd();
+        __m512d coef_i, coef_j;
+        const int n = coefficientsAVX512<TROIS_D>(p, m, rx, ry, rz, mi, mi, coef_i, coef_j);
+        if (n == 0) {
+            continue;
+        }
+        actives += n;
+        ax = _mm512_add_pd(ax, bornerAVX512<BORNER>(_mm512_mul_pd(rx, coef_i)));
+        ay = _mm512_add_pd(ay, bornerAVX512<BORNER>(_mm512_mul_pd(ry, coef_i)));
+        if (TROIS_D) {
+            az = _mm512_add_pd(az, bornerAVX512<BORNER>(_mm512_mul_pd(rz, coef_i)));
+        }
+    }
+    fxi += _mm512_reduce_add_pd(ax);
+    fyi += _mm512_reduce_add_pd(ay);
+    fzi += _mm512_reduce_add_pd(az);
+    return actives;
+}
+
+// Half-shell pairs of [debut, fin) with AVX-512
+template <bool TROIS_D, bool BORNER>
+__attribute__((target("avx512f"))) int demiAVX512(const NoyauLJ::Parametres &p, const ReelPosition *x, const ReelPosition *y,
+                                                  const ReelPosition *z, const float *masse, ReelForce *fx, ReelForce *fy,
+                                                  ReelForce *fz, int i, int debut, int fin, double &fxi, double &fyi,
+                                                  double &fzi) {
+    const __m512d xi = _mm512_set1_pd(x[i]), yi = _mm512_set1_pd(y[i]), zi = _mm512_set1_pd(TROIS_D ? double(z[i]) : 0.0);
+    const __m512d mi = _mm512_set1_pd(masse[i]);
+    __m512d ax = _mm512_setzero_pd(), ay = _mm512_setzero_pd(), az = _mm512_setzero_pd();
+    int actives = 0;
+    for (int j = debut; j < fin; j += 8) {
+        const __mmask8 m = (fin - j >= 8) ? 0xFF : static_cast<__mmask8>((1u << (fin - j)) - 1);
+        const __m512d rx = _mm512_sub_pd(chargerAVX512(x + j, m), xi);
+        const __m512d ry = _mm512_sub_pd(chargerAVX512(y + j, m), yi);
+        const __m512d rz = TROIS_D ? _mm512_sub_pd(chargerAVX512(z + j, m), zi) : _mm512_setzero_pd();
+        const __m512d mj = chargerAVX512(masse + j, m);
+        __m512d coef_i, coef_j;
+        const int n = coefficientsAVX512<TROIS_D>(p, m, rx, ry, rz, mi, mj, coef_i, coef_j);
+        if (n == 0) {
+            continue;
+        }
+        actives += n;
+        ax = _mm512_add_pd(ax, bornerAVX512<BORNER>(_mm512_mul_pd(rx, coef_i)));
+        ay = _mm512_add_pd(ay, bornerAVX512<BORNER>(_mm512_mul_pd(ry, coef_i)));
+        stockerAVX512(fx + j, m, _mm512_sub_pd(chargerAVX512(fx + j, m), bornerAVX512<BORNER>(_mm512_mul_pd(rx, coef_j))));
+        stockerAVX512(fy + j, m, _mm512_sub_pd(chargerAVX512(fy + j, m), bornerAVX512<BORNER>(_mm512_mul_pd(ry, coef_j))));
+        if (TROIS_D) {
+            az = _mm512_add_pd(az, bornerAVX512<BORNER>(_mm512_mul_pd(rz, coef_i)));
+            stockerAVX512(fz + j, m, _mm512_sub_pd(chargerAVX512(fz + j, m), bornerAVX512<BORNER>(_mm512_mul_pd(rz, coef_j))));
+        }
+    }
+    fxi += _mm512_reduce_add_pd(ax);
+    fyi += _mm512_reduce_add_pd(ay);
+    fzi += _mm512_reduce_add_pd(az);
+    return actives;
+}
+
+#endif // NOYAULJ_X86
+
+// Variants of an instruction set for the 4 combinations of (troisD, borner)
+struct Variantes {
+    NoyauLJ::FonctionCoquille coquille[2][2];
+    NoyauLJ::FonctionDemi demi[2][2];
+};
+
+#define NOYAULJ_VARIANTES(COQUILLE, DEMI) \
+    { {{COQUILLE<false, false>, COQUILLE<false, true>}, {COQUILLE<true, false>, COQUILLE<true, true>}}, \
+      {{DEMI<false, false>, DEMI<false, true>}, {DEMI<true, false>, DEMI<true, true>}} }
+
+const Variantes VARIANTES[] = {
+    NOYAULJ_VARIANTES(coquilleScalaire, demiScalaire),
+#ifdef NOYAULJ_X86
+    NOYAULJ_VARIANTES(coquilleSSE2, demiSSE2),
+    NOYAULJ_VARIANTES(coquilleAVX2, demiAVX2),
+    NOYAULJ_VARIANTES(coquilleAVX512, demiAVX512),
+#endif
+};
+
+#undef NOYAULJ_VARIANTES
+
+}
+
+const int NoyauLJ::AUTOMATIQUE;
+const int NoyauLJ::SCALAIRE;
+const int NoyauLJ::SSE2;
+const int NoyauLJ::AVX2;
+const int NoyauLJ::AVX512;
+
+// Select the variant of an instruction set
+NoyauLJ::NoyauLJ(const Parametres &parametres, int jeu) : parametres(parametres) {
+    if (jeu == AUTOMATIQUE) {
+        jeu = detecter();
+    }
+    if (!estDisponible(jeu)) {
+        throw std::invalid_argument(std::string("Instruction set not supported: ") +
+                                    ((jeu >= SCALAIRE && jeu <= AVX512) ? getNom(jeu) : "unknown"));
+    }
+    this->jeu = jeu;
+    coquille = VARIANTES[jeu].coquille[parametres.troisD][parametres.borner];
+    demi = VARIANTES[jeu].demi[parametres.troisD][parametres.borner];
+}
+
+// Tell whether the processor and the build support an instruction set
+bool NoyauLJ::estDisponible(int jeu) {
+    switch (jeu) {
+        case SCALAIRE:
+            return true;
+#ifdef NOYAULJ_X86
+        case SSE2:
+            return __builtin_cpu_supports("sse2");
+        case AVX2:
+            return __builtin_cpu_supports("avx2");
+        case AVX512:
+            return __builtin_cpu_supports("avx512f");
+#endif
+        default:
+            return false;
+    }
+}
+
+// Get the best instruction set supported by the processor
+int NoyauLJ::detecter() {
+    static const int meilleur = [] {
+        int jeu = AVX512;
+        while (!estDisponible(jeu)) {
+            jeu--;
+        }
+        return jeu;
+    }();
+    return meilleur;
+}
+
+// Get the name of an instruction set
+const char *NoyauLJ::getNom(int jeu) {
+    static const char *NOMS[] = {"scalaire", "sse2", "avx2", "avx512"};
+    if (jeu < SCALAIRE || jeu > AVX512) {
+        throw std::out_of_range("Invalid instruction set.");
+    }
+    return NOMS[jeu];
+}
@@ -0,0 +1,109 @@
+#include "OrdreCellules.hxx"
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+const int OrdreCellules::LIGNES;
+const int OrdreCellules::MORTON;
+const int OrdreCellules::HILBERT;
+
+// Interleave the bits of the coordinates, the first coordinate being the least significant
+uint64_t OrdreCellules::cleMorton(const unsigned *coords, int nbDims, int nbBits) {
+    uint64_t cle = 0;
+    for (int b = nbBits - 1; b >= 0; b--) {
+        for (int d = nbDims - 1; d >= 0; d--) {
+            cle = (cle << 1) | ((coords[d] >> b) & 1u);
+        }
+    }
+    return cle;
+}
+
+// Transpose the coordinates into the Hilbert index, then interleave its bits
+uint64_t OrdreCellules::cleHilbert(const unsigned *coords, int nbDims, int nbBits) {
+    unsigned X[3] = {0, 0, 0};
+    std::copy(coords, coords + nbDims, X);
+    const unsigned M = 1u << (nbBits - 1);
+
+    // Inverse undo
+    for (unsigned Q = M; Q > 1; Q >>= 1) {
+        const unsigned P = Q - 1;
+        for (int i = 0; i < nbDims; i++) {
+            if (X[i] & Q) {
+                X[0] ^= P;
+            } else {
+                const unsigned t = (X[0] ^ X[i]) & P;
+                X[0] ^= t;
+                X[i] ^= t;
+            }
+        }
+    }
+    // Gray encode
+    for (int i = 1; i < nbDims; i++) {
+        X[i] ^= X[i - 1];
+    }
+    unsigned t = 0;
+    for (unsigned Q = M; Q > 1; Q >>= 1) {
+        if (X[nbDims - 1] & Q) {
+            t ^= Q - 1;
+        }
+    }
+    for (int i = 0; i < nbDims; i++) {
+        X[i] ^= t;
+    }
+
+    // The first coordinate holds the most significant bit of each group
+    uint64_t cle = 0;
+    for (int b = nbBits - 1; b >= 0; b--) {
+        for (int d = 0; d < nbDims; d++) {
+            cle = (cle << 1) | ((X[d] >> b) & 1u);
+        }
+    }
+    return cle;
+}
+
+// Sort the cells by key along the curve
+std::vector<int> OrdreCellules::calculerRangs(int ordre, int largeur, int hauteur, int profondeur) {
+    if (ordre < LIGNES || ordre > HILBERT) {
+        throw std::invalid_argument("Invalid cell order: must be 0 (row-major), 1 (Morton) or 2 (Hilbert).");
+    }
+    const int n = largeur * hauteur * profondeur;
+    std::vector<int> rangs(n);
+    std::iota(rangs.begin(), rangs.end(), 0);
+    if (ordre == LIGNES || n == 0) {
+        return rangs;
+    }
+
+    const int nbDims = (profondeur > 1) ? 3 : 2;
+    int nbBits = 1;
+    while ((1 << nbBits) < std::max(largeur, std::max(hauteur, profondeur))) {
+        nbBits++;
+    }
+    if (nbBits * nbDims > 63) {
+        throw std::invalid_argument("Grid too large for a space-filling curve.");
+    }
+
+    std::vector<uint64_t> cles(n);
+    for (int r = 0; r < n; r++) {
+        const unsigned coords[3] = {static_cast<unsigned>(r % largeur), static_cast<unsigned>((r / largeur) % hauteur),
+                                    static_cast<unsigned>(r / (largeur * hauteur))};
+        cles[r] = (ordre == MORTON) ? cleMorton(coords, nbDims, nbBits) : cleHilbert(coords, nbDims, nbBits);
+    }
+
+    // Cells in curve order, then the index of each cell
+    std::vector<int> parCle(n);
+    std::iota(parCle.begin(), parCle.end(), 0);
+    std::sort(parCle.begin(), parCle.end(), [&](int a, int b) { return cles[a] < cles[b]; });
+    for (int k = 0; k < n; k++) {
+        rangs[parCle[k]] = k;
+    }
+    return rangs;
+}
+
+// Get the name of an order
+const char *OrdreCellules::getNom(int ordre) {
+    static const char *NOMS[] = {"lignes", "morton", "hilbert"};
+    if (ordre < LIGNES || ordre > HILBERT) {
+        throw std::out_of_range("Invalid cell order.");
+    }
+    return NOMS[ordre];
+}
@@ -0,0 +1,370 @@
+#include "ParticuleStore.hxx"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace {
+
+// Scatters an array following a permutation, using a scratch buffer
+template <typename T>
+void scatter(std::vector<T> &data, const std::vector<int> &permutation, std::vector<T> &tampon) {
+    tampon.resize(data.size());
+    for (size_t i = 0; i < data.size(); i++) {
+        tampon[permutation[i]] = data[i];
+    }
+    data.swap(tampon);
+}
+
+// Keeps the elements whose flag is zero, preserving their order
+template <typename T>
+void compact(std::vector<T> &data, const std::vector<char> &aSupprimer) {
+    size_t k = 0;
+    for (size_t i = 0; i < data.size(); i++) {
+        if (!aSupprimer[i]) {
+            data[k++] = data[i];
+        }
+    }
+    data.resize(k);
+}
+
+// Moves the nbAjouts last elements, taken in the given order, to the end of their cells;
+// the others are shifted in blocks by the number of appended elements before them
+template <typename T>
+void fusionner(std::vector<T> &data, const int *ordre, const int *cellulesQueue, int nbAjouts,
+               const std::vector<int> &debutCellules, std::vector<T> &tampon) {
+    tampon.resize(nbAjouts);
+    for (int k = 0; k < nbAjouts; k++) {
+        tampon[k] = data[ordre[k]];
+    }
+    // From the last appended element back: the elements of the following cells not yet
+    // moved are shifted past the k + 1 elements left, then element k is put after its cell
+    int fin = static_cast<int>(data.size()) - nbAjouts;
+    for (int k = nbAjouts - 1; k >= 0; k--) {
+        const int suivante = debutCellules[cellulesQueue[k] + 1];
+        std::move_backward(data.begin() + suivante, data.begin() + fin, data.begin() + fin + k + 1);
+        data[suivante + k] = tampon[k];
+        fin = suivante;
+    }
+}
+
+// Advises huge pages for the 2 MB aligned part of the memory of an array
+template <typename T>
+void conseillerPagesEnormes(std::vector<T> &data) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    const uintptr_t page = 2 << 20;
+    const uintptr_t debut = (reinterpret_cast<uintptr_t>(data.data()) + page - 1) & ~(page - 1);
+    const uintptr_t fin = (reinterpret_cast<uintptr_t>(data.data() + data.capacity())) & ~(page - 1);
+    if (fin > debut) {
+        madvise(reinterpret_cast<void *>(debut), fin - debut, MADV_HUGEPAGE);
+    }
+#else
+    (void)data;
+#endif
+}
+
+}
+
+// Default constructor
+ParticuleStore::ParticuleStore() : debutCellules(1, 0) {}
+
+// Get the number of particles
+int ParticuleStore::getNbParticules() const {
+    return static_cast<int>(id.size());
+}
+
+// Reserve memory for n particles
+void ParticuleStore::reserve(int n) {
+    for (auto *a : {&x, &y, &z, &vx, &vy, &vz}) {
+        a->reserve(n);
+    }
+    for (auto *a : {&fx, &fy, &fz, &fxOld, &fyOld, &fzOld}) {
+        a->reserve(n);
+    }
+    masse.reserve(n);
+    categorie.reserve(n);
+    id.reserve(n);
+    cellule.reserve(n);
+    conseillerPages();
+}
+
+// Remove every particle
+void ParticuleStore::clear() {
+    for (auto *a : {&x, &y, &z, &vx, &vy, &vz}) {
+        a->clear();
+    }
+    for (auto *a : {&fx, &fy, &fz, &fxOld, &fyOld, &fzOld}) {
+        a->clear();
+    }
+    masse.clear();
+    categorie.clear();
+    id.clear();
+    cellule.clear();
+    debutCellules.assign(1, 0);
+}
+
+// Append a particle
+void ParticuleStore::addParticule(const Particule3D& particule, int indexCellule) {
+    Particule3D p = particule;
+    Vector3D pos = p.getPos();
+    Vector3D vit = p.getVit();
+    Vector3D force = p.getForce();
+    x.push_back(pos.getX());
+    y.push_back(pos.getY());
+    z.push_back(pos.getZ());
+    vx.push_back(vit.getX());
+    vy.push_back(vit.getY());
+    vz.push_back(vit.getZ());
+    fx.push_back(force.getX());
+    fy.push_back(force.getY());
+    fz.push_back(force.getZ());
+    fxOld.push_back(0);
+    fyOld.push_back(0);
+    fzOld.push_back(0);
+    masse.push_back(p.getMasse());
+    categorie.push_back(p.getCategorie());
+    id.push_back(p.getId());
+    cellule.push_back(indexCellule);
+}
+
+// Build a particle from the stored data
+Particule3D ParticuleStore::getParticule(int i) const {
+    return Particule3D(id[i], masse[i], categorie[i], Vector3D(fx[i], fy[i], fz[i]), Vector3D(x[i], y[i], z[i]), Vector3D(vx[i], vy[i], vz[i]));
+}
+
+// Counting sort of the particles by cell index
+void ParticuleStore::sortByCell(int nbCellules) {
+    const int n = getNbParticules();
+    // A margin on the ranges, for the number of cells of a sparse grid changes at each rebuild
+    if (debutCellules.capacity() < static_cast<size_t>(nbCellules) + 1) {
+        debutCellules.reserve(nbCellules + 1 + nbCellules / 2);
+    }
+    debutCellules.assign(nbCellules + 1, 0);
+    for (int i = 0; i < n; i++) {
+        if (cellule[i] < 0 || cellule[i] >= nbCellules) {
+            throw std::out_of_range("Cell index out of range in sortByCell.");
+        }
+        debutCellules[cellule[i] + 1]++;
+    }
+    for (int c = 0; c < nbCellules; c++) {
+        debutCellules[c + 1] += debutCellules[c];
+    }
+
+    // Destination of each particle, then move everything in one pass per array
+    permutation.resize(n);
+    bool dejaTrie = true;
+    for (int i = 0; i < n; i++) {
+        permutation[i] = debutCellules[cellule[i]]++;
+        dejaTrie = dejaTrie && permutation[i] == i;
+    }
+    // debutCellules now holds the end of each range: shift it back
+    for (int c = nbCellules; c > 0; c--) {
+        debutCellules[c] = debutCellules[c - 1];
+    }
+    debutCellules[0] = 0;
+
+    if (!dejaTrie) {
+        permute();
+    }
+}
+
+// Move the migrants in place, or rebin everything when too many particles moved
+int ParticuleStore::rebinCells(int nbCellules) {
+    if (static_cast<int>(debutCellules.size()) != nbCellules + 1 || debutCellules[nbCellules] != getNbParticules()) {
+        sortByCell(nbCellules);
+        return getNbParticules();
+    }
+
+    // Cost of the in-place moves: one swap per crossed cell boundary
+    long cout = 0;
+    int nbMigrants = 0;
+    for (int c = 0; c < nbCellules; c++) {
+        for (int i = debutCellules[c]; i < debutCellules[c + 1]; i++) {
+            if (cellule[i] != c) {
+                cout += std::abs(cellule[i] - c);
+                nbMigrants++;
+            }
+        }
+    }
+    if (nbMigrants == 0) {
+        return 0;
+    }
+    if (cout > getNbParticules() / 4) {
+        sortByCell(nbCellules);
+        return nbMigrants;
+    }
+
+    for (int c = 0; c < nbCellules; c++) {
+        int i = debutCellules[c];
+        while (i < debutCellules[c + 1]) {
+            const int cible = cellule[i];
+            if (cible == c) {
+                i++;
+            } else if (cible > c) {
+                // Move to the last slot of c, which becomes the first slot of c + 1,
+                // then cross each following cell the same way
+                int fin = debutCellules[c + 1] - 1;
+                echanger(i, fin);
+                debutCellules[c + 1]--;
+                for (int k = c + 1; k < cible; k++) {
+                    int premier = debutCellules[k];
+                    int dernier = debutCellules[k + 1] - 1;
+                    echanger(premier, dernier);
+                    debutCellules[k + 1]--;
+                }
+                // Slot i now holds the former last particle of c, check it again
+            } else {
+                // Move to the first slot of c, which becomes the last slot of c - 1,
+                // then cross each previous cell the same way
+                echanger(i, debutCellules[c]);
+                debutCellules[c]++;
+                for (int k = c - 1; k > cible; k--) {
+                    int premier = debutCellules[k];
+                    int dernier = debutCellules[k + 1] - 1;
+                    echanger(premier, dernier);
+                    debutCellules[k]++;
+                }
+                // Slot i now holds a particle already checked
+                i++;
+            }
+        }
+    }
+    return nbMigrants;
+}
+
+// Merge the appended particles into their cells, shifting the others in blocks
+int ParticuleStore::insererQueue(int debutQueue, int nbCellules) {
+    const int nbAjouts = getNbParticules() - debutQueue;
+    if (static_cast<int>(debutCellules.size()) != nbCellules + 1 || debutCellules[nbCellules] != debutQueue) {
+        sortByCell(nbCellules);
+        return nbAjouts;
+    }
+    if (nbAjouts == 0) {
+        return 0;
+    }
+
+    // Appended particles in cell order then order of arrival, and their cells after them
+    permutation.resize(2 * static_cast<size_t>(nbAjouts));
+    for (int k = 0; k < nbAjouts; k++) {
+        const int c = cellule[debutQueue + k];
+        if (c < 0 || c >= nbCellules) {
+            throw std::out_of_range("Cell index out of range in insererQueue.");
+        }
+        permutation[k] = debutQueue + k;
+    }
+    std::sort(permutation.begin(), permutation.begin() + nbAjouts, [&](int a, int b) {
+        return cellule[a] < cellule[b] || (cellule[a] == cellule[b] && a < b);
+    });
+    int *ordre = permutation.data();
+    int *cellulesQueue = permutation.data() + nbAjouts;
+    for (int k = 0; k < nbAjouts; k++) {
+        cellulesQueue[k] = cellule[ordre[k]];
+    }
+
+    for (auto *a : {&x, &y, &z, &vx, &vy, &vz}) {
+        fusionner(*a, ordre, cellulesQueue, nbAjouts, debutCellules, tamponPosition);
+    }
+    for (auto *a : {&fx, &fy, &fz, &fxOld, &fyOld, &fzOld}) {
+        fusionner(*a, ordre, cellulesQueue, nbAjouts, debutCellules, tamponForce);
+    }
+    fusionner(masse, ordre, cellulesQueue, nbAjouts, debutCellules, tamponFloat);
+    for (auto *a : {&categorie, &id, &cellule}) {
+        fusionner(*a, ordre, cellulesQueue, nbAjouts, debutCellules, tamponInt);
+    }
+
+    // Each range starts after the appended particles of the previous cells
+    int k = 0;
+    for (int c = 0; c <= nbCellules; c++) {
+        while (k < nbAjouts && cellulesQueue[k] < c) {
+            k++;
+        }
+        debutCellules[c] += k;
+    }
+    return nbAjouts;
+}
+
+// Recompute the cell ranges of a sorted store
+void ParticuleStore::recountCells(int nbCellules) {
+    debutCellules.assign(nbCellules + 1, 0);
+    for (int c : cellule) {
+        debutCellules[c + 1]++;
+    }
+    for (int c = 0; c < nbCellules; c++) {
+        debutCellules[c + 1] += debutCellules[c];
+    }
+}
+
+// Remove the flagged particles
+int ParticuleStore::removeFlagged(const std::vector<char>& aSupprimer) {
+    const int avant = getNbParticules();
+    for (auto *a : {&x, &y, &z, &vx, &vy, &vz}) {
+        compact(*a, aSupprimer);
+    }
+    for (auto *a : {&fx, &fy, &fz, &fxOld, &fyOld, &fzOld}) {
+        compact(*a, aSupprimer);
+    }
+    compact(masse, aSupprimer);
+    compact(categorie, aSupprimer);
+    compact(id, aSupprimer);
+    compact(cellule, aSupprimer);
+    return avant - getNbParticules();
+}
+
+// Swap two particles
+void ParticuleStore::echanger(int i, int j) {
+    if (i == j) {
+        return;
+    }
+    for (auto *a : {&x, &y, &z, &vx, &vy, &vz}) {
+        std::swap((*a)[i], (*a)[j]);
+    }
+    for (auto *a : {&fx, &fy, &fz, &fxOld, &fyOld, &fzOld}) {
+        std::swap((*a)[i], (*a)[j]);
+    }
+    std::swap(masse[i], masse[j]);
+    std::swap(categorie[i], categorie[j]);
+    std::swap(id[i], id[j]);
+    std::swap(cellule[i], cellule[j]);
+}
+
+// Apply the permutation to every array
+void ParticuleStore::permute() {
+    for (auto *a : {&x, &y, &z, &vx, &vy, &vz}) {
+        scatter(*a, permutation, tamponPosition);
+    }
+    for (auto *a : {&fx, &fy, &fz, &fxOld, &fyOld, &fzOld}) {
+        scatter(*a, permutation, tamponForce);
+    }
+    scatter(masse, permutation, tamponFloat);
+    scatter(categorie, permutation, tamponInt);
+    scatter(id, permutation, tamponInt);
+    scatter(cellule, permutation, tamponInt);
+    conseillerPages();
+}
+
+// Request huge pages for the arrays
+void ParticuleStore::setPagesEnormes(bool pagesEnormes) {
+    this->pagesEnormes = pagesEnormes;
+    conseillerPages();
+}
+
+// Advise huge pages for every array and scratch buffer
+void ParticuleStore::conseillerPages() {
+    if (!pagesEnormes) {
+        return;
+    }
+    for (auto *a : {&x, &y, &z, &vx, &vy, &vz, &tamponPosition}) {
+        conseillerPagesEnormes(*a);
+    }
+    for (auto *a : {&fx, &fy, &fz, &fxOld, &fyOld, &fzOld, &tamponForce}) {
+        conseillerPagesEnormes(*a);
+    }
+    for (auto *a : {&categorie, &id, &cellule, &permutation, &tamponInt}) {
+        conseillerPagesEnormes(*a);
+    }
+    conseillerPagesEnormes(masse);
+    conseillerPagesEnormes(tamponFloat);
+}
@@ -0,0 +1,169 @@
+#include "PoolThreads.hxx"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+// Packs a range of tasks in one word
+uint64_t paquet(int debut, int fin) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(debut)) << 32) | static_cast<uint32_t>(fin);
+}
+
+// Start of a packed range
+int debutPaquet(uint64_t bornes) {
+    return static_cast<int>(bornes >> 32);
+}
+
+// End of a packed range
+int finPaquet(uint64_t bornes) {
+    return static_cast<int>(bornes & 0xffffffffu);
+}
+
+}
+
+// Create the worker threads
+PoolThreads::PoolThreads(int nbThreads) {
+    if (nbThreads < 1) {
+        throw std::invalid_argument("Invalid number of threads: must be at least 1.");
+    }
+    this->nbThreads = nbThreads;
+    plages.reset(new Plage[nbThreads]);
+    for (int rang = 1; rang < nbThreads; rang++) {
+        workers.emplace_back(&PoolThreads::boucleWorker, this, rang);
+    }
+}
+
+// Stop and join the worker threads
+PoolThreads::~PoolThreads() {
+    {
+        std::lock_guard<std::mutex> verrou(mutex);
+        arret = true;
+    }
+    debutTravail.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+// Get the number of threads
+int PoolThreads::getNbThreads() const {
+    return nbThreads;
+}
+
+// Wait for jobs and run the tasks of this rank
+void PoolThreads::boucleWorker(int rang) {
+    long vue = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> verrou(mutex);
+            debutTravail.wait(verrou, [&] { return arret || generation != vue; });
+            if (arret) {
+                return;
+            }
+            vue = generation;
+        }
+
+        executerTaches(rang);
+
+        {
+            std::lock_guard<std::mutex> verrou(mutex);
+            nbActifs--;
+        }
+        finTravail.notify_one();
+    }
+}
+
+// Run the range of a rank, then steal until every range is empty
+void PoolThreads::executerTaches(int rang) {
+    executerPlage(rang);
+    // Visit the other ranks in turn, starting again after each successful theft
+    int k = 1;
+    while (k < nbThreads) {
+        if (voler((rang + k) % nbThreads, rang)) {
+            executerPlage(rang);
+            k = 1;
+        } else {
+            k++;
+        }
+    }
+}
+
+// Take the tasks of the range of a rank one at a time, from the front
+void PoolThreads::executerPlage(int rang) {
+    std::atomic<uint64_t> &bornes = plages[rang].bornes;
+    uint64_t courant = bornes.load(std::memory_order_acquire);
+    while (true) {
+        const int debut = debutPaquet(courant);
+        const int fin = finPaquet(courant);
+        if (debut >= fin) {
+            return;
+        }
+        const uint64_t suivant = paquet(debut + 1, fin);
+        if (bornes.compare_exchange_weak(courant, suivant, std::memory_order_acq_rel)) {
+            fonction(contexte, debut);
+            courant = bornes.load(std::memory_order_acquire);
+        }
+    }
+}
+
+// Take the back half of the range of another thread, the victim keeps the front half
+bool PoolThreads::voler(int victime, int rang) {
+    std::atomic<uint64_t> &bornes = plages[victime].bornes;
+    uint64_t courant = bornes.load(std::memory_order_acquire);
+    while (true) {
+        const int debut = debutPaquet(courant);
+        const int fin = finPaquet(courant);
+        if (debut >= fin) {
+            return false;
+        }
+        const int milieu = debut + (fin - debut) / 2;
+        if (bornes.compare_exchange_weak(courant, paquet(debut, milieu), std::memory_order_acq_rel)) {
+            // The range of the thief is empty, so no other thread writes it meanwhile
+            plages[rang].bornes.store(paquet(milieu, fin), std::memory_order_release);
+            return true;
+        }
+    }
+}
+
+// Run a job on every thread
+void PoolThreads::lancer(int nbTaches, const long *poidsCumules, void (*fonction)(void*, int), void *contexte) {
+    if (nbThreads == 1) {
+        for (int tache = 0; tache < nbTaches; tache++) {
+            fonction(contexte, tache);
+        }
+        return;
+    }
+
+    // Initial ranges: equal weights, or equal numbers of tasks
+    int debut = 0;
+    for (int rang = 0; rang < nbThreads; rang++) {
+        int fin = nbTaches;
+        if (rang + 1 < nbThreads) {
+            if (poidsCumules) {
+                const long cible = poidsCumules[nbTaches] * (rang + 1) / nbThreads;
+                fin = static_cast<int>(std::lower_bound(poidsCumules, poidsCumules + nbTaches + 1, cible) - poidsCumules);
+                fin = std::min(std::max(fin, debut), nbTaches);
+            } else {
+                fin = static_cast<int>(static_cast<long>(nbTaches) * (rang + 1) / nbThreads);
+            }
+        }
+        plages[rang].bornes.store(paquet(debut, fin), std::memory_order_relaxed);
+        debut = fin;
+    }
+
+    {
+        std::lock_guard<std::mutex> verrou(mutex);
+        this->fonction = fonction;
+        this->contexte = contexte;
+        this->nbTaches = nbTaches;
+        nbActifs = nbThreads - 1;
+        generation++;
+    }
+    debutTravail.notify_all();
+
+    // The calling thread works as rank 0
+    executerTaches(0);
+
+    std::unique_lock<std::mutex> verrou(mutex);
+    finTravail.wait(verrou, [&] { return nbActifs == 0; });
+}
@@ -0,0 +1,137 @@
+#include "PotentielTabule.hxx"
+#include <cmath>
+#include <stdexcept>
+
+const int PotentielTabule::LINEAIRE;
+const int PotentielTabule::CUBIQUE;
+
+// Lennard-Jones term
+PotentielTabule::Terme PotentielTabule::Terme::lennardJones(double eps, double sigma) {
+    const double sigma2 = sigma * sigma;
+    Terme terme;
+    terme.coefficient = [=](double r2) {
+        const double s6 = std::pow(sigma2 / r2, 3);
+        return 24 * eps / r2 * s6 * (1 - 2 * s6);
+    };
+    terme.energie = [=](double r2) {
+        const double s6 = std::pow(sigma2 / r2, 3);
+        return 4 * eps * s6 * (s6 - 1);
+    };
+    return terme;
+}
+
+// Lennard-Jones term with an energy shifted to zero at the cutoff radius
+PotentielTabule::Terme PotentielTabule::Terme::lennardJonesDecale(double eps, double sigma, double rCut) {
+    Terme terme = lennardJones(eps, sigma);
+    const double decalage = terme.energie(rCut * rCut);
+    const std::function<double(double)> energie = terme.energie;
+    terme.energie = [=](double r2) { return energie(r2) - decalage; };
+    return terme;
+}
+
+// Gravity-like term of the analytic kernel
+PotentielTabule::Terme PotentielTabule::Terme::gravitation() {
+    Terme terme;
+    terme.coefficient = [](double r2) { return 1 / (r2 * std::sqrt(r2)); };
+    terme.energie = [](double r2) { return -1 / std::sqrt(r2); };
+    terme.parMasse = true;
+    return terme;
+}
+
+// Default constructor
+PotentielTabule::PotentielTabule() {}
+
+// Sample the terms and build the polynomials of each interval
+PotentielTabule::PotentielTabule(const std::vector<Terme> &termes, double rMin, double rCut, int nbPoints, int interpolation)
+    : r2Min(rMin * rMin), r2Max(rCut * rCut), nbIntervalles(nbPoints - 1), interpolation(interpolation) {
+    if (rMin <= 0 || rCut <= rMin || nbPoints < 2) {
+        throw std::invalid_argument("Invalid table: 0 < rMin < rCut and at least 2 points are required.");
+    }
+    if (interpolation != LINEAIRE && interpolation != CUBIQUE) {
+        throw std::invalid_argument("Invalid interpolation: must be LINEAIRE or CUBIQUE.");
+    }
+    for (const Terme &terme : termes) {
+        if (!terme.coefficient || !terme.energie) {
+            throw std::invalid_argument("Invalid term: the coefficient and the energy are required.");
+        }
+    }
+    const double pas = (r2Max - r2Min) / nbIntervalles;
+    invPas = nbIntervalles / (r2Max - r2Min);
+
+    // Sum of the terms of one channel and its derivative along the interval (central differences)
+    const double h = std::min(pas * 1e-3, r2Min / 2);
+    auto evaluer = [&](bool parMasse, bool estEnergie, double r2, double &valeur, double &derivee) {
+        valeur = 0;
+        derivee = 0;
+        for (const Terme &terme : termes) {
+            if (terme.parMasse == parMasse) {
+                const std::function<double(double)> &f = estEnergie ? terme.energie : terme.coefficient;
+                valeur += f(r2);
+                derivee += (f(r2 + h) - f(r2 - h)) / (2 * h) * pas;
+            }
+        }
+    };
+
+    const int degre = (interpolation == CUBIQUE) ? 4 : 2;
+    force.assign(2 * degre * nbIntervalles, 0);
+    energie.assign(2 * degre * nbIntervalles, 0);
+    for (int canal = 0; canal < 4; canal++) {
+        const bool parMasse = canal % 2 == 1;
+        std::vector<double> &table = (canal < 2) ? force : energie;
+        double y0, d0;
+        evaluer(parMasse, canal >= 2, r2Min, y0, d0);
+        for (int k = 0; k < nbIntervalles; k++) {
+            double y1, d1;
+            evaluer(parMasse, canal >= 2, (k + 1 == nbIntervalles) ? r2Max : r2Min + (k + 1) * pas, y1, d1);
+            double *a = &table[2 * degre * k + (parMasse ? degre : 0)];
+            a[0] = y0;
+            if (interpolation == CUBIQUE) {
+                a[1] = d0;
+                a[2] = 3 * (y1 - y0) - 2 * d0 - d1;
+                a[3] = 2 * (y0 - y1) + d0 + d1;
+            } else {
+                a[1] = y1 - y0;
+            }
+            y0 = y1;
+            d0 = d1;
+        }
+    }
+}
+
+// Energy of a pair seen from particle i
+double PotentielTabule::getEnergie(double r2, double masse) const {
+    double t;
+    const int k = intervalle(r2, t);
+    if (interpolation == CUBIQUE) {
+        const double *a = &energie[8 * k];
+        return a[0] + t * (a[1] + t * (a[2] + t * a[3])) + masse * (a[4] + t * (a[5] + t * (a[6] + t * a[7])));
+    }
+    const double *a = &energie[4 * k];
+    return a[0] + t * a[1] + masse * (a[2] + t * a[3]);
+}
+
+// Write the table
+void PotentielTabule::ecrire(EcritureReprise &reprise) const {
+    reprise.ecrire(r2Min);
+    reprise.ecrire(r2Max);
+    reprise.ecrire<int32_t>(nbIntervalles);
+    reprise.ecrire<int32_t>(interpolation);
+    reprise.ecrireTableau(force);
+    reprise.ecrireTableau(energie);
+}
+
+// Read the table
+void PotentielTabule::lire(LectureReprise &reprise) {
+    r2Min = reprise.lire<double>();
+    r2Max = reprise.lire<double>();
+    nbIntervalles = reprise.lire<int32_t>();
+    interpolation = reprise.lire<int32_t>();
+    reprise.lireTableau(force);
+    reprise.lireTableau(energie);
+    const size_t taille = static_cast<size_t>((interpolation == CUBIQUE) ? 8 : 4) * std::max(nbIntervalles, 0);
+    if (r2Min <= 0 || r2Max <= r2Min || nbIntervalles < 1 || (interpolation != LINEAIRE && interpolation != CUBIQUE) ||
+        force.size() != taille || energie.size() != taille) {
+        throw std::runtime_error("Invalid potential table in restart file.");
+    }
+    invPas = nbIntervalles / (r2Max - r2Min);
+}
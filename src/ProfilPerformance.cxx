@@ -0,0 +1,179 @@
+#include "ProfilPerformance.hxx"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+const char *NOMS_PHASES[ProfilPerformance::NB_PHASES] = {"positions", "conditions_limites", "cellules", "forces", "vitesses", "sortie"};
+
+}
+
+// Start timing a phase
+ProfilPerformance::Chrono::Chrono(ProfilPerformance &profilMesure, int phase)
+    : profil(profilMesure.actif ? &profilMesure : nullptr), phase(phase) {
+    if (this->profil) {
+        debut = std::chrono::steady_clock::now();
+    }
+}
+
+// Add the elapsed time to the phase
+ProfilPerformance::Chrono::~Chrono() {
+    if (profil) {
+        profil->ajouterTemps(phase, std::chrono::duration<double>(std::chrono::steady_clock::now() - debut).count());
+    }
+}
+
+// Enable or disable the recording
+void ProfilPerformance::setActif(bool actif) {
+    this->actif = actif;
+}
+
+// Tell whether the recording is enabled
+bool ProfilPerformance::estActif() const {
+    return actif;
+}
+
+// Reset every timer, counter and statistic
+void ProfilPerformance::reinitialiser() {
+    std::fill(temps, temps + NB_PHASES, 0.0);
+    std::fill(nbAppels, nbAppels + NB_PHASES, 0L);
+    nbPairesTestees = 0;
+    nbPairesActives = 0;
+    nbCellules = 0;
+    nbCellulesVides = 0;
+    occupationMin = 0;
+    occupationMax = 0;
+    occupationMoyenne = 0;
+    occupationEcartType = 0;
+}
+
+// Add a measure to a phase
+void ProfilPerformance::ajouterTemps(int phase, double secondes) {
+    temps[phase] += secondes;
+    nbAppels[phase]++;
+}
+
+// Add the pair counts of a force pass
+void ProfilPerformance::ajouterPaires(long testees, long actives) {
+    nbPairesTestees += testees;
+    nbPairesActives += actives;
+}
+
+// Compute the occupancy statistics of the cells
+void ProfilPerformance::mesurerOccupation(const ParticuleStore &store, int nbCellules) {
+    this->nbCellules = nbCellules;
+    nbCellulesVides = 0;
+    occupationMin = 0;
+    occupationMax = 0;
+    occupationMoyenne = 0;
+    occupationEcartType = 0;
+    if (nbCellules <= 0) {
+        return;
+    }
+
+    double somme = 0, somme2 = 0;
+    occupationMin = store.cellEnd(0) - store.cellStart(0);
+    for (int c = 0; c < nbCellules; c++) {
+        const int nb = store.cellEnd(c) - store.cellStart(c);
+        nbCellulesVides += (nb == 0);
+        occupationMin = std::min(occupationMin, nb);
+        occupationMax = std::max(occupationMax, nb);
+        somme += nb;
+        somme2 += static_cast<double>(nb) * nb;
+    }
+    occupationMoyenne = somme / nbCellules;
+    occupationEcartType = std::sqrt(std::max(0.0, somme2 / nbCellules - occupationMoyenne * occupationMoyenne));
+}
+
+// Get the name of a phase
+const char *ProfilPerformance::getNomPhase(int phase) {
+    if (phase < 0 || phase >= NB_PHASES) {
+        throw std::out_of_range("Invalid phase index.");
+    }
+    return NOMS_PHASES[phase];
+}
+
+// Get the time spent in a phase
+double ProfilPerformance::getTemps(int phase) const {
+    return temps[phase];
+}
+
+// Get the number of measures of a phase
+long ProfilPerformance::getNbAppels(int phase) const {
+    return nbAppels[phase];
+}
+
+// Get the number of pair distances evaluated
+long ProfilPerformance::getNbPairesTestees() const {
+    return nbPairesTestees;
+}
+
+// Get the number of pairs within the cutoff radius
+long ProfilPerformance::getNbPairesActives() const {
+    return nbPairesActives;
+}
+
+// Get the number of empty cells
+int ProfilPerformance::getNbCellulesVides() const {
+    return nbCellulesVides;
+}
+
+// Get the largest occupancy
+int ProfilPerformance::getOccupationMax() const {
+    return occupationMax;
+}
+
+// Get the mean occupancy
+double ProfilPerformance::getOccupationMoyenne() const {
+    return occupationMoyenne;
+}
+
+// Write the report as JSON
+void ProfilPerformance::ecrireJSON(const std::string &fichier, int iteration, double t) const {
+    std::ofstream file(fichier);
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open file " + fichier + " for writing.");
+    }
+    double total = 0;
+    for (int p = 0; p < NB_PHASES; p++) {
+        total += temps[p];
+    }
+
+    file << "{\n";
+    file << "  \"iteration\": " << iteration << ",\n";
+    file << "  \"temps_simule\": " << t << ",\n";
+    file << "  \"temps_total\": " << total << ",\n";
+    file << "  \"phases\": {\n";
+    for (int p = 0; p < NB_PHASES; p++) {
+        file << "    \"" << NOMS_PHASES[p] << "\": {\"temps\": " << temps[p] << ", \"appels\": " << nbAppels[p]
+             << ", \"fraction\": " << ((total > 0) ? temps[p] / total : 0) << "}" << ((p + 1 < NB_PHASES) ? ",\n" : "\n");
+    }
+    file << "  },\n";
+    file << "  \"paires\": {\"testees\": " << nbPairesTestees << ", \"actives\": " << nbPairesActives << "},\n";
+    file << "  \"occupation\": {\"cellules\": " << nbCellules << ", \"vides\": " << nbCellulesVides << ", \"min\": " << occupationMin
+         << ", \"max\": " << occupationMax << ", \"moyenne\": " << occupationMoyenne << ", \"ecart_type\": " << occupationEcartType << "}\n";
+    file << "}\n";
+}
+
+// Append the report as a CSV line
+void ProfilPerformance::ecrireCSV(const std::string &fichier, int iteration, double t, bool entete) const {
+    std::ofstream file(fichier, entete ? std::ios::trunc : std::ios::app);
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open file " + fichier + " for writing.");
+    }
+    if (entete) {
+        file << "iteration;temps_simule";
+        for (int p = 0; p < NB_PHASES; p++) {
+            file << ";" << NOMS_PHASES[p];
+        }
+        file << ";paires_testees;paires_actives;cellules;cellules_vides;occupation_min;occupation_max;occupation_moyenne;occupation_ecart_type\n";
+    }
+    file << iteration << ";" << t;
+    for (int p = 0; p < NB_PHASES; p++) {
+        file << ";" << temps[p];
+    }
+    file << ";" << nbPairesTestees << ";" << nbPairesActives << ";" << nbCellules << ";" << nbCellulesVides << ";" << occupationMin << ";"
+         << occupationMax << ";" << occupationMoyenne << ";" << occupationEcartType << "\n";
+}
@@ -0,0 +1,76 @@
+#include "Reprise.hxx"
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const char MAGIQUE[8] = {'T', 'P', 'C', 'P', 'P', 'R', 'E', 'P'};  // Start and end marker of the files
+const uint32_t VERSION = 7;  // Format version written (2: sparse grid, 3: tabulated potential, 4: force field, 5: thermostat, 6: adaptive step, 7: slab of the rank)
+const uint32_t BOUTISME = 0x01020304;  // Reads 0x04030201 on a machine of the other endianness
+
+}
+
+// Open the temporary file and write the header
+EcritureReprise::EcritureReprise(const std::string &fichier)
+    : fichier(fichier), temporaire(fichier + ".tmp"), flux(temporaire, std::ios::binary | std::ios::trunc) {
+    if (!flux) {
+        throw std::runtime_error("Unable to open file " + temporaire + " for writing.");
+    }
+    ecrireOctets(MAGIQUE, sizeof(MAGIQUE));
+    ecrire(VERSION);
+    ecrire(BOUTISME);
+}
+
+// Write raw bytes
+void EcritureReprise::ecrireOctets(const void *data, size_t taille) {
+    flux.write(static_cast<const char *>(data), static_cast<std::streamsize>(taille));
+}
+
+// Write the end marker, then replace the restart file
+void EcritureReprise::terminer() {
+    ecrireOctets(MAGIQUE, sizeof(MAGIQUE));
+    flux.close();
+    if (flux.fail()) {
+        std::remove(temporaire.c_str());
+        throw std::runtime_error("Error while writing file " + temporaire + ".");
+    }
+    if (std::rename(temporaire.c_str(), fichier.c_str()) != 0) {
+        throw std::runtime_error("Unable to rename " + temporaire + " to " + fichier + ".");
+    }
+}
+
+// Open the file and check its header
+LectureReprise::LectureReprise(const std::string &fichier) : fichier(fichier), flux(fichier, std::ios::binary) {
+    if (!flux) {
+        throw std::runtime_error("Unable to open file " + fichier + " for reading.");
+    }
+    char magique[sizeof(MAGIQUE)];
+    lireOctets(magique, sizeof(magique));
+    if (std::memcmp(magique, MAGIQUE, sizeof(MAGIQUE)) != 0) {
+        throw std::runtime_error("File " + fichier + " is not a restart file.");
+    }
+    version = lire<uint32_t>();
+    if (version == 0 || version > VERSION) {
+        throw std::runtime_error("Unsupported restart file version " + std::to_string(version) + " in " + fichier + ".");
+    }
+    if (lire<uint32_t>() != BOUTISME) {
+        throw std::runtime_error("Restart file " + fichier + " was written on a machine of another endianness.");
+    }
+}
+
+// Read raw bytes
+void LectureReprise::lireOctets(void *data, size_t taille) {
+    flux.read(static_cast<char *>(data), static_cast<std::streamsize>(taille));
+    if (flux.gcount() != static_cast<std::streamsize>(taille)) {
+        throw std::runtime_error("Restart file " + fichier + " is truncated.");
+    }
+}
+
+// Check the end marker
+void LectureReprise::terminer() {
+    char magique[sizeof(MAGIQUE)];
+    lireOctets(magique, sizeof(magique));
+    if (std::memcmp(magique, MAGIQUE, sizeof(MAGIQUE)) != 0) {
+        throw std::runtime_error("Restart file " + fichier + " is corrupted.");
+    }
+}
@@ -0,0 +1,114 @@
+#include "Statistiques.hxx"
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+const int Statistiques::NB_REELS;
+
+namespace {
+
+const char MAGIQUE[8] = {'T', 'P', 'C', 'P', 'P', 'S', 'T', 'A'};  // Start of the binary files
+const uint32_t VERSION = 1;  // Format version written
+const uint32_t BOUTISME = 0x01020304;  // Reads 0x04030201 on a machine of the other endianness
+
+// Floating-point fields of a measure, in the order of the files
+void reels(const Statistiques &s, double *valeurs) {
+    const double champs[Statistiques::NB_REELS] = {s.temps, s.energieCinetique, s.energiePotentielle, s.quantiteMouvement[0],
+                                                   s.quantiteMouvement[1], s.quantiteMouvement[2], s.temperature, s.pression, s.viriel};
+    std::memcpy(valeurs, champs, sizeof(champs));
+}
+
+// Write a value to a binary stream
+template <typename T>
+void ecrireValeur(std::ostream &flux, const T &valeur) {
+    flux.write(reinterpret_cast<const char *>(&valeur), sizeof(T));
+}
+
+// Read a value from a binary stream, false if the stream ends first
+template <typename T>
+bool lireValeur(std::istream &flux, T &valeur) {
+    flux.read(reinterpret_cast<char *>(&valeur), sizeof(T));
+    return flux.gcount() == static_cast<std::streamsize>(sizeof(T));
+}
+
+}
+
+// Create the file and write its header
+SerieStatistiques::SerieStatistiques(const std::string &fichier) : fichier(fichier) {
+    const std::string extension = ".csv";
+    csv = fichier.size() >= extension.size() && fichier.compare(fichier.size() - extension.size(), extension.size(), extension) == 0;
+    flux.open(fichier, csv ? std::ios::trunc : std::ios::binary | std::ios::trunc);
+    if (!flux) {
+        throw std::runtime_error("Unable to open file " + fichier + " for writing.");
+    }
+    if (csv) {
+        flux.precision(std::numeric_limits<double>::max_digits10);
+        flux << "iteration;nb_particules;temps;energie_cinetique;energie_potentielle;px;py;pz;temperature;pression;viriel;energie_totale\n";
+    } else {
+        flux.write(MAGIQUE, sizeof(MAGIQUE));
+        ecrireValeur(flux, VERSION);
+        ecrireValeur(flux, BOUTISME);
+    }
+}
+
+// Append a measure
+void SerieStatistiques::ajouter(const Statistiques &statistiques) {
+    double valeurs[Statistiques::NB_REELS];
+    reels(statistiques, valeurs);
+    if (csv) {
+        flux << statistiques.iteration << ";" << statistiques.nbParticules;
+        for (double valeur : valeurs) {
+            flux << ";" << valeur;
+        }
+        flux << ";" << statistiques.getEnergieTotale() << "\n";
+    } else {
+        ecrireValeur<int32_t>(flux, statistiques.iteration);
+        ecrireValeur<int64_t>(flux, statistiques.nbParticules);
+        flux.write(reinterpret_cast<const char *>(valeurs), sizeof(valeurs));
+    }
+    if (!flux) {
+        throw std::runtime_error("Unable to write to file " + fichier + ".");
+    }
+    nbMesures++;
+}
+
+// Flush the stream
+void SerieStatistiques::vider() {
+    flux.flush();
+}
+
+// Read the measures of a binary file
+std::vector<Statistiques> SerieStatistiques::lire(const std::string &fichier) {
+    std::ifstream flux(fichier, std::ios::binary);
+    if (!flux) {
+        throw std::runtime_error("Unable to open file " + fichier + " for reading.");
+    }
+    char magique[sizeof(MAGIQUE)];
+    flux.read(magique, sizeof(magique));
+    uint32_t version = 0, boutisme = 0;
+    if (flux.gcount() != sizeof(magique) || std::memcmp(magique, MAGIQUE, sizeof(MAGIQUE)) != 0 || !lireValeur(flux, version) ||
+        !lireValeur(flux, boutisme) || version == 0 || version > VERSION || boutisme != BOUTISME) {
+        throw std::runtime_error("File " + fichier + " is not a statistics series of this machine.");
+    }
+
+    std::vector<Statistiques> mesures;
+    int32_t iteration;
+    int64_t nbParticules;
+    double valeurs[Statistiques::NB_REELS];
+    while (lireValeur(flux, iteration) && lireValeur(flux, nbParticules) && lireValeur(flux, valeurs)) {
+        Statistiques s;
+        s.iteration = iteration;
+        s.nbParticules = static_cast<long>(nbParticules);
+        s.temps = valeurs[0];
+        s.energieCinetique = valeurs[1];
+        s.energiePotentielle = valeurs[2];
+        s.quantiteMouvement[0] = valeurs[3];
+        s.quantiteMouvement[1] = valeurs[4];
+        s.quantiteMouvement[2] = valeurs[5];
+        s.temperature = valeurs[6];
+        s.pression = valeurs[7];
+        s.viriel = valeurs[8];
+        mesures.push_back(s);
+    }
+    return mesures;
+}
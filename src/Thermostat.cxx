@@ -0,0 +1,76 @@
+#include "Thermostat.hxx"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+const int Thermostat::AUCUN;
+const int Thermostat::BERENDSEN;
+const int Thermostat::LANGEVIN;
+const int Thermostat::NOSE_HOOVER;
+
+// Default constructor
+Thermostat::Thermostat() {}
+
+// Check and keep the parameters
+Thermostat::Thermostat(int type, double temperature, double tempsCouplage, uint64_t graine)
+    : type(type), temperatureCible(temperature), tempsCouplage(tempsCouplage), graine(graine) {
+    if (type < AUCUN || type > NOSE_HOOVER) {
+        throw std::invalid_argument("Invalid thermostat: unknown type.");
+    }
+    if (!(temperature >= 0)) {
+        throw std::invalid_argument("Invalid thermostat: the target temperature must be positive or 0.");
+    }
+    if (type == NOSE_HOOVER && temperature == 0) {
+        throw std::invalid_argument("Invalid thermostat: Nose-Hoover needs a positive target temperature.");
+    }
+    if (!(tempsCouplage > 0)) {
+        throw std::invalid_argument("Invalid thermostat: the coupling time must be positive.");
+    }
+}
+
+// Factors of the step from the temperature of the previous one
+void Thermostat::preparer(double temperature, double dt) {
+    echelle = 1;
+    bruit = 0;
+    switch (type) {
+        case BERENDSEN:
+            // Without kinetic energy there is nothing to rescale
+            if (temperature > 0) {
+                echelle = std::sqrt(std::max(0.0, 1 + dt / tempsCouplage * (temperatureCible / temperature - 1)));
+            }
+            break;
+        case LANGEVIN:
+            echelle = std::exp(-dt / tempsCouplage);
+            bruit = std::sqrt((1 - echelle * echelle) * temperatureCible);
+            break;
+        case NOSE_HOOVER:
+            friction += dt / (tempsCouplage * tempsCouplage) * (temperature / temperatureCible - 1);
+            echelle = std::exp(-friction * dt);
+            break;
+        default:
+            break;
+    }
+}
+
+// Parameters and friction
+void Thermostat::ecrire(EcritureReprise &reprise) const {
+    reprise.ecrire<int32_t>(type);
+    reprise.ecrire(temperatureCible);
+    reprise.ecrire(tempsCouplage);
+    reprise.ecrire(graine);
+    reprise.ecrire(friction);
+}
+
+// Parameters and friction, checked like the constructor
+void Thermostat::lire(LectureReprise &reprise) {
+    const int lu = reprise.lire<int32_t>();
+    const double temperature = reprise.lire<double>();
+    const double couplage = reprise.lire<double>();
+    const uint64_t g = reprise.lire<uint64_t>();
+    const double xi = reprise.lire<double>();
+    if (lu < AUCUN || lu > NOSE_HOOVER || !(temperature >= 0) || !(couplage > 0) || !std::isfinite(xi)) {
+        throw std::runtime_error("Invalid thermostat in restart file.");
+    }
+    *this = Thermostat(lu, temperature, couplage, g);
+    friction = xi;
+}
@@ -0,0 +1,220 @@
+#include "Trajectoire.hxx"
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include "EcritureVTK.hxx"
+
+namespace {
+
+const char MAGIQUE[8] = {'T', 'P', 'C', 'P', 'P', 'T', 'R', 'J'};  // Start of the files
+const uint32_t VERSION = 1;  // Format version written
+const uint32_t BOUTISME = 0x01020304;  // Reads 0x04030201 on a machine of the other endianness
+const uint32_t MARQUEUR_FRAME = 0x4D415246;  // "FRAM" in little endian
+const uint64_t TAILLE_ENTETE = sizeof(MAGIQUE) + 3 * sizeof(uint32_t);  // Size of the file header
+const uint64_t TAILLE_ENTETE_FRAME = 2 * sizeof(uint32_t) + 2 * sizeof(uint64_t) + sizeof(int32_t) + sizeof(double);  // Size of a frame header
+const uint64_t OCTETS_PAR_PARTICULE = 6 * sizeof(float) + 2 * sizeof(int32_t);  // Size of the data of a particle
+
+// Write a value to a binary stream
+template <typename T>
+void ecrireValeur(std::ostream &flux, const T &valeur) {
+    flux.write(reinterpret_cast<const char *>(&valeur), sizeof(T));
+}
+
+// Write an array to a binary stream in one block
+template <typename T>
+void ecrireBloc(std::ostream &flux, const std::vector<T> &tableau) {
+    flux.write(reinterpret_cast<const char *>(tableau.data()), static_cast<std::streamsize>(tableau.size() * sizeof(T)));
+}
+
+// Read a value from a binary stream, false if the stream ends first
+template <typename T>
+bool lireValeur(std::istream &flux, T &valeur) {
+    flux.read(reinterpret_cast<char *>(&valeur), sizeof(T));
+    return flux.gcount() == static_cast<std::streamsize>(sizeof(T));
+}
+
+}
+
+const size_t EcritureTrajectoire::TAILLE_TAMPON;
+
+// Create the file, or keep the frames of an existing one up to a step index
+EcritureTrajectoire::EcritureTrajectoire(const std::string &fichier, int dimension, int derniereIteration)
+    : fichier(fichier), tampon(new char[TAILLE_TAMPON]) {
+    flux.rdbuf()->pubsetbuf(tampon.get(), TAILLE_TAMPON);
+    if (derniereIteration >= 0 && std::filesystem::exists(fichier)) {
+        uint64_t fin;
+        {
+            LectureTrajectoire lecture(fichier);
+            if (lecture.getDimension() != dimension) {
+                throw std::runtime_error("Trajectory file " + fichier + " was written for another dimension.");
+            }
+            fin = lecture.getFinDonnees();
+            nbFrames = static_cast<uint32_t>(lecture.getNbFrames());
+            for (int k = 0; k < lecture.getNbFrames(); k++) {
+                if (lecture.getEntree(k).iteration > derniereIteration) {
+                    fin = lecture.getEntree(k).decalage;
+                    nbFrames = static_cast<uint32_t>(k);
+                    break;
+                }
+            }
+        }
+        std::filesystem::resize_file(fichier, fin);
+        flux.open(fichier, std::ios::binary | std::ios::app);
+    } else {
+        flux.open(fichier, std::ios::binary | std::ios::trunc);
+        flux.write(MAGIQUE, sizeof(MAGIQUE));
+        ecrireValeur(flux, VERSION);
+        ecrireValeur(flux, BOUTISME);
+        ecrireValeur<uint32_t>(flux, dimension);
+    }
+    if (!flux) {
+        throw std::runtime_error("Unable to open file " + fichier + " for writing.");
+    }
+}
+
+// Append a frame: header, then each array in one block
+void EcritureTrajectoire::ecrire(const ParticuleStore &store, int iteration, double temps) {
+    const uint64_t n = store.getNbParticules();
+    ecrireValeur(flux, MARQUEUR_FRAME);
+    ecrireValeur<uint64_t>(flux, TAILLE_ENTETE_FRAME + n * OCTETS_PAR_PARTICULE);
+    ecrireValeur(flux, nbFrames);
+    ecrireValeur<int32_t>(flux, iteration);
+    ecrireValeur(flux, temps);
+    ecrireValeur(flux, n);
+
+    scratch.resize(3 * n);
+    for (uint64_t i = 0; i < n; i++) {
+        scratch[3 * i] = static_cast<float>(store.x[i]);
+        scratch[3 * i + 1] = static_cast<float>(store.y[i]);
+        scratch[3 * i + 2] = static_cast<float>(store.z[i]);
+    }
+    ecrireBloc(flux, scratch);
+    for (uint64_t i = 0; i < n; i++) {
+        scratch[3 * i] = static_cast<float>(store.vx[i]);
+        scratch[3 * i + 1] = static_cast<float>(store.vy[i]);
+        scratch[3 * i + 2] = static_cast<float>(store.vz[i]);
+    }
+    ecrireBloc(flux, scratch);
+    scratchEntiers.assign(store.categorie.begin(), store.categorie.end());
+    ecrireBloc(flux, scratchEntiers);
+    scratchEntiers.assign(store.id.begin(), store.id.end());
+    ecrireBloc(flux, scratchEntiers);
+
+    if (!flux) {
+        throw std::runtime_error("Error while writing file " + fichier + ".");
+    }
+    nbFrames++;
+}
+
+// Write the buffered frames
+void EcritureTrajectoire::vider() {
+    flux.flush();
+    if (!flux) {
+        throw std::runtime_error("Error while writing file " + fichier + ".");
+    }
+}
+
+// Check the header, then hop from frame to frame to index them
+LectureTrajectoire::LectureTrajectoire(const std::string &fichier) : fichier(fichier), flux(fichier, std::ios::binary) {
+    if (!flux) {
+        throw std::runtime_error("Unable to open file " + fichier + " for reading.");
+    }
+    char magique[sizeof(MAGIQUE)];
+    flux.read(magique, sizeof(magique));
+    uint32_t version = 0, boutisme = 0, dim = 0;
+    if (flux.gcount() != sizeof(magique) || std::memcmp(magique, MAGIQUE, sizeof(MAGIQUE)) != 0 || !lireValeur(flux, version) ||
+        !lireValeur(flux, boutisme) || !lireValeur(flux, dim)) {
+        throw std::runtime_error("File " + fichier + " is not a trajectory file.");
+    }
+    if (version == 0 || version > VERSION) {
+        throw std::runtime_error("Unsupported trajectory file version " + std::to_string(version) + " in " + fichier + ".");
+    }
+    if (boutisme != BOUTISME) {
+        throw std::runtime_error("Trajectory file " + fichier + " was written on a machine of another endianness.");
+    }
+    dimension = static_cast<int>(dim);
+
+    const uint64_t tailleFichier = std::filesystem::file_size(fichier);
+    uint64_t decalage = TAILLE_ENTETE;
+    while (decalage + TAILLE_ENTETE_FRAME <= tailleFichier) {
+        flux.seekg(static_cast<std::streamoff>(decalage));
+        uint32_t marqueur, numero;
+        uint64_t taille, n;
+        int32_t iteration;
+        double temps;
+        if (!lireValeur(flux, marqueur) || !lireValeur(flux, taille) || !lireValeur(flux, numero) || !lireValeur(flux, iteration) ||
+            !lireValeur(flux, temps) || !lireValeur(flux, n)) {
+            break;
+        }
+        if (marqueur != MARQUEUR_FRAME || taille != TAILLE_ENTETE_FRAME + n * OCTETS_PAR_PARTICULE) {
+            throw std::runtime_error("Corrupted frame " + std::to_string(index.size()) + " in trajectory file " + fichier + ".");
+        }
+        if (decalage + taille > tailleFichier) {
+            // Frame cut short by the end of the file
+            break;
+        }
+        index.push_back({decalage, iteration, temps, n});
+        decalage += taille;
+    }
+    finDonnees = decalage;
+    flux.clear();
+}
+
+// Get the header of a frame
+const LectureTrajectoire::Entree &LectureTrajectoire::getEntree(int k) const {
+    if (k < 0 || k >= getNbFrames()) {
+        throw std::out_of_range("Invalid frame index: " + std::to_string(k) + ".");
+    }
+    return index[k];
+}
+
+// Read the arrays of a frame
+void LectureTrajectoire::lireFrame(int k, FrameTrajectoire &frame) {
+    const Entree &entree = getEntree(k);
+    const uint64_t n = entree.nbParticules;
+    frame.iteration = entree.iteration;
+    frame.temps = entree.temps;
+    frame.positions.resize(3 * n);
+    frame.vitesses.resize(3 * n);
+    frame.categories.resize(n);
+    frame.ids.resize(n);
+
+    flux.seekg(static_cast<std::streamoff>(entree.decalage + TAILLE_ENTETE_FRAME));
+    flux.read(reinterpret_cast<char *>(frame.positions.data()), static_cast<std::streamsize>(3 * n * sizeof(float)));
+    flux.read(reinterpret_cast<char *>(frame.vitesses.data()), static_cast<std::streamsize>(3 * n * sizeof(float)));
+    flux.read(reinterpret_cast<char *>(frame.categories.data()), static_cast<std::streamsize>(n * sizeof(int32_t)));
+    flux.read(reinterpret_cast<char *>(frame.ids.data()), static_cast<std::streamsize>(n * sizeof(int32_t)));
+    if (!flux) {
+        flux.clear();
+        throw std::runtime_error("Error while reading frame " + std::to_string(k) + " of " + fichier + ".");
+    }
+}
+
+// Write one .vtu file per frame and the .pvd collection that lists them with their time
+void LectureTrajectoire::exporterVTK(const std::string &prefixe, int format) {
+    EcritureVTK ecriture(format);
+    FrameTrajectoire frame;
+    std::vector<float> categories;
+    const std::string nom = std::filesystem::path(prefixe).filename().string();
+
+    std::ofstream pvd(prefixe + ".pvd");
+    if (!pvd) {
+        throw std::runtime_error("Unable to open file " + prefixe + ".pvd for writing.");
+    }
+    pvd << "<?xml version=\"1.0\"?>\n";
+    pvd << "<VTKFile type=\"Collection\" version=\"0.1\">\n";
+    pvd << "  <Collection>\n";
+    for (int k = 0; k < getNbFrames(); k++) {
+        lireFrame(k, frame);
+        categories.assign(frame.categories.begin(), frame.categories.end());
+        ecriture.preparer(frame.positions.data(), frame.vitesses.data(), categories.data(), frame.getNbParticules());
+        const std::string suffixe = "_t" + std::to_string(frame.iteration) + ".vtu";
+        ecriture.ecrire(prefixe + suffixe);
+        pvd << "    <DataSet timestep=\"" << frame.temps << "\" group=\"\" part=\"0\" file=\"" << nom << suffixe << "\"/>\n";
+    }
+    pvd << "  </Collection>\n";
+    pvd << "</VTKFile>\n";
+    if (!pvd) {
+        throw std::runtime_error("Error while writing file " + prefixe + ".pvd.");
+    }
+}
@@ -6,6 +6,8 @@
 #include <stdexcept>
 #include <vector>
 #include <sstream>
+#include <algorithm>
+#include <atomic>
 
 #include "Cellule.hxx"
 #include "Particule3D.hxx"
@@ -15,6 +17,341 @@ void logError(const std::string &message) {
     std::cerr << "Error: " << message << std::endl;
 }
 
+namespace {
+
+/**
+ * @brief Reserves room for a number of elements with a margin of one half, when the
+ * capacity is too small.
+ *
+ * The sparse grid changes size at each rebuild: the margin keeps a growing grid
+ * from reallocating its arrays at every rebuild.
+ */
+template <typename T>
+void reserverAvecMarge(std::vector<T> &data, size_t n) {
+    if (data.capacity() < n) {
+        data.reserve(n + n / 2);
+    }
+}
+
+/**
+ * @brief Interaction of a pair through a pair law, applied to both particles.
+ *
+ * The pair is evaluated with squared distances; the law gives the coefficients of
+ * the forces on i and on j, which differ by the gravitational part, each one using
+ * the mass of the particle it acts on.
+ *
+ * @tparam DIM 2 to skip the z components, 3 for the full vectors.
+ * @tparam BORNER true to cap each force component to [-1e5, 1e5].
+ * @tparam Loi LoiAnalytique, LoiTabulee or LoiChamp, whose coefficients(i, j, r2, coef_i, coef_j)
+ *         gives the coefficients of the forces on i and on j.
+ */
+template <int DIM, bool BORNER, typename Loi>
+struct InteractionLoi {
+    const ReelPosition *x, *y, *z;
+    ReelForce *fx, *fy, *fz;
+    double rCut2;
+    Loi loi;
+
+    // Adds the force on i to (fxi, fyi, fzi) and subtracts the force on j from its store entry.
+    // Returns true if the pair is within the cutoff radius.
+    inline bool operator()(int i, int j, double &fxi, double &fyi, double &fzi) const {
+        double rx = static_cast<double>(x[j]) - x[i];
+        double ry = static_cast<double>(y[j]) - y[i];
+        double rz = (DIM == 3) ? static_cast<double>(z[j]) - z[i] : 0.0;
+        double r2 = rx * rx + ry * ry + rz * rz;
+        if (r2 == 0.0 || r2 >= rCut2) {
+            return false;
+        }
+        double coef_i, coef_j;
+        loi.coefficients(i, j, r2, coef_i, coef_j);
+
+        double fix = rx * coef_i, fiy = ry * coef_i, fiz = rz * coef_i;
+        double fjx = rx * coef_j, fjy = ry * coef_j, fjz = rz * coef_j;
+        // Cap the forces to avoid numerical instabilities
+        if (BORNER) {
+            fix = std::min(std::max(fix, -1e5), 1e5);
+            fiy = std::min(std::max(fiy, -1e5), 1e5);
+            fiz = std::min(std::max(fiz, -1e5), 1e5);
+            fjx = std::min(std::max(fjx, -1e5), 1e5);
+            fjy = std::min(std::max(fjy, -1e5), 1e5);
+            fjz = std::min(std::max(fjz, -1e5), 1e5);
+        }
+        fxi += fix;
+        fyi += fiy;
+        fx[j] -= fjx;
+        fy[j] -= fjy;
+        if (DIM == 3) {
+            fzi += fiz;
+            fz[j] -= fjz;
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief Law of a tabulated potential: the coefficients read in PotentielTabule.
+ */
+struct LoiTabulee {
+    const PotentielTabule *potentiel;
+    const float *masse;
+
+    inline double coefficient(int i, int, double r2) const {
+        double coef, coefMasse;
+        potentiel->coefficients(r2, coef, coefMasse);
+        return coef + masse[i] * coefMasse;
+    }
+
+    inline void coefficients(int i, int j, double r2, double &coef_i, double &coef_j) const {
+        double coef, coefMasse;
+        potentiel->coefficients(r2, coef, coefMasse);
+        coef_i = coef + masse[i] * coefMasse;
+        coef_j = coef + masse[j] * coefMasse;
+    }
+
+    // Energy of the pair, the mean of the energies seen from i and from j, and its virial
+    inline void mesurer(int i, int j, double r2, double &energie, double &viriel) const {
+        double coef_i, coef_j;
+        coefficients(i, j, r2, coef_i, coef_j);
+        energie = 0.5 * (potentiel->getEnergie(r2, masse[i]) + potentiel->getEnergie(r2, masse[j]));
+        viriel = -0.5 * (coef_i + coef_j) * r2;
+    }
+};
+
+/**
+ * @brief Law of a force field: the law P with the parameters of the categories of the pair.
+ *
+ * @tparam P LoiLennardJones, LoiMorse, LoiSphereMolle or LoiCoulomb.
+ */
+template <typename P>
+struct LoiChamp {
+    const double *table;
+    const int *categorie;
+    int nbCategories;
+    const float *masse;
+    bool gravitation;
+
+    inline double coefficient(int i, int j, double r2) const {
+        double coef = P::coefficient(table + ChampForces::TAILLE_LIGNE * (categorie[i] * nbCategories + categorie[j]), r2);
+        if (gravitation) {
+            coef += masse[i] / (r2 * std::sqrt(r2));
+        }
+        return coef;
+    }
+
+    inline void coefficients(int i, int j, double r2, double &coef_i, double &coef_j) const {
+        // The laws are symmetric, the row of (i, j) serves both particles
+        const double coef = P::coefficient(table + ChampForces::TAILLE_LIGNE * (categorie[i] * nbCategories + categorie[j]), r2);
+        coef_i = coef;
+        coef_j = coef;
+        if (gravitation) {
+            const double inv_r3 = 1 / (r2 * std::sqrt(r2));
+            coef_i += masse[i] * inv_r3;
+            coef_j += masse[j] * inv_r3;
+        }
+    }
+
+    // Energy of the pair, the gravitational part being the mean of -m_i / r and -m_j / r, and its virial
+    inline void mesurer(int i, int j, double r2, double &energie, double &viriel) const {
+        const double *p = table + ChampForces::TAILLE_LIGNE * (categorie[i] * nbCategories + categorie[j]);
+        energie = P::energie(p, r2);
+        double coef = P::coefficient(p, r2);
+        if (gravitation) {
+            const double inv_r = 1 / std::sqrt(r2);
+            energie -= 0.5 * (masse[i] + masse[j]) * inv_r;
+            coef += 0.5 * (masse[i] + masse[j]) * inv_r * inv_r * inv_r;
+        }
+        viriel = -coef * r2;
+    }
+};
+
+/**
+ * @brief Law of the analytic kernel NoyauLJ: Lennard-Jones and gravitation, for the
+ * scalar passes and the measures.
+ */
+struct LoiAnalytique {
+    double ligne[3];  // Row of LoiLennardJones: sigma², 24 eps, 4 eps
+    const float *masse;
+
+    // Same r^-2 power chain as NoyauLJ
+    inline void coefficients(int i, int j, double r2, double &coef_i, double &coef_j) const {
+        const double inv_r2 = 1.0 / r2;
+        const double s2 = ligne[0] * inv_r2;
+        const double powTo6 = s2 * s2 * s2;
+        const double inv_r3 = inv_r2 * std::sqrt(inv_r2);
+        const double lj = ligne[1] * inv_r2 * powTo6 * (1 - 2 * powTo6);
+        coef_i = lj + masse[i] * inv_r3;
+        coef_j = lj + masse[j] * inv_r3;
+    }
+
+    // Energy of the pair, the gravitational part being the mean of -m_i / r and -m_j / r, and its virial
+    inline void mesurer(int i, int j, double r2, double &energie, double &viriel) const {
+        const double inv_r = 1 / std::sqrt(r2);
+        const double masses = 0.5 * (masse[i] + masse[j]);
+        energie = LoiLennardJones::energie(ligne, r2) - masses * inv_r;
+        viriel = -(LoiLennardJones::coefficient(ligne, r2) + masses * inv_r * inv_r * inv_r) * r2;
+    }
+};
+
+/**
+ * @brief Lennard-Jones and gravitational interaction of a pair, applied to both particles.
+ */
+template <int DIM, bool BORNER>
+using InteractionPaire = InteractionLoi<DIM, BORNER, LoiAnalytique>;
+
+/**
+ * @brief Sums the potential energy and the virial of the pairs of a force pass, per cell.
+ *
+ * The engines call it on the same batches as their kernel, while the coordinates
+ * are in cache. The forces are capped by the engines, not here: the virial uses the
+ * pair forces of the law.
+ *
+ * @tparam DIM 2 to skip the z components, 3 for the full vectors.
+ * @tparam Loi LoiAnalytique, LoiTabulee or LoiChamp, whose mesurer(i, j, r2, energie, viriel)
+ *         gives the energy and the virial -r² (coef_i + coef_j) / 2 of a pair.
+ */
+template <int DIM, typename Loi>
+struct MesurePaires {
+    const ReelPosition *x, *y, *z;
+    double rCut2;
+    Loi loi;
+    double *cumuls;  // Energy and virial of each cell
+
+    inline void paire(int i, int j, double poids, double &energie, double &viriel) const {
+        double rx = static_cast<double>(x[j]) - x[i];
+        double ry = static_cast<double>(y[j]) - y[i];
+        double rz = (DIM == 3) ? static_cast<double>(z[j]) - z[i] : 0.0;
+        double r2 = rx * rx + ry * ry + rz * rz;
+        if (r2 == 0.0 || r2 >= rCut2) {
+            return;
+        }
+        double e, w;
+        loi.mesurer(i, j, r2, e, w);
+        energie += poids * e;
+        viriel += poids * w;
+    }
+
+    // Pairs of the full-shell engine, each seen from both particles
+    void coquillePleine(int i, int debut, int fin, double &energie, double &viriel) const {
+        for (int j = debut; j < fin; j++) {
+            paire(i, j, 0.5, energie, viriel);
+        }
+    }
+
+    // Pairs of the half-shell engine, each seen once
+    void demiCoquille(int i, int debut, int fin, double &energie, double &viriel) const {
+        for (int j = debut; j < fin; j++) {
+            paire(i, j, 1.0, energie, viriel);
+        }
+    }
+
+    void ajouter(int cellule, double energie, double viriel) const {
+        cumuls[2 * cellule] += energie;
+        cumuls[2 * cellule + 1] += viriel;
+    }
+};
+
+/**
+ * @brief Interface of MesurePaires doing nothing, for the force passes without measure.
+ */
+struct SansMesure {
+    void paire(int, int, double, double &, double &) const {}
+    void coquillePleine(int, int, int, double &, double &) const {}
+    void demiCoquille(int, int, int, double &, double &) const {}
+    void ajouter(int, double, double) const {}
+};
+
+/**
+ * @brief Scalar kernel of the cell engines on a pair law.
+ *
+ * It has the interface of NoyauLJ, so that the engines run the same loops on
+ * either kernel.
+ *
+ * @tparam DIM 2 to skip the z components, 3 for the full vectors.
+ * @tparam Loi LoiTabulee or LoiChamp.
+ */
+template <int DIM, typename Loi>
+struct NoyauPaires {
+    Loi loi;
+    double rCut2;
+    bool borner;
+
+    // Adds to (fxi, fyi, fzi) the forces of the particles [debut, fin) on particle i
+    int coquillePleine(const ReelPosition *x, const ReelPosition *y, const ReelPosition *z, int i, double, int debut,
+                       int fin, double &fxi, double &fyi, double &fzi) const {
+        int actives = 0;
+        for (int j = debut; j < fin; j++) {
+            double rx = static_cast<double>(x[j]) - x[i];
+            double ry = static_cast<double>(y[j]) - y[i];
+            double rz = (DIM == 3) ? static_cast<double>(z[j]) - z[i] : 0.0;
+            double r2 = rx * rx + ry * ry + rz * rz;
+            if (r2 == 0.0 || r2 >= rCut2) {
+                continue;
+            }
+            const double coef = loi.coefficient(i, j, r2);
+            double fix = rx * coef, fiy = ry * coef, fiz = rz * coef;
+            if (borner) {
+                fix = std::min(std::max(fix, -1e5), 1e5);
+                fiy = std::min(std::max(fiy, -1e5), 1e5);
+                fiz = std::min(std::max(fiz, -1e5), 1e5);
+            }
+            fxi += fix;
+            fyi += fiy;
+            fzi += fiz;
+            actives++;
+        }
+        return actives;
+    }
+
+    // Evaluates each pair (i, j) of the batch once, for the half-shell engine
+    int demiCoquille(const ReelPosition *x, const ReelPosition *y, const ReelPosition *z, const float *, ReelForce *fx,
+                     ReelForce *fy, ReelForce *fz, int i, int debut, int fin, double &fxi, double &fyi, double &fzi) const {
+        int actives = 0;
+        if (borner) {
+            const InteractionLoi<DIM, true, Loi> interaction{x, y, z, fx, fy, fz, rCut2, loi};
+            for (int j = debut; j < fin; j++) {
+                actives += interaction(i, j, fxi, fyi, fzi);
+            }
+        } else {
+            const InteractionLoi<DIM, false, Loi> interaction{x, y, z, fx, fy, fz, rCut2, loi};
+            for (int j = debut; j < fin; j++) {
+                actives += interaction(i, j, fxi, fyi, fzi);
+            }
+        }
+        return actives;
+    }
+};
+
+/**
+ * @brief Calls f with the law of a force field, instantiated for its potential.
+ *
+ * @param champ The force field
+ * @param store The particles, for their categories and masses
+ * @param f A generic callable taking a LoiChamp
+ */
+template <typename F>
+void avecLoi(const ChampForces &champ, const ParticuleStore &store, F &&f) {
+    const double *table = champ.getTable();
+    const int *categorie = store.categorie.data();
+    const int nb = champ.getNbCategories();
+    const float *masse = store.masse.data();
+    const bool gravitation = champ.getGravitation();
+    switch (champ.getType()) {
+        case ChampForces::MORSE:
+            f(LoiChamp<LoiMorse>{table, categorie, nb, masse, gravitation});
+            break;
+        case ChampForces::SPHERE_MOLLE:
+            f(LoiChamp<LoiSphereMolle>{table, categorie, nb, masse, gravitation});
+            break;
+        case ChampForces::COULOMB:
+            f(LoiChamp<LoiCoulomb>{table, categorie, nb, masse, gravitation});
+            break;
+        default:
+            f(LoiChamp<LoiLennardJones>{table, categorie, nb, masse, gravitation});
+            break;
+    }
+}
+}
+
 /**
  * @brief Constructs a Univers object.
  *
@@ -44,6 +381,7 @@ Univers::Univers(int dimension, int L1, int L2, int L3, float rCut, float dt, fl
     this->tmax = tmax;
     this->eps = 0;
     this->sigma = 0;
+    initGrille();
 }
 
 /**
@@ -77,6 +415,7 @@ Univers::Univers(int dimension, int L1, int L2, int L3, int eps, int sigma, floa
     this->tmax = tmax;
     this->sigma = sigma;
     this->eps = eps;
+    initGrille();
 }
 
 /**
@@ -93,7 +432,7 @@ Univers::Univers(int dimension, int L1, int L2, int L3, int eps, int sigma, floa
  * @param tmax The maximum simulation time.
  * @param boundaryCond The type of boundary conditions to apply.
  * @param G The gravitational constant.
- * @param scaleType the type of scaling to apply : 0 using for maxForce ; 1 using kinetic energy
+ * @param scaleType 0 caps the forces in 2D as in 3D ; 1 caps them only in 3D (the temperature is controlled by setThermostat)
  */
 Univers::Univers(int dimension, int L1, int L2, int L3, int eps, int sigma, float rCut, float dt, float tmax, int boundaryCond, float G, int scaleType) {
     if (dimension < 1 || dimension > 3) {
@@ -116,6 +455,7 @@ Univers::Univers(int dimension, int L1, int L2, int L3, int eps, int sigma, floa
     this->boundaryCond = boundaryCond;
     this->G = G;
     this->scaleType = scaleType;
+    initGrille();
 }
 
 /**
@@ -123,6 +463,284 @@ Univers::Univers(int dimension, int L1, int L2, int L3, int eps, int sigma, floa
  */
 Univers::Univers() : dimension(0), nbParticules(0), cellules(std::vector<Cellule>()) {}
 
+/**
+ * @brief Computes the number of cells in each direction.
+ *
+ * Directions of zero length get a single layer of cells.
+ */
+void Univers::initGrille() {
+    gridWidth = static_cast<int>(L1 / rCut);
+    gridHeight = (L2 > 0) ? static_cast<int>(L2 / rCut) : 1;
+    gridDepth = (L3 > 0) ? static_cast<int>(L3 / rCut) : 1;
+}
+
+/**
+ * @brief Creates the cells of the grid and empties the particle store.
+ *
+ * The sparse grid starts without any cell: they are created with the particles.
+ */
+void Univers::creerCellules() {
+    if (grilleCreuse) {
+        materialiserCellules(std::vector<long>());
+        celluleManquante = false;
+    } else {
+        construireCellules();
+    }
+    store.clear();
+    nbParticules = 0;
+    plagesValides = false;
+    categoriesVerifiees = false;
+    forcesAJour = false;
+}
+
+/**
+ * @brief Creates every cell of the grid, in row-major order (x first, then y, then z),
+ * then puts them in the order selected with setOrdreCellules.
+ */
+void Univers::construireCellules() {
+    clesCreuses.clear();
+    indexCreux.clear();
+    voisinesCreuses.clear();
+    cellules.clear();
+    cellules.reserve(gridWidth * gridHeight * gridDepth);
+    for (int k = 0; k < gridDepth; k++) {
+        for (int j = 0; j < gridHeight; j++) {
+            for (int i = 0; i < gridWidth; i++) {
+                Vector3D centre((i + 0.5) * rCut, (j + 0.5) * rCut, (L3 > 0) ? (k + 0.5) * rCut : 0);
+                cellules.push_back(Cellule(i, j, k, centre));
+            }
+        }
+    }
+    rangCellules.clear();
+    ordonnerCellules();
+}
+
+/**
+ * @brief Creates the cells of the sparse grid holding a particle, and their neighbors,
+ * then moves every particle to its cell.
+ *
+ * The store is sorted again before the next force pass.
+ */
+void Univers::construireGrilleCreuse() {
+    const int n = store.getNbParticules();
+    const long tailleCouche = static_cast<long>(gridWidth) * gridHeight;
+
+    // Row-major position of the cell of each particle. The scratch vectors keep their
+    // capacity, so that the rebuilds of a running simulation do not allocate
+    rangsParticules.resize(n);
+    for (int i = 0; i < n; i++) {
+        int cellX, cellY, cellZ;
+        coordonneesCellule(store.x[i], store.y[i], store.z[i], cellX, cellY, cellZ);
+        rangsParticules[i] = cellX + cellY * static_cast<long>(gridWidth) + cellZ * tailleCouche;
+    }
+    rangsCrees.assign(rangsParticules.begin(), rangsParticules.end());
+    std::sort(rangsCrees.begin(), rangsCrees.end());
+    const size_t nbOccupees = std::unique(rangsCrees.begin(), rangsCrees.end()) - rangsCrees.begin();
+
+    // The occupied cells, then their neighbors appended after them
+    const int rayonZ = (gridDepth > 1) ? 1 : 0;
+    rangsCrees.resize(nbOccupees);
+    for (size_t o = 0; o < nbOccupees; o++) {
+        const long cle = rangsCrees[o];
+        const int i = static_cast<int>(cle % gridWidth);
+        const int j = static_cast<int>((cle / gridWidth) % gridHeight);
+        const int k = static_cast<int>(cle / tailleCouche);
+        for (int nz = std::max(k - rayonZ, 0); nz <= std::min(k + rayonZ, gridDepth - 1); nz++) {
+            for (int ny = std::max(j - 1, 0); ny <= std::min(j + 1, gridHeight - 1); ny++) {
+                for (int nx = std::max(i - 1, 0); nx <= std::min(i + 1, gridWidth - 1); nx++) {
+                    rangsCrees.push_back(nx + ny * static_cast<long>(gridWidth) + nz * tailleCouche);
+                }
+            }
+        }
+    }
+    std::sort(rangsCrees.begin(), rangsCrees.end());
+    rangsCrees.erase(std::unique(rangsCrees.begin(), rangsCrees.end()), rangsCrees.end());
+    materialiserCellules(rangsCrees);
+
+    for (int i = 0; i < n; i++) {
+        store.cellule[i] = chercherCreuse(rangsParticules[i]);
+    }
+    celluleManquante = false;
+    plagesValides = false;
+    listesValides = false;
+}
+
+/**
+ * @brief Replaces the cells with those of the sparse grid at given positions, and fills the
+ * hash table and the neighbor table.
+ *
+ * Every container keeps its capacity, so that a rebuild with no more cells than the
+ * previous ones does not allocate.
+ *
+ * @param cles The row-major positions of the cells, in increasing order.
+ */
+void Univers::materialiserCellules(const std::vector<long> &cles) {
+    const long tailleCouche = static_cast<long>(gridWidth) * gridHeight;
+    rangCellules.clear();
+    cellules.clear();
+    reserverAvecMarge(cellules, cles.size());
+
+    // Hash table at most half full
+    size_t taille = 16;
+    decalageCreux = 60;
+    while (taille < 2 * cles.size()) {
+        taille *= 2;
+        decalageCreux--;
+    }
+    clesCreuses.assign(taille, -1);
+    indexCreux.assign(taille, -1);
+    for (long cle : cles) {
+        const int i = static_cast<int>(cle % gridWidth);
+        const int j = static_cast<int>((cle / gridWidth) % gridHeight);
+        const int k = static_cast<int>(cle / tailleCouche);
+        Vector3D centre((i + 0.5) * rCut, (j + 0.5) * rCut, (L3 > 0) ? (k + 0.5) * rCut : 0);
+        size_t h = (static_cast<unsigned long long>(cle) * 0x9E3779B97F4A7C15ull) >> decalageCreux;
+        while (clesCreuses[h] >= 0) {
+            h = (h + 1) & (taille - 1);
+        }
+        clesCreuses[h] = cle;
+        indexCreux[h] = static_cast<int>(cellules.size());
+        cellules.push_back(Cellule(i, j, k, centre));
+    }
+
+    reserverAvecMarge(voisinesCreuses, 27 * cellules.size());
+    voisinesCreuses.assign(27 * cellules.size(), -1);
+    for (int c = 0; c < static_cast<int>(cellules.size()); c++) {
+        const int *id = cellules[c].getId();
+        for (int dz = -1; dz <= 1; dz++) {
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    const int nx = id[0] + dx, ny = id[1] + dy, nz = id[2] + dz;
+                    if (nx >= 0 && nx < gridWidth && ny >= 0 && ny < gridHeight && nz >= 0 && nz < gridDepth) {
+                        voisinesCreuses[27 * c + (dz + 1) * 9 + (dy + 1) * 3 + dx + 1] = indexCellule(nx, ny, nz);
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Gets the coordinates of the cell containing a position, clamped to the grid.
+ *
+ * @param x, y, z The position.
+ * @param cellX, cellY, cellZ The coordinates of the cell.
+ */
+void Univers::coordonneesCellule(double x, double y, double z, int &cellX, int &cellY, int &cellZ) const {
+    cellX = std::min(std::max(static_cast<int>(x / rCut), 0), gridWidth - 1);
+    cellY = std::min(std::max(static_cast<int>(y / rCut), 0), gridHeight - 1);
+    cellZ = (gridDepth > 1) ? std::min(std::max(static_cast<int>(z / rCut), 0), gridDepth - 1) : 0;
+}
+
+/**
+ * @brief Gets the index in cellules of the first cell of a layer.
+ *
+ * In the dense grid the layers are contiguous ranges of row-major positions; the
+ * cells of the sparse grid are in row-major order, so the layer starts at the first
+ * created cell whose position is not lower.
+ *
+ * @param couche The layer (y in 2D, z in 3D).
+ * @param tailleCouche The number of cells of a layer in the dense grid.
+ * @return The index of the first cell of the layer.
+ */
+int Univers::debutCouche(int couche, int tailleCouche) const {
+    const long position = static_cast<long>(couche) * tailleCouche;
+    if (!grilleCreuse) {
+        return static_cast<int>(std::min(position, static_cast<long>(cellules.size())));
+    }
+    auto premiere = std::lower_bound(cellules.begin(), cellules.end(), position, [&](const Cellule &cellule, long p) {
+        const int *id = cellule.getId();
+        return id[0] + id[1] * static_cast<long>(gridWidth) + id[2] * static_cast<long>(gridWidth) * gridHeight < p;
+    });
+    return static_cast<int>(premiere - cellules.begin());
+}
+
+/**
+ * @brief Sorts the particle store by cell if needed and refreshes the cell ranges.
+ *
+ * The sparse grid first creates the cells of the particles that have none.
+ */
+void Univers::assurerTri() {
+    if (celluleManquante) {
+        construireGrilleCreuse();
+    }
+    if (!plagesValides) {
+        store.sortByCell(static_cast<int>(cellules.size()));
+        synchroniserPlages();
+        plagesValides = true;
+        listesValides = false;
+    }
+}
+
+/**
+ * @brief Moves the particles whose cell index changed to their new cell.
+ *
+ * When the store is already grouped by cell, only the migrants are moved in
+ * place; otherwise the whole store is sorted by cell.
+ */
+void Univers::migrerParticules() {
+    if (!plagesValides) {
+        nbMigrants = store.getNbParticules();
+        assurerTri();
+        return;
+    }
+    nbMigrants = store.rebinCells(static_cast<int>(cellules.size()));
+    if (nbMigrants > 0) {
+        synchroniserPlages();
+        listesValides = false;
+    }
+}
+
+/**
+ * @brief Makes every cell refer to its range of the particle store.
+ */
+void Univers::synchroniserPlages() {
+    pourIntervalles(static_cast<int>(cellules.size()), [&](int cDebut, int cFin) {
+        for (int c = cDebut; c < cFin; c++) {
+            cellules[c].setPlage(store.cellStart(c), store.cellEnd(c) - store.cellStart(c));
+        }
+    });
+}
+
+/**
+ * @brief Splits the cell array into blocks of equal weight.
+ *
+ * The cumulated weight of the cells [0, c) is cellStart(c) + c, so each bound is
+ * found by a binary search without visiting the cells.
+ *
+ * @param nbBlocs The number of blocks wanted.
+ * @return The number of blocks made, in bornesBlocs and poidsBlocs.
+ */
+int Univers::decouperCellules(int nbBlocs) {
+    const int nbCellules = static_cast<int>(cellules.size());
+    auto poidsAvant = [&](int c) { return static_cast<long>(store.cellStart(c)) + c; };
+    const long total = poidsAvant(nbCellules);
+
+    bornesBlocs.assign(1, 0);
+    poidsBlocs.assign(1, 0);
+    for (int k = 1; k <= nbBlocs; k++) {
+        const long cible = total * k / nbBlocs;
+        // First cell whose cumulated weight reaches the target
+        int bas = bornesBlocs.back(), haut = nbCellules;
+        while (bas < haut) {
+            const int milieu = bas + (haut - bas) / 2;
+            if (poidsAvant(milieu) < cible) {
+                bas = milieu + 1;
+            } else {
+                haut = milieu;
+            }
+        }
+        if (k == nbBlocs) {
+            bas = nbCellules;
+        }
+        if (bas > bornesBlocs.back()) {
+            bornesBlocs.push_back(bas);
+            poidsBlocs.push_back(poidsAvant(bas));
+        }
+    }
+    return static_cast<int>(bornesBlocs.size()) - 1;
+}
+
 /**
  * @brief Initializes the simulation with specific dimensions and velocities.
  *
@@ -134,20 +752,12 @@ Univers::Univers() : dimension(0), nbParticules(0), cellules(std::vector<Cellule
  * @param vitesse_rouge The initial velocity of the red particles.
  */
 void Univers::initialiser(int dim1_rouge, int dim2_rouge, int dim1_bleue, int dim2_bleue, const Vector3D& vitesse_rouge, const Vector3D& vitesse_bleue) {
-    int nCellsX = L1 / rCut;
-    int nCellsY = L2 / rCut;
+    int nCellsX = gridWidth;
 
     try {
-        cellules.reserve(nCellsX * nCellsY);
-
         // Create all cells
-        for (int j = 0; j < nCellsY; j++) {
-            for (int i = 0; i < nCellsX; i++) {
-                Vector3D centre((i + 0.5) * rCut, (j + 0.5) * rCut, 0);
-                Cellule cellule(i, j, centre);
-                cellules.push_back(cellule);
-            }
-        }
+        creerCellules();
+        store.reserve(dim1_rouge * dim2_rouge + dim1_bleue * dim2_bleue);
 
         std::vector<Particule3D> particules_bleues;
         particules_bleues.reserve(dim1_bleue * dim2_bleue);
@@ -174,12 +784,13 @@ void Univers::initialiser(int dim1_rouge, int dim2_rouge, int dim1_bleue, int di
 
         // Assign particles to cells
         for (const auto& particule : particules_rouges) {
-            assignParticule(particule, nCellsY);
+            assignParticule(particule, nCellsX);
         }
 
         for (const auto& particule : particules_bleues) {
-            assignParticule(particule, nCellsY);
+            assignParticule(particule, nCellsX);
         }
+        assurerTri();
 
 
         if (nbParticules < (int)(particules_bleues.size() + particules_rouges.size())) {
@@ -201,20 +812,12 @@ void Univers::initialiser(int dim1_rouge, int dim2_rouge, int dim1_bleue, int di
  * @param vitesse_rouge The initial velocity of the red particles.
  */
 void Univers::initialiserDemoCercle(int dim1_bleue, int dim2_bleue, float rayon_rouge, const Vector3D& vitesse_bleue, const Vector3D & vitesse_rouge) {
-    int nCellsX = L1 / rCut;
-    int nCellsY = L2 / rCut;
+    int nCellsX = gridWidth;
+    int nCellsY = gridHeight;
 
     try {
-        cellules.reserve(nCellsX * nCellsY);
-
         // Create all cells
-        for (int j = 0; j < nCellsY; j++) {
-            for (int i = 0; i < nCellsY; i++) {
-                Vector3D centre((i + 0.5) * rCut, (j + 0.5) * rCut, 0);
-                Cellule cellule(i, j, centre);
-                cellules.push_back(cellule);
-            }
-        }
+        creerCellules();
 
         std::vector<Particule3D> particules_bleues;
         particules_bleues.reserve(dim1_bleue * dim2_bleue);
@@ -252,6 +855,7 @@ void Univers::initialiserDemoCercle(int dim1_bleue, int dim2_bleue, float rayon_
         for (const auto& particule : particules_rouges) {
             assignParticule(particule, nCellsX);
         }
+        assurerTri();
 
         std::cout << "nCd1 : " << nCellsX << std::endl;
         std::cout << "nCd2 : " << nCellsY << std::endl;
@@ -266,6 +870,54 @@ void Univers::initialiserDemoCercle(int dim1_bleue, int dim2_bleue, float rayon_
     }
 }
 
+/**
+ * @brief Fills the whole box with particles on a jittered regular lattice.
+ *
+ * @param nbParticules The number of particles.
+ * @param vitesseMax The maximum of each velocity component.
+ */
+void Univers::initialiserUniforme(int nbParticules, float vitesseMax) {
+    try {
+        if (nbParticules < 0) {
+            throw std::invalid_argument("Invalid number of particles: must be positive.");
+        }
+        creerCellules();
+        store.reserve(nbParticules);
+
+        // Largest lattice spacing giving at least nbParticules sites
+        const bool is3D = L3 > 0;
+        const double volume = is3D ? static_cast<double>(L1) * L2 * L3 : static_cast<double>(L1) * L2;
+        double pas = (nbParticules > 0) ? std::pow(volume / nbParticules, is3D ? 1.0 / 3.0 : 0.5) : 1.0;
+        int nx, ny, nz;
+        while (true) {
+            nx = std::max(1, static_cast<int>(L1 / pas));
+            ny = std::max(1, static_cast<int>(L2 / pas));
+            nz = is3D ? std::max(1, static_cast<int>(L3 / pas)) : 1;
+            if (static_cast<long>(nx) * ny * nz >= nbParticules) {
+                break;
+            }
+            pas *= 0.99;
+        }
+        const double ax = static_cast<double>(L1) / nx;
+        const double ay = static_cast<double>(L2) / ny;
+        const double az = is3D ? static_cast<double>(L3) / nz : 0;
+
+        auto aleatoire = [] { return 2.0 * rand() / RAND_MAX - 1.0; };
+        for (int p = 0; p < nbParticules; p++) {
+            const int i = p % nx;
+            const int j = (p / nx) % ny;
+            const int k = p / (nx * ny);
+            Vector3D position((i + 0.5 + 0.1 * aleatoire()) * ax, (j + 0.5 + 0.1 * aleatoire()) * ay, is3D ? (k + 0.5 + 0.1 * aleatoire()) * az : 0);
+            Vector3D vitesse(vitesseMax * aleatoire(), vitesseMax * aleatoire(), is3D ? vitesseMax * aleatoire() : 0);
+            assignParticule(Particule3D(p, 1, 0, Vector3D(0, 0, 0), position, vitesse), gridWidth);
+        }
+        assurerTri();
+    } catch (const std::exception &e) {
+        logError(e.what());
+        throw;
+    }
+}
+
 /**
  * @brief Gets the dimension of the simulation.
  *
@@ -290,7 +942,28 @@ int Univers::getNbParticules() const {
  * @return A vector of cells.
  */
 std::vector<Cellule> Univers::getCellules() {
-    return cellules;
+    assurerTri();
+    std::vector<Cellule> copie = cellules;
+    for (int c = 0; c < (int)copie.size(); c++) {
+        std::vector<Particule3D> part;
+        part.reserve(store.cellEnd(c) - store.cellStart(c));
+        for (int i = store.cellStart(c); i < store.cellEnd(c); i++) {
+            part.push_back(store.getParticule(i));
+        }
+        copie[c].setParticules(part);
+    }
+    return copie;
+}
+
+/**
+ * @brief Gets the particle store, sorted by cell.
+ *
+ * @return A reference to the particle store.
+ */
+ParticuleStore& Univers::getStore() {
+    assurerTri();
+    categoriesVerifiees = false;
+    return store;
 }
 
 /**
@@ -335,12 +1008,34 @@ float Univers::getRCut() const {
  * @param cellules A vector of cells.
  */
 void Univers::setCellules(std::vector<Cellule> cellules) {
+    // The given cells are in row-major order
+    const int ordre = ordreCellules;
+    ordreCellules = OrdreCellules::LIGNES;
+    rangCellules.clear();
     this->cellules = cellules;
-    this->nbParticules = 0;
+    this->store.clear();
+    // Move the particles of the cells into the store, cell after cell
+    for (int c = 0; c < (int)this->cellules.size(); c++) {
+        for (const auto &p : this->cellules[c].getParticules()) {
+            store.addParticule(p, c);
+        }
+        this->cellules[c].setParticules(std::vector<Particule3D>());
+    }
     // Update the number of particles
-    for (auto it = cellules.begin(); it != cellules.end(); it++) {
-        this->nbParticules += it->getParticules().size();
+    this->nbParticules = store.getNbParticules();
+    listesValides = false;
+    forcesAJour = false;
+    categoriesVerifiees = false;
+    if (grilleCreuse) {
+        // Only the cells of the particles and their neighbors are kept
+        construireGrilleCreuse();
+        assurerTri();
+        return;
     }
+    store.recountCells(static_cast<int>(this->cellules.size()));
+    synchroniserPlages();
+    plagesValides = true;
+    setOrdreCellules(ordre);
 }
 
 /**
@@ -353,9 +1048,35 @@ void Univers::assignParticule(const Particule3D& particule, int nCellsX) {
     try {
         int cellX = (int)(particule.getPos().getX() / rCut);
         int cellY = (int)(particule.getPos().getY() / rCut);
-        int index = cellX + cellY * nCellsX;
-        if (index >= 0 && index < (int)cellules.size()) {
-            cellules[index].addParticule(particule);
+        // The last cell of each direction also holds the remainder of the box (as in reassignCells)
+        if (cellX == nCellsX) {
+            cellX--;
+        }
+        if (cellY == gridHeight) {
+            cellY--;
+        }
+        long index = cellX + static_cast<long>(cellY) * nCellsX;
+        if (L3 > 0) {
+            int cellZ = (int)(particule.getPos().getZ() / rCut);
+            if (cellZ == gridDepth) {
+                cellZ--;
+            }
+            index += cellZ * static_cast<long>(nCellsX) * gridHeight;
+        }
+        const long nbPositions = grilleCreuse ? static_cast<long>(gridWidth) * gridHeight * gridDepth : static_cast<long>(cellules.size());
+        if (index >= 0 && index < nbPositions) {
+            int c = static_cast<int>(index);
+            if (grilleCreuse) {
+                // A cell not created yet is created with its neighbors at the next sort
+                c = chercherCreuse(index);
+                celluleManquante = celluleManquante || c < 0;
+            } else if (!rangCellules.empty()) {
+                c = rangCellules[index];
+            }
+            store.addParticule(particule, c);
+            plagesValides = false;
+            forcesAJour = false;
+            categoriesVerifiees = false;
             nbParticules += 1;
         } else {
             std::ostringstream oss;
@@ -375,169 +1096,1067 @@ void Univers::assignParticule(const Particule3D& particule, int nCellsX) {
  */
 void Univers::writeVTKFile(std::string filename) {
     try {
-        std::ofstream file(filename);
-        if (!file.is_open()) {
-            throw std::runtime_error("Unable to open file " + filename + " for writing.");
-        }
-        file << "<?xml version=\"1.0\"?>" << std::endl;
-        file << "<VTKFile type=\"UnstructuredGrid\" version=\"0.1\" byte_order=\"BigEndian\">" << std::endl;
-        file << "  <UnstructuredGrid>" << std::endl;
-        file << "    <Piece NumberOfPoints=\"" << nbParticules << "\" NumberOfCells=\"0\">" << std::endl;
-        file << "      <Points>" << std::endl;
-        file << "        <DataArray name=\"Position\" type=\"Float32\" NumberOfComponents=\"" << dimension << "\" format=\"ascii\">" << std::endl;
-
-        // Add particle positions
-        for (auto ite = cellules.begin(); ite != cellules.end(); ite++) {
-            std::vector<Particule3D> particules = ite->getParticules();
-            for (auto it = particules.begin(); it != particules.end(); it++) {
-                Vector3D pos = it->getPos();
-                if (dimension == 1) {
-                    file << pos.getX() << " ";
-                } else if (dimension == 2) {
-                    file << pos.getX() << " " << pos.getY() << " ";
-                } else {
-                    file << pos.getX() << " " << pos.getY() << " " << pos.getZ() << " ";
-                }
-            }
-        }
+        ecritureVTK.preparer(store);
+        ecritureVTK.ecrire(filename);
+    } catch (const std::exception &e) {
+        logError(e.what());
+        throw;
+    }
+}
 
-        file << std::endl;
-        file << "        </DataArray>" << std::endl;
-        file << "      </Points>" << std::endl;
-        file << "      <PointData Vectors=\"vector\">" << std::endl;
-        file << "        <DataArray type=\"Float32\" Name=\"Velocity\" NumberOfComponents=\"" << dimension << "\" format=\"ascii\">" << std::endl;
-        // Add particle velocities
-        for (auto ite = cellules.begin(); ite != cellules.end(); ite++) {
-            std::vector<Particule3D> particules = ite->getParticules();
-            for (auto it = particules.begin(); it != particules.end(); it++) {
-                Vector3D vit = it->getVit();
-                if (dimension == 1) {
-                    file << vit.getX() << " ";
-                } else if (dimension == 2) {
-                    file << vit.getX() << " " << vit.getY() << " ";
-                } else {
-                    file << vit.getX() << " " << vit.getY() << " " << vit.getZ() << " ";
-                }
-            }
+/**
+ * @brief Writes the VTK file of a step if the output cadence asks for it.
+ *
+ * With an interval of simulated time, a file is written at the first step
+ * reaching each multiple of the interval; otherwise every frequenceSortie steps.
+ * The initial state (step 0) is always written when the output is enabled.
+ *
+ * @param iter The step index.
+ * @param t The simulated time.
+ */
+void Univers::ecrireSortie(int iter, double t) {
+    bool ecrire;
+    if (intervalleSortie > 0) {
+        if (iter == 0) {
+            prochaineSortie = 0;
         }
+        ecrire = t >= prochaineSortie - 1e-3 * intervalleSortie;
+        while (prochaineSortie <= t + 1e-3 * intervalleSortie) {
+            prochaineSortie += intervalleSortie;
+        }
+    } else {
+        ecrire = frequenceSortie > 0 && iter % frequenceSortie == 0;
+    }
+    if (!ecrire) {
+        return;
+    }
 
+    if (trajectoire) {
+        trajectoire->ecrire(store, iter, t);
+        return;
+    }
+    const std::string filename = nomDuRang(prefixeSortie + "_t" + std::to_string(iter) + ".vtu");
+    if (ecritureAsynchrone) {
+        ecritureAsynchrone->soumettre(store, filename);
+    } else {
+        writeVTKFile(filename);
+    }
+}
 
-        file << std::endl;
-        file << "        </DataArray>" << std::endl;
-        file << "        <DataArray type=\"Float32\" Name=\"Category\" format=\"ascii\">" << std::endl;
-
-        // Add particle categories
-        for (auto ite = cellules.begin(); ite != cellules.end(); ite++) {
-            std::vector<Particule3D> particules = ite->getParticules();
-            for (auto it = particules.begin(); it != particules.end(); it++) {
-                float categorie = it->getCategorie();
-                file << categorie << " ";
-            }
-        }
-        file << std::endl;
-        file << "        </DataArray>" << std::endl;
-        file << "      </PointData>" << std::endl;
-        file << "      <Cells>" << std::endl;
-        file << "        <DataArray type=\"Int32\" Name=\"connectivity\" format=\"ascii\">" << std::endl;
-        file << "        </DataArray>" << std::endl;
-        file << "        <DataArray type=\"Int32\" Name=\"offsets\" format=\"ascii\">" << std::endl;
-        file << "        </DataArray>" << std::endl;
-        file << "        <DataArray type=\"UInt8\" Name=\"types\" format=\"ascii\">" << std::endl;
-        file << "        </DataArray>" << std::endl;
-        file << "      </Cells>" << std::endl;
-        file << "    </Piece>" << std::endl;
-        file << "  </UnstructuredGrid>" << std::endl;
-        file << "</VTKFile>" << std::endl;
-
-        file.close();
-    } catch (const std::exception &e) {
-        logError(e.what());
-        throw;
+/**
+ * @brief Waits for the snapshots written in the background and flushes the trajectory and statistics files.
+ */
+void Univers::terminerSorties() {
+    if (ecritureAsynchrone) {
+        ecritureAsynchrone->attendre();
+    }
+    if (trajectoire) {
+        trajectoire->vider();
+    }
+    if (serieStatistiques) {
+        serieStatistiques->vider();
     }
 }
 
 /**
- * @brief Calculates the forces on each particle using the Lennard-Jones potential and gravitational forces.
+ * @brief Force kernel on the particle store.
  *
+ * Every particle interacts with the particles of its neighboring cells, which are
+ * visited in place through their index ranges: the pass does not allocate.
+ * The pairs are evaluated in batches by the vector kernel NoyauLJ, or by NoyauPaires
+ * when a force field or a tabulated potential is set.
+ * In 2D the forces are capped only when scaleType is 0, in 3D they are always capped.
+ *
+ * @tparam DIM 2 or 3, the number of dimensions of the neighbor stencil.
  */
-void Univers::calculForces() {
-    try {
-        int gridWidth = L1 / rCut;
-        int gridHeight = L2 / rCut;
-
-        for (auto &cellule : cellules) {
-            int *id = cellule.getId();
-            int x = id[0];
-            int y = id[1];
-
-            // List of neighboring particles
-            std::vector<Particule3D> particules_voisines;
-            std::vector<Particule3D> &part = cellule.getParticules();
-
-            // Interactions with the neighboring cells
-            for (int dx = -1; dx <= 1; dx++) {
-                for (int dy = -1; dy <= 1; dy++) {
-                    int neighborX = x + dx;
-                    int neighborY = y + dy;
-
-                    // Check if the neighbor coordinates are within the grid bounds
-                    if (neighborX >= 0 && neighborX < gridWidth && neighborY >= 0 && neighborY < gridHeight) {
-                        auto &neighborCell = cellules[neighborX + neighborY * gridWidth];
-                        // Add all particles from this neighbor to the list of neighboring particles
-                        std::vector<Particule3D> neighborParticles = neighborCell.getParticules();
-                        particules_voisines.insert(particules_voisines.end(), neighborParticles.begin(), neighborParticles.end());
-                    }
+template <int DIM>
+void Univers::calculForcesCellules() {
+    assurerTri();
+
+    const ReelPosition *x = store.x.data();
+    const ReelPosition *y = store.y.data();
+    const ReelPosition *z = store.z.data();
+    const bool borner = (DIM == 3) || scaleType == 0;
+    const double rCut2 = static_cast<double>(rCut) * rCut;
+
+    std::atomic<long> totalTestees(0), totalActives(0);
+
+    // Each block of cells only writes the forces of its own particles
+    auto passe = [&](const auto &noyau, const auto &mesure) {
+        pourCellulesPonderees([&](int cDebut, int cFin) {
+            long testees = 0, actives = 0;
+            for (int c = cDebut; c < cFin; c++) {
+                if (store.cellStart(c) == store.cellEnd(c)) {
+                    continue;
                 }
-            }
+                // Index ranges of the neighboring cells, shared by the particles of the cell
+                int bornes[2 * 27];
+                int nbBornes = 0;
+                forEachCelluleVoisine<DIM>(c, [&](int debut, int fin) {
+                    bornes[nbBornes++] = debut;
+                    bornes[nbBornes++] = fin;
+                });
+                double energie = 0, viriel = 0;
+                for (int i = store.cellStart(c); i < store.cellEnd(c); i++) {
+                    double fxi = 0, fyi = 0, fzi = 0;
+                    const double masse_i = store.masse[i];
+
+                    // Interactions with the particles of the neighboring cells, i itself is masked out
+                    for (int b = 0; b < nbBornes; b += 2) {
+                        testees += bornes[b + 1] - bornes[b];
+                        actives += noyau.coquillePleine(x, y, z, i, masse_i, bornes[b], bornes[b + 1], fxi, fyi, fzi);
+                        mesure.coquillePleine(i, bornes[b], bornes[b + 1], energie, viriel);
+                    }
 
-            for (auto &p1 : part) {
-                p1.setForce(Vector3D(0, 0, 0)); // Reset force to zero
-
-                const Vector3D pos_i = p1.getPos();
-                const double masse_i = p1.getMasse();
-
-                for (auto &p2 : particules_voisines) {
-                    if (&p1 == &p2) continue; // Skip self-interaction
-
-                    const Vector3D pos_j = p2.getPos();
-                    Vector3D r = pos_j - pos_i;
-                    double norme_r = r.norm();
-
-                    if (norme_r != 0.0 && norme_r < rCut) { // Avoid division by zero and skip particles outside the cutoff
-                        double powTo6 = std::pow(sigma / norme_r, 6);
-                        Vector3D force = r * (24 * eps * std::pow(1 / norme_r, 2) * powTo6 * (1 - 2 * powTo6));
-                        force += r * (masse_i * 1 / (norme_r * norme_r * norme_r)); // Gravitational force
-                        // Cap the forces to avoid numerical instabilities
-                        if (scaleType == 0) {
-                            if (force.getX() > 1e5) {
-                                force.setX(1e5);
-                            }
-                            if (force.getY() > 1e5) {
-                                force.setY(1e5);
-                            }
-                            if (force.getX() < -1e5) {
-                                force.setX(-1e5);
-                            }
-                            if (force.getY() < -1e5) {
-                                force.setY(-1e5);
-                            }
-                        }
-
-                        p1.setForce(p1.getForce() + force);
+                    // Add gravitational force if G is non-zero
+                    if (G != 0) {
+                        fyi += masse_i * G;
                     }
-                }
 
-                // Add gravitational force if G is non-zero
-                if (G != 0) {
-                    p1.getForce().setY(p1.getForce().getY() + p1.getMasse() * G);
+                    store.fx[i] = fxi;
+                    store.fy[i] = fyi;
+                    store.fz[i] = fzi;
                 }
+                mesure.ajouter(c, energie, viriel);
             }
-
-            cellule.setParticules(part);
+            totalTestees += testees;
+            totalActives += actives;
+        });
+    };
+    // The pass with the sums of the measure, or without them
+    auto lancer = [&](const auto &noyau, const auto &loi) {
+        if (mesurerForces) {
+            passe(noyau, MesurePaires<DIM, std::decay_t<decltype(loi)>>{x, y, z, rCut2, loi, preparerMesures()});
+        } else {
+            passe(noyau, SansMesure());
         }
-    } catch (const std::exception &e) {
-        logError(e.what());
-        throw;
+    };
+    const double sigma2 = static_cast<double>(sigma) * sigma;
+    if (champ) {
+        avecLoi(*champ, store, [&](const auto &loi) { lancer(NoyauPaires<DIM, std::decay_t<decltype(loi)>>{loi, rCut2, borner}, loi); });
+    } else if (potentiel) {
+        const LoiTabulee loi{potentiel.get(), store.masse.data()};
+        lancer(NoyauPaires<DIM, LoiTabulee>{loi, rCut2, borner}, loi);
+    } else {
+        lancer(NoyauLJ({rCut2, sigma2, 24.0 * eps, borner, DIM == 3}, jeuInstructions),
+               LoiAnalytique{{sigma2, 24.0 * eps, 4.0 * eps}, store.masse.data()});
+    }
+    nbPairesTestees = totalTestees;
+    nbPairesActives = totalActives;
+}
+
+/**
+ * @brief Half-shell force kernel on the particle store.
+ *
+ * Each pair closer than rCut is evaluated once by the vector kernel NoyauLJ, or by
+ * NoyauPaires with a force field or a tabulated potential: pairs inside a cell with j > i, and pairs
+ * with the forward half of the neighboring cells.
+ *
+ * @tparam DIM 2 or 3, the number of dimensions of the neighbor stencil.
+ * @tparam BORNER true to cap the pair forces.
+ */
+template <int DIM, bool BORNER>
+void Univers::calculForcesDemiCoquille() {
+    assurerTri();
+
+    const ReelPosition *x = store.x.data();
+    const ReelPosition *y = store.y.data();
+    const ReelPosition *z = store.z.data();
+    const float *masse = store.masse.data();
+    ReelForce *fx = store.fx.data();
+    ReelForce *fy = store.fy.data();
+    ReelForce *fz = store.fz.data();
+    const int n = store.getNbParticules();
+    const double rCut2 = static_cast<double>(rCut) * rCut;
+    const double sigma2 = static_cast<double>(sigma) * sigma;
+    const double eps24 = 24.0 * eps;
+    const int nbCellules = static_cast<int>(cellules.size());
+
+    pourIntervalles(n, [&](int debut, int fin) {
+        std::fill(fx + debut, fx + fin, 0.0);
+        std::fill(fy + debut, fy + fin, 0.0);
+        std::fill(fz + debut, fz + fin, 0.0);
+    });
+
+    std::atomic<long> totalTestees(0), totalActives(0);
+
+    // Cells [cDebut, cFin) of the array, or of the row-major grid when rangs is not null
+    auto traiterCellules = [&](const auto &noyau, const auto &mesure, int cDebut, int cFin, const int *rangs) {
+        long testees = 0, actives = 0;
+        for (int r = cDebut; r < cFin; r++) {
+            const int c = rangs ? rangs[r] : r;
+            const int debut = store.cellStart(c);
+            const int fin = store.cellEnd(c);
+            if (debut == fin) {
+                continue;
+            }
+            // Index ranges of the forward neighbors, shared by the particles of the cell
+            int bornes[2 * 13];
+            int nbBornes = 0;
+            forEachCelluleVoisineDemi<DIM>(c, [&](int debutVoisine, int finVoisine) {
+                bornes[nbBornes++] = debutVoisine;
+                bornes[nbBornes++] = finVoisine;
+            });
+            double energie = 0, viriel = 0;
+            for (int i = debut; i < fin; i++) {
+                double fxi = 0, fyi = 0, fzi = 0;
+
+                // Pairs inside the cell
+                testees += fin - i - 1;
+                actives += noyau.demiCoquille(x, y, z, masse, fx, fy, fz, i, i + 1, fin, fxi, fyi, fzi);
+                mesure.demiCoquille(i, i + 1, fin, energie, viriel);
+                // Pairs with the forward half of the neighboring cells
+                for (int b = 0; b < nbBornes; b += 2) {
+                    testees += bornes[b + 1] - bornes[b];
+                    actives += noyau.demiCoquille(x, y, z, masse, fx, fy, fz, i, bornes[b], bornes[b + 1], fxi, fyi, fzi);
+                    mesure.demiCoquille(i, bornes[b], bornes[b + 1], energie, viriel);
+                }
+
+                fx[i] += fxi;
+                fy[i] += fyi;
+                fz[i] += fzi;
+            }
+            mesure.ajouter(c, energie, viriel);
+        }
+        totalTestees += testees;
+        totalActives += actives;
+    };
+
+    auto passe = [&](const auto &noyau, const auto &mesure) {
+        // Layers of cells along the slowest axis (y in 2D, z in 3D): the forward stencil of a
+        // layer only writes into that layer and the next one
+        const int tailleCouche = (DIM == 3) ? gridWidth * gridHeight : gridWidth;
+        const int nbCouches = (tailleCouche > 0 && nbCellules > 0) ? ((DIM == 3) ? gridDepth : gridHeight) : 0;
+        int nbTranches = std::min(PoolThreads::BLOCS_PAR_THREAD * nbThreads, nbCouches);
+
+        if (pool && nbTranches >= 2 && (DIM == 3 || gridDepth == 1)) {
+            // The slabs are ranges of row-major positions, whatever the order of the cells
+            const int *rangs = rangCellules.empty() ? nullptr : rangCellules.data();
+
+            // Cumulated weight of the layers: their particles plus one per cell
+            poidsCouches.assign(nbCouches + 1, 0);
+            for (int couche = 0; couche < nbCouches; couche++) {
+                const int rDebut = debutCouche(couche, tailleCouche);
+                const int rFin = debutCouche(couche + 1, tailleCouche);
+                long poids = rFin - rDebut;
+                if (rangs) {
+                    for (int r = rDebut; r < rFin; r++) {
+                        poids += store.cellEnd(rangs[r]) - store.cellStart(rangs[r]);
+                    }
+                } else {
+                    poids += store.cellStart(rFin) - store.cellStart(rDebut);
+                }
+                poidsCouches[couche + 1] = poidsCouches[couche] + poids;
+            }
+
+            // Slabs of whole layers with equal weights, fewer when a layer is heavier than a slab
+            bornesBlocs.assign(1, 0);
+            for (int k = 1; k < nbTranches; k++) {
+                const long cible = poidsCouches[nbCouches] * k / nbTranches;
+                const int couche = static_cast<int>(std::lower_bound(poidsCouches.begin(), poidsCouches.end(), cible) - poidsCouches.begin());
+                if (couche > bornesBlocs.back() && couche < nbCouches) {
+                    bornesBlocs.push_back(couche);
+                }
+            }
+            bornesBlocs.push_back(nbCouches);
+            nbTranches = static_cast<int>(bornesBlocs.size()) - 1;
+
+            // Two colors of slabs: slabs of the same color are separated by a slab of the
+            // other color, so their writes never overlap
+            for (int couleur = 0; couleur < 2; couleur++) {
+                const int nbTaches = (nbTranches + 1 - couleur) / 2;
+                poidsBlocs.assign(nbTaches + 1, 0);
+                for (int k = 0; k < nbTaches; k++) {
+                    const int tranche = 2 * k + couleur;
+                    poidsBlocs[k + 1] = poidsBlocs[k] + poidsCouches[bornesBlocs[tranche + 1]] - poidsCouches[bornesBlocs[tranche]];
+                }
+                pool->paralleliserPondere(nbTaches, poidsBlocs.data(), [&](int k) {
+                    const int tranche = 2 * k + couleur;
+                    traiterCellules(noyau, mesure, debutCouche(bornesBlocs[tranche], tailleCouche), debutCouche(bornesBlocs[tranche + 1], tailleCouche),
+                                    rangs);
+                });
+            }
+        } else {
+            traiterCellules(noyau, mesure, 0, nbCellules, nullptr);
+        }
+    };
+    // The pass with the sums of the measure, or without them
+    auto lancer = [&](const auto &noyau, const auto &loi) {
+        if (mesurerForces) {
+            passe(noyau, MesurePaires<DIM, std::decay_t<decltype(loi)>>{x, y, z, rCut2, loi, preparerMesures()});
+        } else {
+            passe(noyau, SansMesure());
+        }
+    };
+    if (champ) {
+        avecLoi(*champ, store, [&](const auto &loi) { lancer(NoyauPaires<DIM, std::decay_t<decltype(loi)>>{loi, rCut2, BORNER}, loi); });
+    } else if (potentiel) {
+        const LoiTabulee loi{potentiel.get(), masse};
+        lancer(NoyauPaires<DIM, LoiTabulee>{loi, rCut2, BORNER}, loi);
+    } else {
+        lancer(NoyauLJ({rCut2, sigma2, eps24, BORNER, DIM == 3}, jeuInstructions), LoiAnalytique{{sigma2, eps24, 4.0 * eps}, masse});
+    }
+    nbPairesTestees = totalTestees;
+    nbPairesActives = totalActives;
+
+    // Add gravitational force if G is non-zero
+    if (G != 0) {
+        pourIntervalles(n, [&](int debut, int fin) {
+            for (int i = debut; i < fin; i++) {
+                fy[i] += masse[i] * G;
+            }
+        });
+    }
+}
+
+/**
+ * @brief Force kernel on the Verlet neighbor lists.
+ *
+ * With several threads the particles are split into one range per thread, of equal
+ * numbers of pairs. The half lists write the force of j > i beyond the range of i:
+ * the first range writes into the store, the others into their own force buffers,
+ * added to the store in a fixed order at the end. A buffer only spans the particles
+ * its range reaches (ListeVoisins::getPortee), a few layers of cells past the range
+ * since the store is grouped by cell.
+ *
+ * @tparam DIM 2 to skip the z components, 3 for the full vectors.
+ * @tparam BORNER true to cap the pair forces.
+ */
+template <int DIM, bool BORNER>
+void Univers::calculForcesListes() {
+    const int n = store.getNbParticules();
+    ReelForce *fx = store.fx.data();
+    ReelForce *fy = store.fy.data();
+    ReelForce *fz = store.fz.data();
+    const double rCut2 = static_cast<double>(rCut) * rCut;
+    const int *voisins = listes.getVoisins().data();
+
+    pourIntervalles(n, [&](int debut, int fin) {
+        std::fill(fx + debut, fx + fin, 0.0);
+        std::fill(fy + debut, fy + fin, 0.0);
+        std::fill(fz + debut, fz + fin, 0.0);
+    });
+
+    // Ranges of particles weighted by their pairs plus one per particle: the weight
+    // before particle i is debutListe(i) + i
+    const int nbTaches = pool ? std::max(1, std::min(nbThreads, n)) : 1;
+    const long poidsTotal = static_cast<long>(listes.getNbPaires()) + n;
+    bornesBlocs.assign(nbTaches + 1, n);
+    poidsBlocs.assign(nbTaches + 1, poidsTotal);
+    bornesBlocs[0] = 0;
+    poidsBlocs[0] = 0;
+    for (int t = 1; t < nbTaches; t++) {
+        const long cible = poidsTotal * t / nbTaches;
+        int bas = bornesBlocs[t - 1], haut = n;
+        while (bas < haut) {
+            const int milieu = bas + (haut - bas) / 2;
+            if (listes.debutListe(milieu) + static_cast<long>(milieu) < cible) {
+                bas = milieu + 1;
+            } else {
+                haut = milieu;
+            }
+        }
+        bornesBlocs[t] = bas;
+        poidsBlocs[t] = listes.debutListe(bas) + static_cast<long>(bas);
+    }
+
+    // The range [b, e) of a task writes the forces of [b, portee(e - 1)): each other task
+    // gets one buffer per component over that span only. The buffer of the particles
+    // [b, fin) starts at forcesTaches[base + b], the bases packing the buffers one after the other.
+    finsTaches.assign(nbTaches, 0);
+    basesTaches.assign(3 * static_cast<size_t>(nbTaches), 0);
+    size_t taille = 0;
+    for (int t = 1; t < nbTaches; t++) {
+        const int b = bornesBlocs[t];
+        finsTaches[t] = (bornesBlocs[t + 1] > b) ? listes.getPortee(bornesBlocs[t + 1] - 1) : b;
+        for (int composante = 0; composante < 3; composante++) {
+            const size_t base = std::max(taille, static_cast<size_t>(b)) - b;
+            basesTaches[3 * t + composante] = base;
+            taille = base + finsTaches[t];
+        }
+    }
+    forcesTaches.resize(taille);
+
+    std::atomic<long> totalActives(0);
+    auto passe = [&](const auto &interaction, const auto &mesure) {
+        auto tache = [&](int t) {
+            auto locale = interaction;
+            if (t > 0) {
+                ReelForce *forces[3];
+                for (int composante = 0; composante < 3; composante++) {
+                    forces[composante] = forcesTaches.data() + basesTaches[3 * t + composante];
+                    std::fill(forces[composante] + bornesBlocs[t], forces[composante] + finsTaches[t], 0.0);
+                }
+                locale.fx = forces[0];
+                locale.fy = forces[1];
+                locale.fz = forces[2];
+            }
+            long actives = 0;
+            for (int i = bornesBlocs[t]; i < bornesBlocs[t + 1]; i++) {
+                double fxi = 0, fyi = 0, fzi = 0;
+                double energie = 0, viriel = 0;
+                for (int k = listes.debutListe(i); k < listes.finListe(i); k++) {
+                    actives += locale(i, voisins[k], fxi, fyi, fzi);
+                    mesure.paire(i, voisins[k], 1.0, energie, viriel);
+                }
+                locale.fx[i] += fxi;
+                locale.fy[i] += fyi;
+                locale.fz[i] += fzi;
+                mesure.ajouter(t, energie, viriel);
+            }
+            totalActives += actives;
+        };
+        if (nbTaches > 1) {
+            pool->paralleliserPondere(nbTaches, poidsBlocs.data(), tache);
+        } else {
+            tache(0);
+        }
+    };
+    // The pass with the sums of the measure, or without them
+    const ReelPosition *x = store.x.data();
+    const ReelPosition *y = store.y.data();
+    const ReelPosition *z = store.z.data();
+    auto lancer = [&](const auto &interaction, const auto &loi) {
+        if (mesurerForces) {
+            passe(interaction, MesurePaires<DIM, std::decay_t<decltype(loi)>>{x, y, z, rCut2, loi, preparerMesures(nbTaches)});
+        } else {
+            passe(interaction, SansMesure());
+        }
+    };
+    const double sigma2 = static_cast<double>(sigma) * sigma;
+    if (champ) {
+        avecLoi(*champ, store, [&](const auto &loi) {
+            lancer(InteractionLoi<DIM, BORNER, std::decay_t<decltype(loi)>>{x, y, z, fx, fy, fz, rCut2, loi}, loi);
+        });
+    } else if (potentiel) {
+        const LoiTabulee loi{potentiel.get(), store.masse.data()};
+        lancer(InteractionLoi<DIM, BORNER, LoiTabulee>{x, y, z, fx, fy, fz, rCut2, loi}, loi);
+    } else {
+        const LoiAnalytique loi{{sigma2, 24.0 * eps, 4.0 * eps}, store.masse.data()};
+        lancer(InteractionPaire<DIM, BORNER>{x, y, z, fx, fy, fz, rCut2, loi}, loi);
+    }
+    nbPairesTestees = listes.getNbPaires();
+    nbPairesActives = totalActives;
+
+    // Add the forces of the other ranges, then the gravitational force if G is non-zero
+    const float *masse = store.masse.data();
+    if (nbTaches > 1 || G != 0) {
+        pourIntervalles(n, [&](int debut, int fin) {
+            for (int t = 1; t < nbTaches; t++) {
+                const ReelForce *forcesX = forcesTaches.data() + basesTaches[3 * t];
+                const ReelForce *forcesY = forcesTaches.data() + basesTaches[3 * t + 1];
+                const ReelForce *forcesZ = forcesTaches.data() + basesTaches[3 * t + 2];
+                const int finTache = std::min(fin, finsTaches[t]);
+                for (int i = std::max(debut, bornesBlocs[t]); i < finTache; i++) {
+                    fx[i] += forcesX[i];
+                    fy[i] += forcesY[i];
+                    fz[i] += forcesZ[i];
+                }
+            }
+            if (G != 0) {
+                for (int i = debut; i < fin; i++) {
+                    fy[i] += masse[i] * G;
+                }
+            }
+        });
+    }
+}
+
+/**
+ * @brief Updates the cells and the Verlet lists when the lists are no longer valid.
+ *
+ * @param is3D True for the 3D grid and lists.
+ */
+void Univers::mettreAJourVoisinage(bool is3D) {
+    nbPasVerlet++;
+    if (listesValides && !listes.deplacementExcessif(store, verletSkin)) {
+        return;
+    }
+    if (is3D) {
+        reassignCells3D();
+    } else {
+        reassignCells();
+    }
+    listes.construire(store, rCut + verletSkin, L1, L2, is3D ? L3 : 0);
+    listesValides = true;
+}
+
+/**
+ * @brief Sets the number of threads of the force and integration passes.
+ *
+ * @param nbThreads The number of threads, 1 for a sequential run.
+ */
+void Univers::setNbThreads(int nbThreads) {
+    if (nbThreads < 1) {
+        throw std::invalid_argument("Invalid number of threads: must be at least 1.");
+    }
+    this->nbThreads = nbThreads;
+    if (nbThreads > 1) {
+        pool = std::make_shared<PoolThreads>(nbThreads);
+    } else {
+        pool.reset();
+    }
+}
+
+/**
+ * @brief Gets the number of threads.
+ *
+ * @return The number of threads.
+ */
+int Univers::getNbThreads() const {
+    return nbThreads;
+}
+
+/**
+ * @brief Asks the system to back the particle arrays with huge pages (Linux only).
+ *
+ * @param pagesEnormes True to advise transparent huge pages.
+ */
+void Univers::setPagesEnormes(bool pagesEnormes) {
+    store.setPagesEnormes(pagesEnormes);
+}
+
+/**
+ * @brief Tells whether the particle arrays are advised to use huge pages.
+ *
+ * @return True if huge pages are requested.
+ */
+bool Univers::getPagesEnormes() const {
+    return store.getPagesEnormes();
+}
+
+/**
+ * @brief Enables or disables the Verlet neighbor lists.
+ *
+ * @param skin Skin distance, 0 to disable the lists.
+ */
+void Univers::setVerletSkin(float skin) {
+    if (skin < 0) {
+        throw std::invalid_argument("Invalid Verlet skin: must be positive or zero.");
+    }
+    if (skin > 0 && estDecompose()) {
+        throw std::invalid_argument("Invalid Verlet skin: the lists are not supported with a domain decomposition.");
+    }
+    verletSkin = skin;
+    listesValides = false;
+}
+
+/**
+ * @brief Gets the skin distance of the Verlet lists.
+ *
+ * @return The skin distance, 0 when the lists are disabled.
+ */
+float Univers::getVerletSkin() const {
+    return verletSkin;
+}
+
+/**
+ * @brief Gets the number of Verlet list builds.
+ *
+ * @return The number of builds.
+ */
+int Univers::getNbReconstructionsVerlet() const {
+    return listes.getNbReconstructions();
+}
+
+/**
+ * @brief Gets the number of neighborhood updates done in Verlet mode.
+ *
+ * @return The number of updates.
+ */
+int Univers::getNbPasVerlet() const {
+    return nbPasVerlet;
+}
+
+/**
+ * @brief Gets the number of particles that changed cell at the last reassignment.
+ *
+ * @return The number of migrants.
+ */
+int Univers::getNbMigrants() const {
+    return nbMigrants;
+}
+
+/**
+ * @brief Selects the force engine.
+ *
+ * @param forceEngine 0 = full shell, 1 = half shell.
+ */
+void Univers::setForceEngine(int forceEngine) {
+    if (forceEngine < 0 || forceEngine > 1) {
+        throw std::invalid_argument("Invalid force engine: must be 0 (full shell) or 1 (half shell).");
+    }
+    this->forceEngine = forceEngine;
+}
+
+/**
+ * @brief Selects the instruction set of the cell force kernels.
+ *
+ * @param jeu NoyauLJ::AUTOMATIQUE, SCALAIRE, SSE2, AVX2 or AVX512.
+ */
+void Univers::setJeuInstructions(int jeu) {
+    if (jeu != NoyauLJ::AUTOMATIQUE && !NoyauLJ::estDisponible(jeu)) {
+        throw std::invalid_argument("Invalid instruction set: not supported by this processor.");
+    }
+    jeuInstructions = jeu;
+}
+
+/**
+ * @brief Gets the instruction set of the cell force kernels.
+ *
+ * @return The instruction set in use.
+ */
+int Univers::getJeuInstructions() const {
+    return (jeuInstructions == NoyauLJ::AUTOMATIQUE) ? NoyauLJ::detecter() : jeuInstructions;
+}
+
+/**
+ * @brief Replaces the analytic Lennard-Jones kernel with a tabulated potential.
+ *
+ * @param potentiel The table, null to go back to the analytic kernel.
+ */
+void Univers::setPotentielTabule(std::shared_ptr<const PotentielTabule> potentiel) {
+    try {
+        if (potentiel && potentiel->getR2Max() < static_cast<double>(rCut) * rCut * (1 - 1e-9)) {
+            throw std::invalid_argument("Invalid potential table: it must be sampled up to the cutoff radius.");
+        }
+        this->potentiel = potentiel;
+        if (potentiel) {
+            champ.reset();
+        }
+        forcesAJour = false;
+    } catch (const std::exception &e) {
+        logError(e.what());
+        throw;
+    }
+}
+
+/**
+ * @brief Gets the tabulated potential.
+ *
+ * @return The table, null for the analytic kernel.
+ */
+const PotentielTabule *Univers::getPotentielTabule() const {
+    return potentiel.get();
+}
+
+/**
+ * @brief Replaces the analytic Lennard-Jones kernel with a force field.
+ *
+ * @param champ The force field, null to go back to the analytic kernel.
+ */
+void Univers::setChampForces(std::shared_ptr<const ChampForces> champ) {
+    try {
+        if (champ && champ->getNbCategories() < 1) {
+            throw std::invalid_argument("Invalid force field: it has no category.");
+        }
+        this->champ = champ;
+        if (champ) {
+            potentiel.reset();
+        }
+        forcesAJour = false;
+        categoriesVerifiees = false;
+    } catch (const std::exception &e) {
+        logError(e.what());
+        throw;
+    }
+}
+
+/**
+ * @brief Gets the force field.
+ *
+ * @return The force field, null when not set.
+ */
+const ChampForces *Univers::getChampForces() const {
+    return champ.get();
+}
+
+/**
+ * @brief Selects the order of the cells in the cell array.
+ *
+ * @param ordre OrdreCellules::LIGNES, MORTON or HILBERT.
+ */
+void Univers::setOrdreCellules(int ordre) {
+    if (ordre < OrdreCellules::LIGNES || ordre > OrdreCellules::HILBERT) {
+        throw std::invalid_argument("Invalid cell order: must be 0 (row-major), 1 (Morton) or 2 (Hilbert).");
+    }
+    if (grilleCreuse && ordre != OrdreCellules::LIGNES) {
+        throw std::invalid_argument("Invalid cell order: the sparse grid keeps its cells in row-major order.");
+    }
+    if (ordre == ordreCellules) {
+        return;
+    }
+    ordreCellules = ordre;
+
+    // Back to row-major order, then to the new one
+    std::vector<Cellule> lignes(cellules);
+    for (const Cellule &cellule : cellules) {
+        const int *id = cellule.getId();
+        lignes[id[0] + id[1] * gridWidth + id[2] * gridWidth * gridHeight] = cellule;
+    }
+    cellules.swap(lignes);
+    rangCellules.clear();
+    ordonnerCellules();
+
+    // Same cells, new indices
+    std::vector<int> nouvelIndex(cellules.size());
+    for (size_t c = 0; c < lignes.size(); c++) {
+        const int *id = lignes[c].getId();
+        nouvelIndex[c] = indexCellule(id[0], id[1], id[2]);
+    }
+    for (int &c : store.cellule) {
+        c = nouvelIndex[c];
+    }
+    plagesValides = false;
+    listesValides = false;
+}
+
+/**
+ * @brief Gets the order of the cells in the cell array.
+ *
+ * @return OrdreCellules::LIGNES, MORTON or HILBERT.
+ */
+int Univers::getOrdreCellules() const {
+    return ordreCellules;
+}
+
+/**
+ * @brief Selects the sparse grid, which only creates the cells holding a particle and their neighbors.
+ *
+ * The particles already added are moved to the cells of the new grid; the store is
+ * sorted again before the next force pass.
+ *
+ * @param creuse true for the sparse grid, false for the dense one.
+ */
+void Univers::setGrilleCreuse(bool creuse) {
+    try {
+        if (creuse == grilleCreuse) {
+            return;
+        }
+        if (creuse && ordreCellules != OrdreCellules::LIGNES) {
+            throw std::invalid_argument("Invalid sparse grid: the cells must be in row-major order.");
+        }
+        grilleCreuse = creuse;
+        if (creuse) {
+            construireGrilleCreuse();
+            return;
+        }
+        construireCellules();
+        for (int i = 0; i < store.getNbParticules(); i++) {
+            store.cellule[i] = celluleDePosition(store.x[i], store.y[i], store.z[i]);
+        }
+        celluleManquante = false;
+        plagesValides = false;
+        listesValides = false;
+    } catch (const std::exception &e) {
+        logError(e.what());
+        throw;
+    }
+}
+
+/**
+ * @brief Tells whether only the occupied cells and their neighbors are created.
+ *
+ * @return true for the sparse grid.
+ */
+bool Univers::getGrilleCreuse() const {
+    return grilleCreuse;
+}
+
+/**
+ * @brief Gets the number of cells created.
+ *
+ * @return The number of cells.
+ */
+int Univers::getNbCellules() const {
+    return static_cast<int>(cellules.size());
+}
+
+/**
+ * @brief Moves the row-major cells to the positions of the selected order.
+ */
+void Univers::ordonnerCellules() {
+    if (ordreCellules == OrdreCellules::LIGNES || cellules.empty()) {
+        return;
+    }
+    rangCellules = OrdreCellules::calculerRangs(ordreCellules, gridWidth, gridHeight, gridDepth);
+    std::vector<Cellule> ordonnees(cellules);
+    for (size_t r = 0; r < cellules.size(); r++) {
+        ordonnees[rangCellules[r]] = cellules[r];
+    }
+    cellules.swap(ordonnees);
+}
+
+/**
+ * @brief Selects the format of the VTK files.
+ *
+ * @param format 0 = ASCII, 1 = raw binary, 2 = zlib-compressed binary.
+ */
+void Univers::setFormatVTK(int format) {
+    ecritureVTK.setFormat(format);
+    if (ecritureAsynchrone) {
+        ecritureAsynchrone = std::make_shared<EcritureAsynchrone>(format);
+    }
+}
+
+/**
+ * @brief Gets the format of the VTK files.
+ *
+ * @return 0 = ASCII, 1 = raw binary, 2 = zlib-compressed binary.
+ */
+int Univers::getFormatVTK() const {
+    return ecritureVTK.getFormat();
+}
+
+/**
+ * @brief Writes a VTK file every given number of steps.
+ *
+ * @param frequence Number of steps between two files, 0 to disable the output.
+ */
+void Univers::setFrequenceSortie(int frequence) {
+    if (frequence < 0) {
+        throw std::invalid_argument("Invalid output frequency: must be positive or 0.");
+    }
+    frequenceSortie = frequence;
+}
+
+/**
+ * @brief Gets the number of steps between two VTK files.
+ *
+ * @return The number of steps, 0 if the output is disabled.
+ */
+int Univers::getFrequenceSortie() const {
+    return frequenceSortie;
+}
+
+/**
+ * @brief Writes a VTK file every given interval of simulated time.
+ *
+ * @param intervalle Simulated time between two files, 0 to use the step frequency.
+ */
+void Univers::setIntervalleSortie(float intervalle) {
+    if (intervalle < 0) {
+        throw std::invalid_argument("Invalid output interval: must be positive or 0.");
+    }
+    intervalleSortie = intervalle;
+}
+
+/**
+ * @brief Gets the simulated time between two VTK files.
+ *
+ * @return The interval, 0 if the step frequency is used.
+ */
+float Univers::getIntervalleSortie() const {
+    return intervalleSortie;
+}
+
+/**
+ * @brief Writes the VTK files on a background thread or synchronously.
+ *
+ * @param asynchrone true to write on a background thread.
+ */
+void Univers::setEcritureAsynchrone(bool asynchrone) {
+    if (!asynchrone) {
+        ecritureAsynchrone.reset();
+    } else if (!ecritureAsynchrone) {
+        ecritureAsynchrone = std::make_shared<EcritureAsynchrone>(ecritureVTK.getFormat());
+    }
+}
+
+/**
+ * @brief Tells whether the VTK files are written on a background thread.
+ *
+ * @return true if the output is asynchronous.
+ */
+bool Univers::getEcritureAsynchrone() const {
+    return ecritureAsynchrone != nullptr;
+}
+
+/**
+ * @brief Sets the start of the VTK file names.
+ *
+ * @param prefixe The prefix, followed by _t<N>.vtu.
+ */
+void Univers::setPrefixeSortie(const std::string &prefixe) {
+    if (prefixe.empty()) {
+        throw std::invalid_argument("Invalid output prefix: must not be empty.");
+    }
+    prefixeSortie = prefixe;
+}
+
+/**
+ * @brief Gets the start of the VTK file names.
+ *
+ * @return The prefix.
+ */
+const std::string& Univers::getPrefixeSortie() const {
+    return prefixeSortie;
+}
+
+/**
+ * @brief Writes the snapshots to a single trajectory file instead of one VTK file each.
+ *
+ * @param fichier The trajectory file, empty to go back to the VTK files.
+ * @param reprendre true to keep the frames of the existing file up to the current step.
+ */
+void Univers::setTrajectoire(const std::string &fichier, bool reprendre) {
+    try {
+        trajectoire.reset();
+        if (!fichier.empty()) {
+            trajectoire = std::make_shared<EcritureTrajectoire>(nomDuRang(fichier), dimension, reprendre ? iteration : -1);
+        }
+    } catch (const std::exception &e) {
+        logError(e.what());
+        throw;
+    }
+}
+
+/**
+ * @brief Enables or disables the per-phase timers and counters.
+ *
+ * @param actif true to record the profile.
+ */
+void Univers::setProfilage(bool actif) {
+    profil.setActif(actif);
+}
+
+/**
+ * @brief Gets the performance profile of the current run.
+ *
+ * @return The profile.
+ */
+const ProfilPerformance& Univers::getProfil() const {
+    return profil;
+}
+
+/**
+ * @brief Writes a performance report at the end of each run, and every given number of steps.
+ *
+ * @param fichier The report file: JSON if its name ends with .json, CSV otherwise. Empty to disable the report.
+ * @param frequence Number of steps between two intermediate reports, 0 for the final report only.
+ */
+void Univers::setRapportPerformance(const std::string &fichier, int frequence) {
+    if (frequence < 0) {
+        throw std::invalid_argument("Invalid report frequency: must be positive or 0.");
+    }
+    fichierRapport = fichier;
+    frequenceRapport = fichier.empty() ? 0 : frequence;
+    rapportCommence = false;
+    if (!fichier.empty()) {
+        profil.setActif(true);
+    }
+}
+
+/**
+ * @brief Writes the performance report with the current cell occupancy.
+ *
+ * A JSON report replaces the file; a CSV report adds one line per call.
+ */
+void Univers::ecrireRapport() {
+    assurerTri();
+    profil.mesurerOccupation(store, static_cast<int>(cellules.size()));
+    const std::string extension = ".json";
+    const bool json = fichierRapport.size() >= extension.size() &&
+                      fichierRapport.compare(fichierRapport.size() - extension.size(), extension.size(), extension) == 0;
+    if (json) {
+        profil.ecrireJSON(nomDuRang(fichierRapport), iteration, temps);
+    } else {
+        profil.ecrireCSV(nomDuRang(fichierRapport), iteration, temps, !rapportCommence);
+    }
+    rapportCommence = true;
+}
+
+/**
+ * @brief Gets the force engine.
+ *
+ * @return 0 = full shell, 1 = half shell.
+ */
+int Univers::getForceEngine() const {
+    return forceEngine;
+}
+
+/**
+ * @brief Checks once that the categories of the particles lie in those of the force field.
+ *
+ * The particles received from the other ranks were checked on their rank, so the
+ * migration and the ghosts keep the check.
+ */
+void Univers::verifierCategories() {
+    if (champ) {
+        const int nbCategories = champ->getNbCategories();
+        for (int categorie : store.categorie) {
+            if (categorie < 0 || categorie >= nbCategories) {
+                throw std::invalid_argument("Invalid particle category: the force field has " + std::to_string(nbCategories) +
+                                            " categories.");
+            }
+        }
+    }
+    categoriesVerifiees = true;
+}
+
+/**
+ * @brief Runs the selected force engine.
+ *
+ * The Verlet lists are used when they are enabled and valid, otherwise the
+ * half-shell or full-shell cell kernel. In 2D the forces are capped only when
+ * scaleType is 0, in 3D they are always capped.
+ *
+ * @tparam DIM 2 or 3.
+ */
+template <int DIM>
+void Univers::calculForcesDim() {
+    const bool borner = (DIM == 3) || scaleType == 0;
+    if (!categoriesVerifiees) {
+        verifierCategories();
+    }
+    if (verletSkin > 0 && listesValides) {
+        if (borner) {
+            calculForcesListes<DIM, true>();
+        } else {
+            calculForcesListes<DIM, false>();
+        }
+    } else if (forceEngine == 1) {
+        if (borner) {
+            calculForcesDemiCoquille<DIM, true>();
+        } else {
+            calculForcesDemiCoquille<DIM, false>();
+        }
+    } else {
+        calculForcesCellules<DIM>();
+    }
+    if (mesurerForces) {
+        // Sums of the cells of this rank, in the order of the cells
+        double energie = 0, viriel = 0;
+        const int nbSommes = static_cast<int>(mesuresCellules.size()) / 2;
+        for (int c = 0; c < nbSommes; c++) {
+            if (estDecompose() && c < static_cast<int>(cellules.size())) {
+                const int couche = coucheCellule(c);
+                if (couche < decomposition->getDebut() || couche >= decomposition->getFin()) {
+                    continue;
+                }
+            }
+            energie += mesuresCellules[2 * c];
+            viriel += mesuresCellules[2 * c + 1];
+        }
+        statistiques.energiePotentielle = energie;
+        statistiques.viriel = viriel;
+    }
+    forcesAJour = true;
+    if (profil.estActif()) {
+        profil.ajouterPaires(nbPairesTestees, nbPairesActives);
+    }
+}
+
+/**
+ * @brief Calculates the forces on each particle using the Lennard-Jones potential and gravitational forces.
+ *
+ */
+void Univers::calculForces() {
+    try {
+        calculForcesDim<2>();
+    } catch (const std::exception &e) {
+        logError(e.what());
+        throw;
     }
 }
 
@@ -545,134 +2164,802 @@ void Univers::calculForces() {
  * @brief Calculates the forces on each particle using the Lennard-Jones potential and gravitational forces in 3D.
  *
  */
-void Univers::calculForces3D() {
+void Univers::calculForces3D() {
+    try {
+        calculForcesDim<3>();
+    } catch (const std::exception &e) {
+        logError(e.what());
+        throw;
+    }
+}
+
+/**
+ * @brief Applies periodic boundary conditions to the simulation.
+ *
+ * This function ensures that particles that move out of the simulation domain on one side
+ * re-enter on the opposite side, maintaining the continuity of the simulation space.
+ * The function iterates through each particle, checks if a particle's position
+ * is outside the domain boundaries in 2D or 3D, and if so, wraps the position around to the opposite side.
+ */
+void Univers::periodicBC() {
+    try {
+        const int n = store.getNbParticules();
+        for (int i = 0; i < n; i++) {
+            double posOldX = store.x[i];
+            double posOldY = store.y[i];
+            double posOldZ = store.z[i];
+
+            // Apply periodic boundary conditions for X coordinate
+            if (posOldX < 0) {
+                store.x[i] = L1 - std::abs(fmod(posOldX, L1));
+            }
+            if (posOldX >= L1) {
+                store.x[i] = fmod(posOldX, L1);
+            }
+
+            // Apply periodic boundary conditions for Y coordinate
+            if (posOldY < 0) {
+                store.y[i] = L2 - std::abs(fmod(posOldY, L2));
+            }
+            if (posOldY >= L2) {
+                store.y[i] = fmod(posOldY, L2);
+            }
+
+            // Apply periodic boundary conditions for Z coordinate
+            if (posOldZ < 0 && L3 != 0) {
+                store.z[i] = L3 - std::abs(fmod(posOldZ, L3));
+            }
+            if (posOldZ >= L3 && L3 != 0) {
+                store.z[i] = fmod(posOldZ, L3);
+            }
+        }
+    } catch (const std::exception &e) {
+        logError(e.what());
+        throw;
+    }
+}
+
+/**
+ * @brief Calculates the total kinetic energy of the system.
+ *
+ * This function computes the kinetic energy of all particles in the system.
+ * The kinetic energy for each particle is calculated as 0.5 * mass * velocity^2.
+ *
+ * @return The total kinetic energy of the system.
+ */
+double Univers::energieCinetique() {
+    try {
+        // Parallel reduction, the partial sums of the intervals added in a fixed order
+        double sommes[7];
+        sommerVitesses<3, false>(sommes);
+        return estDecompose() ? decomposition->sommer(sommes[0]) : sommes[0];
+    } catch (const std::exception &e) {
+        logError(e.what());
+        throw;
+    }
+}
+
+/**
+ * @brief Measures the statistics every few steps of the runs.
+ *
+ * @param frequence The number of steps between two measures, 0 to stop measuring.
+ * @param fichier The time series file, empty to keep only the last measure.
+ */
+void Univers::setStatistiques(int frequence, const std::string &fichier) {
+    try {
+        if (frequence < 0) {
+            throw std::invalid_argument("Invalid statistics frequency: must be positive or 0.");
+        }
+        frequenceStatistiques = frequence;
+        serieStatistiques.reset();
+        // The measures are global sums: one series for the whole decomposition
+        if (frequence > 0 && !fichier.empty() && (!estDecompose() || decomposition->getRang() == 0)) {
+            serieStatistiques = std::make_shared<SerieStatistiques>(fichier);
+        }
+    } catch (const std::exception &e) {
+        logError(e.what());
+        throw;
+    }
+}
+
+/**
+ * @brief Gets the number of steps between two measures of the statistics.
+ *
+ * @return The number of steps, 0 when not measured.
+ */
+int Univers::getFrequenceStatistiques() const {
+    return frequenceStatistiques;
+}
+
+/**
+ * @brief Gets the last measure of the statistics.
+ *
+ * @return The last measure.
+ */
+const Statistiques &Univers::getStatistiques() const {
+    return statistiques;
+}
+
+/**
+ * @brief Measures the statistics of the current state with a measured force pass.
+ *
+ * @return The measure.
+ */
+const Statistiques &Univers::mesurerStatistiques() {
+    try {
+        mesurerForces = true;
+        if (dimension == 3 && L3 != 0) {
+            calculForcesPas<3>();
+        } else {
+            calculForcesPas<2>();
+        }
+        mesurerForces = false;
+        double sommes[7];
+        sommerVitesses<3, false>(sommes);
+        terminerStatistiques(sommes);
+        return statistiques;
+    } catch (const std::exception &e) {
+        mesurerForces = false;
+        logError(e.what());
+        throw;
+    }
+}
+
+/**
+ * @brief Prepares mesuresCellules for a measured force pass.
+ *
+ * @param nbSommes The minimum number of pairs of sums, for the passes summing per thread.
+ * @return Two zeroed sums per cell, at least nbSommes.
+ */
+double *Univers::preparerMesures(int nbSommes) {
+    mesuresCellules.assign(2 * std::max<size_t>(cellules.size(), static_cast<size_t>(std::max(nbSommes, 1))), 0.0);
+    return mesuresCellules.data();
+}
+
+/**
+ * @brief Sums the kinetic energy, the momentum and the field energy, optionally in the velocity update.
+ *
+ * @tparam DIM 2 or 3, the number of components updated.
+ * @tparam MISE_A_JOUR true to update the velocities in the same loop.
+ * @tparam LANGEVIN true to add the random kicks of the Langevin thermostat.
+ * @param sommes Receives Ec, px, py, pz, the field energy and the largest v² and (F / m)².
+ */
+template <int DIM, bool MISE_A_JOUR, bool LANGEVIN>
+void Univers::sommerVitesses(double sommes[7]) {
+    const int n = store.getNbParticules();
+    // Factor of the thermostat, 1 without it (the product is then exact)
+    const double echelle = thermostat.getEchelle();
+    const double bruit = thermostat.getBruit();
+    const uint64_t graine = thermostat.getGraine();
+    const auto pas = static_cast<uint64_t>(iteration);
+    partielsVitesses.resize(7 * static_cast<size_t>(pool ? pool->getNbIntervalles(n) : 1));
+    const int nbIntervalles = pourIntervallesNumerotes(n, [&](int intervalle, int debut, int fin) {
+        double ec = 0, px = 0, py = 0, pz = 0, hauteur = 0, v2Max = 0, a2Max = 0;
+        for (int i = debut; i < fin; i++) {
+            const double m = store.masse[i];
+            if (MISE_A_JOUR) {
+                const double coef = dt * (0.5 / m);
+                store.vx[i] = echelle * (store.vx[i] + (store.fx[i] + store.fxOld[i]) * coef);
+                store.vy[i] = echelle * (store.vy[i] + (store.fy[i] + store.fyOld[i]) * coef);
+                if (DIM == 3) {
+                    store.vz[i] = echelle * (store.vz[i] + (store.fz[i] + store.fzOld[i]) * coef);
+                }
+                if (LANGEVIN) {
+                    const double ecart = bruit / std::sqrt(m);
+                    const auto id = static_cast<uint64_t>(store.id[i]);
+                    double gx, gy;
+                    Thermostat::gaussiennes(graine, pas, id, 0, gx, gy);
+                    store.vx[i] += ecart * gx;
+                    store.vy[i] += ecart * gy;
+                    if (DIM == 3) {
+                        double gz, inutilise;
+                        Thermostat::gaussiennes(graine, pas, id, 1, gz, inutilise);
+                        store.vz[i] += ecart * gz;
+                    }
+                }
+            }
+            const double vx = store.vx[i], vy = store.vy[i], vz = store.vz[i];
+            const double v2 = vx * vx + vy * vy + vz * vz;
+            const double f2 = static_cast<double>(store.fx[i]) * store.fx[i] + static_cast<double>(store.fy[i]) * store.fy[i] +
+                              static_cast<double>(store.fz[i]) * store.fz[i];
+            v2Max = std::max(v2Max, v2);
+            a2Max = std::max(a2Max, f2 / (m * m));
+            ec += m * v2;
+            px += m * vx;
+            py += m * vy;
+            pz += m * vz;
+            hauteur += m * store.y[i];
+        }
+        double *partiel = &partielsVitesses[7 * intervalle];
+        partiel[0] = 0.5 * ec;
+        partiel[1] = px;
+        partiel[2] = py;
+        partiel[3] = pz;
+        partiel[4] = -G * hauteur;
+        partiel[5] = v2Max;
+        partiel[6] = a2Max;
+    });
+    std::fill(sommes, sommes + 7, 0.0);
+    for (int t = 0; t < nbIntervalles; t++) {
+        for (int k = 0; k < 5; k++) {
+            sommes[k] += partielsVitesses[7 * t + k];
+        }
+        sommes[5] = std::max(sommes[5], partielsVitesses[7 * t + 5]);
+        sommes[6] = std::max(sommes[6], partielsVitesses[7 * t + 6]);
+    }
+}
+
+/**
+ * @brief Completes the measure from the sums of this rank.
+ *
+ * @param sommes Ec, px, py, pz and the field energy of this rank (the maxima are not read).
+ */
+void Univers::terminerStatistiques(const double sommes[7]) {
+    statistiques.iteration = iteration;
+    statistiques.temps = temps;
+    statistiques.energieCinetique = sommes[0];
+    statistiques.energiePotentielle += sommes[4];
+    for (int k = 0; k < 3; k++) {
+        statistiques.quantiteMouvement[k] = sommes[1 + k];
+    }
+    if (estDecompose()) {
+        statistiques.energieCinetique = decomposition->sommer(statistiques.energieCinetique);
+        statistiques.energiePotentielle = decomposition->sommer(statistiques.energiePotentielle);
+        statistiques.viriel = decomposition->sommer(statistiques.viriel);
+        for (double &p : statistiques.quantiteMouvement) {
+            p = decomposition->sommer(p);
+        }
+    }
+    statistiques.nbParticules = getNbParticulesTotal();
+
+    // Temperature and virial pressure, with k_B = 1 (a 3D universe with L3 = 0 runs in 2D)
+    const int d = (dimension == 3 && L3 != 0) ? 3 : 2;
+    const double volume = static_cast<double>(L1) * L2 * ((d == 3) ? L3 : 1);
+    statistiques.temperature = (statistiques.nbParticules > 0) ? 2 * statistiques.energieCinetique / (d * statistiques.nbParticules) : 0;
+    statistiques.pression = (volume > 0) ? (2 * statistiques.energieCinetique + statistiques.viriel) / (d * volume) : 0;
+}
+
+/**
+ * @brief Computes the temperature 2 Ec / (d N) over every MPI rank.
+ *
+ * @param energie The kinetic energy of this rank.
+ * @return The temperature, 0 without particles.
+ */
+double Univers::calculerTemperature(double energie) {
+    const int d = (dimension == 3 && L3 != 0) ? 3 : 2;
+    const double total = estDecompose() ? decomposition->sommer(energie) : energie;
+    const long n = getNbParticulesTotal();
+    return (n > 0) ? 2 * total / (d * n) : 0;
+}
+
+/**
+ * @brief Controls the temperature of the runs with a thermostat.
+ *
+ * @param type Thermostat::AUCUN, BERENDSEN, LANGEVIN or NOSE_HOOVER.
+ * @param temperature The target temperature.
+ * @param tempsCouplage The coupling time.
+ * @param graine The seed of the random kicks of Langevin.
+ */
+void Univers::setThermostat(int type, double temperature, double tempsCouplage, uint64_t graine) {
+    try {
+        thermostat = Thermostat(type, temperature, tempsCouplage, graine);
+    } catch (const std::exception &e) {
+        logError(e.what());
+        throw;
+    }
+}
+
+/**
+ * @brief Gets the thermostat.
+ *
+ * @return The thermostat, of type AUCUN when not set.
+ */
+const Thermostat &Univers::getThermostat() const {
+    return thermostat;
+}
+
+/**
+ * @brief Chooses the time step of the runs from the velocities and the forces.
+ *
+ * @param deplacementMax The largest displacement of a particle in a step, 0 to go back to the fixed step.
+ * @param dtMin The smallest step.
+ * @param dtMax The largest step, 0 for the current step.
+ */
+void Univers::setPasAdaptatif(float deplacementMax, float dtMin, float dtMax) {
+    try {
+        if (deplacementMax < 0 || dtMin < 0 || dtMax < 0) {
+            throw std::invalid_argument("Invalid adaptive step: the displacement and the bounds must be positive or 0.");
+        }
+        const float pasFixe = (this->dtMax > 0) ? this->dtMax : dt;
+        const float maximum = (dtMax > 0) ? dtMax : pasFixe;
+        if (deplacementMax > 0 && dtMin > maximum) {
+            throw std::invalid_argument("Invalid adaptive step: dtMin must not exceed dtMax.");
+        }
+        if (deplacementMax > 0) {
+            this->dtMin = dtMin;
+            this->dtMax = maximum;
+        } else {
+            // Back to the fixed step, the largest one
+            dt = pasFixe;
+            this->dtMin = 0;
+            this->dtMax = 0;
+        }
+        deplacementMaxPas = deplacementMax;
+    } catch (const std::exception &e) {
+        logError(e.what());
+        throw;
+    }
+}
+
+/**
+ * @brief Gets the largest displacement of a particle in an adaptive step.
+ *
+ * @return The displacement, 0 for the fixed step.
+ */
+float Univers::getPasAdaptatif() const {
+    return deplacementMaxPas;
+}
+
+/**
+ * @brief Gets the time step of the next step.
+ *
+ * @return The time step.
+ */
+float Univers::getDt() const {
+    return dt;
+}
+
+/**
+ * @brief Chooses the time step of the next step from the largest velocity and acceleration.
+ *
+ * @param sommes The sums of sommerVitesses on this rank.
+ */
+void Univers::choisirPas(const double sommes[7]) {
+    double v2Max = sommes[5], a2Max = sommes[6];
+    if (estDecompose()) {
+        v2Max = decomposition->maximum(v2Max);
+        a2Max = decomposition->maximum(a2Max);
+    }
+    // A particle moves by at most v dt + a dt² / 2 <= 2 deplacementMaxPas
+    double pas = dtMax;
+    if (v2Max > 0) {
+        pas = std::min(pas, deplacementMaxPas / std::sqrt(v2Max));
+    }
+    if (a2Max > 0) {
+        pas = std::min(pas, std::sqrt(2 * deplacementMaxPas / std::sqrt(a2Max)));
+    }
+    dt = static_cast<float>(std::max(pas, static_cast<double>(dtMin)));
+}
+
+/**
+ * @brief Applies absorption boundary conditions to the simulation.
+ *
+ * This function removes particles that move out of the simulation domain.
+ * If a particle's position is outside the domain boundaries, it is removed from the simulation.
+ * The remaining particles keep their order, so the cell ranges only need to be recounted.
+ */
+void Univers::absorptionBC() {
+    try {
+        const int n = store.getNbParticules();
+        aSupprimer.assign(n, 0);
+        bool suppression = false;
+
+        for (int i = 0; i < n; i++) {
+            // Check if the particle is outside the domain boundaries
+            if (store.x[i] < 0 || store.x[i] > L1 || store.y[i] < 0 || store.y[i] > L2 || store.z[i] < 0 || store.z[i] > L3) {
+                std::cout << "Removing particle at index: " << i << std::endl;
+                aSupprimer[i] = 1;
+                suppression = true;
+            }
+        }
+
+        if (suppression) {
+            // Decrease the total number of particles
+            nbParticules -= store.removeFlagged(aSupprimer);
+            listesValides = false;
+            if (plagesValides) {
+                store.recountCells(static_cast<int>(cellules.size()));
+                synchroniserPlages();
+            }
+        }
+    } catch (const std::exception &e) {
+        logError(e.what());
+        throw;
+    }
+}
+
+/**
+ * @brief Reassigns particles to the correct cells based on their positions.
+ *
+ * This function computes the new cell of every particle from its position,
+ * then moves only the particles whose cell changed.
+ */
+void Univers::reassignCells() {
+    try {
+        const int n = store.getNbParticules();
+
+        // Compute the new cell of each particle from its position
+        std::atomic<int> horsGrille(-1);
+        std::atomic<bool> manquante(false);
+        pourIntervalles(n, [&](int debut, int fin) {
+            for (int i = debut; i < fin; i++) {
+                int cellX = static_cast<int>(store.x[i] / rCut);
+                int cellY = static_cast<int>(store.y[i] / rCut);
+
+                // Ensure the particle is within the grid bounds
+                if (cellX >= 0 && cellX <= gridWidth && cellY >= 0 && cellY <= gridHeight) {
+                    // Handle edge cases where the particle is on the boundary
+                    if (cellX == gridWidth) {
+                        cellX--;
+                    }
+                    if (cellY == gridHeight) {
+                        cellY--;
+                    }
+
+                    const int c = celluleApresDeplacement(store.cellule[i], cellX, cellY, 0);
+                    store.cellule[i] = c;
+                    if (c < 0) {
+                        manquante = true;
+                    }
+                } else {
+                    // Reported once the threads are done
+                    horsGrille = i;
+                }
+            }
+        });
+        if (horsGrille >= 0) {
+            // If a particle is out of bounds, print an error message and exit
+            const int i = horsGrille;
+            std::ostringstream oss;
+            oss << "Particle out of bounds: ID=" << store.id[i] << ", Position=(" << store.x[i] << ", " << store.y[i] << ")";
+            throw std::out_of_range(oss.str());
+        }
+        if (manquante) {
+            // Some particles entered cells of the sparse grid not created yet
+            construireGrilleCreuse();
+        }
+
+        // Move the particles that changed cell
+        migrerParticules();
+    } catch (const std::exception &e) {
+        logError(e.what());
+        throw;
+    }
+}
+
+/**
+ * @brief Reassigns particles to the correct cells based on their positions in 3D.
+ *
+ * This function computes the new cell of every particle from its position,
+ * then moves only the particles whose cell changed.
+ */
+void Univers::reassignCells3D() {
     try {
-        int gridWidth = L1 / rCut;
-        int gridHeight = L2 / rCut;
-        int gridDepth = L3 / rCut;
-
-        for (auto &cellule : cellules) {
-            int *id = cellule.getId();
-            int x = id[0];
-            int y = id[1];
-            int z = id[2];
-
-            // List of neighboring particles
-            std::vector<Particule3D> particules_voisines;
-            std::vector<Particule3D> &part = cellule.getParticules();
-
-            // Interactions with the neighboring cells
-            for (int dx = -1; dx <= 1; dx++) {
-                for (int dy = -1; dy <= 1; dy++) {
-                    for (int dz = -1; dz <= 1; dz++) {
-                        int neighborX = x + dx;
-                        int neighborY = y + dy;
-                        int neighborZ = z + dz;
-
-                        // Check if the neighbor coordinates are within the grid bounds
-                        if (neighborX >= 0 && neighborX < gridWidth && neighborY >= 0 && neighborY < gridHeight && neighborZ >= 0 && neighborZ < gridDepth) {
-                            auto &neighborCell = cellules[neighborX + neighborY * gridWidth + neighborZ * gridWidth * gridHeight];
-                            // Add all particles from this neighbor to the list of neighboring particles
-                            std::vector<Particule3D> neighborParticles = neighborCell.getParticules();
-                            particules_voisines.insert(particules_voisines.end(), neighborParticles.begin(), neighborParticles.end());
-                        }
+        const int n = store.getNbParticules();
+
+        // Compute the new cell of each particle from its position
+        std::atomic<int> horsGrille(-1);
+        std::atomic<bool> manquante(false);
+        pourIntervalles(n, [&](int debut, int fin) {
+            for (int i = debut; i < fin; i++) {
+                int cellX = static_cast<int>(store.x[i] / rCut);
+                int cellY = static_cast<int>(store.y[i] / rCut);
+                int cellZ = static_cast<int>(store.z[i] / rCut);
+
+                // Ensure the particle is within the grid bounds
+                if (cellX >= 0 && cellX <= gridWidth && cellY >= 0 && cellY <= gridHeight && cellZ >= 0 && cellZ <= gridDepth) {
+                    // Handle edge cases where the particle is on the boundary
+                    if (cellX == gridWidth) {
+                        cellX--;
+                    }
+                    if (cellY == gridHeight) {
+                        cellY--;
+                    }
+                    if (cellZ == gridDepth) {
+                        cellZ--;
+                    }
+
+                    const int c = celluleApresDeplacement(store.cellule[i], cellX, cellY, cellZ);
+                    store.cellule[i] = c;
+                    if (c < 0) {
+                        manquante = true;
+                    }
+                } else {
+                    // Reported once the threads are done
+                    horsGrille = i;
+                }
+            }
+        });
+        if (horsGrille >= 0) {
+            // If a particle is out of bounds, print an error message and exit
+            const int i = horsGrille;
+            std::ostringstream oss;
+            oss << "Particle out of bounds: ID=" << store.id[i] << ", Position=(" << store.x[i] << ", " << store.y[i] << ", " << store.z[i] << ")";
+            throw std::out_of_range(oss.str());
+        }
+        if (manquante) {
+            // Some particles entered cells of the sparse grid not created yet
+            construireGrilleCreuse();
+        }
+
+        // Move the particles that changed cell
+        migrerParticules();
+    } catch (const std::exception &e) {
+        logError(e.what());
+        throw;
+    }
+}
+
+/**
+ * @brief Updates the positions with the current velocities and forces, and saves the forces.
+ *
+ * With reflecting boundaries, the velocity components that would take a particle
+ * out of the box during the step are reversed before moving it.
+ *
+ * @tparam DIM 2 or 3, the number of components updated.
+ * @tparam BC The boundary condition (see boundaryCond).
+ */
+template <int DIM, int BC>
+void Univers::miseAJourPositions() {
+    pourIntervalles(store.getNbParticules(), [&](int debut, int fin) {
+        for (int i = debut; i < fin; i++) {
+            const double coef = dt * (0.5 / store.masse[i]);
+
+            if (BC == 2) {
+                // Reflection boundary conditions
+                double xPred = store.x[i] + (store.vx[i] + store.fx[i] * coef) * dt;
+                double yPred = store.y[i] + (store.vy[i] + store.fy[i] * coef) * dt;
+                if (xPred < 0 || xPred > L1) {
+                    store.vx[i] = -store.vx[i];
+                }
+                if (yPred < 0 || yPred > L2) {
+                    store.vy[i] = -store.vy[i];
+                }
+                if (DIM == 3) {
+                    double zPred = store.z[i] + (store.vz[i] + store.fz[i] * coef) * dt;
+                    if (zPred < 0 || zPred > L3) {
+                        store.vz[i] = -store.vz[i];
                     }
                 }
             }
+            store.x[i] += (store.vx[i] + store.fx[i] * coef) * dt;
+            store.y[i] += (store.vy[i] + store.fy[i] * coef) * dt;
+            store.fxOld[i] = store.fx[i];
+            store.fyOld[i] = store.fy[i];
+            if (DIM == 3) {
+                store.z[i] += (store.vz[i] + store.fz[i] * coef) * dt;
+                store.fzOld[i] = store.fz[i];
+            }
+        }
+    });
+}
+
+/**
+ * @brief Updates the velocities with the mean of the old and new forces.
+ *
+ * @tparam DIM 2 or 3, the number of components updated.
+ */
+template <int DIM>
+void Univers::miseAJourVitesses() {
+    pourIntervalles(store.getNbParticules(), [&](int debut, int fin) {
+        for (int i = debut; i < fin; i++) {
+            const double coef = dt * (0.5 / store.masse[i]);
+            store.vx[i] += (store.fx[i] + store.fxOld[i]) * coef;
+            store.vy[i] += (store.fy[i] + store.fyOld[i]) * coef;
+            if (DIM == 3) {
+                store.vz[i] += (store.fz[i] + store.fzOld[i]) * coef;
+            }
+        }
+    });
+}
+
+/**
+ * @brief Updates the velocities with the sums of the thermostat, of the statistics and of the adaptive step.
+ *
+ * The temperature read by Berendsen and Nosé–Hoover is the one summed by the previous
+ * update; the sums of this update give the temperature and the time step of the next one.
+ *
+ * @tparam DIM 2 or 3.
+ */
+template <int DIM>
+void Univers::miseAJourVitessesSommees() {
+    thermostat.preparer(temperatureThermostat, dt);
+    double sommes[7];
+    if (thermostat.getType() == Thermostat::LANGEVIN) {
+        sommerVitesses<DIM, true, true>(sommes);
+    } else {
+        sommerVitesses<DIM, true>(sommes);
+    }
+    if (thermostat.litTemperature()) {
+        temperatureThermostat = calculerTemperature(sommes[0]);
+    }
+    if (mesurerForces) {
+        terminerStatistiques(sommes);
+    }
+    if (deplacementMaxPas > 0) {
+        choisirPas(sommes);
+    }
+}
+
+/**
+ * @brief Runs steps of the Verlet integration.
+ *
+ * Each step updates the positions, applies the boundary conditions, updates the
+ * cells (or the Verlet lists), computes the new forces, updates the velocities and
+ * writes the VTK file when the output cadence asks for it. With absorbing and
+ * reflecting boundaries, the particles still leaving the box are removed.
+ *
+ * @tparam DIM 2 or 3.
+ * @tparam BC The boundary condition (see boundaryCond).
+ * @param nbPas The number of steps, ignored when jusquaTmax is true.
+ * @param jusquaTmax true to run until the simulated time reaches tmax and print the progress.
+ */
+template <int DIM, int BC>
+void Univers::integrer(int nbPas, bool jusquaTmax) {
+    // Forces of the current positions, needed by the first position update
+    if (!forcesAJour) {
+        if (verletSkin > 0) {
+            mettreAJourVoisinage(DIM == 3);
+        }
+        calculForcesPas<DIM>();
+    }
+
+    // Temperature of the current velocities, read by the thermostat in the first update, and first adaptive step
+    if (thermostat.litTemperature() || deplacementMaxPas > 0) {
+        double sommes[7];
+        sommerVitesses<3, false>(sommes);
+        if (thermostat.litTemperature()) {
+            temperatureThermostat = calculerTemperature(sommes[0]);
+        }
+        if (deplacementMaxPas > 0) {
+            choisirPas(sommes);
+        }
+    }
+
+    for (int k = 0; jusquaTmax ? temps < tmax : k < nbPas; k++) {
+        // The adaptive step ends the run at tmax
+        if (deplacementMaxPas > 0 && jusquaTmax && temps + dt > tmax) {
+            dt = tmax - temps;
+        }
+        temps += dt;
+        iteration++;
+        mesurerForces = frequenceStatistiques > 0 && iteration % frequenceStatistiques == 0;
+
+        // Update positions and keep the forces for the velocity update
+        {
+            ProfilPerformance::Chrono chrono(profil, ProfilPerformance::POSITIONS);
+            miseAJourPositions<DIM, BC>();
+        }
+
+        // Apply boundary conditions (particles still escaping a reflecting box are absorbed)
+        {
+            ProfilPerformance::Chrono chrono(profil, ProfilPerformance::CONDITIONS_LIMITES);
+            if (BC == 1) {
+                periodicBC();
+            } else {
+                absorptionBC();
+            }
+        }
 
-            for (auto &p1 : part) {
-                p1.setForce(Vector3D(0, 0, 0)); // Reset force to zero
-
-                const Vector3D pos_i = p1.getPos();
-                const double masse_i = p1.getMasse();
-
-                for (auto &p2 : particules_voisines) {
-                    if (&p1 == &p2) continue; // Skip self-interaction
-
-                    const Vector3D pos_j = p2.getPos();
-                    Vector3D r = pos_j - pos_i;
-                    double norme_r = r.norm();
-
-                    if (norme_r != 0.0 && norme_r < rCut) { // Avoid division by zero and skip particles outside the cutoff
-                        double powTo6 = std::pow(sigma / norme_r, 6);
-                        Vector3D force = r * (24 * eps * std::pow(1 / norme_r, 2) * powTo6 * (1 - 2 * powTo6));
-                        force += r * (masse_i * 1 / (norme_r * norme_r * norme_r)); // Gravitational force
-                        // Cap the forces to avoid numerical instabilities
-                        if (force.getX() > 1e5) force.setX(1e5);
-                        if (force.getY() > 1e5) force.setY(1e5);
-                        if (force.getZ() > 1e5) force.setZ(1e5);
-                        if (force.getX() < -1e5) force.setX(-1e5);
-                        if (force.getY() < -1e5) force.setY(-1e5);
-                        if (force.getZ() < -1e5) force.setZ(-1e5);
-                        p1.setForce(p1.getForce() + force);
-                    }
-                }
+        // Reassign particles to their new cells (with Verlet lists, only when the lists are rebuilt)
+        {
+            ProfilPerformance::Chrono chrono(profil, ProfilPerformance::CELLULES);
+            if (verletSkin > 0) {
+                mettreAJourVoisinage(DIM == 3);
+            } else if (DIM == 3) {
+                reassignCells3D();
+            } else {
+                reassignCells();
+            }
+            if (estDecompose()) {
+                migrerEntreDomaines();
+            }
+        }
+
+        // Calculate new forces
+        {
+            ProfilPerformance::Chrono chrono(profil, ProfilPerformance::FORCES);
+            calculForcesPas<DIM>();
+        }
 
-                // Add gravitational force if G is non-zero
-                if (G != 0) {
-                    p1.getForce().setY(p1.getForce().getY() + p1.getMasse() * G);
+        // Update velocities, with the sums of the thermostat, of the adaptive step and of the statistics on the measured steps
+        {
+            ProfilPerformance::Chrono chrono(profil, ProfilPerformance::VITESSES);
+            if (thermostat.estActif() || deplacementMaxPas > 0 || mesurerForces) {
+                miseAJourVitessesSommees<DIM>();
+            } else {
+                miseAJourVitesses<DIM>();
+            }
+            if (mesurerForces) {
+                mesurerForces = false;
+                if (serieStatistiques) {
+                    serieStatistiques->ajouter(statistiques);
                 }
             }
+        }
 
-            cellule.setParticules(part);
+        // Write to VTK file when the output cadence asks for it
+        {
+            ProfilPerformance::Chrono chrono(profil, ProfilPerformance::SORTIE);
+            ecrireSortie(iteration, temps);
+        }
+        if (frequenceRapport > 0 && iteration % frequenceRapport == 0) {
+            ecrireRapport();
+        }
+        if (frequenceReprise > 0 && iteration % frequenceReprise == 0) {
+            saveCheckpoint(fichierReprise);
+        }
+        if (jusquaTmax) {
+            std::cout << "Pourcentage de l'évolution : " << (temps - dt) / tmax * 100 << "%" << std::endl;
         }
-    } catch (const std::exception &e) {
-        logError(e.what());
-        throw;
     }
 }
 
 /**
- * @brief Applies periodic boundary conditions to the simulation.
+ * @brief Selects the instantiation of the integrator matching the boundary condition.
  *
- * This function ensures that particles that move out of the simulation domain on one side
- * re-enter on the opposite side, maintaining the continuity of the simulation space.
- * The function iterates through each cell and each particle, checks if a particle's position
- * is outside the domain boundaries in 2D or 3D, and if so, wraps the position around to the opposite side.
+ * @tparam DIM 2 or 3.
+ * @param nbPas The number of steps, ignored when jusquaTmax is true.
+ * @param jusquaTmax true to run until the simulated time reaches tmax.
  */
-void Univers::periodicBC() {
-    try {
-        std::vector<Cellule> &cells = cellules;
-        for (auto &cellule : cells) {
-            // Verify if the cell is in the domain boundary
-            std::vector<Particule3D> &part = cellule.getParticules();
-            // Check if the particle is out of the domain
-            for (auto &p : part) {
-                Vector3D pos = p.getPos();
-                Vector3D oldPos = p.getPos();
-                double posOldX = pos.getX();
-                double posOldY = pos.getY();
-                double posOldZ = pos.getZ();
-
-                // Apply periodic boundary conditions for X coordinate
-                if (posOldX < 0) {
-                    pos.setX(L1 - std::abs(fmod(posOldX, L1)));
-                }
-                if (posOldX >= L1) {
-                    pos.setX(fmod(posOldX, L1));
-                }
-
-                // Apply periodic boundary conditions for Y coordinate
-                if (posOldY < 0) {
-                    pos.setY(L2 - std::abs(fmod(posOldY, L2)));
-                }
-                if (posOldY >= L2) {
-                    pos.setY(fmod(posOldY, L2));
-                }
+template <int DIM>
+void Univers::lancerIntegration(int nbPas, bool jusquaTmax) {
+    switch (boundaryCond) {
+        case 0:
+            integrer<DIM, 0>(nbPas, jusquaTmax);
+            break;
+        case 1:
+            integrer<DIM, 1>(nbPas, jusquaTmax);
+            break;
+        case 2:
+            integrer<DIM, 2>(nbPas, jusquaTmax);
+            break;
+        default:
+            throw std::invalid_argument("Invalid boundary condition: " + std::to_string(boundaryCond));
+    }
+}
 
-                // Apply periodic boundary conditions for Z coordinate
-                if (posOldZ < 0) {
-                    pos.setZ(L3 - std::abs(fmod(posOldZ, L3)));
-                }
-                if (posOldZ >= L3 && L3 != 0) {
-                    pos.setZ(fmod(posOldZ, L3));
-                }
+/**
+ * @brief Runs a whole evolution from t = 0 to tmax.
+ *
+ * @tparam DIM 2 or 3.
+ */
+template <int DIM>
+void Univers::evolutionDim() {
+    iteration = 0;
+    temps = 0;
+    forcesAJour = false;
+    profil.reinitialiser();
+    rapportCommence = false;
+
+    // Initial output to VTK file
+    ecrireSortie(0, 0);
+
+    std::cout << "Number of particles: " << nbParticules << std::endl;
+
+    lancerIntegration<DIM>(0, true);
+    if (!fichierRapport.empty()) {
+        ecrireRapport();
+    }
 
-                p.setPos(pos);
-            }
+    if (verletSkin > 0) {
+        std::cout << "Verlet lists rebuilt " << listes.getNbReconstructions() << " times in " << nbPasVerlet << " steps" << std::endl;
+    }
+    // Wait for the last snapshots written in the background
+    terminerSorties();
+}
 
-            cellule.setParticules(part);
-        }
+/**
+ * @brief Evolves the system over time using the Verlet integration algorithm.
+ *
+ * This function performs the time evolution of the system by iterating over time steps,
+ * updating positions and velocities of particles, applying boundary conditions, and
+ * recalculating forces.
+ */
+void Univers::evolution2D() {
+    try {
+        evolutionDim<2>();
+        std::cout << "Evolution completed" << std::endl;
     } catch (const std::exception &e) {
         logError(e.what());
         throw;
@@ -680,29 +2967,12 @@ void Univers::periodicBC() {
 }
 
 /**
- * @brief Calculates the total kinetic energy of the system.
- *
- * This function computes the kinetic energy of all particles in the system.
- * The kinetic energy for each particle is calculated as 0.5 * mass * velocity^2.
- *
- * @return The total kinetic energy of the system.
+ * @brief Evolves the system over time using the Verlet integration algorithm for 3D.
  */
-double Univers::energieCinetique() {
+void Univers::evolution3D() {
     try {
-        double energieCinetique = 0;
-
-        for (auto &cellule : cellules) {
-            std::vector<Particule3D> &part = cellule.getParticules();
-
-            // Iterate over each particle in the cell
-            for (auto &p : part) {
-                Vector3D vit = p.getVit();
-
-                energieCinetique += p.getMasse() * (vit * vit);
-            }
-        }
-
-        return 0.5 * energieCinetique;
+        evolutionDim<3>();
+        std::cout << "Evolution in 3D completed" << std::endl;
     } catch (const std::exception &e) {
         logError(e.what());
         throw;
@@ -710,34 +2980,27 @@ double Univers::energieCinetique() {
 }
 
 /**
- * @brief Applies absorption boundary conditions to the simulation.
+ * @brief Advances the simulation by a number of steps from its current state.
  *
- * This function removes particles that move out of the simulation domain.
- * If a particle's position is outside the domain boundaries, it is removed from the simulation.
- * The function iterates through each cell and each particle, checks if a particle's position
- * is outside the domain boundaries, and if so, removes the particle from the cell.
+ * The steps follow the output cadence; the step index and the simulated time
+ * continue from the previous call.
+ *
+ * @param nbPas The number of steps.
  */
-void Univers::absorptionBC() {
+void Univers::avancer(int nbPas) {
     try {
-        // Iterate over each cell in the simulation
-        for (auto &cellule : cellules) {
-            auto &part = cellule.getParticules();
-
-            // Iterate over each particle in the cell in reverse order
-            // (to avoid issues with removing elements while iterating)
-            for (int i = static_cast<int>(part.size()) - 1; i >= 0; --i) {
-                auto &p = part[i];
-
-                // Check if the particle is outside the domain boundaries
-                if (p.getPos().getX() < 0 || p.getPos().getX() > L1 || p.getPos().getY() < 0 || p.getPos().getY() > L2 || p.getPos().getZ() < 0 || p.getPos().getZ() > L3) {
-                    std::cout << "Removing particle at index: " << i << std::endl;
-                    // Remove the particle from the cell
-                    cellule.removeParticule(i);
-                    // Decrease the total number of particles
-                    nbParticules--;
-                }
-            }
+        if (nbPas < 0) {
+            throw std::invalid_argument("Invalid number of steps: must be positive.");
+        }
+        if (dimension == 3 && L3 != 0) {
+            lancerIntegration<3>(nbPas, false);
+        } else {
+            lancerIntegration<2>(nbPas, false);
+        }
+        if (!fichierRapport.empty()) {
+            ecrireRapport();
         }
+        terminerSorties();
     } catch (const std::exception &e) {
         logError(e.what());
         throw;
@@ -745,107 +3008,176 @@ void Univers::absorptionBC() {
 }
 
 /**
- * @brief Reassigns particles to the correct cells based on their positions.
+ * @brief Gets the simulated time.
  *
- * This function collects all particles from all cells, clears the cells,
- * and then reassigns the particles to the correct cells based on their positions.
- * It ensures that particles are placed in the appropriate cell according to their new positions.
+ * @return The simulated time since the start of the last evolution.
  */
-void Univers::reassignCells() {
-    try {
-        // Collect all particles from all cells
-        std::vector<Particule3D> allParticules;
-        for (auto &cellule : cellules) {
-            auto part = cellule.getParticules();
-            allParticules.insert(allParticules.end(), part.begin(), part.end());
-            cellule.clearParticules(); // Clear particles as we collect them
-        }
-
-        int nCellsX = L1 / rCut;
-        int nCellsY = L2 / rCut;
-
-        // Reassign particles to the correct cells based on their positions
-        for (auto &p : allParticules) {
-            int cellX = static_cast<int>(p.getPos().getX() / rCut);
-            int cellY = static_cast<int>(p.getPos().getY() / rCut);
-
-            // Ensure the particle is within the grid bounds
-            if (cellX >= 0 && cellX <= nCellsX && cellY >= 0 && cellY <= nCellsY) {
-                // Handle edge cases where the particle is on the boundary
-                if (cellX == nCellsX) {
-                    cellX--;
-                }
-                if (cellY == nCellsY) {
-                    cellY--;
-                }
+float Univers::getTemps() const {
+    return temps;
+}
 
-                int newCellIndex = cellX + cellY * nCellsX;
+/**
+ * @brief Gets the index of the current step.
+ *
+ * @return The number of steps since the start of the last evolution.
+ */
+int Univers::getIteration() const {
+    return iteration;
+}
 
-                // Add the particle to the correct cell
-                cellules[newCellIndex].addParticule(p);
-            } else {
-                // If a particle is out of bounds, print an error message and exit
-                std::ostringstream oss;
-                oss << "Particle out of bounds: ID=" << p.getId() << ", Position=(" << p.getPos().getX() << ", " << p.getPos().getY() << ")";
-                throw std::out_of_range(oss.str());
-            }
-        }
-    } catch (const std::exception &e) {
-        logError(e.what());
-        throw;
+/**
+ * @brief Computes the forces of a step, with the ghost particles when the grid is decomposed.
+ *
+ * The ghosts complete the neighborhood of the particles of the border layers of
+ * the slab; their own forces are partial and they are removed right after.
+ *
+ * @tparam DIM 2 or 3.
+ */
+template <int DIM>
+void Univers::calculForcesPas() {
+    if (estDecompose()) {
+        ajouterFantomes();
+    }
+    calculForcesDim<DIM>();
+    if (estDecompose()) {
+        retirerHorsDomaine();
     }
 }
 
 /**
- * @brief Reassigns particles to the correct cells based on their positions in 3D.
+ * @brief Computes the index of the cell containing a position of the box.
  *
- * This function collects all particles from all cells, clears the cells,
- * and then reassigns the particles to the correct cells based on their positions.
- * It ensures that particles are placed in the appropriate cell according to their new positions.
+ * @param x, y, z The position.
+ * @return The index of the cell, -1 if the sparse grid has not created it.
  */
-void Univers::reassignCells3D() {
-    try {
-        // Collect all particles from all cells
-        std::vector<Particule3D> allParticules;
-        for (auto &cellule : cellules) {
-            auto part = cellule.getParticules();
-            allParticules.insert(allParticules.end(), part.begin(), part.end());
-            cellule.clearParticules(); // Clear particles as we collect them
-        }
-
-        int nCellsX = L1 / rCut;
-        int nCellsY = L2 / rCut;
-        int nCellsZ = L3 / rCut;
-
-        // Reassign particles to the correct cells based on their positions
-        for (auto &p : allParticules) {
-            int cellX = static_cast<int>(p.getPos().getX() / rCut);
-            int cellY = static_cast<int>(p.getPos().getY() / rCut);
-            int cellZ = static_cast<int>(p.getPos().getZ() / rCut);
-
-            // Ensure the particle is within the grid bounds
-            if (cellX >= 0 && cellX <= nCellsX && cellY >= 0 && cellY <= nCellsY && cellZ >= 0 && cellZ <= nCellsZ) {
-                // Handle edge cases where the particle is on the boundary
-                if (cellX == nCellsX) {
-                    cellX--;
-                }
-                if (cellY == nCellsY) {
-                    cellY--;
-                }
-                if (cellZ == nCellsZ) {
-                    cellZ--;
-                }
+int Univers::celluleDePosition(double x, double y, double z) const {
+    int cellX, cellY, cellZ;
+    coordonneesCellule(x, y, z, cellX, cellY, cellZ);
+    return indexCellule(cellX, cellY, cellZ);
+}
+
+/**
+ * @brief Sends the particles that left the slab of this rank to their new owner and receives the others.
+ *
+ * Every rank takes part in the exchange, even without migrants.
+ */
+void Univers::migrerEntreDomaines() {
+    const int n = store.getNbParticules();
+    envois.resize(decomposition->getNbRangs());
+    for (auto &liste : envois) {
+        liste.clear();
+    }
+    aSupprimer.assign(n, 0);
+    bool depart = false;
+    for (int i = 0; i < n; i++) {
+        const int couche = coucheCellule(store.cellule[i]);
+        if (couche < decomposition->getDebut() || couche >= decomposition->getFin()) {
+            envois[decomposition->getProprietaire(couche)].push_back(DecompositionDomaine::extraire(store, i));
+            aSupprimer[i] = 1;
+            depart = true;
+        }
+    }
+    if (depart) {
+        store.removeFlagged(aSupprimer);
+        if (plagesValides) {
+            store.recountCells(static_cast<int>(cellules.size()));
+            synchroniserPlages();
+        }
+    }
 
-                int newCellIndex = cellX + cellY * nCellsX + cellZ * nCellsX * nCellsY;
+    decomposition->echanger(envois, recus);
+    insererRecus();
+    nbParticules = store.getNbParticules();
+}
 
-                // Add the particle to the correct cell
-                cellules[newCellIndex].addParticule(p);
-            } else {
-                // If a particle is out of bounds, print an error message and exit
-                std::ostringstream oss;
-                oss << "Particle out of bounds: ID=" << p.getId() << ", Position=(" << p.getPos().getX() << ", " << p.getPos().getY() << ", " << p.getPos().getZ() << ")";
-                throw std::out_of_range(oss.str());
-            }
+/**
+ * @brief Adds copies of the particles of the layers bordering the slab, received from the neighboring ranks.
+ */
+void Univers::ajouterFantomes() {
+    versPrecedent.clear();
+    versSuivant.clear();
+    for (int i = 0; i < store.getNbParticules(); i++) {
+        const int couche = coucheCellule(store.cellule[i]);
+        if (couche == decomposition->getDebut()) {
+            versPrecedent.push_back(DecompositionDomaine::extraire(store, i));
+        }
+        if (couche == decomposition->getFin() - 1) {
+            versSuivant.push_back(DecompositionDomaine::extraire(store, i));
+        }
+    }
+    decomposition->echangerVoisins(versPrecedent, versSuivant, recus);
+    insererRecus();
+}
+
+/**
+ * @brief Appends the received particles to the store and merges them into their cells.
+ */
+void Univers::insererRecus() {
+    const int debutQueue = store.getNbParticules();
+    bool manquante = false;
+    for (const auto &p : recus) {
+        const int c = celluleDePosition(p.x, p.y, p.z);
+        DecompositionDomaine::ajouter(store, p, c);
+        manquante = manquante || c < 0;
+    }
+    celluleManquante = celluleManquante || manquante;
+    if (recus.empty()) {
+        return;
+    }
+    if (plagesValides && !manquante) {
+        store.insererQueue(debutQueue, static_cast<int>(cellules.size()));
+        synchroniserPlages();
+    } else {
+        plagesValides = false;
+    }
+}
+
+/**
+ * @brief Removes the particles outside the slab of this rank.
+ *
+ * @return The number of particles removed.
+ */
+int Univers::retirerHorsDomaine() {
+    const int n = store.getNbParticules();
+    aSupprimer.assign(n, 0);
+    for (int i = 0; i < n; i++) {
+        const int couche = coucheCellule(store.cellule[i]);
+        aSupprimer[i] = couche < decomposition->getDebut() || couche >= decomposition->getFin();
+    }
+    const int nbRetires = store.removeFlagged(aSupprimer);
+    if (nbRetires > 0 && plagesValides) {
+        store.recountCells(static_cast<int>(cellules.size()));
+        synchroniserPlages();
+    }
+    nbParticules = store.getNbParticules();
+    return nbRetires;
+}
+
+/**
+ * @brief Splits the grid over the MPI ranks.
+ *
+ * @param active true to split the grid; false to drop the decomposition (the
+ * particles of the other ranks are not gathered back).
+ */
+void Univers::setDecomposition(bool active) {
+    try {
+        if (!active) {
+            decomposition.reset();
+            return;
+        }
+        if (verletSkin > 0) {
+            throw std::invalid_argument("Invalid decomposition: the Verlet lists are not supported with a domain decomposition.");
+        }
+        if (trajectoire || serieStatistiques) {
+            throw std::invalid_argument("Invalid decomposition: set the trajectory and statistics files after the decomposition.");
+        }
+        auto nouvelle = std::make_shared<DecompositionDomaine>();
+        nouvelle->decouper((gridDepth > 1) ? gridDepth : gridHeight);
+        decomposition = nouvelle;
+        if (estDecompose()) {
+            retirerHorsDomaine();
+            listesValides = false;
+            forcesAJour = false;
         }
     } catch (const std::exception &e) {
         logError(e.what());
@@ -854,126 +3186,124 @@ void Univers::reassignCells3D() {
 }
 
 /**
- * @brief Evolves the system over time using the Verlet integration algorithm.
+ * @brief Gets the name of a file of this rank.
  *
- * This function performs the time evolution of the system by iterating over time steps,
- * updating positions and velocities of particles, applying boundary conditions, and
- * recalculating forces.
+ * @param fichier The name of the file.
+ * @return The name with the suffix _r<rank> before its extension, unchanged for a single process.
  */
-void Univers::evolution2D() {
-    try {
-        // Initial output to VTK file
-        std::string filename = "data_t0.vtu";
-        writeVTKFile(filename);
+std::string Univers::nomDuRang(const std::string &fichier) const {
+    if (!estDecompose()) {
+        return fichier;
+    }
+    const std::string suffixe = "_r" + std::to_string(decomposition->getRang());
+    const size_t point = fichier.find_last_of('.');
+    const size_t separateur = fichier.find_last_of("/\\");
+    if (point == std::string::npos || (separateur != std::string::npos && point < separateur)) {
+        return fichier + suffixe;
+    }
+    return fichier.substr(0, point) + suffixe + fichier.substr(point);
+}
 
-        // Initialize forces vector
-        std::vector<Vector3D> forcesOld;
-        forcesOld.resize(nbParticules);
+/**
+ * @brief Gets the domain decomposition.
+ *
+ * @return The decomposition, null for a single process.
+ */
+const DecompositionDomaine *Univers::getDecomposition() const {
+    return decomposition.get();
+}
 
-        std::cout << "Number of particles: " << nbParticules << std::endl;
+/**
+ * @brief Gets the number of particles over every MPI rank.
+ *
+ * @return The number of particles of the whole universe.
+ */
+long Univers::getNbParticulesTotal() const {
+    return estDecompose() ? decomposition->sommer(static_cast<long>(nbParticules)) : nbParticules;
+}
 
-        // Calculate initial forces
-        calculForces();
-
-        // Time initialization
-        int iter = 0;
-        float t = 0;
-        int file_index = 0;
-
-        // Time evolution loop
-        while (t < tmax) {
-            // Scale speed using kinetic energy to compute coefficient Beta
-            if (scaleType == 1) {
-                double kinetic_energy = energieCinetique();
-                std::cout << "Kinetic energy: " << kinetic_energy << std::endl;
-                auto beta = static_cast<float>(std::sqrt(0.005 / kinetic_energy));
-
-                if (iter % 1000 == 0) {
-                    for (auto &cellule : cellules) {
-                        std::vector<Particule3D> &part = cellule.getParticules();
-                        for (auto &p : part) {
-                            p.setVit(p.getVit() * beta);
-                        }
-                        cellule.setParticules(part);
-                    }
-                }
-            }
+/**
+ * @brief Saves the whole state of the simulation to a binary restart file.
+ *
+ * @param fichier The name of the file.
+ */
+void Univers::saveCheckpoint(const std::string &fichier) {
+    try {
+        // The trajectory file holds at least the frames up to the checkpoint
+        if (trajectoire) {
+            trajectoire->vider();
+        }
+        EcritureReprise reprise(nomDuRang(fichier));
 
-            file_index++;
-            t += dt;
-            iter++;
-
-            // Update positions
-            for (auto &cellule : cellules) {
-                std::vector<Particule3D> par = cellule.getParticules();
-                for (auto &p : par) {
-                    Vector3D pos = p.getPos();
-                    Vector3D vit = p.getVit();
-                    float masse = p.getMasse();
-                    Vector3D force = p.getForce();
-
-                    if (boundaryCond == 2) {
-                        Vector3D v = pos;
-                        v += (vit + force * dt * (0.5 / masse)) * dt;
-                        // Reflection boundary conditions
-                        if (v.getX() < 0 || v.getX() > L1) {
-                            vit.setX(-vit.getX());
-                        }
-                        if (pos.getY() < 0 || pos.getY() > L2) {
-                            vit.setY(-vit.getY());
-                        }
-                        p.setVit(vit);
-                        pos += (p.getVit() + force * dt * (0.5 / masse)) * dt;
-                        p.setPos(pos);
-                        absorptionBC();
-                    } else {
-                        pos += (p.getVit() + force * dt * (0.5 / masse)) * dt;
-                        p.setPos(pos);
-                    }
+        // Parameters of the universe
+        for (int valeur : {dimension, L1, L2, L3, eps, sigma, boundaryCond, scaleType, forceEngine, jeuInstructions, ordreCellules,
+                           frequenceSortie}) {
+            reprise.ecrire<int32_t>(valeur);
+        }
+        for (float valeur : {rCut, dt, tmax, G, verletSkin, intervalleSortie}) {
+            reprise.ecrire(valeur);
+        }
 
-                    int id = p.getId();
-                    if (id >= 0 && id < (int)forcesOld.size()) {
-                        forcesOld[id] = p.getForce();
-                    }
-                }
-                cellule.setParticules(par);
-            }
+        // Slab of this rank: number of ranks, rank, first and end layer (1, 0, 0, 0 for a single process)
+        for (int valeur : {estDecompose() ? decomposition->getNbRangs() : 1, estDecompose() ? decomposition->getRang() : 0,
+                           estDecompose() ? decomposition->getDebut() : 0, estDecompose() ? decomposition->getFin() : 0}) {
+            reprise.ecrire<int32_t>(valeur);
+        }
 
-            // Apply boundary conditions
-            if (boundaryCond == 0) {
-                absorptionBC();
-            } else if (boundaryCond == 1) {
-                std::cout << "here" << std::endl;
-                periodicBC();
+        // Cells of the sparse grid: they depend on the positions at the last rebuild, not the current ones
+        reprise.ecrire<uint8_t>(grilleCreuse);
+        if (grilleCreuse) {
+            std::vector<int64_t> cles;
+            cles.reserve(cellules.size());
+            for (const Cellule &cellule : cellules) {
+                const int *id = cellule.getId();
+                cles.push_back(id[0] + id[1] * static_cast<int64_t>(gridWidth) + id[2] * static_cast<int64_t>(gridWidth) * gridHeight);
             }
+            reprise.ecrireTableau(cles);
+        }
 
-            // Reassign particles to their new cells
-            reassignCells();
-
-            // Calculate new forces
-            calculForces();
-
-            // Update velocities
-            for (auto &cellule : cellules) {
-                std::vector<Particule3D> &part = cellule.getParticules();
-                for (auto &p : part) {
-                    Vector3D vit = p.getVit();
-                    float masse = p.getMasse();
-                    Vector3D force = p.getForce();
-                    Vector3D forceOld = forcesOld[p.getId()];
-                    vit = vit + (force + forceOld) * dt * (0.5 / masse);
-                    p.setVit(vit);
-                }
-                cellule.setParticules(part);
-            }
+        // Tabulated potential
+        reprise.ecrire<uint8_t>(potentiel != nullptr);
+        if (potentiel) {
+            potentiel->ecrire(reprise);
+        }
 
-            // Write to VTK file
-            filename = "data_t" + std::to_string(file_index) + ".vtu";
-            writeVTKFile(filename);
-            std::cout << "Pourcentage de l'évolution : " << (t - dt) / tmax * 100 << "%" << std::endl;
+        // Force field
+        reprise.ecrire<uint8_t>(champ != nullptr);
+        if (champ) {
+            champ->ecrire(reprise);
         }
 
-        std::cout << "Evolution completed" << std::endl;
+        // Thermostat, with the friction of Nose-Hoover, and adaptive step
+        thermostat.ecrire(reprise);
+        for (float valeur : {deplacementMaxPas, dtMin, dtMax}) {
+            reprise.ecrire(valeur);
+        }
+
+        // Counters of the run
+        reprise.ecrire(temps);
+        reprise.ecrire<int32_t>(iteration);
+        reprise.ecrire<int32_t>(nbPasVerlet);
+        reprise.ecrire(prochaineSortie);
+        reprise.ecrire<uint8_t>(forcesAJour);
+        reprise.ecrire<uint8_t>(plagesValides);
+        reprise.ecrire<uint8_t>(listesValides);
+
+        // Particles, in the order of the store
+        for (const auto *a : {&store.x, &store.y, &store.z, &store.vx, &store.vy, &store.vz}) {
+            reprise.ecrireTableau(*a);
+        }
+        for (const auto *a : {&store.fx, &store.fy, &store.fz, &store.fxOld, &store.fyOld, &store.fzOld}) {
+            reprise.ecrireTableau(*a);
+        }
+        reprise.ecrireTableau(store.masse);
+        reprise.ecrireTableau(store.categorie);
+        reprise.ecrireTableau(store.id);
+        reprise.ecrireTableau(store.cellule);
+        if (listesValides) {
+            listes.ecrire(reprise);
+        }
+        reprise.terminer();
     } catch (const std::exception &e) {
         logError(e.what());
         throw;
@@ -981,121 +3311,199 @@ void Univers::evolution2D() {
 }
 
 /**
- * @brief Evolves the system over time using the Verlet integration algorithm for 3D.
+ * @brief Replaces the state of the simulation with the content of a restart file.
+ *
+ * @param fichier The name of a file written by saveCheckpoint.
  */
-void Univers::evolution3D() {
+void Univers::loadCheckpoint(const std::string &fichier) {
     try {
-        // Initial output to VTK file
-        std::string filename = "data_t0.vtu";
-        writeVTKFile(filename);
+        const std::string nom = nomDuRang(fichier);
+        LectureReprise reprise(nom);
 
-        // Initialize forces vector
-        std::vector<Vector3D> forcesOld;
-        forcesOld.resize(nbParticules);
-
-        std::cout << "Number of particles: " << nbParticules << std::endl;
+        // Parameters of the universe
+        int32_t entiers[12];
+        for (int32_t &valeur : entiers) {
+            valeur = reprise.lire<int32_t>();
+        }
+        float reels[6];
+        for (float &valeur : reels) {
+            valeur = reprise.lire<float>();
+        }
+        if (entiers[0] < 1 || entiers[0] > 3 || entiers[6] < 0 || entiers[6] > 2 || entiers[8] < 0 || entiers[8] > 1 ||
+            entiers[10] < OrdreCellules::LIGNES || entiers[10] > OrdreCellules::HILBERT || reels[0] <= 0) {
+            throw std::runtime_error("Invalid parameters in restart file " + nom + ".");
+        }
 
-        // Calculate initial forces
-        calculForces3D();
-
-        // Time initialization
-        int iter = 0;
-        float t = 0;
-        int file_index = 0;
-
-        // Time evolution loop
-        while (t < tmax) {
-            // Scale speed using kinetic energy to compute coefficient Beta
-            if (scaleType == 1) {
-                double kinetic_energy = energieCinetique();
-                std::cout << "Kinetic energy: " << kinetic_energy << std::endl;
-                auto beta = static_cast<float>(std::sqrt(0.005 / kinetic_energy));
-
-                if (iter % 1000 == 0) {
-                    for (auto &cellule : cellules) {
-                        std::vector<Particule3D> &part = cellule.getParticules();
-                        for (auto &p : part) {
-                            p.setVit(p.getVit() * beta);
-                        }
-                        cellule.setParticules(part);
-                    }
+        // Slab, since version 7: the file must come from the same rank of the same decomposition
+        int32_t tranche[4] = {1, 0, 0, 0};
+        if (reprise.getVersion() >= 7) {
+            for (int32_t &valeur : tranche) {
+                valeur = reprise.lire<int32_t>();
+            }
+        }
+        const int32_t attendue[4] = {estDecompose() ? decomposition->getNbRangs() : 1, estDecompose() ? decomposition->getRang() : 0,
+                                     estDecompose() ? decomposition->getDebut() : 0, estDecompose() ? decomposition->getFin() : 0};
+        if (!std::equal(tranche, tranche + 4, attendue)) {
+            throw std::runtime_error("Restart file " + nom + " was saved by rank " + std::to_string(tranche[1]) + " of " +
+                                     std::to_string(tranche[0]) + " (layers " + std::to_string(tranche[2]) + " to " +
+                                     std::to_string(tranche[3]) + "), not by this rank of the current decomposition.");
+        }
+        dimension = entiers[0];
+        L1 = entiers[1];
+        L2 = entiers[2];
+        L3 = entiers[3];
+        eps = entiers[4];
+        sigma = entiers[5];
+        boundaryCond = entiers[6];
+        scaleType = entiers[7];
+        forceEngine = entiers[8];
+        // A file saved on a processor with more instruction sets falls back to the best one here
+        jeuInstructions = NoyauLJ::estDisponible(entiers[9]) ? entiers[9] : NoyauLJ::AUTOMATIQUE;
+        ordreCellules = entiers[10];
+        frequenceSortie = entiers[11];
+        rCut = reels[0];
+        dt = reels[1];
+        tmax = reels[2];
+        G = reels[3];
+        verletSkin = reels[4];
+        intervalleSortie = reels[5];
+        initGrille();
+        // Version 1 files have no sparse grid
+        grilleCreuse = reprise.getVersion() >= 2 && reprise.lire<uint8_t>() != 0;
+        if (grilleCreuse && ordreCellules != OrdreCellules::LIGNES) {
+            throw std::runtime_error("Invalid parameters in restart file " + nom + ".");
+        }
+        creerCellules();
+        if (grilleCreuse) {
+            std::vector<int64_t> cles;
+            reprise.lireTableau(cles);
+            const int64_t nbPositions = static_cast<int64_t>(gridWidth) * gridHeight * gridDepth;
+            for (size_t k = 0; k < cles.size(); k++) {
+                if (cles[k] < 0 || cles[k] >= nbPositions || (k > 0 && cles[k] <= cles[k - 1])) {
+                    throw std::runtime_error("Invalid sparse grid in restart file " + nom + ".");
                 }
             }
+            materialiserCellules(std::vector<long>(cles.begin(), cles.end()));
+        }
 
-            file_index++;
-            t += dt;
-            iter++;
-
-            // Update positions
-            for (auto &cellule : cellules) {
-                std::vector<Particule3D> par = cellule.getParticules();
-                for (auto &p : par) {
-                    Vector3D pos = p.getPos();
-                    Vector3D vit = p.getVit();
-                    float masse = p.getMasse();
-                    Vector3D force = p.getForce();
-
-                    if (boundaryCond == 2) {
-                        Vector3D v = pos;
-                        v += (vit + force * dt * (0.5 / masse)) * dt;
-                        // Reflection boundary conditions
-                        if (v.getX() < 0 || v.getX() > L1) {
-                            vit.setX(-vit.getX());
-                            pos = p.getPos() + (vit + force * dt * (0.5 / masse)) * dt;
-                        }
-                        if (pos.getY() < 0 || pos.getY() > L2) {
-                            vit.setY(-vit.getY());
-                            pos = p.getPos() + (vit + force * dt * (0.5 / masse)) * dt;
-                        }
-                        p.setVit(vit);
-                    } else {
-                        pos += (vit + force * dt * (0.5 / masse)) * dt;
-                    }
-                    p.setPos(pos);
+        // Tabulated potential, since version 3
+        potentiel.reset();
+        if (reprise.getVersion() >= 3 && reprise.lire<uint8_t>() != 0) {
+            auto table = std::make_shared<PotentielTabule>();
+            table->lire(reprise);
+            potentiel = table;
+        }
 
-                    int id = p.getId();
-                    if (id >= 0 && id < (int)forcesOld.size()) {
-                        forcesOld[id] = p.getForce();
-                    }
-                }
-                cellule.setParticules(par);
-            }
+        // Force field, since version 4
+        champ.reset();
+        if (reprise.getVersion() >= 4 && reprise.lire<uint8_t>() != 0) {
+            auto lu = std::make_shared<ChampForces>();
+            lu->lire(reprise);
+            champ = lu;
+        }
 
-            // Apply boundary conditions
-            if (boundaryCond == 0) {
-                absorptionBC();
-            } else if (boundaryCond == 1) {
-                periodicBC();
+        // Thermostat, since version 5, and adaptive step, since version 6
+        thermostat = Thermostat();
+        if (reprise.getVersion() >= 5) {
+            thermostat.lire(reprise);
+        }
+        deplacementMaxPas = 0;
+        dtMin = 0;
+        dtMax = 0;
+        if (reprise.getVersion() >= 6) {
+            deplacementMaxPas = reprise.lire<float>();
+            dtMin = reprise.lire<float>();
+            dtMax = reprise.lire<float>();
+            if (deplacementMaxPas < 0 || dtMin < 0 || (deplacementMaxPas > 0 && !(dtMax >= dtMin && dtMax > 0))) {
+                throw std::runtime_error("Invalid adaptive step in restart file " + nom + ".");
             }
+        }
 
-            // Reassign particles to their new cells
-            reassignCells3D();
-
-            // Calculate new forces
-            calculForces3D();
-
-            // Update velocities
-            for (auto &cellule : cellules) {
-                std::vector<Particule3D> &part = cellule.getParticules();
-                for (auto &p : part) {
-                    Vector3D vit = p.getVit();
-                    float masse = p.getMasse();
-                    Vector3D force = p.getForce();
-                    Vector3D forceOld = forcesOld[p.getId()];
-                    vit = vit + (force + forceOld) * dt * (0.5 / masse);
-                    p.setVit(vit);
-                }
-                cellule.setParticules(part);
-            }
+        // Counters of the run
+        temps = reprise.lire<float>();
+        iteration = reprise.lire<int32_t>();
+        nbPasVerlet = reprise.lire<int32_t>();
+        prochaineSortie = reprise.lire<double>();
+        const bool forces = reprise.lire<uint8_t>() != 0;
+        const bool plages = reprise.lire<uint8_t>() != 0;
+        const bool listesLues = reprise.lire<uint8_t>() != 0;
+
+        // Particles, in the order of the store
+        for (auto *a : {&store.x, &store.y, &store.z, &store.vx, &store.vy, &store.vz}) {
+            reprise.lireTableau(*a);
+        }
+        for (auto *a : {&store.fx, &store.fy, &store.fz, &store.fxOld, &store.fyOld, &store.fzOld}) {
+            reprise.lireTableau(*a);
+        }
+        reprise.lireTableau(store.masse);
+        reprise.lireTableau(store.categorie);
+        categoriesVerifiees = false;
+        reprise.lireTableau(store.id);
+        reprise.lireTableau(store.cellule);
+        if (listesLues) {
+            listes.lire(reprise);
+        }
+        reprise.terminer();
 
-            // Write to VTK file at specified intervals
-            filename = "data_t" + std::to_string(file_index) + ".vtu";
-            writeVTKFile(filename);
-            // print le pourcentage de l'évolution
-            std::cout << "Pourcentage de l'évolution : " << (t - dt) / tmax * 100 << "%" << std::endl;
+        const size_t n = store.id.size();
+        const int nbCellules = static_cast<int>(cellules.size());
+        for (const auto *a : {&store.x, &store.y, &store.z, &store.vx, &store.vy, &store.vz}) {
+            if (a->size() != n) {
+                throw std::runtime_error("Inconsistent particle arrays in restart file " + nom + ".");
+            }
+        }
+        for (const auto *a : {&store.fx, &store.fy, &store.fz, &store.fxOld, &store.fyOld, &store.fzOld}) {
+            if (a->size() != n) {
+                throw std::runtime_error("Inconsistent particle arrays in restart file " + nom + ".");
+            }
+        }
+        if (store.masse.size() != n || store.categorie.size() != n || store.cellule.size() != n ||
+            std::any_of(store.cellule.begin(), store.cellule.end(), [&](int c) { return c < 0 || c >= nbCellules; })) {
+            throw std::runtime_error("Inconsistent particle arrays in restart file " + nom + ".");
         }
+        nbParticules = static_cast<int>(n);
+        if (plages) {
+            store.recountCells(nbCellules);
+            synchroniserPlages();
+        }
+        plagesValides = plages;
+        listesValides = listesLues;
+        forcesAJour = forces;
+    } catch (const std::exception &e) {
+        logError(e.what());
+        throw;
+    }
+}
 
-        std::cout << "Evolution in 3D completed" << std::endl;
+/**
+ * @brief Saves a restart file every given number of steps of the runs.
+ *
+ * @param fichier The restart file, empty to disable the saves.
+ * @param frequence Number of steps between two saves.
+ */
+void Univers::setCheckpoint(const std::string &fichier, int frequence) {
+    if (frequence < 0 || (!fichier.empty() && frequence == 0)) {
+        throw std::invalid_argument("Invalid checkpoint frequency: must be positive.");
+    }
+    fichierReprise = fichier;
+    frequenceReprise = fichier.empty() ? 0 : frequence;
+}
+
+/**
+ * @brief Continues the evolution from the current state until tmax.
+ */
+void Univers::poursuivreEvolution() {
+    try {
+        if (dimension == 3 && L3 != 0) {
+            lancerIntegration<3>(0, true);
+        } else {
+            lancerIntegration<2>(0, true);
+        }
+        if (!fichierRapport.empty()) {
+            ecrireRapport();
+        }
+        terminerSorties();
+        std::cout << "Evolution completed" << std::endl;
     } catch (const std::exception &e) {
         logError(e.what());
         throw;
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include "Univers.hxx"
+#include "Vector3D.hxx"
+
+// Global allocation counter: every operator new of this test program goes through it
+static long nbAllocations = 0;
+
+void* operator new(std::size_t taille) {
+    nbAllocations++;
+    if (void *p = std::malloc(taille ? taille : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+// Test that the 2D force pass does not allocate once the store is built
+TEST(Allocation, CalculForcesWithoutAllocation) {
+    Univers u(2, 40, 40, 0, 1, 1, 2.5, 0.01, 1.0);
+    u.initialiser(10, 10, 10, 20, Vector3D(0, 0, 0), Vector3D(0, 0, 0));
+    u.calculForces();
+
+    long avant = nbAllocations;
+    for (int step = 0; step < 5; step++) {
+        u.calculForces();
+    }
+    EXPECT_EQ(nbAllocations - avant, 0);
+}
+
+// Test that the 3D force pass does not allocate once the store is built
+TEST(Allocation, CalculForces3DWithoutAllocation) {
+    Univers u(3, 40, 40, 10, 1, 1, 2.5, 0.01, 1.0);
+    u.initialiser(10, 10, 10, 20, Vector3D(0, 0, 0), Vector3D(0, 0, 0));
+    u.calculForces3D();
+
+    long avant = nbAllocations;
+    for (int step = 0; step < 5; step++) {
+        u.calculForces3D();
+    }
+    EXPECT_EQ(nbAllocations - avant, 0);
+}
+
+// Test that a warmed-up rebinning and force step does not allocate
+TEST(Allocation, StepWithoutAllocation) {
+    Univers u(2, 40, 40, 0, 1, 1, 2.5, 0.01, 1.0);
+    u.initialiser(10, 10, 10, 20, Vector3D(1, 1, 0), Vector3D(0, 0, 0));
+    u.reassignCells();
+    u.calculForces();
+
+    long avant = nbAllocations;
+    for (int step = 0; step < 5; step++) {
+        u.periodicBC();
+        u.reassignCells();
+        u.calculForces();
+    }
+    EXPECT_EQ(nbAllocations - avant, 0);
+}
+
+// Test that the rebuilds of a sparse grid do not allocate, unless the grid grows beyond
+// its largest size so far
+TEST(Allocation, SparseGridStepWithoutAllocation) {
+    srand(3);
+    Univers u(2, 400, 400, 0, 1, 1, 2.5, 0.0005, 1.0, 1, 0, 0);
+    u.setFrequenceSortie(0);
+    u.setGrilleCreuse(true);
+    u.initialiserDemoCercle(12, 12, 4, Vector3D(0, -20, 0), Vector3D(0, -40, 0));
+    u.avancer(300);
+
+    int nbCellulesMax = u.getNbCellules();
+    int nbReconstructions = 0;
+    for (int step = 0; step < 1000; step++) {
+        const int nbCellules = u.getNbCellules();
+        long avant = nbAllocations;
+        u.avancer(1);
+        if (u.getNbCellules() <= nbCellulesMax) {
+            EXPECT_EQ(nbAllocations - avant, 0);
+            nbReconstructions += u.getNbCellules() != nbCellules;
+        }
+        nbCellulesMax = std::max(nbCellulesMax, u.getNbCellules());
+    }
+    EXPECT_GT(nbReconstructions, 0);
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include "ChampForces.hxx"
+#include "Reprise.hxx"
+
+// Largest relative gap between the coefficient of a pair and -(1/r) dU/dr by central differences, over [rDebut, rFin)
+static double erreurDerivee(const ChampForces &champ, int a, int b, double rDebut, double rFin) {
+    double erreur = 0;
+    const double h = 1e-6;
+    for (double r = rDebut; r < rFin; r += 0.013) {
+        const double derivee = (champ.getEnergie(a, b, (r + h) * (r + h)) - champ.getEnergie(a, b, (r - h) * (r - h))) / (2 * h);
+        const double attendu = derivee / r;
+        erreur = std::max(erreur, std::abs(champ.getCoefficient(a, b, r * r) - attendu) / (1 + std::abs(attendu)));
+    }
+    return erreur;
+}
+
+// Test the Lorentz-Berthelot mixing of the Lennard-Jones field and the explicit pairs
+TEST(ChampForces, Melange) {
+    ChampForces champ(ChampForces::LENNARD_JONES, 3, 1, 1);
+    champ.setCategorie(1, 4, 3);
+    EXPECT_EQ(champ.getNbCategories(), 3);
+    EXPECT_EQ(champ.getType(), ChampForces::LENNARD_JONES);
+    EXPECT_TRUE(champ.getGravitation());
+
+    // Pair (0, 1): eps = sqrt(1 * 4) = 2, sigma = (1 + 3) / 2 = 2, in both orders
+    const double *ligne = champ.getTable() + ChampForces::TAILLE_LIGNE * (0 * 3 + 1);
+    EXPECT_DOUBLE_EQ(ligne[0], 4);
+    EXPECT_DOUBLE_EQ(ligne[1], 48);
+    EXPECT_DOUBLE_EQ(champ.getEnergie(0, 1, 4), 0);
+    EXPECT_DOUBLE_EQ(champ.getEnergie(1, 0, 4), 0);
+    EXPECT_DOUBLE_EQ(champ.getEnergie(0, 1, std::pow(2, 1.0 / 3) * 4), -2);
+    EXPECT_DOUBLE_EQ(champ.getEnergie(1, 1, 9), 0);
+    EXPECT_DOUBLE_EQ(champ.getEnergie(0, 0, 1), 0);
+
+    // An explicit pair is kept when its categories change
+    champ.setPaire(2, 1, 0.5, 1);
+    champ.setCategorie(2, 9, 1);
+    champ.setCategorie(1, 1, 1);
+    EXPECT_DOUBLE_EQ(champ.getEnergie(1, 2, std::pow(2, 1.0 / 3)), -0.5);
+    EXPECT_DOUBLE_EQ(champ.getEnergie(2, 1, std::pow(2, 1.0 / 3)), -0.5);
+    EXPECT_DOUBLE_EQ(champ.getEnergie(0, 2, std::pow(2, 1.0 / 3)), -3);
+    EXPECT_LT(erreurDerivee(champ, 0, 2, 0.9, 2.5), 1e-6);
+}
+
+// Test that the coefficient of each law is -(1/r) dU/dr, and the mixing rules of Morse and Coulomb
+TEST(ChampForces, Lois) {
+    ChampForces morse(ChampForces::MORSE, 2, 1, 2, 1);
+    morse.setCategorie(1, 4, 4, 2);
+    EXPECT_DOUBLE_EQ(morse.getEnergie(0, 0, 1), -1);
+    EXPECT_DOUBLE_EQ(morse.getEnergie(0, 1, 2.25), -2);
+    EXPECT_NEAR(morse.getCoefficient(0, 1, 2.25), 0, 1e-15);
+    EXPECT_LT(erreurDerivee(morse, 0, 1, 0.5, 3), 1e-6);
+
+    ChampForces molle(ChampForces::SPHERE_MOLLE, 1, 2, 1);
+    EXPECT_DOUBLE_EQ(molle.getEnergie(0, 0, 1), 2);
+    EXPECT_DOUBLE_EQ(molle.getCoefficient(0, 0, 1), -24);
+    EXPECT_LT(erreurDerivee(molle, 0, 0, 0.8, 2.5), 1e-6);
+
+    ChampForces coulomb(ChampForces::COULOMB, 2, 1);
+    coulomb.setCategorie(1, -2);
+    EXPECT_DOUBLE_EQ(coulomb.getEnergie(0, 0, 4), 0.5);
+    EXPECT_DOUBLE_EQ(coulomb.getEnergie(0, 1, 4), -1);
+    EXPECT_DOUBLE_EQ(coulomb.getEnergie(1, 1, 4), 2);
+    EXPECT_LT(erreurDerivee(coulomb, 0, 1, 0.5, 2.5), 1e-6);
+}
+
+// Test the rejected parameters
+TEST(ChampForces, Invalide) {
+    EXPECT_THROW(ChampForces(4, 1, 1, 1), std::invalid_argument);
+    EXPECT_THROW(ChampForces(ChampForces::LENNARD_JONES, 0, 1, 1), std::invalid_argument);
+    EXPECT_THROW(ChampForces(ChampForces::LENNARD_JONES, 1, 1, 0), std::invalid_argument);
+    EXPECT_THROW(ChampForces(ChampForces::MORSE, 1, -1, 1, 1), std::invalid_argument);
+    ChampForces champ(ChampForces::SPHERE_MOLLE, 2, 1, 1);
+    EXPECT_THROW(champ.setCategorie(2, 1, 1), std::invalid_argument);
+    EXPECT_THROW(champ.setPaire(0, -1, 1, 1), std::invalid_argument);
+    EXPECT_THROW(champ.getEnergie(0, 2, 1), std::invalid_argument);
+}
+
+// Test that a field read back from a restart file has the same table
+TEST(ChampForces, Reprise) {
+    const std::string fichier = "champ_forces_reprise.bin";
+    ChampForces champ(ChampForces::LENNARD_JONES, 2, 1, 1);
+    champ.setCategorie(1, 2, 1.5);
+    champ.setPaire(0, 1, 0.3, 1.2);
+    champ.setGravitation(false);
+    {
+        EcritureReprise ecriture(fichier);
+        champ.ecrire(ecriture);
+        ecriture.terminer();
+    }
+    ChampForces lu;
+    LectureReprise lecture(fichier);
+    lu.lire(lecture);
+    lecture.terminer();
+    EXPECT_EQ(lu.getType(), ChampForces::LENNARD_JONES);
+    EXPECT_EQ(lu.getNbCategories(), 2);
+    EXPECT_FALSE(lu.getGravitation());
+    for (int k = 0; k < ChampForces::TAILLE_LIGNE * 4; k++) {
+        EXPECT_EQ(lu.getTable()[k], champ.getTable()[k]);
+    }
+
+    // The explicit pair survives the reading
+    lu.setCategorie(0, 5, 1);
+    EXPECT_EQ(lu.getEnergie(0, 1, 2), champ.getEnergie(0, 1, 2));
+    std::remove(fichier.c_str());
+}
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include "DecompositionDomaine.hxx"
+#include "Univers.hxx"
+#include "Vector3D.hxx"
+
+// Tolerance on positions after a few steps: the forces of the border layers are
+// summed in a different order on each rank
+static const double TOLERANCE_POSITION = (sizeof(ReelPosition) == sizeof(float)) ? 1e-3 : 1e-8;
+
+// Build a small 2D collision, identical on every rank
+static Univers collision(int boundaryCond) {
+    Univers u(2, 40, 40, 0, 1, 1, 2.5, 0.0005, 1.0, boundaryCond, 0, 0);
+    u.setFrequenceSortie(0);
+    srand(1);
+    u.initialiserDemoCercle(10, 10, 3, Vector3D(0, -20, 0), Vector3D(0, -40, 0));
+    return u;
+}
+
+// Test the split of the layers
+TEST(DecompositionDomaine, Decouper) {
+    DecompositionDomaine d;
+    d.decouper(10);
+    EXPECT_GE(d.getRang(), 0);
+    EXPECT_LT(d.getRang(), d.getNbRangs());
+    EXPECT_LE(d.getDebut(), d.getFin());
+    for (int couche = d.getDebut(); couche < d.getFin(); couche++) {
+        EXPECT_EQ(d.getProprietaire(couche), d.getRang());
+    }
+    EXPECT_EQ(d.getProprietaire(0), 0);
+    EXPECT_EQ(d.getProprietaire(9), d.getNbRangs() - 1);
+    EXPECT_EQ(d.sommer(1L), d.getNbRangs());
+    EXPECT_THROW(d.decouper(d.getNbRangs() - 1), std::invalid_argument);
+}
+
+// Test the copy of a particle to and from the exchanged form
+TEST(DecompositionDomaine, ExtraireAjouter) {
+    ParticuleStore store;
+    store.addParticule(Particule3D(7, 2, 1, Vector3D(1, 2, 3), Vector3D(4, 5, 6), Vector3D(7, 8, 9)), 0);
+    auto p = DecompositionDomaine::extraire(store, 0);
+    DecompositionDomaine::ajouter(store, p, 3);
+    ASSERT_EQ(store.getNbParticules(), 2);
+    EXPECT_EQ(store.id[1], 7);
+    EXPECT_EQ(store.categorie[1], 1);
+    EXPECT_EQ(store.cellule[1], 3);
+    EXPECT_EQ(store.masse[1], 2);
+    EXPECT_EQ(store.x[1], 4);
+    EXPECT_EQ(store.vz[1], 9);
+    EXPECT_EQ(store.fy[1], 2);
+}
+
+// Test that a decomposed run matches the single-process run, for each boundary condition
+TEST(DecompositionDomaine, CollisionCommeSequentiel) {
+    for (int boundaryCond = 0; boundaryCond < 3; boundaryCond++) {
+        Univers sequentiel = collision(boundaryCond);
+        sequentiel.avancer(60);
+
+        Univers decompose = collision(boundaryCond);
+        decompose.setDecomposition(true);
+        EXPECT_NE(decompose.getDecomposition(), nullptr);
+        decompose.avancer(60);
+
+        EXPECT_EQ(decompose.getNbParticulesTotal(), sequentiel.getNbParticules());
+        EXPECT_NEAR(decompose.energieCinetique(), sequentiel.energieCinetique(), 1e-6 * sequentiel.energieCinetique());
+
+        std::map<int, int> indices;
+        const ParticuleStore &reference = sequentiel.getStore();
+        for (int i = 0; i < reference.getNbParticules(); i++) {
+            indices[reference.id[i]] = i;
+        }
+        const ParticuleStore &local = decompose.getStore();
+        const DecompositionDomaine &d = *decompose.getDecomposition();
+        for (int i = 0; i < local.getNbParticules(); i++) {
+            // No ASSERT between the collective calls: a rank leaving the test would block the others
+            EXPECT_EQ(indices.count(local.id[i]), 1u);
+            if (indices.count(local.id[i]) == 0) {
+                continue;
+            }
+            const int j = indices[local.id[i]];
+            EXPECT_NEAR(local.x[i], reference.x[j], TOLERANCE_POSITION);
+            EXPECT_NEAR(local.y[i], reference.y[j], TOLERANCE_POSITION);
+            EXPECT_NEAR(local.vy[i], reference.vy[j], 1e3 * TOLERANCE_POSITION);
+            const int couche = static_cast<int>(local.y[i] / 2.5);
+            EXPECT_EQ(d.getProprietaire(std::min(couche, 15)), d.getRang());
+        }
+    }
+}
+
+// Test that each rank saves and resumes its own slab, and that another decomposition refuses the files
+TEST(DecompositionDomaine, Reprise) {
+    const std::string fichier = "decomposition_reprise.bin";
+    Univers a = collision(2);
+    a.setDecomposition(true);
+    a.avancer(20);
+    a.saveCheckpoint(fichier);
+    a.avancer(20);
+
+    Univers b = collision(2);
+    b.setDecomposition(true);
+    b.loadCheckpoint(fichier);
+    EXPECT_EQ(b.getIteration(), 20);
+    b.avancer(20);
+    EXPECT_EQ(b.getNbParticulesTotal(), a.getNbParticulesTotal());
+    EXPECT_EQ(b.getStore().id, a.getStore().id);
+    EXPECT_EQ(b.getStore().x, a.getStore().x);
+    EXPECT_EQ(b.getStore().vy, a.getStore().vy);
+
+    // The file of this rank names its slab, and a single process cannot load it
+    const DecompositionDomaine &d = *a.getDecomposition();
+    const std::string nom = (d.getNbRangs() > 1) ? "decomposition_reprise_r" + std::to_string(d.getRang()) + ".bin" : fichier;
+    EXPECT_TRUE(std::ifstream(nom).good());
+    if (d.getNbRangs() > 1) {
+        Univers seul = collision(2);
+        EXPECT_THROW(seul.loadCheckpoint(nom), std::runtime_error);
+        EXPECT_FALSE(std::ifstream(fichier).good());
+    }
+    std::remove(nom.c_str());
+}
+
+// Test that the Verlet lists are refused with a decomposition
+TEST(DecompositionDomaine, VerletRefuse) {
+    Univers u = collision(0);
+    u.setDecomposition(true);
+    EXPECT_THROW(u.setVerletSkin(0.3), std::invalid_argument);
+    u.setDecomposition(false);
+    EXPECT_EQ(u.getDecomposition(), nullptr);
+}
+
+int main(int argc, char **argv) {
+    DecompositionDomaine::initialiserMPI(&argc, &argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    const int resultat = RUN_ALL_TESTS();
+    DecompositionDomaine::finaliserMPI();
+    return resultat;
+}
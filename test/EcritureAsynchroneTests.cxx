@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include "EcritureAsynchrone.hxx"
+#include "EcritureVTK.hxx"
+#include "ParticuleStore.hxx"
+
+// Reads a whole file
+static std::string lireFichier(const std::string &filename) {
+    std::ifstream file(filename, std::ios::binary);
+    std::ostringstream oss;
+    oss << file.rdbuf();
+    return oss.str();
+}
+
+// Test that the snapshots written in the background match the synchronous writer
+TEST(EcritureAsynchrone, MatchesSynchronous) {
+    ParticuleStore s;
+    for (int i = 0; i < 500; i++) {
+        s.addParticule(Particule3D(i, 1.0f, i % 2, Vector3D(), Vector3D(i, 1, 0), Vector3D(0, i, 0)), 0);
+    }
+
+    std::vector<std::string> attendus;
+    {
+        EcritureAsynchrone e(1);
+        EcritureVTK reference(1);
+        for (int k = 0; k < 5; k++) {
+            // The store changes right after each submission: the snapshot must not see it
+            e.soumettre(s, "async_" + std::to_string(k) + ".vtu");
+            reference.preparer(s);
+            reference.ecrire("sync.vtu");
+            attendus.push_back(lireFichier("sync.vtu"));
+            for (auto &x : s.x) {
+                x += 1.0;
+            }
+        }
+        e.attendre();
+    }
+    std::remove("sync.vtu");
+
+    for (int k = 0; k < 5; k++) {
+        std::string nom = "async_" + std::to_string(k) + ".vtu";
+        EXPECT_EQ(lireFichier(nom), attendus[k]);
+        std::remove(nom.c_str());
+    }
+}
+
+// Test that a write error is reported to the caller
+TEST(EcritureAsynchrone, ErrorIsRethrown) {
+    ParticuleStore s;
+    s.addParticule(Particule3D(0, 1.0f, 0, Vector3D(), Vector3D(), Vector3D()), 0);
+    EcritureAsynchrone e;
+    e.soumettre(s, "/nonexistent/dir/file.vtu");
+    EXPECT_THROW(e.attendre(), std::runtime_error);
+    // The error is reported once
+    EXPECT_NO_THROW(e.attendre());
+}
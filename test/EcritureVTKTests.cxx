@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include "EcritureVTK.hxx"
+#include "ParticuleStore.hxx"
+
+#ifdef UNIVERS_AVEC_ZLIB
+#include <zlib.h>
+#endif
+
+// Builds a small store with distinct values
+static ParticuleStore creerStore(int n) {
+    ParticuleStore s;
+    for (int i = 0; i < n; i++) {
+        s.addParticule(Particule3D(i, 1.0f, i % 2, Vector3D(), Vector3D(i, 2.0 * i, 0.5), Vector3D(-i, 0.25, 3.0 * i)), 0);
+    }
+    return s;
+}
+
+// Reads a whole file
+static std::string lireFichier(const std::string &filename) {
+    std::ifstream file(filename, std::ios::binary);
+    std::ostringstream oss;
+    oss << file.rdbuf();
+    return oss.str();
+}
+
+// Gets the offset of the n-th appended array declared in the header
+static uint64_t lireDecalage(const std::string &contenu, int n) {
+    size_t pos = 0;
+    for (int k = 0; k <= n; k++) {
+        pos = contenu.find("offset=\"", pos) + 8;
+    }
+    return std::stoull(contenu.substr(pos));
+}
+
+// Decodes the n-th appended array of a file
+static std::vector<float> lireTableau(const std::string &contenu, int n, bool compresse) {
+    const size_t debut = contenu.find("_", contenu.find("<AppendedData")) + 1;
+    const char *p = contenu.data() + debut + lireDecalage(contenu, n);
+    std::vector<float> valeurs;
+    if (!compresse) {
+        uint64_t taille;
+        std::memcpy(&taille, p, sizeof(taille));
+        valeurs.resize(taille / sizeof(float));
+        std::memcpy(valeurs.data(), p + sizeof(taille), taille);
+        return valeurs;
+    }
+#ifdef UNIVERS_AVEC_ZLIB
+    uint64_t entete[3];
+    std::memcpy(entete, p, sizeof(entete));
+    const uint64_t nbBlocs = entete[0];
+    const uint64_t taille = (nbBlocs == 0) ? 0 : (nbBlocs - 1) * entete[1] + entete[2];
+    valeurs.resize(taille / sizeof(float));
+    const char *bloc = p + (3 + nbBlocs) * sizeof(uint64_t);
+    auto *sortie = reinterpret_cast<Bytef*>(valeurs.data());
+    for (uint64_t b = 0; b < nbBlocs; b++) {
+        uint64_t tailleCompresse;
+        std::memcpy(&tailleCompresse, p + (3 + b) * sizeof(uint64_t), sizeof(tailleCompresse));
+        uLongf tailleBloc = (b + 1 == nbBlocs) ? entete[2] : entete[1];
+        EXPECT_EQ(uncompress(sortie + b * entete[1], &tailleBloc, reinterpret_cast<const Bytef*>(bloc), tailleCompresse), Z_OK);
+        bloc += tailleCompresse;
+    }
+#endif
+    return valeurs;
+}
+
+// Checks the decoded arrays against the store
+static void verifierTableaux(const std::string &contenu, const ParticuleStore &s, bool compresse) {
+    std::vector<float> positions = lireTableau(contenu, 0, compresse);
+    std::vector<float> vitesses = lireTableau(contenu, 1, compresse);
+    std::vector<float> categories = lireTableau(contenu, 2, compresse);
+    const int n = s.getNbParticules();
+    ASSERT_EQ(positions.size(), 3u * n);
+    ASSERT_EQ(vitesses.size(), 3u * n);
+    ASSERT_EQ(categories.size(), (size_t)n);
+    for (int i = 0; i < n; i++) {
+        EXPECT_EQ(positions[3 * i], (float)s.x[i]);
+        EXPECT_EQ(positions[3 * i + 1], (float)s.y[i]);
+        EXPECT_EQ(positions[3 * i + 2], (float)s.z[i]);
+        EXPECT_EQ(vitesses[3 * i], (float)s.vx[i]);
+        EXPECT_EQ(vitesses[3 * i + 1], (float)s.vy[i]);
+        EXPECT_EQ(vitesses[3 * i + 2], (float)s.vz[i]);
+        EXPECT_EQ(categories[i], (float)s.categorie[i]);
+    }
+}
+
+// Test the format selection
+TEST(EcritureVTK, Format) {
+    EcritureVTK e;
+    EXPECT_EQ(e.getFormat(), 1);
+    e.setFormat(0);
+    EXPECT_EQ(e.getFormat(), 0);
+    EXPECT_THROW(e.setFormat(3), std::invalid_argument);
+    EXPECT_THROW(e.setFormat(-1), std::invalid_argument);
+    if (EcritureVTK::zlibDisponible()) {
+        e.setFormat(2);
+        EXPECT_EQ(e.getFormat(), 2);
+    } else {
+        EXPECT_THROW(e.setFormat(2), std::invalid_argument);
+    }
+}
+
+// Test the ASCII format
+TEST(EcritureVTK, Ascii) {
+    ParticuleStore s = creerStore(3);
+    EcritureVTK e(0);
+    e.preparer(s);
+    e.ecrire("ecriture_ascii.vtu");
+    std::string contenu = lireFichier("ecriture_ascii.vtu");
+    std::remove("ecriture_ascii.vtu");
+    EXPECT_NE(contenu.find("NumberOfPoints=\"3\""), std::string::npos);
+    EXPECT_NE(contenu.find("format=\"ascii\">\n0 0 0.5 1 2 0.5 2 4 0.5 \n"), std::string::npos);
+    EXPECT_EQ(contenu.find("AppendedData"), std::string::npos);
+}
+
+// Test the raw binary format: the appended arrays read back to the store values
+TEST(EcritureVTK, Binaire) {
+    ParticuleStore s = creerStore(100);
+    EcritureVTK e(1);
+    e.preparer(s);
+    e.ecrire("ecriture_binaire.vtu");
+    std::string contenu = lireFichier("ecriture_binaire.vtu");
+    std::remove("ecriture_binaire.vtu");
+    EXPECT_NE(contenu.find("NumberOfPoints=\"100\""), std::string::npos);
+    verifierTableaux(contenu, s, false);
+}
+
+// Test the compressed format over several blocks
+TEST(EcritureVTK, Compresse) {
+    if (!EcritureVTK::zlibDisponible()) {
+        GTEST_SKIP() << "Built without zlib";
+    }
+    ParticuleStore s = creerStore(10000);
+    EcritureVTK e(2);
+    e.preparer(s);
+    e.ecrire("ecriture_compresse.vtu");
+    std::string contenu = lireFichier("ecriture_compresse.vtu");
+    std::remove("ecriture_compresse.vtu");
+    EXPECT_NE(contenu.find("vtkZLibDataCompressor"), std::string::npos);
+    verifierTableaux(contenu, s, true);
+}
+
+// Test that writing to an invalid path throws
+TEST(EcritureVTK, FichierInvalide) {
+    EcritureVTK e;
+    e.preparer(creerStore(1));
+    EXPECT_THROW(e.ecrire("/nonexistent/dir/file.vtu"), std::runtime_error);
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include "ListeVoisins.hxx"
+#include "ParticuleStore.hxx"
+#include "Particule3D.hxx"
+#include "Vector3D.hxx"
+
+// Builds a store with particles on a line along x
+static ParticuleStore ligne(int n, double pas) {
+    ParticuleStore s;
+    for (int i = 0; i < n; i++) {
+        s.addParticule(Particule3D(i, 1.0f, 0, Vector3D(), Vector3D(1.0 + i * pas, 1.0, 0.0), Vector3D()), 0);
+    }
+    return s;
+}
+
+// Test that the half lists hold each close pair once
+TEST(ListeVoisins, BuildHalfLists) {
+    ParticuleStore s = ligne(5, 1.0);
+    ListeVoisins l;
+    l.construire(s, 1.5, 10, 10, 0);
+
+    EXPECT_EQ(l.getNbReconstructions(), 1);
+    EXPECT_EQ(l.getNbPaires(), 4); // Only consecutive particles are closer than 1.5
+    for (int i = 0; i < 4; i++) {
+        ASSERT_EQ(l.finListe(i) - l.debutListe(i), 1);
+        EXPECT_EQ(l.getVoisins()[l.debutListe(i)], i + 1);
+    }
+    EXPECT_EQ(l.finListe(4), l.debutListe(4));
+}
+
+// Test the end of the particles reached by the lists: the running maximum of the neighbors
+TEST(ListeVoisins, Portee) {
+    ParticuleStore s = ligne(6, 1.0);
+    s.x[5] = 1.5;  // The last particle is close to the first two
+    ListeVoisins l;
+    l.construire(s, 1.2, 10, 10, 0);
+
+    EXPECT_EQ(l.getPortee(0), 6);
+    EXPECT_EQ(l.getPortee(2), 6);
+    EXPECT_EQ(l.getPortee(5), 6);
+
+    s = ligne(4, 2.0);
+    l.construire(s, 1.5, 10, 10, 0);
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(l.getPortee(i), i + 1);  // No pair: each particle only reaches itself
+    }
+}
+
+// Test the skin / 2 displacement criterion
+TEST(ListeVoisins, DisplacementCriterion) {
+    ParticuleStore s = ligne(3, 1.0);
+    ListeVoisins l;
+    l.construire(s, 1.5, 10, 10, 0);
+
+    s.x[1] += 0.2;
+    EXPECT_FALSE(l.deplacementExcessif(s, 0.5));
+    s.y[2] += 0.3;
+    EXPECT_TRUE(l.deplacementExcessif(s, 0.5));
+}
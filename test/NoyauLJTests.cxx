@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "NoyauLJ.hxx"
+
+namespace {
+
+// Random batch of particles in a 3 x 3 x 3 box, with a duplicate of particle 0
+struct Lot {
+    std::vector<ReelPosition> x, y, z;
+    std::vector<ReelForce> fx, fy, fz;
+    std::vector<float> masse;
+
+    explicit Lot(int n) : x(n), y(n), z(n), fx(n), fy(n), fz(n), masse(n) {
+        std::mt19937 generateur(42);
+        std::uniform_real_distribution<double> position(0.0, 3.0);
+        std::uniform_real_distribution<double> force(-1.0, 1.0);
+        for (int k = 0; k < n; k++) {
+            x[k] = position(generateur);
+            y[k] = position(generateur);
+            z[k] = position(generateur);
+            fx[k] = force(generateur);
+            fy[k] = force(generateur);
+            fz[k] = force(generateur);
+            masse[k] = static_cast<float>(1 + position(generateur));
+        }
+        // Two particles at the same place: the pair is masked out
+        x[n - 1] = x[0];
+        y[n - 1] = y[0];
+        z[n - 1] = z[0];
+    }
+};
+
+const double TOLERANCE = 1e-12;
+
+}
+
+// Test that the scalar kernel is always available and that the detected instruction set is supported
+TEST(NoyauLJ, Detection) {
+    EXPECT_TRUE(NoyauLJ::estDisponible(NoyauLJ::SCALAIRE));
+    EXPECT_TRUE(NoyauLJ::estDisponible(NoyauLJ::detecter()));
+    EXPECT_FALSE(NoyauLJ::estDisponible(NoyauLJ::AVX512 + 1));
+    EXPECT_STREQ(NoyauLJ::getNom(NoyauLJ::AVX2), "avx2");
+    EXPECT_THROW(NoyauLJ({1, 1, 24, true, true}, 7), std::invalid_argument);
+
+    NoyauLJ noyau({1, 1, 24, true, true});
+    EXPECT_EQ(noyau.getJeu(), NoyauLJ::detecter());
+}
+
+// Test a single pair against the Lennard-Jones formula
+TEST(NoyauLJ, SinglePair) {
+    const ReelPosition x[] = {0.0, 1.2f}, y[] = {0.0, 0.0}, z[] = {0.0, 0.0};
+    for (int jeu = NoyauLJ::SCALAIRE; jeu <= NoyauLJ::AVX512; jeu++) {
+        if (!NoyauLJ::estDisponible(jeu)) {
+            continue;
+        }
+        NoyauLJ noyau({2.5 * 2.5, 1, 24, false, true}, jeu);
+        double fxi = 0, fyi = 0, fzi = 0;
+        EXPECT_EQ(noyau.coquillePleine(x, y, z, 0, 0.0, 0, 2, fxi, fyi, fzi), 1) << NoyauLJ::getNom(jeu);
+        const double r = x[1];
+        const double attendu = 24 * std::pow(1 / r, 2) * std::pow(1 / r, 6) * (1 - 2 * std::pow(1 / r, 6)) * r;
+        EXPECT_NEAR(fxi, attendu, 1e-12) << NoyauLJ::getNom(jeu);
+        EXPECT_EQ(fyi, 0.0);
+        EXPECT_EQ(fzi, 0.0);
+    }
+}
+
+// Test every instruction set against the scalar loop, for every batch length up to 2 vectors of 8
+TEST(NoyauLJ, MatchesScalar) {
+    const int n = 40;
+    for (bool troisD : {false, true}) {
+        for (bool borner : {false, true}) {
+            // A small sigma gives forces larger than the cap
+            const NoyauLJ::Parametres p{2.0 * 2.0, borner ? 1.0 : 0.5, 24.0, borner, troisD};
+            const NoyauLJ reference(p, NoyauLJ::SCALAIRE);
+            for (int jeu = NoyauLJ::SSE2; jeu <= NoyauLJ::AVX512; jeu++) {
+                if (!NoyauLJ::estDisponible(jeu)) {
+                    continue;
+                }
+                const NoyauLJ noyau(p, jeu);
+                for (int longueur = 0; longueur <= 17; longueur++) {
+                    const int debut = 1, fin = debut + longueur;
+                    Lot attendu(n), obtenu(n);
+                    double ax = 0, ay = 0, az = 0, bx = 0, by = 0, bz = 0;
+
+                    // Full shell, with particle 0 duplicated at the end of the longest batches
+                    EXPECT_EQ(reference.coquillePleine(attendu.x.data(), attendu.y.data(), attendu.z.data(), 0, 1.5, debut, n,
+                                                       ax, ay, az),
+                              noyau.coquillePleine(obtenu.x.data(), obtenu.y.data(), obtenu.z.data(), 0, 1.5, debut, n,
+                                                   bx, by, bz));
+                    EXPECT_NEAR(ax, bx, TOLERANCE * (1 + std::abs(ax))) << NoyauLJ::getNom(jeu);
+                    EXPECT_NEAR(ay, by, TOLERANCE * (1 + std::abs(ay))) << NoyauLJ::getNom(jeu);
+                    EXPECT_NEAR(az, bz, TOLERANCE * (1 + std::abs(az))) << NoyauLJ::getNom(jeu);
+
+                    // Half shell on the batch of the given length
+                    ax = ay = az = bx = by = bz = 0;
+                    const int actives = reference.demiCoquille(attendu.x.data(), attendu.y.data(), attendu.z.data(),
+                                                               attendu.masse.data(), attendu.fx.data(), attendu.fy.data(),
+                                                               attendu.fz.data(), 0, debut, fin, ax, ay, az);
+                    EXPECT_EQ(actives, noyau.demiCoquille(obtenu.x.data(), obtenu.y.data(), obtenu.z.data(), obtenu.masse.data(),
+                                                          obtenu.fx.data(), obtenu.fy.data(), obtenu.fz.data(), 0, debut, fin,
+                                                          bx, by, bz));
+                    EXPECT_NEAR(ax, bx, TOLERANCE * (1 + std::abs(ax))) << NoyauLJ::getNom(jeu) << " " << longueur;
+                    EXPECT_NEAR(ay, by, TOLERANCE * (1 + std::abs(ay))) << NoyauLJ::getNom(jeu) << " " << longueur;
+                    EXPECT_NEAR(az, bz, TOLERANCE * (1 + std::abs(az))) << NoyauLJ::getNom(jeu) << " " << longueur;
+                    // The reactions are computed pair by pair with the same operations: no rounding difference
+                    for (int k = 0; k < n; k++) {
+                        ASSERT_EQ(attendu.fx[k], obtenu.fx[k]) << NoyauLJ::getNom(jeu) << " " << longueur << " " << k;
+                        ASSERT_EQ(attendu.fy[k], obtenu.fy[k]) << NoyauLJ::getNom(jeu) << " " << longueur << " " << k;
+                        ASSERT_EQ(attendu.fz[k], obtenu.fz[k]) << NoyauLJ::getNom(jeu) << " " << longueur << " " << k;
+                    }
+                }
+            }
+        }
+    }
+}
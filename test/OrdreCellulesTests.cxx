@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+#include "OrdreCellules.hxx"
+
+// Test the Morton keys of a few points
+TEST(OrdreCellules, CleMorton) {
+    const unsigned a[2] = {1, 0}, b[2] = {0, 1}, c[2] = {3, 3};
+    EXPECT_EQ(OrdreCellules::cleMorton(a, 2, 2), 1u);
+    EXPECT_EQ(OrdreCellules::cleMorton(b, 2, 2), 2u);
+    EXPECT_EQ(OrdreCellules::cleMorton(c, 2, 2), 15u);
+    const unsigned d[3] = {1, 1, 1};
+    EXPECT_EQ(OrdreCellules::cleMorton(d, 3, 1), 7u);
+}
+
+// Test that the Hilbert curve visits every point once, each step moving to a neighbor
+TEST(OrdreCellules, HilbertContinu) {
+    for (int nbDims = 2; nbDims <= 3; nbDims++) {
+        const int nbBits = 3;
+        const int cote = 1 << nbBits;
+        const int n = (nbDims == 3) ? cote * cote * cote : cote * cote;
+        std::vector<int> parCle(n, -1);
+        for (int r = 0; r < n; r++) {
+            const unsigned coords[3] = {static_cast<unsigned>(r % cote), static_cast<unsigned>((r / cote) % cote),
+                                        static_cast<unsigned>(r / (cote * cote))};
+            const uint64_t cle = OrdreCellules::cleHilbert(coords, nbDims, nbBits);
+            ASSERT_LT(cle, static_cast<uint64_t>(n));
+            EXPECT_EQ(parCle[cle], -1);
+            parCle[cle] = r;
+        }
+        for (int k = 1; k < n; k++) {
+            const int a = parCle[k - 1], b = parCle[k];
+            const int distance = std::abs(a % cote - b % cote) + std::abs((a / cote) % cote - (b / cote) % cote) +
+                                 std::abs(a / (cote * cote) - b / (cote * cote));
+            EXPECT_EQ(distance, 1);
+        }
+    }
+}
+
+// Test that the ranks of the cells are a permutation, the identity in row-major order
+TEST(OrdreCellules, CalculerRangs) {
+    for (int ordre = OrdreCellules::LIGNES; ordre <= OrdreCellules::HILBERT; ordre++) {
+        std::vector<int> rangs = OrdreCellules::calculerRangs(ordre, 5, 3, 7);
+        ASSERT_EQ(rangs.size(), 105u);
+        std::vector<int> tries(rangs);
+        std::sort(tries.begin(), tries.end());
+        for (int k = 0; k < 105; k++) {
+            EXPECT_EQ(tries[k], k);
+            if (ordre == OrdreCellules::LIGNES) {
+                EXPECT_EQ(rangs[k], k);
+            }
+        }
+    }
+    // The cells of a power-of-two grid follow the curve
+    std::vector<int> morton = OrdreCellules::calculerRangs(OrdreCellules::MORTON, 2, 2, 1);
+    EXPECT_EQ(morton, std::vector<int>({0, 1, 2, 3}));
+    std::vector<int> hilbert = OrdreCellules::calculerRangs(OrdreCellules::HILBERT, 2, 2, 1);
+    EXPECT_EQ(hilbert[0], 0);
+    EXPECT_EQ(std::abs(hilbert[1] - hilbert[2]), 2);
+
+    EXPECT_THROW(OrdreCellules::calculerRangs(3, 2, 2, 2), std::invalid_argument);
+    EXPECT_STREQ(OrdreCellules::getNom(OrdreCellules::HILBERT), "hilbert");
+}
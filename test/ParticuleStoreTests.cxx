@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include "ParticuleStore.hxx"
+#include "Particule3D.hxx"
+#include "Vector3D.hxx"
+
+// Test the default constructor
+TEST(ParticuleStore, DefaultConstructor) {
+    ParticuleStore s;
+    EXPECT_EQ(s.getNbParticules(), 0);
+}
+
+// Test adding and reading back a particle
+TEST(ParticuleStore, AddAndGetParticule) {
+    ParticuleStore s;
+    Particule3D p(7, 2.0f, 1, Vector3D(1.0, 2.0, 3.0), Vector3D(4.0, 5.0, 6.0), Vector3D(7.0, 8.0, 9.0));
+    s.addParticule(p, 3);
+    EXPECT_EQ(s.getNbParticules(), 1);
+    EXPECT_EQ(s.cellule[0], 3);
+    Particule3D q = s.getParticule(0);
+    EXPECT_EQ(q.getId(), 7);
+    EXPECT_EQ(q.getMasse(), 2.0f);
+    EXPECT_EQ(q.getCategorie(), 1);
+    EXPECT_EQ(q.getForce(), Vector3D(1.0, 2.0, 3.0));
+    EXPECT_EQ(q.getPos(), Vector3D(4.0, 5.0, 6.0));
+    EXPECT_EQ(q.getVit(), Vector3D(7.0, 8.0, 9.0));
+}
+
+// Test that sortByCell groups the particles by cell and keeps their data together
+TEST(ParticuleStore, SortByCell) {
+    ParticuleStore s;
+    int cells[] = {2, 0, 2, 1, 0};
+    for (int i = 0; i < 5; i++) {
+        s.addParticule(Particule3D(i, 1.0f, 0, Vector3D(), Vector3D(i, 0, 0), Vector3D()), cells[i]);
+    }
+    s.sortByCell(4);
+
+    EXPECT_EQ(s.cellStart(0), 0);
+    EXPECT_EQ(s.cellEnd(0), 2);
+    EXPECT_EQ(s.cellStart(1), 2);
+    EXPECT_EQ(s.cellEnd(1), 3);
+    EXPECT_EQ(s.cellStart(2), 3);
+    EXPECT_EQ(s.cellEnd(2), 5);
+    EXPECT_EQ(s.cellStart(3), s.cellEnd(3));
+
+    // Stable: original order is kept inside a cell
+    int expectedIds[] = {1, 4, 3, 0, 2};
+    for (int i = 0; i < 5; i++) {
+        EXPECT_EQ(s.id[i], expectedIds[i]);
+        EXPECT_EQ(s.x[i], (double)expectedIds[i]);
+    }
+}
+
+// Test removing flagged particles
+TEST(ParticuleStore, RemoveFlagged) {
+    ParticuleStore s;
+    for (int i = 0; i < 4; i++) {
+        s.addParticule(Particule3D(i, 1.0f, 0, Vector3D(), Vector3D(), Vector3D()), 0);
+    }
+    std::vector<char> flags = {0, 1, 0, 1};
+    EXPECT_EQ(s.removeFlagged(flags), 2);
+    EXPECT_EQ(s.getNbParticules(), 2);
+    EXPECT_EQ(s.id[0], 0);
+    EXPECT_EQ(s.id[1], 2);
+}
+
+// Checks that every particle lies in the range of its cell and kept its data
+static void verifierRegroupement(const ParticuleStore &s, int nbCellules) {
+    EXPECT_EQ(s.cellStart(0), 0);
+    EXPECT_EQ(s.cellEnd(nbCellules - 1), s.getNbParticules());
+    for (int c = 0; c < nbCellules; c++) {
+        for (int i = s.cellStart(c); i < s.cellEnd(c); i++) {
+            EXPECT_EQ(s.cellule[i], c);
+            EXPECT_EQ(s.x[i], (double)s.id[i]);
+        }
+    }
+}
+
+// Test that rebinCells moves a few migrants in place, forward and backward
+TEST(ParticuleStore, RebinCellsFewMigrants) {
+    ParticuleStore s;
+    const int nbCellules = 10;
+    for (int i = 0; i < 200; i++) {
+        // Cells 4 and 5 are left empty
+        int c = i % nbCellules;
+        if (c == 4 || c == 5) c = 3;
+        s.addParticule(Particule3D(i, 1.0f, 0, Vector3D(), Vector3D(i, 0, 0), Vector3D()), c);
+    }
+    s.sortByCell(nbCellules);
+    EXPECT_EQ(s.rebinCells(nbCellules), 0);
+
+    // Forward across the empty cells, backward, and to the last cell
+    s.cellule[s.cellStart(3)] = 6;
+    s.cellule[s.cellStart(7) + 2] = 2;
+    s.cellule[s.cellEnd(0) - 1] = 9;
+    EXPECT_EQ(s.rebinCells(nbCellules), 3);
+    verifierRegroupement(s, nbCellules);
+    EXPECT_EQ(s.cellEnd(4) - s.cellStart(4), 0);
+    EXPECT_EQ(s.cellEnd(5) - s.cellStart(5), 0);
+    EXPECT_EQ(s.cellEnd(6) - s.cellStart(6), 21);
+    EXPECT_EQ(s.cellEnd(2) - s.cellStart(2), 21);
+    EXPECT_EQ(s.cellEnd(0) - s.cellStart(0), 19);
+}
+
+// Test that insererQueue merges appended particles into their cells like a sort
+TEST(ParticuleStore, InsererQueue) {
+    ParticuleStore s;
+    ParticuleStore reference;
+    const int nbCellules = 10;
+    for (int i = 0; i < 100; i++) {
+        // Cell 5 is left empty
+        int c = i % nbCellules;
+        if (c == 5) c = 4;
+        s.addParticule(Particule3D(i, 1.0f, 0, Vector3D(), Vector3D(i, 0, 0), Vector3D()), c);
+    }
+    s.sortByCell(nbCellules);
+    for (int i = 0; i < s.getNbParticules(); i++) {
+        reference.addParticule(Particule3D(s.id[i], 1.0f, 0, Vector3D(), Vector3D(s.x[i], 0, 0), Vector3D()),
+                               s.cellule[i]);
+    }
+
+    // Appended out of order, into the first, the empty and the last cells
+    const int debutQueue = s.getNbParticules();
+    const int cellulesAjouts[] = {9, 0, 5, 9, 3, 0};
+    for (int k = 0; k < 6; k++) {
+        const Particule3D p(100 + k, 1.0f, 0, Vector3D(), Vector3D(100 + k, 0, 0), Vector3D());
+        s.addParticule(p, cellulesAjouts[k]);
+        reference.addParticule(p, cellulesAjouts[k]);
+    }
+    EXPECT_EQ(s.insererQueue(debutQueue, nbCellules), 6);
+    reference.sortByCell(nbCellules);
+    verifierRegroupement(s, nbCellules);
+    ASSERT_EQ(s.getNbParticules(), reference.getNbParticules());
+    for (int i = 0; i < s.getNbParticules(); i++) {
+        EXPECT_EQ(s.id[i], reference.id[i]);
+        EXPECT_EQ(s.x[i], s.id[i]);
+    }
+    for (int c = 0; c <= nbCellules; c++) {
+        EXPECT_EQ(s.cellStart(c), reference.cellStart(c));
+    }
+}
+
+// Test that rebinCells falls back to a full sort when most particles migrate
+TEST(ParticuleStore, RebinCellsBulkMigration) {
+    ParticuleStore s;
+    const int nbCellules = 8;
+    for (int i = 0; i < 64; i++) {
+        s.addParticule(Particule3D(i, 1.0f, 0, Vector3D(), Vector3D(i, 0, 0), Vector3D()), i % nbCellules);
+    }
+    s.sortByCell(nbCellules);
+    for (int i = 0; i < s.getNbParticules(); i++) {
+        s.cellule[i] = nbCellules - 1 - s.cellule[i];
+    }
+    EXPECT_EQ(s.rebinCells(nbCellules), 64);
+    verifierRegroupement(s, nbCellules);
+}
+
+TEST(ParticuleStore, PagesEnormes) {
+    // Large enough for the arrays to hold several 2 MB pages
+    const int n = 1 << 20;
+    ParticuleStore s;
+    s.setPagesEnormes(true);
+    EXPECT_TRUE(s.getPagesEnormes());
+    s.reserve(n);
+    for (int i = 0; i < n; i++) {
+        s.addParticule(Particule3D(i, 1.0f, 0, Vector3D(), Vector3D(i, 0, 0), Vector3D()), (n - 1 - i) % 7);
+    }
+    s.sortByCell(7);
+
+    // The advice changes nothing to the content
+    for (int c = 0; c < 7; c++) {
+        for (int i = s.cellStart(c); i < s.cellEnd(c); i++) {
+            EXPECT_EQ(s.cellule[i], c);
+            EXPECT_EQ(s.x[i], (double)s.id[i]);
+        }
+    }
+    s.setPagesEnormes(false);
+    EXPECT_FALSE(s.getPagesEnormes());
+}
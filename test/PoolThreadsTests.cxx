@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "PoolThreads.hxx"
+
+// Test that every task runs exactly once
+TEST(PoolThreads, EveryTaskRunsOnce) {
+    PoolThreads pool(4);
+    EXPECT_EQ(pool.getNbThreads(), 4);
+    std::vector<std::atomic<int>> compteurs(1000);
+    for (int repetition = 0; repetition < 10; repetition++) {
+        pool.paralleliser(1000, [&](int tache) { compteurs[tache]++; });
+    }
+    for (auto &c : compteurs) {
+        EXPECT_EQ(c.load(), 10);
+    }
+}
+
+// Test that the intervals cover the range without overlap
+TEST(PoolThreads, IntervalsCoverRange) {
+    PoolThreads pool(3);
+    std::vector<int> marques(10, 0);
+    pool.pourIntervalles(10, [&](int debut, int fin) {
+        for (int i = debut; i < fin; i++) {
+            marques[i]++;
+        }
+    });
+    for (int m : marques) {
+        EXPECT_EQ(m, 1);
+    }
+}
+
+// Test that every task runs exactly once with very uneven weights
+TEST(PoolThreads, WeightedTasksRunOnce) {
+    PoolThreads pool(4);
+    const int nbTaches = 500;
+    // One heavy task, as a cell holding most of the particles
+    std::vector<long> poidsCumules(nbTaches + 1, 0);
+    for (int t = 0; t < nbTaches; t++) {
+        poidsCumules[t + 1] = poidsCumules[t] + ((t == 17) ? 100000 : 1);
+    }
+    std::vector<std::atomic<int>> compteurs(nbTaches);
+    for (int repetition = 0; repetition < 10; repetition++) {
+        pool.paralleliserPondere(nbTaches, poidsCumules.data(), [&](int tache) { compteurs[tache]++; });
+    }
+    for (auto &c : compteurs) {
+        EXPECT_EQ(c.load(), 10);
+    }
+}
+
+// Test that the tasks queued behind a blocked task are stolen by the other threads
+TEST(PoolThreads, IdleThreadsSteal) {
+    PoolThreads pool(4);
+    const int nbTaches = 100;
+    std::atomic<int> terminees(0);
+    std::atomic<bool> aides(false);
+    pool.paralleliser(nbTaches, [&](int tache) {
+        if (tache == 0) {
+            // Blocks the first thread until the 99 other tasks are done, 25 of them being in its own range
+            auto limite = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            while (terminees < nbTaches - 1 && std::chrono::steady_clock::now() < limite) {
+                std::this_thread::yield();
+            }
+            aides = terminees == nbTaches - 1;
+        }
+        terminees++;
+    });
+    EXPECT_TRUE(aides);
+    EXPECT_EQ(terminees.load(), nbTaches);
+}
+
+// Test that a pool needs at least one thread
+TEST(PoolThreads, InvalidSize) {
+    EXPECT_THROW(PoolThreads pool(0), std::invalid_argument);
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include "PotentielTabule.hxx"
+#include "Reprise.hxx"
+
+typedef PotentielTabule::Terme Terme;
+
+// Relative error of the table on the force and energy of a term, over [rDebut, rFin)
+static void mesurerErreur(const PotentielTabule &table, const Terme &terme, double masse, double rDebut, double rFin,
+                          double &erreurForce, double &erreurEnergie) {
+    erreurForce = 0;
+    erreurEnergie = 0;
+    for (double r = rDebut; r < rFin; r += 0.0013) {
+        double coef, coefMasse;
+        table.coefficients(r * r, coef, coefMasse);
+        const double attendu = terme.coefficient(r * r) * (terme.parMasse ? masse : 1);
+        erreurForce = std::max(erreurForce, std::abs(coef + masse * coefMasse - attendu) / (1 + std::abs(attendu)));
+        const double energie = terme.energie(r * r) * (terme.parMasse ? masse : 1);
+        erreurEnergie = std::max(erreurEnergie, std::abs(table.getEnergie(r * r, masse) - energie) / (1 + std::abs(energie)));
+    }
+}
+
+// Test that the cubic table follows the Lennard-Jones potential closely, and the linear one roughly
+TEST(PotentielTabule, LennardJones) {
+    const Terme lj = Terme::lennardJones(1, 1);
+    double erreurForce, erreurEnergie;
+    PotentielTabule cubique({lj}, 0.5, 2.5, 4096, PotentielTabule::CUBIQUE);
+    mesurerErreur(cubique, lj, 1, 0.8, 2.5, erreurForce, erreurEnergie);
+    EXPECT_LT(erreurForce, 1e-8);
+    EXPECT_LT(erreurEnergie, 1e-8);
+
+    PotentielTabule lineaire({lj}, 0.5, 2.5, 4096, PotentielTabule::LINEAIRE);
+    mesurerErreur(lineaire, lj, 1, 0.8, 2.5, erreurForce, erreurEnergie);
+    EXPECT_LT(erreurForce, 1e-3);
+    EXPECT_LT(erreurEnergie, 1e-3);
+    EXPECT_EQ(lineaire.getNbPoints(), 4096);
+    EXPECT_EQ(lineaire.getInterpolation(), PotentielTabule::LINEAIRE);
+    EXPECT_DOUBLE_EQ(lineaire.getR2Max(), 6.25);
+
+    // Below rMin, the values at rMin
+    double coef, coefMasse, coefMin;
+    cubique.coefficients(0.01, coef, coefMasse);
+    cubique.coefficients(0.25, coefMin, coefMasse);
+    EXPECT_EQ(coef, coefMin);
+    EXPECT_EQ(coefMasse, 0);
+}
+
+// Test the mass-weighted term, the sum of terms and the shifted energy
+TEST(PotentielTabule, Termes) {
+    const Terme gravitation = Terme::gravitation();
+    double erreurForce, erreurEnergie;
+    PotentielTabule table({gravitation}, 0.5, 2.5);
+    mesurerErreur(table, gravitation, 3, 0.6, 2.5, erreurForce, erreurEnergie);
+    EXPECT_LT(erreurForce, 1e-8);
+    EXPECT_LT(erreurEnergie, 1e-8);
+
+    // A user term: harmonic spring U = (r - 1)^2
+    Terme ressort;
+    ressort.coefficient = [](double r2) { return 2 * (std::sqrt(r2) - 1) / std::sqrt(r2); };
+    ressort.energie = [](double r2) { return (std::sqrt(r2) - 1) * (std::sqrt(r2) - 1); };
+    PotentielTabule somme({Terme::lennardJones(1, 1), ressort, gravitation}, 0.5, 2.5);
+    for (double r : {0.9, 1.12, 1.7, 2.4}) {
+        double coef, coefMasse;
+        somme.coefficients(r * r, coef, coefMasse);
+        EXPECT_NEAR(coef, Terme::lennardJones(1, 1).coefficient(r * r) + ressort.coefficient(r * r), 1e-7);
+        EXPECT_NEAR(coefMasse, gravitation.coefficient(r * r), 1e-7);
+    }
+
+    PotentielTabule decale({Terme::lennardJonesDecale(1, 1, 2.5)}, 0.5, 2.5);
+    EXPECT_NEAR(decale.getEnergie(6.25, 1), 0, 1e-12);
+    EXPECT_NEAR(decale.getEnergie(1, 1), -Terme::lennardJones(1, 1).energie(6.25), 1e-9);
+}
+
+// Test the invalid parameters
+TEST(PotentielTabule, Invalide) {
+    const Terme lj = Terme::lennardJones(1, 1);
+    EXPECT_THROW(PotentielTabule({lj}, 0, 2.5), std::invalid_argument);
+    EXPECT_THROW(PotentielTabule({lj}, 3, 2.5), std::invalid_argument);
+    EXPECT_THROW(PotentielTabule({lj}, 0.5, 2.5, 1), std::invalid_argument);
+    EXPECT_THROW(PotentielTabule({lj}, 0.5, 2.5, 100, 2), std::invalid_argument);
+    EXPECT_THROW(PotentielTabule({Terme()}, 0.5, 2.5), std::invalid_argument);
+}
+
+// Test that a table read back from a restart file gives the same values
+TEST(PotentielTabule, Reprise) {
+    const std::string fichier = "potentiel.bin";
+    PotentielTabule table({Terme::lennardJones(1, 1), Terme::gravitation()}, 0.5, 2.5, 1000, PotentielTabule::CUBIQUE);
+    {
+        EcritureReprise ecriture(fichier);
+        table.ecrire(ecriture);
+        ecriture.terminer();
+    }
+    PotentielTabule relue;
+    LectureReprise lecture(fichier);
+    relue.lire(lecture);
+    lecture.terminer();
+    for (double r2 = 0.3; r2 < 6.25; r2 += 0.0371) {
+        double a, aMasse, b, bMasse;
+        table.coefficients(r2, a, aMasse);
+        relue.coefficients(r2, b, bMasse);
+        EXPECT_EQ(a, b);
+        EXPECT_EQ(aMasse, bMasse);
+        EXPECT_EQ(table.getEnergie(r2, 2), relue.getEnergie(r2, 2));
+    }
+    std::remove(fichier.c_str());
+}
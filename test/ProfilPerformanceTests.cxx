@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include "ProfilPerformance.hxx"
+#include "ParticuleStore.hxx"
+
+// Reads a whole file
+static std::string lireFichier(const std::string &filename) {
+    std::ifstream file(filename);
+    std::ostringstream oss;
+    oss << file.rdbuf();
+    return oss.str();
+}
+
+// Test that an inactive profile records nothing
+TEST(ProfilPerformance, Inactive) {
+    ProfilPerformance p;
+    {
+        ProfilPerformance::Chrono chrono(p, ProfilPerformance::FORCES);
+    }
+    EXPECT_EQ(p.getNbAppels(ProfilPerformance::FORCES), 0);
+    EXPECT_EQ(p.getTemps(ProfilPerformance::FORCES), 0.0);
+}
+
+// Test the scoped timer and the counters
+TEST(ProfilPerformance, ChronoAndCounters) {
+    ProfilPerformance p;
+    p.setActif(true);
+    for (int k = 0; k < 2; k++) {
+        ProfilPerformance::Chrono chrono(p, ProfilPerformance::SORTIE);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    EXPECT_EQ(p.getNbAppels(ProfilPerformance::SORTIE), 2);
+    EXPECT_GE(p.getTemps(ProfilPerformance::SORTIE), 0.004);
+    EXPECT_EQ(p.getNbAppels(ProfilPerformance::POSITIONS), 0);
+
+    p.ajouterPaires(10, 4);
+    p.ajouterPaires(5, 1);
+    EXPECT_EQ(p.getNbPairesTestees(), 15);
+    EXPECT_EQ(p.getNbPairesActives(), 5);
+
+    p.reinitialiser();
+    EXPECT_EQ(p.getNbAppels(ProfilPerformance::SORTIE), 0);
+    EXPECT_EQ(p.getNbPairesTestees(), 0);
+    EXPECT_STREQ(ProfilPerformance::getNomPhase(ProfilPerformance::FORCES), "forces");
+    EXPECT_THROW(ProfilPerformance::getNomPhase(ProfilPerformance::NB_PHASES), std::out_of_range);
+}
+
+// Test the occupancy statistics
+TEST(ProfilPerformance, Occupation) {
+    ParticuleStore s;
+    int cells[] = {0, 0, 0, 2};
+    for (int i = 0; i < 4; i++) {
+        s.addParticule(Particule3D(i, 1.0f, 0, Vector3D(), Vector3D(), Vector3D()), cells[i]);
+    }
+    s.sortByCell(4);
+    ProfilPerformance p;
+    p.mesurerOccupation(s, 4);
+    EXPECT_EQ(p.getNbCellulesVides(), 2);
+    EXPECT_EQ(p.getOccupationMax(), 3);
+    EXPECT_DOUBLE_EQ(p.getOccupationMoyenne(), 1.0);
+}
+
+// Test the JSON and CSV reports
+TEST(ProfilPerformance, Reports) {
+    ProfilPerformance p;
+    p.setActif(true);
+    p.ajouterTemps(ProfilPerformance::FORCES, 0.5);
+    p.ajouterPaires(100, 40);
+
+    p.ecrireJSON("profil_test.json", 10, 0.1);
+    std::string json = lireFichier("profil_test.json");
+    std::remove("profil_test.json");
+    EXPECT_NE(json.find("\"iteration\": 10"), std::string::npos);
+    EXPECT_NE(json.find("\"forces\": {\"temps\": 0.5, \"appels\": 1, \"fraction\": 1}"), std::string::npos);
+    EXPECT_NE(json.find("\"testees\": 100"), std::string::npos);
+
+    p.ecrireCSV("profil_test.csv", 10, 0.1, true);
+    p.ecrireCSV("profil_test.csv", 20, 0.2, false);
+    std::string csv = lireFichier("profil_test.csv");
+    std::remove("profil_test.csv");
+    EXPECT_EQ(csv.find("iteration;temps_simule;positions"), 0u);
+    EXPECT_NE(csv.find("\n10;0.1;"), std::string::npos);
+    EXPECT_NE(csv.find("\n20;0.2;"), std::string::npos);
+}
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+#include "Reprise.hxx"
+
+// Test that values and arrays are read back as written
+TEST(Reprise, AllerRetour) {
+    const std::string fichier = "reprise_aller_retour.bin";
+    const std::vector<double> reels = {1.5, -2.25, 1e-300};
+    const std::vector<int> entiers = {3, -1, 7, 0};
+    {
+        EcritureReprise ecriture(fichier);
+        ecriture.ecrire<int32_t>(42);
+        ecriture.ecrire(0.125f);
+        ecriture.ecrireTableau(reels);
+        ecriture.ecrireTableau(entiers);
+        ecriture.ecrireTableau(std::vector<float>());
+        ecriture.terminer();
+    }
+    LectureReprise lecture(fichier);
+    EXPECT_EQ(lecture.getVersion(), 7u);
+    EXPECT_EQ(lecture.lire<int32_t>(), 42);
+    EXPECT_EQ(lecture.lire<float>(), 0.125f);
+    std::vector<double> reelsLus;
+    lecture.lireTableau(reelsLus);
+    EXPECT_EQ(reelsLus, reels);
+    std::vector<int> entiersLus(10, 1);
+    lecture.lireTableau(entiersLus);
+    EXPECT_EQ(entiersLus, entiers);
+    std::vector<float> vide(3);
+    lecture.lireTableau(vide);
+    EXPECT_TRUE(vide.empty());
+    EXPECT_NO_THROW(lecture.terminer());
+    std::remove(fichier.c_str());
+}
+
+// Test the conversion of floating-point arrays saved with another precision
+TEST(Reprise, ConversionPrecision) {
+    const std::string fichier = "reprise_conversion.bin";
+    {
+        EcritureReprise ecriture(fichier);
+        ecriture.ecrireTableau(std::vector<double>{0.5, 3.0});
+        ecriture.ecrireTableau(std::vector<float>{0.25f});
+        ecriture.ecrireTableau(std::vector<int64_t>{1});
+        ecriture.terminer();
+    }
+    LectureReprise lecture(fichier);
+    std::vector<float> simple;
+    lecture.lireTableau(simple);
+    EXPECT_EQ(simple, std::vector<float>({0.5f, 3.0f}));
+    std::vector<double> double_;
+    lecture.lireTableau(double_);
+    EXPECT_EQ(double_, std::vector<double>({0.25}));
+    std::vector<int> entiers;
+    EXPECT_THROW(lecture.lireTableau(entiers), std::runtime_error);
+    std::remove(fichier.c_str());
+}
+
+// Test the detection of foreign, truncated and missing files
+TEST(Reprise, FichiersInvalides) {
+    const std::string fichier = "reprise_invalide.bin";
+    {
+        std::ofstream sortie(fichier, std::ios::binary);
+        sortie << "<?xml version=\"1.0\"?>";
+    }
+    EXPECT_THROW(LectureReprise lecture(fichier), std::runtime_error);
+
+    {
+        EcritureReprise ecriture(fichier);
+        ecriture.ecrireTableau(std::vector<double>(100, 1.0));
+        // Not terminated: the previous file is untouched
+    }
+    EXPECT_THROW(LectureReprise lecture(fichier), std::runtime_error);
+    std::remove((fichier + ".tmp").c_str());
+
+    {
+        EcritureReprise ecriture(fichier);
+        ecriture.ecrire<int32_t>(1);
+        ecriture.terminer();
+    }
+    LectureReprise lecture(fichier);
+    EXPECT_THROW(lecture.terminer(), std::runtime_error);
+    std::remove(fichier.c_str());
+    EXPECT_THROW(LectureReprise absent(fichier), std::runtime_error);
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include "Statistiques.hxx"
+
+// A measure whose fields all differ
+static Statistiques creerMesure(int iteration) {
+    Statistiques s;
+    s.iteration = iteration;
+    s.nbParticules = 1000 + iteration;
+    s.temps = 0.01 * iteration;
+    s.energieCinetique = 1.5 + iteration;
+    s.energiePotentielle = -3.25 - iteration;
+    s.quantiteMouvement[0] = 1e-12;
+    s.quantiteMouvement[1] = -2;
+    s.quantiteMouvement[2] = 1.0 / 3;
+    s.temperature = 0.75;
+    s.pression = 0.125;
+    s.viriel = -42;
+    return s;
+}
+
+// Test that the binary series reads back every field exactly
+TEST(Statistiques, SerieBinaire) {
+    const std::string fichier = "serie_statistiques.bin";
+    {
+        SerieStatistiques serie(fichier);
+        EXPECT_FALSE(serie.estCSV());
+        for (int k = 0; k < 3; k++) {
+            serie.ajouter(creerMesure(10 * k));
+        }
+        EXPECT_EQ(serie.getNbMesures(), 3);
+    }
+    const std::vector<Statistiques> lues = SerieStatistiques::lire(fichier);
+    ASSERT_EQ(lues.size(), 3u);
+    for (int k = 0; k < 3; k++) {
+        const Statistiques attendue = creerMesure(10 * k);
+        EXPECT_EQ(lues[k].iteration, attendue.iteration);
+        EXPECT_EQ(lues[k].nbParticules, attendue.nbParticules);
+        EXPECT_EQ(lues[k].temps, attendue.temps);
+        EXPECT_EQ(lues[k].energieCinetique, attendue.energieCinetique);
+        EXPECT_EQ(lues[k].energiePotentielle, attendue.energiePotentielle);
+        EXPECT_EQ(lues[k].quantiteMouvement[2], attendue.quantiteMouvement[2]);
+        EXPECT_EQ(lues[k].temperature, attendue.temperature);
+        EXPECT_EQ(lues[k].pression, attendue.pression);
+        EXPECT_EQ(lues[k].viriel, attendue.viriel);
+        EXPECT_EQ(lues[k].getEnergieTotale(), attendue.getEnergieTotale());
+    }
+    std::remove(fichier.c_str());
+}
+
+// Test the CSV series: a header line, then one line per measure with the total energy last
+TEST(Statistiques, SerieCSV) {
+    const std::string fichier = "serie_statistiques.csv";
+    {
+        SerieStatistiques serie(fichier);
+        EXPECT_TRUE(serie.estCSV());
+        serie.ajouter(creerMesure(0));
+        serie.ajouter(creerMesure(5));
+    }
+    std::ifstream flux(fichier);
+    std::string ligne;
+    ASSERT_TRUE(std::getline(flux, ligne));
+    EXPECT_EQ(ligne.substr(0, 24), "iteration;nb_particules;");
+    ASSERT_TRUE(std::getline(flux, ligne));
+    ASSERT_TRUE(std::getline(flux, ligne));
+    EXPECT_EQ(ligne.substr(0, 7), "5;1005;");
+    EXPECT_EQ(ligne.substr(ligne.rfind(';') + 1), "-1.75");
+    EXPECT_FALSE(std::getline(flux, ligne));
+    std::remove(fichier.c_str());
+}
+
+// Test that a file of another kind is rejected
+TEST(Statistiques, FichierInvalide) {
+    const std::string fichier = "serie_invalide.bin";
+    {
+        std::ofstream flux(fichier, std::ios::binary);
+        flux << "pas une serie";
+    }
+    EXPECT_THROW(SerieStatistiques::lire(fichier), std::runtime_error);
+    EXPECT_THROW(SerieStatistiques::lire("absent.bin"), std::runtime_error);
+    std::remove(fichier.c_str());
+}
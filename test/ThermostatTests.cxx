@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include "Thermostat.hxx"
+#include "Reprise.hxx"
+
+// Test the factors of each kind of thermostat
+TEST(Thermostat, Facteurs) {
+    Thermostat aucun;
+    EXPECT_FALSE(aucun.estActif());
+    aucun.preparer(3, 0.01);
+    EXPECT_EQ(aucun.getEchelle(), 1.0);
+    EXPECT_EQ(aucun.getBruit(), 0.0);
+
+    // Berendsen: T (1 + dt / tau (T0 / T - 1)) after the rescaling
+    Thermostat berendsen(Thermostat::BERENDSEN, 2, 0.1);
+    EXPECT_TRUE(berendsen.litTemperature());
+    berendsen.preparer(4, 0.01);
+    EXPECT_NEAR(4 * berendsen.getEchelle() * berendsen.getEchelle(), 4 + 0.1 * (2 - 4), 1e-12);
+    berendsen.preparer(0, 0.01);
+    EXPECT_EQ(berendsen.getEchelle(), 1.0);
+
+    // Langevin: the friction and the kicks keep T0 in equilibrium
+    Thermostat langevin(Thermostat::LANGEVIN, 1.5, 0.5, 7);
+    EXPECT_FALSE(langevin.litTemperature());
+    langevin.preparer(0, 0.01);
+    const double c = langevin.getEchelle();
+    EXPECT_NEAR(c, std::exp(-0.02), 1e-15);
+    EXPECT_NEAR(c * c * 1.5 + langevin.getBruit() * langevin.getBruit(), 1.5, 1e-12);
+
+    // Nosé–Hoover: the friction grows while T > T0 and slows the particles
+    Thermostat nose(Thermostat::NOSE_HOOVER, 1, 0.2);
+    nose.preparer(2, 0.01);
+    EXPECT_NEAR(nose.getFriction(), 0.01 / 0.04, 1e-12);
+    EXPECT_LT(nose.getEchelle(), 1);
+    nose.preparer(0.5, 0.01);
+    EXPECT_NEAR(nose.getFriction(), 0.25 - 0.125, 1e-12);
+}
+
+// Test the random numbers of Langevin: reproducible, independent, standard normal
+TEST(Thermostat, Gaussiennes) {
+    double a, b, c, d;
+    Thermostat::gaussiennes(1, 2, 3, 0, a, b);
+    Thermostat::gaussiennes(1, 2, 3, 0, c, d);
+    EXPECT_EQ(a, c);
+    EXPECT_EQ(b, d);
+    Thermostat::gaussiennes(1, 2, 3, 1, c, d);
+    EXPECT_NE(a, c);
+    Thermostat::gaussiennes(1, 3, 3, 0, c, d);
+    EXPECT_NE(a, c);
+    Thermostat::gaussiennes(2, 2, 3, 0, c, d);
+    EXPECT_NE(a, c);
+    const int n = 200000;
+    double somme = 0, carres = 0, produits = 0, croises = 0;
+    for (int k = 0; k < n; k++) {
+        Thermostat::gaussiennes(5, k / 1000, k % 1000, 0, a, b);
+        Thermostat::gaussiennes(5, k / 1000, k % 1000, 1, c, d);
+        somme += a + b;
+        carres += a * a + b * b;
+        produits += a * b;
+        croises += a * c;
+    }
+    EXPECT_NEAR(somme / (2 * n), 0, 0.01);
+    EXPECT_NEAR(carres / (2 * n), 1, 0.01);
+    EXPECT_NEAR(produits / n, 0, 0.01);
+    EXPECT_NEAR(croises / n, 0, 0.01);
+}
+
+// Test the invalid parameters
+TEST(Thermostat, Invalide) {
+    EXPECT_THROW(Thermostat(4, 1, 1), std::invalid_argument);
+    EXPECT_THROW(Thermostat(Thermostat::BERENDSEN, -1, 1), std::invalid_argument);
+    EXPECT_THROW(Thermostat(Thermostat::LANGEVIN, 1, 0), std::invalid_argument);
+    EXPECT_THROW(Thermostat(Thermostat::NOSE_HOOVER, 0, 1), std::invalid_argument);
+    EXPECT_NO_THROW(Thermostat(Thermostat::LANGEVIN, 0, 1));
+}
+
+// Test that the friction of Nosé–Hoover is read back from a restart file
+TEST(Thermostat, Reprise) {
+    const std::string fichier = "reprise_thermostat.bin";
+    Thermostat nose(Thermostat::NOSE_HOOVER, 1.2, 0.3, 9);
+    nose.preparer(2, 0.01);
+    {
+        EcritureReprise ecriture(fichier);
+        nose.ecrire(ecriture);
+        ecriture.terminer();
+    }
+    Thermostat lu;
+    LectureReprise lecture(fichier);
+    lu.lire(lecture);
+    lecture.terminer();
+    EXPECT_EQ(lu.getType(), Thermostat::NOSE_HOOVER);
+    EXPECT_EQ(lu.getTemperatureCible(), 1.2);
+    EXPECT_EQ(lu.getTempsCouplage(), 0.3);
+    EXPECT_EQ(lu.getGraine(), 9u);
+    EXPECT_EQ(lu.getFriction(), nose.getFriction());
+    std::remove(fichier.c_str());
+}
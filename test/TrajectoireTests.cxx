@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "Trajectoire.hxx"
+#include "Particule3D.hxx"
+#include "Vector3D.hxx"
+
+namespace {
+
+// Store of n particles whose coordinates depend on a step index
+ParticuleStore creerStore(int n, int pas) {
+    ParticuleStore s;
+    for (int i = 0; i < n; i++) {
+        s.addParticule(Particule3D(100 + i, 1.0f, i % 2, Vector3D(), Vector3D(i + 0.5 * pas, 2 * i, 3), Vector3D(pas, -i, 0.25)), 0);
+    }
+    return s;
+}
+
+}
+
+// Test that every frame can be read back, in any order
+TEST(Trajectoire, EcritureLecture) {
+    const std::string fichier = "trajectoire_test.traj";
+    {
+        EcritureTrajectoire ecriture(fichier, 3);
+        for (int pas = 0; pas < 5; pas++) {
+            ecriture.ecrire(creerStore(10 - pas, pas), 10 * pas, 0.1 * pas);
+        }
+        EXPECT_EQ(ecriture.getNbFrames(), 5);
+    }
+    LectureTrajectoire lecture(fichier);
+    EXPECT_EQ(lecture.getDimension(), 3);
+    ASSERT_EQ(lecture.getNbFrames(), 5);
+    FrameTrajectoire frame;
+    for (int k : {3, 0, 4, 1}) {
+        lecture.lireFrame(k, frame);
+        EXPECT_EQ(frame.iteration, 10 * k);
+        EXPECT_DOUBLE_EQ(frame.temps, 0.1 * k);
+        ASSERT_EQ(frame.getNbParticules(), 10 - k);
+        for (int i = 0; i < frame.getNbParticules(); i++) {
+            EXPECT_EQ(frame.positions[3 * i], static_cast<float>(i + 0.5 * k));
+            EXPECT_EQ(frame.positions[3 * i + 1], 2.0f * i);
+            EXPECT_EQ(frame.vitesses[3 * i + 2], 0.25f);
+            EXPECT_EQ(frame.categories[i], i % 2);
+            EXPECT_EQ(frame.ids[i], 100 + i);
+        }
+    }
+    EXPECT_EQ(lecture.getEntree(2).iteration, 20);
+    EXPECT_THROW(lecture.lireFrame(5, frame), std::out_of_range);
+    std::remove(fichier.c_str());
+}
+
+// Test that a frame cut short is ignored, then dropped when the file is resumed
+TEST(Trajectoire, Reprise) {
+    const std::string fichier = "trajectoire_reprise.traj";
+    {
+        EcritureTrajectoire ecriture(fichier, 2);
+        for (int pas = 0; pas < 4; pas++) {
+            ecriture.ecrire(creerStore(6, pas), pas, pas);
+        }
+    }
+    const auto taille = std::filesystem::file_size(fichier);
+    std::filesystem::resize_file(fichier, taille - 10);
+    EXPECT_EQ(LectureTrajectoire(fichier).getNbFrames(), 3);
+
+    // Keep the frames up to step 1, then append steps 2 to 4
+    {
+        EXPECT_THROW(EcritureTrajectoire(fichier, 3, 1), std::runtime_error);
+        EcritureTrajectoire ecriture(fichier, 2, 1);
+        EXPECT_EQ(ecriture.getNbFrames(), 2);
+        for (int pas = 2; pas < 5; pas++) {
+            ecriture.ecrire(creerStore(6, pas), pas, pas);
+        }
+    }
+    LectureTrajectoire lecture(fichier);
+    ASSERT_EQ(lecture.getNbFrames(), 5);
+    FrameTrajectoire frame;
+    for (int k = 0; k < 5; k++) {
+        lecture.lireFrame(k, frame);
+        EXPECT_EQ(frame.iteration, k);
+        EXPECT_EQ(frame.positions[3], 1.0f + 0.5f * k);
+    }
+    EXPECT_EQ(lecture.getFinDonnees(), std::filesystem::file_size(fichier));
+    std::remove(fichier.c_str());
+
+    EXPECT_THROW(LectureTrajectoire absent(fichier), std::runtime_error);
+}
+
+// Test the conversion to .vtu files and a .pvd collection
+TEST(Trajectoire, ExporterVTK) {
+    const std::string fichier = "trajectoire_export.traj";
+    {
+        EcritureTrajectoire ecriture(fichier, 2);
+        ecriture.ecrire(creerStore(4, 0), 0, 0);
+        ecriture.ecrire(creerStore(4, 1), 5, 0.5);
+    }
+    LectureTrajectoire(fichier).exporterVTK("export", 0);
+    std::ifstream pvd("export.pvd");
+    std::stringstream contenu;
+    contenu << pvd.rdbuf();
+    EXPECT_NE(contenu.str().find("type=\"Collection\""), std::string::npos);
+    EXPECT_NE(contenu.str().find("timestep=\"0.5\" group=\"\" part=\"0\" file=\"export_t5.vtu\""), std::string::npos);
+    EXPECT_TRUE(std::ifstream("export_t0.vtu").good());
+    EXPECT_TRUE(std::ifstream("export_t5.vtu").good());
+    for (const char *nom : {"export.pvd", "export_t0.vtu", "export_t5.vtu", "trajectoire_export.traj"}) {
+        std::remove(nom);
+    }
+}
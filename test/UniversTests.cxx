@@ -1,9 +1,18 @@
 #include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <map>
 #include "Univers.hxx"
 #include "Cellule.hxx"
 #include "Particule3D.hxx"
 #include "Vector3D.hxx"
 
+// Relative tolerance on forces summed in a different order. The forces stored as
+// floats (UNIVERS_PRECISION=simple) are rounded at each reaction of the half shell,
+// and the capped pair forces reach 1e5
+static const double TOLERANCE_FORCE = (sizeof(ReelForce) == sizeof(float)) ? 1e-2 : 1e-9;
+
 // Test the constructor
 TEST(Univers, Constructor) {
     Univers u(2, 10, 10, 0, 2.5, 0.01, 1.0);
@@ -119,3 +128,1026 @@ TEST(Univers, PeriodicBoundaryConditions) {
     EXPECT_NEAR(cellules[8].getParticules()[0].getPos().getX(), 0.1, tolerance); // Wrapped from right to left
     EXPECT_NEAR(cellules[8].getParticules()[0].getPos().getY(), 0.1, tolerance); // Wrapped from bottom to top
 }
+
+// Test that the forces computed on the particle store are equal and opposite for a pair
+TEST(Univers, CalculForcesPair) {
+    Univers u(2, 10, 10, 0, 1, 1, 2.5, 0.01, 1.0);
+    std::vector<Cellule> cellules = u.getCellules();
+    cellules.resize(16);
+    for (int c = 0; c < 16; c++) {
+        cellules[c] = Cellule(c % 4, c / 4, Vector3D());
+    }
+    cellules[0].addParticule(Particule3D(0, 1.0, 0, Vector3D(), Vector3D(1.0, 1.0, 0.0), Vector3D()));
+    cellules[1].addParticule(Particule3D(1, 1.0, 0, Vector3D(), Vector3D(2.2, 1.0, 0.0), Vector3D()));
+    u.setCellules(cellules);
+
+    u.calculForces();
+
+    cellules = u.getCellules();
+    Vector3D f0 = cellules[0].getParticules()[0].getForce();
+    Vector3D f1 = cellules[1].getParticules()[0].getForce();
+    EXPECT_NEAR(f0.getX(), -f1.getX(), 1e-12);
+    EXPECT_NEAR(f0.getY(), 0.0, 1e-12);
+    EXPECT_GT(f0.getX(), 0.0); // Attractive at r = 1.2 > 2^(1/6)
+}
+
+// Test that the half-shell engine gives the same forces as the full-shell engine in 2D
+TEST(Univers, HalfShellMatchesFullShell2D) {
+    srand(42);
+    Univers u(2, 60, 60, 0, 1, 1, 2.5, 0.01, 1.0);
+    u.initialiserDemoCercle(10, 10, 5, Vector3D(0, 0, 0), Vector3D(0, 0, 0));
+
+    u.setForceEngine(0);
+    u.calculForces();
+    ParticuleStore complet = u.getStore();
+
+    u.setForceEngine(1);
+    u.calculForces();
+    ParticuleStore &demi = u.getStore();
+
+    ASSERT_EQ(complet.getNbParticules(), demi.getNbParticules());
+    for (int i = 0; i < demi.getNbParticules(); i++) {
+        EXPECT_NEAR(complet.fx[i], demi.fx[i], TOLERANCE_FORCE * (1 + std::abs(complet.fx[i])));
+        EXPECT_NEAR(complet.fy[i], demi.fy[i], TOLERANCE_FORCE * (1 + std::abs(complet.fy[i])));
+    }
+}
+
+// Test that the half-shell engine gives the same forces as the full-shell engine in 3D
+TEST(Univers, HalfShellMatchesFullShell3D) {
+    Univers u(3, 20, 20, 20, 1, 1, 2.5, 0.01, 1.0);
+    u.initialiser(6, 6, 6, 10, Vector3D(0, 0, 0), Vector3D(0, 0, 0));
+    ParticuleStore &s = u.getStore();
+    for (int i = 0; i < s.getNbParticules(); i++) {
+        s.z[i] = 1.0 + (i % 7) * 0.9;
+    }
+    u.reassignCells3D();
+
+    u.setForceEngine(0);
+    u.calculForces3D();
+    ParticuleStore complet = u.getStore();
+
+    u.setForceEngine(1);
+    u.calculForces3D();
+    ParticuleStore &demi = u.getStore();
+
+    ASSERT_EQ(complet.getNbParticules(), demi.getNbParticules());
+    for (int i = 0; i < demi.getNbParticules(); i++) {
+        EXPECT_NEAR(complet.fx[i], demi.fx[i], TOLERANCE_FORCE * (1 + std::abs(complet.fx[i])));
+        EXPECT_NEAR(complet.fy[i], demi.fy[i], TOLERANCE_FORCE * (1 + std::abs(complet.fy[i])));
+        EXPECT_NEAR(complet.fz[i], demi.fz[i], TOLERANCE_FORCE * (1 + std::abs(complet.fz[i])));
+    }
+}
+
+// Test the force engine selection
+TEST(Univers, ForceEngineSelection) {
+    Univers u(2, 10, 10, 0, 2.5, 0.01, 1.0);
+    EXPECT_EQ(u.getForceEngine(), 1);
+    u.setForceEngine(0);
+    EXPECT_EQ(u.getForceEngine(), 0);
+    EXPECT_THROW(u.setForceEngine(2), std::invalid_argument);
+}
+
+// Test that the forces on the Verlet lists match the forces on the cells
+TEST(Univers, VerletListsMatchCells) {
+    srand(7);
+    Univers u(2, 60, 60, 0, 1, 1, 2.5, 0.01, 1.0);
+    u.initialiserDemoCercle(10, 10, 5, Vector3D(0, 0, 0), Vector3D(0, 0, 0));
+    u.reassignCells();
+    u.calculForces();
+    ParticuleStore reference = u.getStore();
+
+    u.setVerletSkin(0.5);
+    u.mettreAJourVoisinage(false);
+    EXPECT_EQ(u.getNbReconstructionsVerlet(), 1);
+    u.calculForces();
+    ParticuleStore &s = u.getStore();
+    for (int i = 0; i < s.getNbParticules(); i++) {
+        EXPECT_NEAR(reference.fx[i], s.fx[i], TOLERANCE_FORCE * (1 + std::abs(s.fx[i])));
+        EXPECT_NEAR(reference.fy[i], s.fy[i], TOLERANCE_FORCE * (1 + std::abs(s.fy[i])));
+    }
+
+    // A small move keeps the lists, a move beyond skin / 2 rebuilds them
+    s.x[0] += 0.1;
+    u.mettreAJourVoisinage(false);
+    EXPECT_EQ(u.getNbReconstructionsVerlet(), 1);
+    s.x[0] += 0.2;
+    u.mettreAJourVoisinage(false);
+    EXPECT_EQ(u.getNbReconstructionsVerlet(), 2);
+    EXPECT_EQ(u.getNbPasVerlet(), 3);
+}
+
+// Test that a table of the Lennard-Jones and gravity-like terms gives the forces of the
+// analytic kernel, with each engine, and that a user potential replaces them
+TEST(Univers, PotentielTabule) {
+    typedef PotentielTabule::Terme Terme;
+    auto table = std::make_shared<PotentielTabule>(std::vector<Terme>{Terme::lennardJones(1, 1), Terme::gravitation()}, 0.5, 2.5);
+    for (int dimension = 2; dimension <= 3; dimension++) {
+        for (int engine = 0; engine <= 2; engine++) {
+            srand(11);
+            Univers u = (dimension == 3) ? Univers(3, 20, 20, 20, 1, 1, 2.5, 0.01, 1.0) : Univers(2, 40, 40, 0, 1, 1, 2.5, 0.01, 1.0);
+            if (dimension == 3) {
+                u.initialiserUniforme(800, 1);
+            } else {
+                u.initialiser(10, 10, 10, 20, Vector3D(0, 0, 0), Vector3D(0, 0, 0));
+            }
+            u.setForceEngine(engine == 0 ? 0 : 1);
+            if (engine == 2) {
+                u.setVerletSkin(0.3);
+                u.mettreAJourVoisinage(dimension == 3);
+            }
+            dimension == 3 ? u.calculForces3D() : u.calculForces();
+            ParticuleStore reference = u.getStore();
+
+            u.setPotentielTabule(table);
+            EXPECT_EQ(u.getPotentielTabule(), table.get());
+            dimension == 3 ? u.calculForces3D() : u.calculForces();
+            const ParticuleStore &s = u.getStore();
+            for (int i = 0; i < s.getNbParticules(); i++) {
+                EXPECT_NEAR(reference.fx[i], s.fx[i], 1e-6 * (1 + std::abs(reference.fx[i])));
+                EXPECT_NEAR(reference.fy[i], s.fy[i], 1e-6 * (1 + std::abs(reference.fy[i])));
+                EXPECT_NEAR(reference.fz[i], s.fz[i], 1e-6 * (1 + std::abs(reference.fz[i])));
+            }
+        }
+    }
+
+    // A pair at distance 1 under a spring of stiffness 3 and rest length 2: pushed apart
+    Terme ressort;
+    ressort.coefficient = [](double r2) { return 6 * (std::sqrt(r2) - 2) / std::sqrt(r2); };
+    ressort.energie = [](double r2) { return 3 * (std::sqrt(r2) - 2) * (std::sqrt(r2) - 2); };
+    Univers u(2, 10, 10, 0, 1, 1, 2.5, 0.01, 1.0);
+    std::vector<Cellule> cellules(16);
+    for (int c = 0; c < 16; c++) {
+        cellules[c] = Cellule(c % 4, c / 4, Vector3D());
+    }
+    cellules[0].addParticule(Particule3D(0, 1.0, 0, Vector3D(), Vector3D(1.0, 1.0, 0.0), Vector3D()));
+    cellules[0].addParticule(Particule3D(1, 1.0, 0, Vector3D(), Vector3D(2.0, 1.0, 0.0), Vector3D()));
+    u.setCellules(cellules);
+    u.setPotentielTabule(std::make_shared<PotentielTabule>(std::vector<Terme>{ressort}, 0.1, 2.5));
+    u.calculForces();
+    const ParticuleStore &s = u.getStore();
+    EXPECT_NEAR(s.fx[0], -6, 1e-9);
+    EXPECT_NEAR(s.fx[1], 6, 1e-9);
+
+    EXPECT_THROW(u.setPotentielTabule(std::make_shared<PotentielTabule>(std::vector<Terme>{ressort}, 0.1, 2)), std::invalid_argument);
+    u.setPotentielTabule(nullptr);
+    EXPECT_EQ(u.getPotentielTabule(), nullptr);
+
+    // The table is saved in the restart files: the run goes on identically
+    const std::string fichier = "reprise_potentiel.bin";
+    srand(5);
+    Univers a(2, 40, 40, 0, 1, 1, 2.5, 0.0005, 1, 1, 0, 0);
+    a.setFrequenceSortie(0);
+    a.initialiser(10, 10, 10, 20, Vector3D(0, 0, 0), Vector3D(0, 10, 0));
+    a.setPotentielTabule(std::make_shared<PotentielTabule>(std::vector<Terme>{Terme::lennardJonesDecale(1, 1, 2.5)}, 0.5, 2.5, 500,
+                                                           PotentielTabule::LINEAIRE));
+    a.avancer(10);
+    a.saveCheckpoint(fichier);
+    a.avancer(20);
+    Univers b;
+    b.loadCheckpoint(fichier);
+    ASSERT_NE(b.getPotentielTabule(), nullptr);
+    EXPECT_EQ(b.getPotentielTabule()->getInterpolation(), PotentielTabule::LINEAIRE);
+    b.avancer(20);
+    EXPECT_EQ(a.getStore().x, b.getStore().x);
+    EXPECT_EQ(a.getStore().fy, b.getStore().fy);
+    std::remove(fichier.c_str());
+}
+
+// Test the force fields: the Lennard-Jones field with gravitation matches the analytic kernel
+// in every engine, the species mix, and the field is saved in the restart files
+TEST(Univers, ChampForces) {
+    auto lj = std::make_shared<ChampForces>(ChampForces::LENNARD_JONES, 2, 1, 1);
+    for (int dimension = 2; dimension <= 3; dimension++) {
+        for (int engine = 0; engine <= 2; engine++) {
+            srand(11);
+            Univers u = (dimension == 3) ? Univers(3, 20, 20, 20, 1, 1, 2.5, 0.01, 1.0) : Univers(2, 40, 40, 0, 1, 1, 2.5, 0.01, 1.0);
+            if (dimension == 3) {
+                u.initialiserUniforme(800, 1);
+            } else {
+                u.initialiserDemoCercle(20, 20, 6, Vector3D(0, 0, 0), Vector3D(0, 0, 0));
+            }
+            u.setForceEngine(engine == 0 ? 0 : 1);
+            if (engine == 2) {
+                u.setVerletSkin(0.3);
+                u.mettreAJourVoisinage(dimension == 3);
+            }
+            dimension == 3 ? u.calculForces3D() : u.calculForces();
+            ParticuleStore reference = u.getStore();
+
+            u.setChampForces(lj);
+            EXPECT_EQ(u.getChampForces(), lj.get());
+            dimension == 3 ? u.calculForces3D() : u.calculForces();
+            const ParticuleStore &s = u.getStore();
+            for (int i = 0; i < s.getNbParticules(); i++) {
+                EXPECT_NEAR(reference.fx[i], s.fx[i], 1e-9 * (1 + std::abs(reference.fx[i])));
+                EXPECT_NEAR(reference.fy[i], s.fy[i], 1e-9 * (1 + std::abs(reference.fy[i])));
+                EXPECT_NEAR(reference.fz[i], s.fz[i], 1e-9 * (1 + std::abs(reference.fz[i])));
+            }
+        }
+    }
+
+    // Two soft spheres at distance 1, of species mixed to eps = sqrt(1 * 4) = 2: coefficient -24
+    auto molle = std::make_shared<ChampForces>(ChampForces::SPHERE_MOLLE, 2, 1, 1);
+    molle->setCategorie(1, 4, 1);
+    molle->setGravitation(false);
+    for (int engine = 0; engine <= 2; engine++) {
+        Univers u(2, 10, 10, 0, 1, 1, 2.5, 0.01, 1.0);
+        std::vector<Cellule> cellules(16);
+        for (int c = 0; c < 16; c++) {
+            cellules[c] = Cellule(c % 4, c / 4, Vector3D());
+        }
+        cellules[0].addParticule(Particule3D(0, 1.0, 0, Vector3D(), Vector3D(1.0, 1.0, 0.0), Vector3D()));
+        cellules[0].addParticule(Particule3D(1, 1.0, 1, Vector3D(), Vector3D(2.0, 1.0, 0.0), Vector3D()));
+        u.setCellules(cellules);
+        u.setForceEngine(engine == 0 ? 0 : 1);
+        if (engine == 2) {
+            u.setVerletSkin(0.3);
+            u.mettreAJourVoisinage(false);
+        }
+        u.setChampForces(molle);
+        u.calculForces();
+        const ParticuleStore &s = u.getStore();
+        const int premiere = (s.id[0] == 0) ? 0 : 1;
+        EXPECT_NEAR(s.fx[premiere], -24, 1e-9);
+        EXPECT_NEAR(s.fx[1 - premiere], 24, 1e-9);
+    }
+
+    // A category outside the field is rejected, and the field and the table exclude each other
+    Univers seul(2, 10, 10, 0, 1, 1, 2.5, 0.01, 1.0);
+    std::vector<Cellule> cellules(16);
+    for (int c = 0; c < 16; c++) {
+        cellules[c] = Cellule(c % 4, c / 4, Vector3D());
+    }
+    cellules[0].addParticule(Particule3D(0, 1.0, 2, Vector3D(), Vector3D(1.0, 1.0, 0.0), Vector3D()));
+    seul.setCellules(cellules);
+    seul.setChampForces(molle);
+    EXPECT_THROW(seul.calculForces(), std::invalid_argument);
+    // The check is cached, and a category changed through the store is checked again
+    seul.getStore().categorie[0] = 1;
+    seul.calculForces();
+    seul.calculForces();
+    seul.getStore().categorie[0] = -1;
+    EXPECT_THROW(seul.calculForces(), std::invalid_argument);
+    seul.setPotentielTabule(std::make_shared<PotentielTabule>(std::vector<PotentielTabule::Terme>{PotentielTabule::Terme::gravitation()},
+                                                              0.5, 2.5, 100));
+    EXPECT_EQ(seul.getChampForces(), nullptr);
+    seul.setChampForces(molle);
+    EXPECT_EQ(seul.getPotentielTabule(), nullptr);
+    seul.setChampForces(nullptr);
+    EXPECT_EQ(seul.getChampForces(), nullptr);
+
+    // Two species under Morse, saved in a restart file: the run goes on identically
+    const std::string fichier = "univers_reprise_champ.bin";
+    auto morse = std::make_shared<ChampForces>(ChampForces::MORSE, 2, 1, 2, 1.1);
+    morse->setCategorie(1, 0.5, 2, 1.3);
+    srand(5);
+    Univers a(2, 40, 40, 0, 1, 1, 2.5, 0.0005, 1, 1, 0, 0);
+    a.setFrequenceSortie(0);
+    a.initialiser(10, 10, 10, 20, Vector3D(0, 0, 0), Vector3D(0, 10, 0));
+    a.setChampForces(morse);
+    a.avancer(10);
+    a.saveCheckpoint(fichier);
+    a.avancer(20);
+    Univers b;
+    b.loadCheckpoint(fichier);
+    ASSERT_NE(b.getChampForces(), nullptr);
+    EXPECT_EQ(b.getChampForces()->getType(), ChampForces::MORSE);
+    EXPECT_EQ(b.getPotentielTabule(), nullptr);
+    b.avancer(20);
+    EXPECT_EQ(a.getStore().x, b.getStore().x);
+    EXPECT_EQ(a.getStore().fy, b.getStore().fy);
+    std::remove(fichier.c_str());
+}
+
+// Potential energy and virial of the analytic kernel by a loop over every pair (eps = sigma = 1)
+static void sommerPaires(const ParticuleStore &s, double rCut, double &energie, double &viriel) {
+    energie = 0;
+    viriel = 0;
+    for (int i = 0; i < s.getNbParticules(); i++) {
+        for (int j = i + 1; j < s.getNbParticules(); j++) {
+            const double rx = static_cast<double>(s.x[j]) - s.x[i];
+            const double ry = static_cast<double>(s.y[j]) - s.y[i];
+            const double rz = static_cast<double>(s.z[j]) - s.z[i];
+            const double r2 = rx * rx + ry * ry + rz * rz;
+            if (r2 >= rCut * rCut) {
+                continue;
+            }
+            const double s6 = 1 / (r2 * r2 * r2);
+            const double r = std::sqrt(r2);
+            const double masses = 0.5 * (s.masse[i] + s.masse[j]);
+            energie += 4 * s6 * (s6 - 1) - masses / r;
+            viriel -= 24 * s6 * (1 - 2 * s6) + masses / r;
+        }
+    }
+}
+
+// Test the statistics: the sums of the measured force pass match a loop over every pair in
+// every engine, the measured steps leave the run unchanged and fill the time series
+TEST(Univers, Statistiques) {
+    for (int dimension = 2; dimension <= 3; dimension++) {
+        for (int engine = 0; engine <= 2; engine++) {
+            for (int threads : {1, 3}) {
+                srand(11);
+                Univers u = (dimension == 3) ? Univers(3, 20, 20, 20, 1, 1, 2.5, 0.01, 1.0) : Univers(2, 40, 40, 0, 1, 1, 2.5, 0.01, 1.0);
+                if (dimension == 3) {
+                    u.initialiserUniforme(800, 1);
+                } else {
+                    u.initialiserDemoCercle(20, 20, 6, Vector3D(0, 0, 0), Vector3D(0, 0, 0));
+                }
+                u.setForceEngine(engine == 0 ? 0 : 1);
+                u.setNbThreads(threads);
+                if (engine == 2) {
+                    u.setVerletSkin(0.3);
+                    u.mettreAJourVoisinage(dimension == 3);
+                }
+                const Statistiques &mesure = u.mesurerStatistiques();
+                double energie, viriel;
+                sommerPaires(u.getStore(), 2.5, energie, viriel);
+                EXPECT_NEAR(mesure.energiePotentielle, energie, 1e-9 * (1 + std::abs(energie)));
+                EXPECT_NEAR(mesure.viriel, viriel, 1e-9 * (1 + std::abs(viriel)));
+
+                double ec = 0, py = 0;
+                const ParticuleStore &s = u.getStore();
+                for (int i = 0; i < s.getNbParticules(); i++) {
+                    ec += 0.5 * s.masse[i] * (s.vx[i] * s.vx[i] + s.vy[i] * s.vy[i] + s.vz[i] * s.vz[i]);
+                    py += s.masse[i] * s.vy[i];
+                }
+                EXPECT_NEAR(mesure.energieCinetique, ec, 1e-9 * (1 + ec));
+                EXPECT_NEAR(mesure.quantiteMouvement[1], py, 1e-9 * (1 + std::abs(py)));
+                EXPECT_NEAR(u.energieCinetique(), ec, 1e-9 * (1 + ec));
+                EXPECT_EQ(mesure.nbParticules, s.getNbParticules());
+                EXPECT_DOUBLE_EQ(mesure.temperature, 2 * mesure.energieCinetique / (dimension * mesure.nbParticules));
+                const double volume = (dimension == 3) ? 20.0 * 20 * 20 : 40.0 * 40;
+                EXPECT_DOUBLE_EQ(mesure.pression, (2 * mesure.energieCinetique + mesure.viriel) / (dimension * volume));
+            }
+        }
+    }
+
+    // The pair energies of a tabulated potential and of a two-species force field
+    srand(3);
+    Univers u(2, 40, 40, 0, 1, 1, 2.5, 0.01, 1.0);
+    u.initialiser(10, 10, 10, 20, Vector3D(0, 0, 0), Vector3D(0, 0, 0));
+    double energie, viriel;
+    sommerPaires(u.getStore(), 2.5, energie, viriel);
+    typedef PotentielTabule::Terme Terme;
+    u.setPotentielTabule(std::make_shared<PotentielTabule>(std::vector<Terme>{Terme::lennardJones(1, 1), Terme::gravitation()}, 0.5, 2.5));
+    EXPECT_NEAR(u.mesurerStatistiques().energiePotentielle, energie, 1e-6 * (1 + std::abs(energie)));
+    EXPECT_NEAR(u.getStatistiques().viriel, viriel, 1e-6 * (1 + std::abs(viriel)));
+
+    auto champ = std::make_shared<ChampForces>(ChampForces::MORSE, 2, 1, 2, 1.1);
+    champ->setCategorie(1, 0.5, 1.5, 1.3);
+    u.setChampForces(champ);
+    double attendue = 0;
+    const ParticuleStore &s = u.getStore();
+    for (int i = 0; i < s.getNbParticules(); i++) {
+        for (int j = i + 1; j < s.getNbParticules(); j++) {
+            const double rx = static_cast<double>(s.x[j]) - s.x[i], ry = static_cast<double>(s.y[j]) - s.y[i];
+            const double r2 = rx * rx + ry * ry;
+            if (r2 < 2.5 * 2.5) {
+                attendue += champ->getEnergie(s.categorie[i], s.categorie[j], r2) - 0.5 * (s.masse[i] + s.masse[j]) / std::sqrt(r2);
+            }
+        }
+    }
+    EXPECT_NEAR(u.mesurerStatistiques().energiePotentielle, attendue, 1e-9 * (1 + std::abs(attendue)));
+
+    // Measured steps: the same run, the series of the measures, the energy in the uniform field
+    const std::string fichier = "statistiques.bin";
+    srand(5);
+    Univers a(2, 40, 40, 0, 1, 1, 2.5, 0.0005, 1, 0, -1, 0);
+    a.setFrequenceSortie(0);
+    a.initialiser(10, 10, 10, 20, Vector3D(0, 0, 0), Vector3D(0, 10, 0));
+    srand(5);
+    Univers b(2, 40, 40, 0, 1, 1, 2.5, 0.0005, 1, 0, -1, 0);
+    b.setFrequenceSortie(0);
+    b.initialiser(10, 10, 10, 20, Vector3D(0, 0, 0), Vector3D(0, 10, 0));
+    b.setStatistiques(10, fichier);
+    EXPECT_EQ(b.getFrequenceStatistiques(), 10);
+    a.avancer(50);
+    b.avancer(50);
+    EXPECT_EQ(a.getStore().x, b.getStore().x);
+    EXPECT_EQ(a.getStore().vy, b.getStore().vy);
+    const Statistiques derniere = b.getStatistiques();
+    EXPECT_EQ(derniere.iteration, 50);
+    const Statistiques &recalculee = b.mesurerStatistiques();
+    EXPECT_NEAR(recalculee.energiePotentielle, derniere.energiePotentielle, 1e-9 * (1 + std::abs(derniere.energiePotentielle)));
+    EXPECT_EQ(recalculee.energieCinetique, derniere.energieCinetique);
+    double hauteur = 0;
+    for (int i = 0; i < b.getStore().getNbParticules(); i++) {
+        hauteur += b.getStore().masse[i] * b.getStore().y[i];
+    }
+    sommerPaires(b.getStore(), 2.5, energie, viriel);
+    EXPECT_NEAR(derniere.energiePotentielle, energie + hauteur, 1e-9 * (1 + std::abs(energie + hauteur)));
+
+    const std::vector<Statistiques> serie = SerieStatistiques::lire(fichier);
+    ASSERT_EQ(serie.size(), 5u);
+    for (int k = 0; k < 5; k++) {
+        EXPECT_EQ(serie[k].iteration, 10 * (k + 1));
+    }
+    EXPECT_EQ(serie.back().energiePotentielle, derniere.energiePotentielle);
+    EXPECT_EQ(serie.back().quantiteMouvement[1], derniere.quantiteMouvement[1]);
+    EXPECT_EQ(serie.back().temps, derniere.temps);
+    EXPECT_THROW(b.setStatistiques(-1), std::invalid_argument);
+    b.setStatistiques(0);
+    std::remove(fichier.c_str());
+}
+
+// Test that each thermostat brings the temperature to its target, and the runs it makes reproducible
+TEST(Univers, Thermostat) {
+    auto gaz = [](int threads) {
+        srand(13);
+        Univers u(3, 12, 12, 12, 1, 1, 2.5, 0.002, 1, 2, 0, 0);
+        u.initialiserUniforme(400, 2);
+        u.setFrequenceSortie(0);
+        u.setNbThreads(threads);
+        return u;
+    };
+    for (int type : {Thermostat::BERENDSEN, Thermostat::LANGEVIN, Thermostat::NOSE_HOOVER}) {
+        Univers u = gaz(1);
+        u.setThermostat(type, 0.8, 0.05, 3);
+        EXPECT_EQ(u.getThermostat().getType(), type);
+        u.setStatistiques(1);
+        u.avancer(1500);
+        double moyenne = 0;
+        for (int k = 0; k < 500; k++) {
+            u.avancer(1);
+            moyenne += u.getStatistiques().temperature / 500;
+        }
+        EXPECT_NEAR(moyenne, 0.8, 0.08) << "thermostat " << type;
+    }
+
+    // The random kicks do not depend on the number of threads (only the order of the force sums does)
+    Univers a = gaz(1), b = gaz(3);
+    a.setThermostat(Thermostat::LANGEVIN, 0.8, 0.05, 3);
+    b.setThermostat(Thermostat::LANGEVIN, 0.8, 0.05, 3);
+    a.avancer(20);
+    b.avancer(20);
+    ASSERT_EQ(a.getStore().getNbParticules(), b.getStore().getNbParticules());
+    for (int i = 0; i < a.getStore().getNbParticules(); i++) {
+        EXPECT_NEAR(a.getStore().vx[i], b.getStore().vx[i], 1e-6);
+        EXPECT_NEAR(a.getStore().z[i], b.getStore().z[i], 1e-6);
+    }
+
+    // The friction of Nosé–Hoover goes through the restart file
+    const std::string fichier = "reprise_thermostat_univers.bin";
+    Univers c = gaz(1);
+    c.setThermostat(Thermostat::NOSE_HOOVER, 0.8, 0.05);
+    c.avancer(30);
+    c.saveCheckpoint(fichier);
+    c.avancer(20);
+    Univers d;
+    d.loadCheckpoint(fichier);
+    EXPECT_EQ(d.getThermostat().getType(), Thermostat::NOSE_HOOVER);
+    d.avancer(20);
+    EXPECT_EQ(d.getThermostat().getFriction(), c.getThermostat().getFriction());
+    EXPECT_EQ(c.getStore().vx, d.getStore().vx);
+    EXPECT_EQ(c.getStore().y, d.getStore().y);
+    std::remove(fichier.c_str());
+
+    EXPECT_THROW(c.setThermostat(Thermostat::BERENDSEN, 1, -1), std::invalid_argument);
+    EXPECT_THROW(c.setThermostat(7, 1, 1), std::invalid_argument);
+}
+
+// Test the adaptive step: bounded, as accurate as the fixed step of its displacement, resumed identically
+TEST(Univers, PasAdaptatif) {
+    auto gaz = [](float dt, float tmax) {
+        srand(1);
+        Univers u(3, 10, 10, 10, 1, 1, 2.5, dt, tmax, 2, 0, 0);
+        u.initialiserUniforme(300, 2);
+        u.setFrequenceSortie(0);
+        auto champ = std::make_shared<ChampForces>(ChampForces::SPHERE_MOLLE, 1, 1, 1);
+        champ->setGravitation(false);
+        u.setChampForces(champ);
+        return u;
+    };
+    auto derive = [](Univers &u, int &nbPas, float &dtMin, float &dtMax) {
+        const double initiale = u.mesurerStatistiques().getEnergieTotale();
+        nbPas = 0;
+        dtMin = 1;
+        dtMax = 0;
+        while (u.getTemps() < 0.5f) {
+            u.avancer(1);
+            nbPas++;
+            dtMin = std::min(dtMin, u.getDt());
+            dtMax = std::max(dtMax, u.getDt());
+        }
+        return std::abs(u.mesurerStatistiques().getEnergieTotale() - initiale) / std::abs(initiale);
+    };
+    Univers fixe = gaz(0.002, 1);
+    Univers adaptatif = gaz(0.02, 1);
+    adaptatif.setPasAdaptatif(0.01, 1e-5);
+    EXPECT_EQ(adaptatif.getPasAdaptatif(), 0.01f);
+    int pasFixe, pasAdaptatif;
+    float minimum, maximum;
+    const double erreurFixe = derive(fixe, pasFixe, minimum, maximum);
+    const double erreurAdaptative = derive(adaptatif, pasAdaptatif, minimum, maximum);
+    EXPECT_GE(minimum, 1e-5f);
+    EXPECT_LE(maximum, 0.02f);
+    EXPECT_LT(minimum, maximum);
+    EXPECT_LT(erreurAdaptative, 1e-4);
+    EXPECT_LT(erreurAdaptative, 2 * erreurFixe + 1e-6);
+
+    // A run until tmax ends at tmax
+    Univers fin = gaz(0.02, 0.05f);
+    fin.setPasAdaptatif(0.01);
+    fin.evolution();
+    EXPECT_FLOAT_EQ(fin.getTemps(), 0.05f);
+
+    // Resumed from a restart file, the steps are the same
+    const std::string fichier = "reprise_pas_adaptatif.bin";
+    Univers a = gaz(0.02, 1);
+    a.setPasAdaptatif(0.01, 0, 0.01);
+    a.avancer(20);
+    a.saveCheckpoint(fichier);
+    a.avancer(30);
+    Univers b;
+    b.loadCheckpoint(fichier);
+    EXPECT_EQ(b.getPasAdaptatif(), 0.01f);
+    b.avancer(30);
+    EXPECT_EQ(a.getTemps(), b.getTemps());
+    EXPECT_EQ(a.getDt(), b.getDt());
+    EXPECT_EQ(a.getStore().x, b.getStore().x);
+    EXPECT_EQ(a.getStore().vz, b.getStore().vz);
+    std::remove(fichier.c_str());
+
+    // Back to the fixed step, the largest one
+    a.setPasAdaptatif(0);
+    EXPECT_EQ(a.getDt(), 0.01f);
+    EXPECT_THROW(a.setPasAdaptatif(-1), std::invalid_argument);
+    EXPECT_THROW(a.setPasAdaptatif(0.01, 0.1, 0.01), std::invalid_argument);
+}
+
+// Test that the multithreaded force engines give the same forces as the sequential ones,
+// the Verlet lists (engine 2) included
+TEST(Univers, MultithreadedForcesMatchSequential) {
+    for (int engine = 0; engine <= 2; engine++) {
+        srand(3);
+        Univers u(2, 60, 60, 0, 1, 1, 2.5, 0.01, 1.0);
+        u.initialiserDemoCercle(20, 20, 6, Vector3D(0, 0, 0), Vector3D(0, 0, 0));
+        u.setForceEngine(engine == 0 ? 0 : 1);
+        if (engine == 2) {
+            u.setVerletSkin(0.3);
+            u.mettreAJourVoisinage(false);
+        }
+        u.calculForces();
+        ParticuleStore sequentiel = u.getStore();
+
+        u.setNbThreads(4);
+        EXPECT_EQ(u.getNbThreads(), 4);
+        u.calculForces();
+        ParticuleStore &parallele = u.getStore();
+        for (int i = 0; i < parallele.getNbParticules(); i++) {
+            EXPECT_NEAR(sequentiel.fx[i], parallele.fx[i], TOLERANCE_FORCE * (1 + std::abs(sequentiel.fx[i])));
+            EXPECT_NEAR(sequentiel.fy[i], parallele.fy[i], TOLERANCE_FORCE * (1 + std::abs(sequentiel.fy[i])));
+        }
+    }
+}
+
+// Test that the weighted blocks of cells give the same forces as the sequential engines
+// when the particles are concentrated, in every order of the cells
+TEST(Univers, MultithreadedConcentratedForcesMatchSequential) {
+    for (int ordre : {OrdreCellules::LIGNES, OrdreCellules::MORTON, OrdreCellules::HILBERT}) {
+        for (int engine = 0; engine <= 1; engine++) {
+            srand(5);
+            Univers u(2, 200, 200, 0, 1, 1, 2.5, 0.01, 1.0);
+            u.initialiserDemoCercle(15, 15, 5, Vector3D(0, 0, 0), Vector3D(0, 0, 0));
+            u.setOrdreCellules(ordre);
+            u.setForceEngine(engine);
+            u.calculForces();
+            ParticuleStore sequentiel = u.getStore();
+
+            u.setNbThreads(3);
+            u.calculForces();
+            ParticuleStore &parallele = u.getStore();
+            ASSERT_EQ(sequentiel.getNbParticules(), parallele.getNbParticules());
+            for (int i = 0; i < parallele.getNbParticules(); i++) {
+                EXPECT_EQ(sequentiel.id[i], parallele.id[i]);
+                EXPECT_NEAR(sequentiel.fx[i], parallele.fx[i], TOLERANCE_FORCE * (1 + std::abs(sequentiel.fx[i])));
+                EXPECT_NEAR(sequentiel.fy[i], parallele.fy[i], TOLERANCE_FORCE * (1 + std::abs(sequentiel.fy[i])));
+            }
+        }
+    }
+}
+
+// Test that the sparse grid creates few cells and gives the same forces and steps as the dense one
+TEST(Univers, GrilleCreuse) {
+    auto creer = [](bool creuse, int nbThreads) {
+        srand(7);
+        Univers u(2, 400, 400, 0, 1, 1, 2.5, 0.0005, 1, 1, 0, 0);
+        u.setGrilleCreuse(creuse);
+        u.setNbThreads(nbThreads);
+        u.setFrequenceSortie(0);
+        u.initialiserDemoCercle(12, 12, 4, Vector3D(0, -20, 0), Vector3D(0, -40, 0));
+        return u;
+    };
+    for (int engine = 0; engine <= 1; engine++) {
+        for (int nbThreads : {1, 3}) {
+            Univers dense = creer(false, nbThreads);
+            Univers creuse = creer(true, nbThreads);
+            dense.setForceEngine(engine);
+            creuse.setForceEngine(engine);
+            EXPECT_TRUE(creuse.getGrilleCreuse());
+            EXPECT_EQ(dense.getNbCellules(), 160 * 160);
+            EXPECT_LT(creuse.getNbCellules(), 200);
+
+            // Same cells in the same order: the stores are identical, up to the order in
+            // which the half shell slabs add their forces with several threads
+            dense.calculForces();
+            creuse.calculForces();
+            const ParticuleStore &fd = dense.getStore();
+            const ParticuleStore &fc = creuse.getStore();
+            EXPECT_EQ(fd.id, fc.id);
+            if (nbThreads == 1) {
+                EXPECT_EQ(fd.fx, fc.fx);
+                EXPECT_EQ(fd.fy, fc.fy);
+            } else {
+                for (int i = 0; i < fd.getNbParticules(); i++) {
+                    EXPECT_NEAR(fc.fx[i], fd.fx[i], 1e-9 * (1 + std::abs(fd.fx[i])));
+                    EXPECT_NEAR(fc.fy[i], fd.fy[i], 1e-9 * (1 + std::abs(fd.fy[i])));
+                }
+            }
+
+            // The particles leave the created cells through the periodic boundary
+            dense.avancer(80);
+            creuse.avancer(80);
+            std::map<int, int> indices;
+            const ParticuleStore &sd = dense.getStore();
+            for (int i = 0; i < sd.getNbParticules(); i++) {
+                indices[sd.id[i]] = i;
+            }
+            const ParticuleStore &sc = creuse.getStore();
+            ASSERT_EQ(sc.getNbParticules(), sd.getNbParticules());
+            for (int i = 0; i < sc.getNbParticules(); i++) {
+                const int j = indices[sc.id[i]];
+                EXPECT_NEAR(sc.x[i], sd.x[j], 1e-6);
+                EXPECT_NEAR(sc.y[i], sd.y[j], 1e-6);
+            }
+            EXPECT_LT(creuse.getNbCellules(), 400);
+        }
+    }
+
+    // Back to the dense grid, and the orders that need every cell
+    Univers u = creer(true, 1);
+    EXPECT_THROW(u.setOrdreCellules(OrdreCellules::MORTON), std::invalid_argument);
+    u.setGrilleCreuse(false);
+    EXPECT_EQ(u.getNbCellules(), 160 * 160);
+    u.calculForces();
+    u.setOrdreCellules(OrdreCellules::HILBERT);
+    EXPECT_THROW(u.setGrilleCreuse(true), std::invalid_argument);
+}
+
+// Test that a sparse grid is restored exactly from a restart file
+TEST(Univers, GrilleCreuseCheckpoint) {
+    const std::string fichier = "reprise_creuse.bin";
+    for (int troisD = 0; troisD <= 1; troisD++) {
+        srand(13);
+        Univers a = troisD ? Univers(3, 60, 60, 60, 1, 1, 2.5, 0.0005, 1, 1, 0, 0)
+                           : Univers(2, 300, 300, 0, 1, 1, 2.5, 0.0005, 1, 1, 0, 0);
+        a.setGrilleCreuse(true);
+        a.setFrequenceSortie(0);
+        if (troisD) {
+            a.initialiser(4, 4, 4, 4, Vector3D(0, 0, 0), Vector3D(0, 10, 0));
+        } else {
+            a.initialiserDemoCercle(10, 10, 3, Vector3D(0, -20, 0), Vector3D(0, -40, 0));
+        }
+        a.avancer(20);
+        a.saveCheckpoint(fichier);
+        a.avancer(30);
+
+        Univers b;
+        b.loadCheckpoint(fichier);
+        EXPECT_TRUE(b.getGrilleCreuse());
+        b.avancer(30);
+        EXPECT_EQ(a.getNbCellules(), b.getNbCellules());
+        EXPECT_EQ(a.getStore().id, b.getStore().id);
+        EXPECT_EQ(a.getStore().x, b.getStore().x);
+        EXPECT_EQ(a.getStore().vy, b.getStore().vy);
+        EXPECT_EQ(a.getStore().fx, b.getStore().fx);
+    }
+    std::remove(fichier.c_str());
+}
+
+// Test the output cadence: every K steps, then every interval of simulated time
+TEST(Univers, OutputCadence) {
+    auto existe = [](int k) {
+        std::ifstream f("univers_cadence_t" + std::to_string(k) + ".vtu");
+        return f.good();
+    };
+    auto nettoyer = [](int n) {
+        for (int k = 0; k <= n; k++) {
+            std::remove(("univers_cadence_t" + std::to_string(k) + ".vtu").c_str());
+        }
+    };
+
+    Univers u(2, 20, 20, 0, 1, 1, 2.5, 0.01, 0.1, 1, 0, 0);
+    u.initialiser(4, 4, 4, 4, Vector3D(0, 0, 0), Vector3D(0, 0, 0));
+    u.setPrefixeSortie("univers_cadence");
+    u.setFrequenceSortie(4);
+    u.setEcritureAsynchrone(true);
+    u.evolution();
+    EXPECT_TRUE(existe(0));
+    EXPECT_FALSE(existe(2));
+    EXPECT_TRUE(existe(4));
+    EXPECT_TRUE(existe(8));
+    EXPECT_FALSE(existe(9));
+    nettoyer(20);
+
+    u.setEcritureAsynchrone(false);
+    u.setIntervalleSortie(0.05f);
+    u.evolution();
+    EXPECT_TRUE(existe(0));
+    EXPECT_FALSE(existe(1));
+    EXPECT_TRUE(existe(5));
+    EXPECT_TRUE(existe(10));
+    nettoyer(20);
+
+    EXPECT_THROW(u.setFrequenceSortie(-1), std::invalid_argument);
+    EXPECT_THROW(u.setIntervalleSortie(-1), std::invalid_argument);
+}
+
+// Test that avancer continues the simulation like a whole evolution
+TEST(Univers, AvancerMatchesEvolution) {
+    for (int bc = 0; bc < 3; bc++) {
+        Univers a(2, 20, 20, 0, 1, 1, 2.5, 0.001, 0.02, bc, 0, 0);
+        a.initialiser(4, 4, 4, 4, Vector3D(0, 0, 0), Vector3D(0, 10, 0));
+        a.setFrequenceSortie(0);
+        a.evolution();
+
+        Univers b(2, 20, 20, 0, 1, 1, 2.5, 0.001, 0.02, bc, 0, 0);
+        b.initialiser(4, 4, 4, 4, Vector3D(0, 0, 0), Vector3D(0, 10, 0));
+        b.setFrequenceSortie(0);
+        b.avancer(5);
+        b.avancer(a.getIteration() - 5);
+
+        EXPECT_EQ(b.getIteration(), a.getIteration());
+        const ParticuleStore &sa = a.getStore();
+        const ParticuleStore &sb = b.getStore();
+        ASSERT_EQ(sa.getNbParticules(), sb.getNbParticules());
+        for (int i = 0; i < sa.getNbParticules(); i++) {
+            EXPECT_EQ(sa.id[i], sb.id[i]);
+            EXPECT_EQ(sa.x[i], sb.x[i]);
+            EXPECT_EQ(sa.y[i], sb.y[i]);
+            EXPECT_EQ(sa.vx[i], sb.vx[i]);
+        }
+    }
+    Univers u(2, 20, 20, 0, 2.5, 0.01, 1.0);
+    EXPECT_THROW(u.avancer(-1), std::invalid_argument);
+}
+
+// Test the uniform initialization, including a box that is not a multiple of rCut
+TEST(Univers, InitialiserUniforme) {
+    Univers u2(2, 41, 41, 0, 1, 1, 2.5, 0.001, 0.01, 1, 0, 0);
+    u2.initialiserUniforme(1000, 1);
+    EXPECT_EQ(u2.getNbParticules(), 1000);
+
+    Univers u3(3, 21, 21, 21, 1, 1, 2.5, 0.001, 0.01, 1, 0, 0);
+    u3.initialiserUniforme(5000, 1);
+    EXPECT_EQ(u3.getNbParticules(), 5000);
+    const ParticuleStore &s = u3.getStore();
+    for (int i = 0; i < s.getNbParticules(); i++) {
+        EXPECT_GE(s.x[i], 0);
+        EXPECT_LT(s.x[i], 21);
+        EXPECT_GE(s.z[i], 0);
+        EXPECT_LT(s.z[i], 21);
+        EXPECT_LE(std::abs(s.vx[i]), 1.0);
+    }
+    EXPECT_THROW(u3.initialiserUniforme(-1, 1), std::invalid_argument);
+}
+
+// Test the pair counters of the force engines and the performance report of a run
+TEST(Univers, ProfilEtRapport) {
+    Univers u(3, 15, 15, 15, 1, 1, 2.5, 0.0005, 0.0025, 1, 0, 0);
+    u.initialiserUniforme(1000, 1);
+    u.setProfilage(true);
+
+    u.setForceEngine(0);
+    u.calculForces3D();
+    const long activesPleine = u.getProfil().getNbPairesActives();
+    u.setForceEngine(1);
+    u.calculForces3D();
+    const long activesDemi = u.getProfil().getNbPairesActives() - activesPleine;
+    // The full shell sees every pair twice
+    EXPECT_GT(activesDemi, 0);
+    EXPECT_EQ(activesPleine, 2 * activesDemi);
+
+    u.setFrequenceSortie(0);
+    u.setRapportPerformance("rapport_test.csv", 2);
+    u.evolution();
+    std::ifstream f("rapport_test.csv");
+    std::string ligne;
+    int nbLignes = 0;
+    while (std::getline(f, ligne)) {
+        nbLignes++;
+    }
+    f.close();
+    std::remove("rapport_test.csv");
+    // Header, steps 2 and 4, final report
+    EXPECT_EQ(nbLignes, 1 + u.getIteration() / 2 + 1);
+    EXPECT_EQ(u.getProfil().getNbAppels(ProfilPerformance::FORCES), u.getIteration());
+    EXPECT_GT(u.getProfil().getTemps(ProfilPerformance::FORCES), 0);
+}
+
+// Test that the cell force engines give the same forces with every instruction set
+TEST(Univers, JeuInstructions) {
+    EXPECT_THROW(Univers(3, 10, 10, 10, 1, 1, 2.5, 0.01, 1.0).setJeuInstructions(NoyauLJ::AVX512 + 1), std::invalid_argument);
+    for (int engine = 0; engine <= 1; engine++) {
+        Univers u(3, 12, 12, 12, 1, 1, 2.5, 0.0005, 0.0025, 1, 0, 0);
+        srand(5);
+        u.initialiserUniforme(1000, 1);
+        u.setForceEngine(engine);
+        u.setJeuInstructions(NoyauLJ::SCALAIRE);
+        EXPECT_EQ(u.getJeuInstructions(), NoyauLJ::SCALAIRE);
+        u.calculForces3D();
+        ParticuleStore scalaire = u.getStore();
+
+        u.setJeuInstructions(NoyauLJ::AUTOMATIQUE);
+        EXPECT_EQ(u.getJeuInstructions(), NoyauLJ::detecter());
+        u.calculForces3D();
+        ParticuleStore &vectoriel = u.getStore();
+        for (int i = 0; i < vectoriel.getNbParticules(); i++) {
+            EXPECT_NEAR(scalaire.fx[i], vectoriel.fx[i], TOLERANCE_FORCE * (1 + std::abs(scalaire.fx[i])));
+            EXPECT_NEAR(scalaire.fy[i], vectoriel.fy[i], TOLERANCE_FORCE * (1 + std::abs(scalaire.fy[i])));
+            EXPECT_NEAR(scalaire.fz[i], vectoriel.fz[i], TOLERANCE_FORCE * (1 + std::abs(scalaire.fz[i])));
+        }
+    }
+}
+
+// Test that the space-filling-curve orders of the cells give the same forces as the row-major order
+TEST(Univers, OrdreCellules) {
+    EXPECT_THROW(Univers(3, 10, 10, 10, 1, 1, 2.5, 0.01, 1.0).setOrdreCellules(OrdreCellules::HILBERT + 1), std::invalid_argument);
+    for (int engine = 0; engine <= 1; engine++) {
+        for (int nbThreads : {1, 4}) {
+            Univers u(3, 21, 21, 21, 1, 1, 2.5, 0.0005, 0.0025, 1, 0, 0);
+            srand(7);
+            u.initialiserUniforme(1000, 1);
+            u.setForceEngine(engine);
+            u.setNbThreads(nbThreads);
+            u.calculForces3D();
+            ParticuleStore lignes = u.getStore();
+            std::vector<int> rang(lignes.getNbParticules());
+            for (int i = 0; i < lignes.getNbParticules(); i++) {
+                rang[lignes.id[i]] = i;
+            }
+
+            for (int ordre : {OrdreCellules::MORTON, OrdreCellules::HILBERT, OrdreCellules::LIGNES}) {
+                u.setOrdreCellules(ordre);
+                EXPECT_EQ(u.getOrdreCellules(), ordre);
+                u.calculForces3D();
+                const ParticuleStore &s = u.getStore();
+                const std::vector<Cellule> cellules = u.getCellules();
+                ASSERT_EQ(s.getNbParticules(), lignes.getNbParticules());
+                for (int i = 0; i < s.getNbParticules(); i++) {
+                    // Each particle lies in its cell
+                    const int *id = cellules[s.cellule[i]].getId();
+                    EXPECT_EQ(id[0], std::min(static_cast<int>(s.x[i] / 2.5f), 7));
+                    EXPECT_EQ(id[2], std::min(static_cast<int>(s.z[i] / 2.5f), 7));
+                    const int j = rang[s.id[i]];
+                    EXPECT_NEAR(lignes.fx[j], s.fx[i], TOLERANCE_FORCE * (1 + std::abs(lignes.fx[j])));
+                    EXPECT_NEAR(lignes.fy[j], s.fy[i], TOLERANCE_FORCE * (1 + std::abs(lignes.fy[j])));
+                    EXPECT_NEAR(lignes.fz[j], s.fz[i], TOLERANCE_FORCE * (1 + std::abs(lignes.fz[j])));
+                }
+            }
+        }
+    }
+
+    // Order selected before the particles are added, then kept through the migrations
+    Univers a(2, 20, 20, 0, 1, 1, 2.5, 0.001, 0.02, 1, 0, 0);
+    a.initialiser(4, 4, 4, 4, Vector3D(0, 0, 0), Vector3D(0, 10, 0));
+    a.setFrequenceSortie(0);
+    a.evolution();
+    Univers b(2, 20, 20, 0, 1, 1, 2.5, 0.001, 0.02, 1, 0, 0);
+    b.setOrdreCellules(OrdreCellules::HILBERT);
+    b.initialiser(4, 4, 4, 4, Vector3D(0, 0, 0), Vector3D(0, 10, 0));
+    b.setFrequenceSortie(0);
+    b.evolution();
+    EXPECT_EQ(b.getOrdreCellules(), OrdreCellules::HILBERT);
+    const ParticuleStore &sa = a.getStore();
+    const ParticuleStore &sb = b.getStore();
+    ASSERT_EQ(sa.getNbParticules(), sb.getNbParticules());
+    std::vector<int> rang(sa.getNbParticules());
+    for (int i = 0; i < sa.getNbParticules(); i++) {
+        rang[sa.id[i]] = i;
+    }
+    for (int i = 0; i < sb.getNbParticules(); i++) {
+        const int j = rang[sb.id[i]];
+        EXPECT_NEAR(sa.x[j], sb.x[i], 1e-3);
+        EXPECT_NEAR(sa.y[j], sb.y[i], 1e-3);
+    }
+}
+
+// Test that a run resumed from a restart file follows the uninterrupted trajectory bit for bit
+TEST(Univers, Checkpoint) {
+    const std::string fichier = "reprise_test.bin";
+    auto identiques = [](Univers &a, Univers &b) {
+        EXPECT_EQ(a.getIteration(), b.getIteration());
+        EXPECT_EQ(a.getTemps(), b.getTemps());
+        const ParticuleStore &sa = a.getStore();
+        const ParticuleStore &sb = b.getStore();
+        ASSERT_EQ(sa.getNbParticules(), sb.getNbParticules());
+        EXPECT_EQ(sa.id, sb.id);
+        EXPECT_EQ(sa.x, sb.x);
+        EXPECT_EQ(sa.y, sb.y);
+        EXPECT_EQ(sa.z, sb.z);
+        EXPECT_EQ(sa.vx, sb.vx);
+        EXPECT_EQ(sa.vy, sb.vy);
+        EXPECT_EQ(sa.vz, sb.vz);
+        EXPECT_EQ(sa.fx, sb.fx);
+        EXPECT_EQ(sa.fyOld, sb.fyOld);
+    };
+
+    // 2D with every boundary condition, 3D along a Hilbert curve, 3D with Verlet lists
+    for (int cas = 0; cas < 5; cas++) {
+        const bool troisD = cas >= 3;
+        Univers a = troisD ? Univers(3, 15, 15, 15, 1, 1, 2.5, 0.0005, 1, 1, 0, 0)
+                           : Univers(2, 20, 20, 0, 1, 1, 2.5, 0.001, 1, cas, 0, 0);
+        srand(11);
+        if (troisD) {
+            a.initialiserUniforme(800, 1);
+            if (cas == 3) {
+                a.setOrdreCellules(OrdreCellules::HILBERT);
+            } else {
+                a.setVerletSkin(0.3f);
+            }
+        } else {
+            a.initialiser(4, 4, 4, 4, Vector3D(0, 0, 0), Vector3D(0, 10, 0));
+        }
+        a.setFrequenceSortie(0);
+        a.avancer(10);
+        a.saveCheckpoint(fichier);
+        a.avancer(15);
+
+        Univers b;
+        b.loadCheckpoint(fichier);
+        EXPECT_EQ(b.getDimension(), a.getDimension());
+        EXPECT_EQ(b.getIteration(), 10);
+        b.avancer(15);
+        identiques(a, b);
+    }
+
+    // Periodic saves during an evolution, then the end of the run from the last one
+    Univers a(2, 20, 20, 0, 1, 1, 2.5, 0.001, 0.05, 1, 0, 0);
+    a.initialiser(4, 4, 4, 4, Vector3D(0, 0, 0), Vector3D(0, 10, 0));
+    a.setFrequenceSortie(0);
+    a.setCheckpoint(fichier, 20);
+    a.evolution();
+    a.setCheckpoint("", 0);
+    Univers b;
+    b.loadCheckpoint(fichier);
+    EXPECT_EQ(b.getIteration(), 40);
+    b.poursuivreEvolution();
+    identiques(a, b);
+
+    // Truncated and missing files
+    {
+        std::ifstream entree(fichier, std::ios::binary);
+        std::string contenu((std::istreambuf_iterator<char>(entree)), std::istreambuf_iterator<char>());
+        std::ofstream sortie(fichier, std::ios::binary | std::ios::trunc);
+        sortie.write(contenu.data(), static_cast<std::streamsize>(contenu.size() / 2));
+    }
+    EXPECT_THROW(b.loadCheckpoint(fichier), std::runtime_error);
+    std::remove(fichier.c_str());
+    EXPECT_THROW(b.loadCheckpoint(fichier), std::runtime_error);
+    EXPECT_THROW(b.setCheckpoint(fichier, 0), std::invalid_argument);
+}
+
+// Test the trajectory file: same cadence as the VTK files, and resumed after a checkpoint
+TEST(Univers, Trajectoire) {
+    Univers a(2, 20, 20, 0, 1, 1, 2.5, 0.01, 0.1, 1, 0, 0);
+    a.initialiser(4, 4, 4, 4, Vector3D(0, 0, 0), Vector3D(0, 10, 0));
+    a.setFrequenceSortie(4);
+    a.setPrefixeSortie("univers_trajectoire");
+    a.setTrajectoire("univers_test.traj");
+    a.evolution();
+    EXPECT_FALSE(std::ifstream("univers_trajectoire_t0.vtu").good());
+    {
+        LectureTrajectoire lecture("univers_test.traj");
+        ASSERT_EQ(lecture.getNbFrames(), a.getIteration() / 4 + 1);
+        FrameTrajectoire frame;
+        lecture.lireFrame(lecture.getNbFrames() - 1, frame);
+        EXPECT_EQ(frame.iteration, a.getIteration() / 4 * 4);
+        EXPECT_EQ(frame.getNbParticules(), a.getNbParticules());
+    }
+
+    // A run resumed from a checkpoint rewrites the same trajectory
+    auto lireFichier = [](const std::string &nom) {
+        std::ifstream f(nom, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    };
+    Univers b(2, 20, 20, 0, 1, 1, 2.5, 0.001, 1, 1, 0, 0);
+    b.initialiser(4, 4, 4, 4, Vector3D(0, 0, 0), Vector3D(0, 10, 0));
+    b.setFrequenceSortie(3);
+    b.setTrajectoire("univers_test.traj");
+    b.avancer(10);
+    b.saveCheckpoint("univers_test.bin");
+    b.avancer(10);
+    b.setTrajectoire("");
+    const std::string complete = lireFichier("univers_test.traj");
+
+    Univers c;
+    c.loadCheckpoint("univers_test.bin");
+    c.setTrajectoire("univers_test.traj", true);
+    c.avancer(10);
+    c.setTrajectoire("");
+    EXPECT_EQ(lireFichier("univers_test.traj"), complete);
+    std::remove("univers_test.traj");
+    std::remove("univers_test.bin");
+}